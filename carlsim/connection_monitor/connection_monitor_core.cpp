@@ -24,6 +24,7 @@ ConnectionMonitorCore::ConnectionMonitorCore(CpuSNN* snn,int monitorId,short int
 	wtTimeWrite_ = -1;
 
 	connFileId_ = NULL;
+	connFileWriterId_ = -1;
 	needToWriteFileHeader_ = true;
 	needToInit_ = true;
 	connFileSignature_ = 202029319;
@@ -80,9 +81,10 @@ ConnectionMonitorCore::~ConnectionMonitorCore() {
 			writeConnectFileSnapshot(snn_->getSimTime(), snn_->getWeightMatrix2D(connId_));
 		}
 
-		// then close file and clean up
-		fclose(connFileId_);
+		// then close file (once everything has been written) and clean up
+		snn_->getMonitorWriter()->closeFile(connFileWriterId_);
 		connFileId_ = NULL;
+		connFileWriterId_ = -1;
 		needToInit_ = true;
 		needToWriteFileHeader_ = true;
 	}
@@ -379,6 +381,9 @@ void ConnectionMonitorCore::setConnectFileId(FILE* connFileId) {
 		// for now: file pointer has changed, so we need to write header (again)
 		needToWriteFileHeader_ = true;
 		writeConnectFileHeader();
+
+		// snapshots are written in the background
+		connFileWriterId_ = snn_->getMonitorWriter()->addFile(connFileId_);
 	}
 }
 
@@ -468,7 +473,7 @@ void ConnectionMonitorCore::writeConnectFileHeader() {
 	needToWriteFileHeader_ = false;
 }
 
-void ConnectionMonitorCore::writeConnectFileSnapshot(unsigned int simTimeMs, std::vector< std::vector<float> > wts) {
+void ConnectionMonitorCore::writeConnectFileSnapshot(unsigned int simTimeMs, const std::vector< std::vector<float> >& wts) {
 	// don't write if we have already written this timestamp to file (or file doesn't exist)
 	if ((int64_t)simTimeMs <= wtTimeWrite_ || connFileId_==NULL) {
 		return;
@@ -476,16 +481,12 @@ void ConnectionMonitorCore::writeConnectFileSnapshot(unsigned int simTimeMs, std
 
 	wtTimeWrite_ = (int64_t)simTimeMs;
 
-	// write time stamp
-	if (!fwrite(&wtTimeWrite_,sizeof(int64_t),1,connFileId_))
-		KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
-
-	// write all weights
+	// write time stamp and all weights, one row of the weight matrix at a time
+	// fwrite errors are reported by CpuSNN::runNetwork
+	AsyncWriter* writer = snn_->getMonitorWriter();
+	writer->append(connFileWriterId_, &wtTimeWrite_, sizeof(int64_t));
 	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			if (!fwrite(&wts[i][j],sizeof(float),1,connFileId_)) {
-				KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
-			}
-		}
+		writer->append(connFileWriterId_, &wts[i][0], sizeof(float)*nNeurPost_);
 	}
+	writer->submit(connFileWriterId_);
 }
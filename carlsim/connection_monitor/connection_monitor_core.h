@@ -124,6 +124,9 @@ public:
 
 	int getUpdateTimeIntervalSec() { return connFileTimeIntervalSec_; }
 
+	//! forgets the timestamps of all snapshots, so that new snapshots are taken when simulation time starts over
+	void resetSnapshotTimes() { wtTime_ = -1; wtTimeLast_ = -1; wtTimeWrite_ = -1; }
+
 	//! returns absolute sum of all weight changes since last snapshot
 	double getTotalAbsWeightChange();
 
@@ -162,7 +165,7 @@ public:
 	void setUpdateTimeIntervalSec(int intervalSec);
 
 	//! writes each snapshot to connect file
-	void writeConnectFileSnapshot(unsigned int simTimeMs, std::vector< std::vector<float> > wts);
+	void writeConnectFileSnapshot(unsigned int simTimeMs, const std::vector< std::vector<float> >& wts);
 	
 private:
 	//! indicates whether writing the current snapshot is necessary (false it has already been written)
@@ -197,6 +200,7 @@ private:
 	bool needToWriteFileHeader_;    //!< whether we have to write header section of conn file
 
 	FILE* connFileId_;              //!< file pointer to the conn file or NULL
+	int connFileWriterId_;          //!< ID of the conn file in the monitor writer (see CpuSNN::getMonitorWriter), or -1
 	int connFileSignature_;         //!< int signature of conn file
 	float connFileVersion_;         //!< version number of conn file
 	int connFileTimeIntervalSec_;   //!< time update interval (seconds) for storing weights to file
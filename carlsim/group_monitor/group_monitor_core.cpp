@@ -12,6 +12,7 @@ GroupMonitorCore::GroupMonitorCore(CpuSNN* snn, int monitorId, int grpId) {
 	monitorId_ = monitorId;
 
 	groupFileId_ = NULL;
+	groupFileWriterId_ = -1;
 	recordSet_ = false;
 	grpMonLastUpdated_ = 0;
 
@@ -40,8 +41,10 @@ void GroupMonitorCore::init() {
 
 GroupMonitorCore::~GroupMonitorCore() {
 	if (groupFileId_ != NULL) {
-		fclose(groupFileId_);
+		// the writer fcloses the file once everything has been written
+		snn_->getMonitorWriter()->closeFile(groupFileWriterId_);
 		groupFileId_ = NULL;
+		groupFileWriterId_ = -1;
 	}
 }
 
@@ -187,6 +190,9 @@ void GroupMonitorCore::setGroupFileId(FILE* groupFileId) {
 		// for now: file pointer has changed, so we need to write header (again)
 		needToWriteFileHeader_ = true;
 		writeGroupFileHeader();
+
+		// group data is written in the background
+		groupFileWriterId_ = snn_->getMonitorWriter()->addFile(groupFileId_);
 	}
 }
 
@@ -129,6 +129,9 @@ public:
 	//! returns a pointer to the group data file
 	FILE* getGroupFileId() { return groupFileId_; }
 
+	//! returns the ID of the group data file in the monitor writer (see CpuSNN::getMonitorWriter), or -1
+	int getGroupFileWriterId() { return groupFileWriterId_; }
+
 	//! sets pointer to group data file
 	void setGroupFileId(FILE* groupFileId);
 	
@@ -154,6 +157,7 @@ private:
 	int nNeurons_;	//!< number of neurons in the group
 
 	FILE* groupFileId_;	//!< file pointer to the group data file or NULL
+	int groupFileWriterId_;	//!< ID of the group data file in the monitor writer, or -1
 	int groupFileSignature_; //!< int signature of group data file
 	float groupFileVersion_; //!< version number of group data file
 
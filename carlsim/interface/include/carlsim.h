@@ -54,6 +54,7 @@
 // include the following core functionalities instead of forward-declaring, so that the user only needs to include
 // carlsim.h
 #include <poisson_rate.h>
+#include <simulation_snapshot.h>
 #include <spike_monitor.h>
 #include <connection_monitor.h>
 #include <group_monitor.h>
@@ -167,6 +168,11 @@ public:
 	 * Location of the CARLsim log file can be set in any mode using setLogFile.
 	 * In mode CUSTOM, the other file pointers can be set using setLogsFpCustom.
 	 *
+	 * Independent CARLsim objects can be created, set up, and run concurrently from different threads (e.g., to
+	 * evaluate many networks in a parameter sweep). Every object uses its own random number streams, so its results
+	 * do not depend on other objects. All objects share the default log file, and default output files are named
+	 * after the network, so concurrent objects should be given different names.
+	 *
 	 * \param[in] netName 		network name
 	 * \param[in] simMode		either CPU_MODE or GPU_MODE
 	 * \param[in] loggerMode    either USER, DEVELOPER, SILENT, or CUSTOM
@@ -484,6 +490,133 @@ public:
 	 */
 	void setIntegrationMethod(integrationMethod_t method, int numStepsPerMs);
 
+	/*!
+	 * \brief Sets the number of CPU threads used to simulate the network in CPU_MODE
+	 *
+	 * By default, CPU_MODE runs on a single thread. This function distributes the integration of the neuronal state
+	 * (membrane potential and recovery variable of all regular neurons) as well as the delivery of spikes to
+	 * post-synaptic neurons among numThreads threads, each of which owns a contiguous block of neuron IDs.
+	 *
+	 * Because every thread only ever writes to the state (and incoming synapses) of the neurons it owns, and does so
+	 * in the same order as the single-threaded version, the result of a multi-threaded simulation is identical to
+	 * the result of a single-threaded simulation.
+	 * The time every thread spent working on its share of neurons is reported in the simulation summary.
+	 *
+	 * The threads are also used to build the network in setupNetwork: the synapses of every random, full, one-to-one,
+	 * and gaussian connection are generated in parallel, each pre-synaptic neuron drawing from its own random stream
+	 * derived from the random seed. For a given seed, the network topology therefore does not depend on the number
+	 * of threads. User-defined connections are always built on a single thread.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] numThreads the number of threads to use, including the calling thread. Default: 1.
+	 *
+	 * \note In GPU_MODE, only network construction makes use of multiple threads.
+	 * \note Thread creation and synchronization come with an overhead; small networks might not benefit from
+	 * using multiple threads.
+	 * \see getNumThreads
+	 */
+	void setNumThreads(int numThreads);
+
+	/*!
+	 * \brief Simulates several replicas of the network that share one topology
+	 *
+	 * A replica is a copy of every group and every connection of the network. All replicas are simulated in the
+	 * same run, and the neuronal state of all replicas is integrated in the same sweep over the (possibly
+	 * vectorized, see setSIMD) neuron update, which is much faster than running numReplicas networks one after the
+	 * other. This is useful for evaluating many parameter variants of the same network, e.g. during parameter tuning.
+	 *
+	 * The synapses of every connection are generated only once (for replica 0), and then copied to all other
+	 * replicas, so that all replicas have the same topology, delays, and initial weights. There are no synapses
+	 * between different replicas. Weights (setReplicaWeight, setWeight), Izhikevich parameters
+	 * (setReplicaNeuronParameters), and inputs can then be set per replica.
+	 *
+	 * Internally, every group holds numReplicas blocks of neurons: the neuron with ID neurId (0-indexed) in replica
+	 * r has ID r*N+neurId in the group, where N is the number of neurons that was passed to createGroup.
+	 * getGroupNumNeurons therefore returns numReplicas*N, and all functions that take neuron IDs (setWeight,
+	 * setExternalCurrent, PoissonRate, SpikeMonitor, etc.) use these IDs. All replicas of a neuron share the same
+	 * location in 3D space (see getNeuronLocation3D).
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] numReplicas the number of replicas. Default: 1.
+	 * \attention Must be called before the first group is created.
+	 * \note Every replica has its own noise (Poisson spike trains and standard deviations of the neuron parameters).
+	 * \see getNumReplicas
+	 * \see SpikeMonitor::getReplicaMeanFiringRate
+	 */
+	void setNumReplicas(int numReplicas);
+
+	/*!
+	 * \brief Simulates a batch of input samples at once that all share the synapses of the network
+	 *
+	 * Evaluating a data set in testing mode (see startTesting) usually means presenting one sample after the other.
+	 * This function instead simulates batchSize copies of the network (one per sample) in the same run. Like
+	 * setNumReplicas, every group holds one block of neurons per sample, so that neuron state, conductances, STP
+	 * variables, and spike tables exist once per sample. Unlike setNumReplicas, the synapses (weights, delays, and
+	 * connectivity) exist only once: a spike of a neuron in sample b travels along the synapses of the same neuron
+	 * in sample 0 to the corresponding post-synaptic neurons of sample b. The synaptic memory of a batch is thus the
+	 * same as for a single sample, and all samples read the same cache lines when they deliver spikes.
+	 *
+	 * Sample b is identical to replica b, and is addressed the same way: neuron neurId (0-indexed) of sample b has
+	 * ID b*N+neurId in its group, where N is the number of neurons passed to createGroup. The input of sample b is
+	 * set through these neuron IDs (e.g. PoissonRate or setExternalCurrent), and its output can be retrieved per
+	 * batch index via SpikeMonitor::getReplicaNumSpikes and SpikeMonitor::getReplicaMeanFiringRate, or from the
+	 * corresponding slice of the arrays returned by SpikeMonitor::getSpikeVector2D and getSpikeCounter.
+	 *
+	 * Because the weights are shared, they can only be changed for all samples at once (e.g., setWeight with the
+	 * neuron IDs of sample 0, or scaleWeights). If the network has plastic synapses, runNetwork can only be called
+	 * in testing mode.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] batchSize the number of samples to simulate at once. Default: 1.
+	 * \attention Must be called before the first group is created.
+	 * \note Only supported in CPU_MODE.
+	 * \see getBatchSize
+	 * \see setNumReplicas
+	 */
+	void setBatchSize(int batchSize);
+
+	/*!
+	 * \brief Enables or disables vectorized (SIMD) neuron state update in CPU_MODE
+	 *
+	 * By default, CPU_MODE integrates the membrane potential and recovery variable of one neuron at a time. This
+	 * function enables integrating several neurons at once, using the widest SIMD instruction set (SSE4.2, AVX2, or
+	 * AVX-512) supported by the CPU. The instruction set is picked at run-time; if none is available, the scalar
+	 * code path is used. Groups with compartments always use the scalar code path.
+	 *
+	 * Vectorized and scalar code compute the same equations in the same order, without fusing multiply-add
+	 * operations, and produce identical results unless CARLsim is compiled with -ffast-math. In that case (e.g., the
+	 * release build), the compiler may reorder floating-point operations, so that membrane potentials differ in the
+	 * last bits of precision. In COBA mode, this can shift spikes by a time step or more over the course of a long
+	 * simulation. Leave SIMD off if a simulation must be bit-exact with the scalar code.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] useSIMD whether to use SIMD instructions if available. Default: false.
+	 * \note This function has no effect in GPU_MODE.
+	 * \see setSIMD(simdIsa_t)
+	 * \see getSIMD
+	 */
+	void setSIMD(bool useSIMD);
+
+	/*!
+	 * \brief Forces vectorized (SIMD) neuron state update with a specific instruction set in CPU_MODE
+	 *
+	 * Same as setSIMD(bool), but uses the given instruction set instead of the widest one available. This is mostly
+	 * useful to compare the different code paths. SIMD_NONE turns vectorization off.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] isa the instruction set to use; must be supported by the CPU (see isSIMDSupported)
+	 * \note This function has no effect in GPU_MODE.
+	 */
+	void setSIMD(simdIsa_t isa);
+
+	/*!
+	 * \brief Returns whether the CPU (and the compiler CARLsim was built with) supports a SIMD instruction set
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE, ::RUN_STATE
+	 * \see setSIMD(simdIsa_t)
+	 */
+	bool isSIMDSupported(simdIsa_t isa);
+
 	/*!
 	 * \brief Sets Izhikevich params a, b, c, and d with as mean +- standard deviation
 	 *
@@ -569,6 +702,25 @@ public:
 
 	void setCompartmentParameters(int grpId, float couplingUp, float couplingDown);
 
+	/*!
+	 * \brief Sets the mean Izhikevich parameters of a group in a single replica
+	 *
+	 * By default, all replicas of a group (see setNumReplicas) share the parameters given to setNeuronParameters.
+	 * This function replaces the mean values of izh_a, izh_b, izh_c, and izh_d for the neurons of one replica. The
+	 * standard deviations (and, for the 9-parameter model, all other parameters) are still taken from
+	 * setNeuronParameters, which must be called on the group as well.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] grpId   the group ID
+	 * \param[in] replica the replica (0-indexed, must be smaller than getNumReplicas)
+	 * \param[in] izh_a   mean value of the Izhikevich parameter a in this replica
+	 * \param[in] izh_b   mean value of the Izhikevich parameter b in this replica
+	 * \param[in] izh_c   mean value of the Izhikevich parameter c in this replica
+	 * \param[in] izh_d   mean value of the Izhikevich parameter d in this replica
+	 * \see setNumReplicas
+	 */
+	void setReplicaNeuronParameters(int grpId, int replica, float izh_a, float izh_b, float izh_c, float izh_d);
+
 	/*!
 	 * \brief Sets baseline concentration and decay time constant of neuromodulators (DP, 5HT, ACh, NE) for a neuron
 	 * group.
@@ -766,6 +918,43 @@ public:
 	 */
 	void setWeightAndWeightChangeUpdate(updateInterval_t wtANDwtChangeUpdateInterval, bool enableWtChangeDecay, float wtChangeDecay=0.9f);
 
+	/*!
+	 * \brief Sets whether weight updates only visit synapses whose weight change got modified
+	 *
+	 * By default, every weight update (see setWeightAndWeightChangeUpdate) visits every plastic synapse in the
+	 * network, even though the weight change of most synapses is zero if activity is sparse. In incremental mode,
+	 * only neurons that fired or received a spike since the last update are visited. If weight change decay is
+	 * enabled, the decaying weight change of all other synapses is applied once they are used again (or at the end
+	 * of a runNetwork call), in the same order as in the default mode. Both modes produce identical weights.
+	 *
+	 * Groups with homeostasis or dopamine-modulated STDP are still visited in every weight update.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] isSet whether to use incremental weight updates. Default: false.
+	 * \note This function has no effect in GPU_MODE.
+	 * \see setWeightAndWeightChangeUpdate
+	 */
+	void setIncrementalWeightUpdate(bool isSet);
+
+	/*!
+	 * \brief Sets whether STDP records spike arrival times per pre-synaptic neuron and delay instead of per synapse
+	 *
+	 * STDP needs to know when the last pre-synaptic spike arrived at a synapse. By default, every plastic synapse
+	 * stores this time (4 bytes per synapse), which has to be written on every spike delivery. With per-delay arrival
+	 * times, CARLsim instead stores, for every neuron and every possible synaptic delay d, the time at which the last
+	 * spike of the neuron arrived at its synapses with delay d (4 bytes per neuron and ms of maximum delay), plus the
+	 * delay of every synapse (1 byte per synapse). All synapses of a neuron with the same delay receive its spikes at
+	 * the same time, so both modes pair spikes the same way and produce identical weight changes, while per-delay
+	 * arrival times need less memory and memory traffic in large plastic networks.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] isSet whether to record arrival times per neuron and delay. Default: false.
+	 * \note This function has no effect in GPU_MODE.
+	 * \see setESTDP
+	 * \see setISTDP
+	 */
+	void setPerDelayArrivalTimes(bool isSet);
+
 
 	// +++++ PUBLIC METHODS: RUNNING A SIMULATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
@@ -780,6 +969,119 @@ public:
 	 */
 	int runNetwork(int nSec, int nMsec=0, bool printRunSummary=true, bool copyState=false);
 
+	/*!
+	 * \brief Advances the simulation by a single time step (1 ms)
+	 *
+	 * A lightweight alternative to CARLsim::runNetwork(0,1) for closed-loop simulations, where the input of every
+	 * millisecond depends on the output of the last one. A step simulates exactly what runNetwork(0,1) would, but
+	 * skips the per-run work: spike counts are not reset, no run summary is printed, and monitors are only updated
+	 * once per simulated second (and when they start or stop recording) instead of after every call. The spikes of
+	 * the last step can be read directly with CARLsim::getLastStepSpikes.
+	 *
+	 * Spike generators draw their spikes one ms at a time while stepping, so that spike rates and external currents
+	 * set between two steps take effect in the next step.
+	 *
+	 * \code
+	 * std::vector<int> spikes;
+	 * while (robot.isRunning()) {
+	 *   sim.setExternalCurrent(gSensor, robot.readSensors());
+	 *   sim.step();
+	 *   sim.getLastStepSpikes(gMotor, spikes);
+	 *   robot.drive(spikes);
+	 * }
+	 * \endcode
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE. The first step will make CARLsim state switch from ::SETUP_STATE to
+	 * ::RUN_STATE.
+	 * \note Only available in ::CPU_MODE.
+	 * \see CARLsim::stepN
+	 * \since v3.1
+	 */
+	void step();
+
+	/*!
+	 * \brief Advances the simulation by numSteps time steps (ms)
+	 *
+	 * Same as calling CARLsim::step numSteps times.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] numSteps number of time steps (ms) to simulate
+	 * \note Only available in ::CPU_MODE.
+	 * \since v3.1
+	 */
+	void stepN(int numSteps);
+
+	/*!
+	 * \brief Returns the neurons of a group that spiked in the last time step
+	 *
+	 * Lists the neurons of a group that emitted a spike in the last simulated ms (after CARLsim::step, or at the end
+	 * of CARLsim::runNetwork), without a SpikeMonitor. The vector is overwritten, so it can be reused from step to
+	 * step without allocating memory.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] grpId the group ID
+	 * \param[out] neurIds the neuron IDs (relative to the group, in ascending order)
+	 * \returns the number of spikes
+	 * \note Only available in ::CPU_MODE.
+	 * \since v3.1
+	 */
+	int getLastStepSpikes(int grpId, std::vector<int>& neurIds);
+
+	/*!
+	 * \brief Locks simulated time to wall-clock time
+	 *
+	 * In real-time mode, every simulated ms of CARLsim::runNetwork and CARLsim::step has a deadline on a monotonic
+	 * clock: the k-th step after the clock started is due k ms after the start. A step that finishes early waits for
+	 * its deadline; a step that finishes late (an overrun) does not wait, so that the following steps run back to
+	 * back until the simulation has caught up. The clock starts with the first step after enabling real-time mode
+	 * (or after CARLsim::resetRealTimeStats, CARLsim::resetState, or CARLsim::restore) and keeps running in between
+	 * calls to runNetwork/step: time spent in user code counts against the budget of the next step.
+	 *
+	 * With skipMonitorsWhenLate, CARLsim sheds work that can be dropped without losing data while it is behind
+	 * schedule: ConnectionMonitor snapshots that fall on a late step, and the run summary of runNetwork. SpikeMonitors
+	 * and GroupMonitors are always updated, because their data of the last second would otherwise be lost.
+	 *
+	 * \code
+	 * sim.setRealTimeMode(true, true);
+	 * sim.runNetwork(10,0); // takes (at least) 10 seconds
+	 * RealTimeStats_t stats = sim.getRealTimeStats();
+	 * printf("%d of %d steps missed their deadline\n", stats.numOverruns, stats.numSteps);
+	 * \endcode
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] enable whether to pace the simulation against the wall clock. Default: false.
+	 * \param[in] skipMonitorsWhenLate whether to skip monitor work while behind schedule. Default: false.
+	 * \see CARLsim::getRealTimeStats
+	 * \since v3.1
+	 */
+	void setRealTimeMode(bool enable, bool skipMonitorsWhenLate=false);
+
+	/*!
+	 * \brief Returns the deadline statistics of real-time mode
+	 *
+	 * Returns the number of steps simulated in real-time mode, how many of them missed their deadline (and by how
+	 * much), the slack of the steps that met their deadline, and the number of skipped monitor updates, all counted
+	 * since the last call to CARLsim::resetRealTimeStats (or since the CARLsim object was created).
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE, ::RUN_STATE
+	 * \see CARLsim::setRealTimeMode
+	 * \see RealTimeStats
+	 * \since v3.1
+	 */
+	RealTimeStats_t getRealTimeStats();
+
+	/*!
+	 * \brief Resets the deadline statistics of real-time mode and restarts the real-time clock
+	 *
+	 * Call this after a deliberate pause (e.g., between two trials), so that the next step gets a full ms instead
+	 * of trying to make up for the pause.
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE, ::RUN_STATE
+	 * \see CARLsim::setRealTimeMode
+	 * \since v3.1
+	 */
+	void resetRealTimeStats();
+
 	/*!
 	 * \brief build the network
 	 *
@@ -918,6 +1220,175 @@ public:
 	 */
 	void resetSpikeCounter(int grpId);
 
+	/*!
+	 * \brief Resets the dynamic state of the network without rebuilding it
+	 *
+	 * Puts the network back into the state it was in right after CARLsim::setupNetwork: membrane potentials,
+	 * recovery variables, currents, conductances, STP variables, neuromodulators, homeostatic firing averages,
+	 * firing tables, scheduled spikes, spike counters, and accumulated weight changes are reset, and the simulation
+	 * time starts again at zero. No memory is reallocated, so this is much faster than building a new network.
+	 *
+	 * Synaptic weights are kept (including any changes made through learning or CARLsim::setWeight), as are all
+	 * parameters and the spike rates of spike generators. Because random numbers only depend on the seed, the
+	 * neuron index, and the simulation time, running the network after a reset gives the same result as running a
+	 * new network with the same weights.
+	 *
+	 * This makes it possible to evaluate many trials (or parameter sets) on a single network:
+	 * \code
+	 * sim.setupNetwork();
+	 * for (int trial=0; trial<numTrials; trial++) {
+	 *   sim.resetState();
+	 *   sim.setWeight(connId, 0, 0, newWeight[trial]);
+	 *   spkMon->startRecording();
+	 *   sim.runNetwork(1,0);
+	 *   spkMon->stopRecording();
+	 * }
+	 * \endcode
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \attention SpikeMonitors must not be recording, as their recording period would no longer make sense.
+	 * \note Only available in ::CPU_MODE.
+	 * \since v3.1
+	 */
+	void resetState();
+
+	/*!
+	 * \brief Copies all dynamic state of the network into an in-memory snapshot
+	 *
+	 * The snapshot holds neuron state, conductances, short-term plasticity, neuromodulators, synaptic weights and
+	 * weight changes, scheduled and recent spikes, spike counters, and the simulation time (see SimulationSnapshot).
+	 * Pass it to CARLsim::restore to bring the network back to this point in time, as often as needed. Because
+	 * random numbers only depend on the seed, the neuron index, and the simulation time, a network that is restored
+	 * and run again produces exactly the same spikes (given the same input).
+	 *
+	 * Synaptic arrays that have not changed since the last snapshot (for example, in testing mode) are shared with
+	 * that snapshot instead of being copied again.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \returns pointer to a new SimulationSnapshot; the user is responsible for deleting it
+	 * \note Only available in ::CPU_MODE.
+	 * \since v3.1
+	 */
+	SimulationSnapshot* snapshot();
+
+	/*!
+	 * \brief Brings all dynamic state of the network back to what it was when the snapshot was taken
+	 *
+	 * Restores everything that was copied by CARLsim::snapshot, including the simulation time. Parameters (such as
+	 * spike rates) are not changed. The snapshot is not modified and can be restored again later.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] snap a snapshot of this network, created by CARLsim::snapshot
+	 * \attention SpikeMonitors must not be recording, as their recording period would no longer make sense.
+	 * \note Only available in ::CPU_MODE.
+	 * \since v3.1
+	 */
+	void restore(SimulationSnapshot* snap);
+
+	/*!
+	 * \brief Changes the Izhikevich parameters of a group after the network has been set up
+	 *
+	 * Works like CARLsim::setNeuronParameters (4-parameter model), but can be called in ::SETUP_STATE and
+	 * ::RUN_STATE. The parameters of every neuron in the group are drawn again in place, using the same random
+	 * numbers as before, so only the new mean values and standard deviations make a difference. Parameter overrides
+	 * of single replicas (see CARLsim::setReplicaNeuronParameters) remain in effect.
+	 *
+	 * The new parameters take effect immediately. Membrane potential and recovery variable keep their values; call
+	 * CARLsim::resetState to start the next trial from the new reset potential:
+	 * \code
+	 * sim.updateNeuronParameters(gExc, 0.02f, 0.2f, -55.0f, 4.0f);
+	 * sim.resetState();
+	 * sim.runNetwork(1,0);
+	 * \endcode
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] grpId the group (cannot be ALL; cannot be a spike generator or a 9-parameter group)
+	 * \note Only available in ::CPU_MODE.
+	 * \see CARLsim::setNeuronParameters
+	 * \see CARLsim::resetState
+	 * \since v3.1
+	 */
+	void updateNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
+		float izh_c, float izh_c_sd, float izh_d, float izh_d_sd);
+
+	/*!
+	 * \brief Changes the Izhikevich parameters of a group after the network has been set up (no standard deviations)
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \see CARLsim::updateNeuronParameters
+	 * \since v3.1
+	 */
+	void updateNeuronParameters(int grpId, float izh_a, float izh_b, float izh_c, float izh_d);
+
+	/*!
+	 * \brief Changes the E-STDP curve of a group after the network has been set up
+	 *
+	 * Replaces the E-STDP curve of a group on which E-STDP was enabled with CARLsim::setESTDP. The STDP type
+	 * (STANDARD or DA_MOD) stays the same. Weight changes accumulated so far are not affected.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \note Only available in ::CPU_MODE.
+	 * \see CARLsim::setESTDP
+	 * \since v3.1
+	 */
+	void updateESTDP(int grpId, ExpCurve curve);
+
+	/*!
+	 * \brief Changes the E-STDP curve of a group after the network has been set up
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \see CARLsim::updateESTDP(int, ExpCurve)
+	 * \since v3.1
+	 */
+	void updateESTDP(int grpId, TimingBasedCurve curve);
+
+	/*!
+	 * \brief Changes the I-STDP curve of a group after the network has been set up
+	 *
+	 * Replaces the I-STDP curve of a group on which I-STDP was enabled with CARLsim::setISTDP. The STDP type
+	 * (STANDARD or DA_MOD) stays the same.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \note Only available in ::CPU_MODE.
+	 * \see CARLsim::setISTDP
+	 * \since v3.1
+	 */
+	void updateISTDP(int grpId, ExpCurve curve);
+
+	/*!
+	 * \brief Changes the I-STDP curve of a group after the network has been set up
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \see CARLsim::updateISTDP(int, ExpCurve)
+	 * \since v3.1
+	 */
+	void updateISTDP(int grpId, PulseCurve curve);
+
+	/*!
+	 * \brief Changes the homeostasis parameters of a group after the network has been set up
+	 *
+	 * Homeostasis must have been enabled on the group with CARLsim::setHomeostasis.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \note Only available in ::CPU_MODE.
+	 * \see CARLsim::setHomeostasis
+	 * \since v3.1
+	 */
+	void updateHomeostasis(int grpId, float homeoScale, float avgTimeScale);
+
+	/*!
+	 * \brief Changes the homeostatic target firing rate of a group after the network has been set up
+	 *
+	 * The average firing rates the neurons have tracked so far are kept; CARLsim::resetState sets them to the new
+	 * target rates.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \note Only available in ::CPU_MODE.
+	 * \see CARLsim::setHomeoBaseFiringRate
+	 * \since v3.1
+	 */
+	void updateHomeoBaseFiringRate(int grpId, float baseFiring, float baseFiringSD=0.0f);
+
 	/*!
 	 * \brief Multiplies the weight of every synapse in the connection with a scaling factor
 	 *
@@ -1120,6 +1591,10 @@ public:
 	 * (can be retrieved via getGroupName).
 	 * If no binary file shall be created, set fileName equal to the string "NULL".
 	 *
+	 * Spike files (as well as the files of GroupMonitor and ConnectionMonitor) are written by a background thread, so
+	 * that writing large groups to disk overlaps with the simulation. All files are complete once CARLsim::runNetwork
+	 * returns. After CARLsim::step, they are only guaranteed to be complete once the CARLsim object is deleted.
+	 *
 	 * The function returns a pointer to a SpikeMonitor object, which can be used to calculate spike statistics (such
 	 * group firing rate, number of silent neurons, etc.) or retrieve all spikes from a particular time window.
 	 * See \ref ch7s1_spike_monitor of the User Guide for more information on how to use SpikeMonitor.
@@ -1148,12 +1623,21 @@ public:
 	 * \brief Sets a spike rate
 	 * \TODO finish docu
 	 *
+	 * By default, spikes are drawn for a whole time slice at once (by sampling inter-spike intervals) and then
+	 * scheduled in the spike buffer. In CPU_MODE, setting perStep to true instead draws the spikes of every time step
+	 * directly (each neuron fires with probability rate/1000 unless it is refractory) and adds them to the firing
+	 * table right away. This is considerably faster for large Poisson groups, and the spikes drawn do not depend on
+	 * the time slice. Both modes produce Poisson spike trains with the given rate and refractory period, but not the
+	 * same spikes.
+	 *
 	 * \STATE ::SETUP_STATE, ::RUN_STATE
 	 * \param[in] grpId      group ID
 	 * \param[in] spikeRate  pointer to PoissonRate object
 	 * \param[in] refPeriod  refactory period (ms). Default: 1ms.
+	 * \param[in] perStep    whether to draw the spikes of every time step directly (CPU_MODE only). Default: false.
 	 *
 	 * \note This method can only be applied to SpikeGenerator groups.
+	 * \note perStep has no effect in GPU_MODE.
 	 * \note setSpikeRate will *not* take over ownership of PoissonRate. In other words, if you allocate the
 	 * PoissonRate object on the heap, you are responsible for correctly deallocating it.
 	 * \attention Make sure to reset spike rate after use (i.e., for the next call to runNetwork), otherwise
@@ -1161,7 +1645,7 @@ public:
 	 * \see setExternalCurrent
 	 * \see setSpikeGenerator
 	 */
-	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod=1);
+	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod=1, bool perStep=false);
 
 	/*!
 	 * \brief Sets the weight value of a specific synapse
@@ -1192,6 +1676,23 @@ public:
 	 */
 	void setWeight(short int connId, int neurIdPre, int neurIdPost, float weight, bool updateWeightRange=false);
 
+	/*!
+	 * \brief Sets the weight value of all synapses of a connection in a single replica
+	 *
+	 * This method sets the weight value of every synapse that belongs to connection connId and to replica replica
+	 * (see setNumReplicas). Weight values outside of [minWt,maxWt] are handled the same way as in setWeight.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] connId            the connection ID to manipulate
+	 * \param[in] replica           the replica (0-indexed, must be smaller than getNumReplicas)
+	 * \param[in] weight            the weight value to set for all synapses of the connection in this replica
+	 * \param[in] updateWeightRange a flag specifying what to do when the specified weight lies outside the range
+	 *                              [minWt,maxWt]. Default: false.
+	 * \see setWeight
+	 * \see setNumReplicas
+	 */
+	void setReplicaWeight(short int connId, int replica, float weight, bool updateWeightRange=false);
+
 	/*!
 	 * \brief Enters a testing phase in which all weight changes are disabled
 	 *
@@ -1503,6 +2004,38 @@ public:
 	 */
 	int getNumPostSynapses();
 
+	/*!
+	 * \brief returns the number of CPU threads used to simulate the network in CPU_MODE
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE, ::RUN_STATE
+	 * \see setNumThreads
+	 */
+	int getNumThreads();
+
+	/*!
+	 * \brief returns the number of replicas of the network
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE, ::RUN_STATE
+	 * \see setNumReplicas
+	 */
+	int getNumReplicas();
+
+	/*!
+	 * \brief returns the number of input samples that are simulated at once
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE, ::RUN_STATE
+	 * \see setBatchSize
+	 */
+	int getBatchSize();
+
+	/*!
+	 * \brief returns the SIMD instruction set used to integrate the neuronal state in CPU_MODE
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE, ::RUN_STATE
+	 * \see setSIMD
+	 */
+	simdIsa_t getSIMD();
+
 	/*!
 	 * \brief returns the first neuron id of a groupd specified by grpId
 	 *
@@ -1524,6 +2057,7 @@ public:
 	 *
 	 * \TODO finish docu
 	 * \STATE ::CONFIG_STATE, ::SETUP_STATE, ::RUN_STATE
+	 * \note The number includes all replicas of the group (see setNumReplicas).
 	 */
 	int getGroupNumNeurons(int grpId);
 
@@ -1784,6 +2318,9 @@ private:
 
 	void CARLsimInit();					//!< init function, unsafe computations that would usually go in constructor
 
+	//! checks shared by all functions that change STDP parameters after setupNetwork
+	void checkUpdateSTDP(const std::string& funcName, int grpId, bool isExcitatory);
+
 	bool existsGrpId(int grpId);		//!< checks whether a certain grpId exists in grpIds_
 
 	void handleUserWarnings(); 			//!< print all user warnings, continue only after user input
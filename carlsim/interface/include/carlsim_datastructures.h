@@ -133,6 +133,25 @@ static const char* integrationMethod_string[] = {
 	"Forward-Euler", "4-th order Runge-Kutta", "Unknown integration method"
 };
 
+/*!
+ * \brief SIMD instruction sets
+ *
+ * Instruction sets that can be used to integrate the neuronal state in CPU_MODE (see CARLsim::setSIMD).
+ * SIMD_NONE:   scalar code
+ * SIMD_SSE42:  4 neurons at once (SSE4.2)
+ * SIMD_AVX2:   8 neurons at once (AVX2)
+ * SIMD_AVX512: 16 neurons at once (AVX-512F)
+ */
+enum simdIsa_t {
+	SIMD_NONE,
+	SIMD_SSE42,
+	SIMD_AVX2,
+	SIMD_AVX512
+};
+static const char* simdIsa_string[] = {
+	"none", "SSE4.2", "AVX2", "AVX-512"
+};
+
 // \TODO: extend documentation, add relevant references
 /*!
  * \brief STDP flavors
@@ -179,13 +198,17 @@ static const char* stdpCurve_string[] = {
  *          neuron, and is thus not capable of computing spike train correlation etc.
  * AER:     Will collect spike information in AER format (will collect both neuron IDs and
  *          spike times).
+ * STATS:   Will not store any spikes, but update spike statistics (spike counts, ISI CV, Fano
+ *          factor, binned population rate) as the spikes come in. Memory does not grow with the
+ *          recording time.
  */
 enum spikeMonMode_t {
 	COUNT,      //!< mode in which only spike count information is collected
 	AER,        //!< mode in which spike information is collected in AER format
+	STATS,      //!< mode in which only spike statistics are collected
 };
 static const char* spikeMonMode_string[] = {
-	"SpikeCount Mode","SpikeTime Mode"
+	"SpikeCount Mode","SpikeTime Mode","SpikeStats Mode"
 };
 
 /*!
@@ -406,6 +429,24 @@ typedef struct GroupNeuromodulatorInfo {
 	float		decayNE;		//!< decay rate for Noradrenaline
 } GroupNeuromodulatorInfo_t;
 
+/*!
+ * \brief A struct for retrieving the deadline statistics of a real-time simulation
+ *
+ * In real-time mode (see CARLsim::setRealTimeMode), every simulated millisecond has a deadline on the wall clock.
+ * A step that finishes before its deadline waits for the remaining time (the slack), a step that finishes after its
+ * deadline is an overrun.
+ *
+ * \sa CARLsim::getRealTimeStats()
+ */
+typedef struct RealTimeStats {
+	int		numSteps;					//!< number of time steps (ms) simulated in real-time mode
+	int		numOverruns;				//!< number of time steps that finished after their deadline
+	int		numSkippedMonitorUpdates;	//!< number of monitor updates skipped because the simulation was behind schedule
+	double	minSlackMs;					//!< smallest slack of a step that met its deadline (ms)
+	double	meanSlackMs;				//!< average slack of the steps that met their deadline (ms)
+	double	maxLatenessMs;				//!< largest time by which a step missed its deadline (ms)
+} RealTimeStats_t;
+
 /*!
  * \brief A struct to arrange neurons on a 3D grid (a primitive cubic Bravais lattice with cubic side length 1)
  *
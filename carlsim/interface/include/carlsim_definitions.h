@@ -75,6 +75,9 @@
 
 #define MAX_NUM_CUDA_DEVICES 8
 
+// maximum number of CPU threads that can be used in CPU_MODE
+#define MAX_NUM_CPU_THREADS 64
+
 // maximum number of compartmental connections allowed per group
 #define MAX_NUM_COMP_CONN 4
 
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#ifndef _SIMULATION_SNAPSHOT_H_
+#define _SIMULATION_SNAPSHOT_H_
+
+#include <stddef.h>		// size_t
+#include <stdint.h>		// uint64_t
+
+class SnapshotCore; // forward-declaration of implementation
+
+/*!
+ * \brief The dynamic state of a network at a certain point in time
+ *
+ * A SimulationSnapshot is created by CARLsim::snapshot and holds a copy of all dynamic state of the network: neuron
+ * state, conductances, short-term plasticity, neuromodulators, synaptic weights and weight changes, scheduled and
+ * recent spikes, spike counters, and the simulation time. CARLsim::restore brings the network back to that state, so
+ * that a simulation can branch off from (or be rewound to) the same point in time many times.
+ *
+ * Snapshots live in memory. The synaptic arrays, which make up most of the state of a large network, are only copied
+ * if they have changed since the last snapshot: otherwise the snapshots share the same copy. For example, in testing
+ * mode (see CARLsim::startTesting) the weights do not change, so many snapshots can be taken at little cost.
+ *
+ * Example usage:
+ * \code
+ * sim.setupNetwork();
+ * sim.runNetwork(10,0); // warm-up
+ * SimulationSnapshot* snap = sim.snapshot();
+ * for (int trial=0; trial<numTrials; trial++) {
+ *   sim.restore(snap);
+ *   sim.setSpikeRate(gIn, &trialRates[trial]);
+ *   sim.runNetwork(1,0);
+ * }
+ * delete snap;
+ * \endcode
+ *
+ * \note Parameters (such as spike rates, STDP parameters, or weight ranges) are not part of a snapshot, neither is the
+ * state of user-defined SpikeGenerator objects or the data recorded by monitors.
+ * \since v3.1
+ */
+class SimulationSnapshot {
+public:
+	/*!
+	 * \brief SimulationSnapshot destructor
+	 *
+	 * Cleans up all the memory upon object deletion. Copies shared with other snapshots are kept until the last of
+	 * these snapshots is deleted. A snapshot may be deleted after the network it belongs to.
+	 * \since v3.1
+	 */
+	~SimulationSnapshot();
+
+	/*!
+	 * \brief Returns the simulation time at which the snapshot was taken (ms)
+	 * \since v3.1
+	 */
+	uint64_t getSimTime();
+
+	/*!
+	 * \brief Returns the (approximate) number of bytes that would be freed by deleting the snapshot
+	 *
+	 * Copies that are shared with other snapshots of the same network are not counted.
+	 * \since v3.1
+	 */
+	size_t getMemoryUsage();
+
+private:
+	friend class CARLsim;
+
+	//! snapshots can only be created by CARLsim::snapshot
+	explicit SimulationSnapshot(SnapshotCore* snapCore);
+
+	SimulationSnapshot(const SimulationSnapshot&);				// not copyable
+	SimulationSnapshot& operator=(const SimulationSnapshot&);
+
+	SnapshotCore* snapCore_;
+};
+
+#endif
@@ -596,6 +596,66 @@ void CARLsim::setIntegrationMethod(integrationMethod_t method, int numStepsPerMs
 	snn_->setIntegrationMethod(method, numStepsPerMs);	
 }
 
+// set number of CPU threads used to simulate the network
+void CARLsim::setNumThreads(int numThreads) {
+	std::string funcName = "setNumThreads()";
+	UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+		"CONFIG.");
+	std::stringstream rangeStr; rangeStr << "[1, " << MAX_NUM_CPU_THREADS << "]";
+	UserErrors::assertTrue((numThreads >= 1) && (numThreads <= MAX_NUM_CPU_THREADS), UserErrors::MUST_BE_IN_RANGE,
+		funcName, "numThreads", rangeStr.str());
+
+	snn_->setNumThreads(numThreads);
+}
+
+// simulate several copies of every group that share the topology of the network
+void CARLsim::setNumReplicas(int numReplicas) {
+	std::string funcName = "setNumReplicas()";
+	UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+		"CONFIG.");
+	UserErrors::assertTrue(getNumGroups()==0, UserErrors::MUST_BE_CALLED, funcName, funcName,
+		"before createGroup.");
+	UserErrors::assertTrue(numReplicas >= 1, UserErrors::MUST_BE_POSITIVE, funcName, "numReplicas");
+
+	snn_->setNumReplicas(numReplicas);
+}
+
+// simulate several input samples at once, all of which share the synapses of the network
+void CARLsim::setBatchSize(int batchSize) {
+	std::string funcName = "setBatchSize()";
+	UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+		"CONFIG.");
+	UserErrors::assertTrue(simMode_==CPU_MODE, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName,
+		"CPU_MODE.");
+	UserErrors::assertTrue(getNumGroups()==0, UserErrors::MUST_BE_CALLED, funcName, funcName,
+		"before createGroup.");
+	UserErrors::assertTrue(batchSize >= 1, UserErrors::MUST_BE_POSITIVE, funcName, "batchSize");
+
+	snn_->setNumReplicas(batchSize, true);
+}
+
+// enable/disable vectorized neuron state update
+void CARLsim::setSIMD(bool useSIMD) {
+	std::string funcName = "setSIMD()";
+	UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+		"CONFIG.");
+
+	snn_->setSIMD(useSIMD);
+}
+
+// force vectorized neuron state update with a specific instruction set
+void CARLsim::setSIMD(simdIsa_t isa) {
+	std::string funcName = "setSIMD()";
+	UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+		"CONFIG.");
+	UserErrors::assertTrue(isSimdIsaSupported(isa), UserErrors::CANNOT_BE_SET_TO, funcName, "isa",
+		std::string(simdIsa_string[isa]) + " (not supported by this CPU).");
+
+	snn_->setSIMD(isa);
+}
+
+bool CARLsim::isSIMDSupported(simdIsa_t isa) { return isSimdIsaSupported(isa); }
+
 // set neuron parameters for Izhikevich neuron, with standard deviations
 void CARLsim::setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
 	float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
@@ -614,6 +674,20 @@ void CARLsim::setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float
 	}
 }
 
+// set neuron parameters for Izhikevich neuron in a single replica
+void CARLsim::setReplicaNeuronParameters(int grpId, int replica, float izh_a, float izh_b, float izh_c, float izh_d) {
+	std::stringstream funcName; funcName << "setReplicaNeuronParameters(\"" << getGroupName(grpId) << "\"," << replica
+		<< ")";
+	UserErrors::assertTrue(grpId!=ALL, UserErrors::ALL_NOT_ALLOWED, funcName.str(), "grpId");
+	UserErrors::assertTrue(!isPoissonGroup(grpId), UserErrors::WRONG_NEURON_TYPE, funcName.str(), funcName.str());
+	UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName.str(),
+		funcName.str(), "CONFIG.");
+	UserErrors::assertTrue(replica>=0 && replica<getNumReplicas(), UserErrors::MUST_BE_IN_RANGE, funcName.str(),
+		"replica", "[0,getNumReplicas()-1]");
+
+	snn_->setReplicaNeuronParameters(grpId, replica, izh_a, izh_b, izh_c, izh_d);
+}
+
 // set neuron parameters for Izhikevich neuron
 void CARLsim::setNeuronParameters(int grpId, float izh_a, float izh_b, float izh_c, float izh_d) {
 	std::string funcName = "setNeuronParameters(\""+getGroupName(grpId)+"\")";
@@ -849,6 +923,24 @@ void CARLsim::setWeightAndWeightChangeUpdate(updateInterval_t wtANDwtChangeUpdat
 	snn_->setWeightAndWeightChangeUpdate(wtANDwtChangeUpdateInterval, enableWtChangeDecay, wtChangeDecay);
 }
 
+// only update weights of synapses whose weight change got modified
+void CARLsim::setIncrementalWeightUpdate(bool isSet) {
+	std::string funcName = "setIncrementalWeightUpdate()";
+	UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+		"CONFIG.");
+
+	snn_->setIncrementalWeightUpdate(isSet);
+}
+
+// record spike arrival times per pre-synaptic neuron and delay for STDP
+void CARLsim::setPerDelayArrivalTimes(bool isSet) {
+	std::string funcName = "setPerDelayArrivalTimes()";
+	UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+		"CONFIG.");
+
+	snn_->setPerDelayArrivalTimes(isSet);
+}
+
 
 // +++++++++ PUBLIC METHODS: RUNNING A SIMULATION +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
@@ -868,11 +960,76 @@ int CARLsim::runNetwork(int nSec, int nMsec, bool printRunSummary, bool copyStat
 		handleUserWarnings();
 	}
 
+	// the samples of a batch share their weights: these must not change while running
+	UserErrors::assertTrue(getBatchSize()==1 || snn_->isInTestingMode() || !snn_->isSimulationWithPlasticWeights(),
+		UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "testing mode (see startTesting) when the batch "
+		"size is larger than 1 and the network has plastic synapses.");
+
 	carlsimState_ = RUN_STATE;
 
 	return snn_->runNetwork(nSec, nMsec, printRunSummary, copyState);
 }
 
+// advances the simulation by a single time step
+void CARLsim::step() {
+	stepN(1);
+}
+
+// advances the simulation by numSteps time steps
+void CARLsim::stepN(int numSteps) {
+	// most calls come from a closed loop running in real time: keep the common path free of string handling
+	if (carlsimState_!=RUN_STATE || simMode_!=CPU_MODE || numSteps<=0 || getBatchSize()>1) {
+		std::string funcName = "stepN()";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+		UserErrors::assertTrue(simMode_==CPU_MODE, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName,
+			"CPU_MODE.");
+		UserErrors::assertTrue(numSteps>0, UserErrors::MUST_BE_POSITIVE, funcName, "numSteps");
+		UserErrors::assertTrue(getBatchSize()==1 || snn_->isInTestingMode() || !snn_->isSimulationWithPlasticWeights(),
+			UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "testing mode (see startTesting) when the "
+			"batch size is larger than 1 and the network has plastic synapses.");
+
+		if (carlsimState_ != RUN_STATE) {
+			if (!hasSetConductances_) {
+				userWarnings_.push_back("CARLsim::setConductances has not been called. Setting simulation mode to CUBA.");
+			}
+			handleUserWarnings();
+			carlsimState_ = RUN_STATE;
+		}
+	}
+
+	snn_->stepNetwork(numSteps);
+}
+
+// returns the neurons of a group that spiked in the last time step
+int CARLsim::getLastStepSpikes(int grpId, std::vector<int>& neurIds) {
+	if (carlsimState_!=RUN_STATE || simMode_!=CPU_MODE || grpId<0 || grpId>=getNumGroups()) {
+		std::stringstream funcName; funcName << "getLastStepSpikes(" << grpId << ")";
+		UserErrors::assertTrue(carlsimState_==SETUP_STATE||carlsimState_==RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName.str(), funcName.str(), "SETUP or RUN.");
+		UserErrors::assertTrue(simMode_==CPU_MODE, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName.str(),
+			funcName.str(), "CPU_MODE.");
+		UserErrors::assertTrue(grpId!=ALL, UserErrors::ALL_NOT_ALLOWED, funcName.str(), "grpId");
+		UserErrors::assertTrue(grpId>=0 && grpId<getNumGroups(), UserErrors::MUST_BE_IN_RANGE, funcName.str(),
+			"grpId", "[0,getNumGroups()]");
+	}
+
+	return snn_->getLastStepSpikes(grpId, neurIds);
+}
+
+// paces the simulation against the wall clock
+void CARLsim::setRealTimeMode(bool enable, bool skipMonitorsWhenLate) {
+	snn_->setRealTimeMode(enable, skipMonitorsWhenLate);
+}
+
+RealTimeStats_t CARLsim::getRealTimeStats() {
+	return snn_->getRealTimeStats();
+}
+
+void CARLsim::resetRealTimeStats() {
+	snn_->resetRealTimeStats();
+}
+
 // setup network with custom options
 void CARLsim::setupNetwork(bool removeTempMemory) {
 	std::string funcName = "setupNetwork()";
@@ -987,6 +1144,144 @@ void CARLsim::resetSpikeCounter(int grpId) {
 	snn_->resetSpikeCounter(grpId);
 }
 
+// resets the network to the state right after setupNetwork, keeping weights and parameters
+void CARLsim::resetState() {
+	std::string funcName = "resetState()";
+	UserErrors::assertTrue(carlsimState_==SETUP_STATE||carlsimState_==RUN_STATE,
+		UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+	UserErrors::assertTrue(simMode_==CPU_MODE, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName,
+		"CPU_MODE.");
+	for (int g=0; g<getNumGroups(); g++) {
+		SpikeMonitor* spkMon = snn_->getSpikeMonitor(g);
+		UserErrors::assertTrue(spkMon==NULL || !spkMon->isRecording(), UserErrors::MUST_BE_OFF, funcName,
+			"SpikeMonitor recording");
+	}
+
+	snn_->resetState();
+}
+
+// copies all dynamic state of the network into an in-memory snapshot
+SimulationSnapshot* CARLsim::snapshot() {
+	std::string funcName = "snapshot()";
+	UserErrors::assertTrue(carlsimState_==SETUP_STATE||carlsimState_==RUN_STATE,
+		UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+	UserErrors::assertTrue(simMode_==CPU_MODE, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName,
+		"CPU_MODE.");
+
+	return new SimulationSnapshot(snn_->takeSnapshot());
+}
+
+// brings all dynamic state of the network back to what it was when the snapshot was taken
+void CARLsim::restore(SimulationSnapshot* snap) {
+	std::string funcName = "restore()";
+	UserErrors::assertTrue(carlsimState_==SETUP_STATE||carlsimState_==RUN_STATE,
+		UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+	UserErrors::assertTrue(simMode_==CPU_MODE, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName,
+		"CPU_MODE.");
+	UserErrors::assertTrue(snap!=NULL, UserErrors::CANNOT_BE_NULL, funcName, "snap");
+	UserErrors::assertTrue(snap->snapCore_->snn==snn_, UserErrors::MUST_BE_IDENTICAL, funcName,
+		"Network of snapshot and simulation");
+	for (int g=0; g<getNumGroups(); g++) {
+		SpikeMonitor* spkMon = snn_->getSpikeMonitor(g);
+		UserErrors::assertTrue(spkMon==NULL || !spkMon->isRecording(), UserErrors::MUST_BE_OFF, funcName,
+			"SpikeMonitor recording");
+	}
+
+	snn_->restoreSnapshot(snap->snapCore_);
+}
+
+// changes the Izhikevich parameters of a group after setupNetwork, with standard deviations
+void CARLsim::updateNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
+	float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
+{
+	std::stringstream funcName; funcName << "updateNeuronParameters(" << grpId << ")";
+	UserErrors::assertTrue(carlsimState_==SETUP_STATE||carlsimState_==RUN_STATE,
+		UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName.str(), funcName.str(), "SETUP or RUN.");
+	UserErrors::assertTrue(simMode_==CPU_MODE, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName.str(),
+		funcName.str(), "CPU_MODE.");
+	UserErrors::assertTrue(grpId!=ALL, UserErrors::ALL_NOT_ALLOWED, funcName.str(), "grpId");
+	UserErrors::assertTrue(grpId>=0 && grpId<getNumGroups(), UserErrors::MUST_BE_IN_RANGE, funcName.str(),
+		"grpId", "[0,getNumGroups()]");
+	UserErrors::assertTrue(!isPoissonGroup(grpId) && !snn_->getGroupInfo(grpId).withParamModel_9,
+		UserErrors::WRONG_NEURON_TYPE, funcName.str(), funcName.str());
+	UserErrors::assertTrue(izh_a_sd>=0 && izh_b_sd>=0 && izh_c_sd>=0 && izh_d_sd>=0, UserErrors::CANNOT_BE_NEGATIVE,
+		funcName.str(), "Standard deviation");
+
+	snn_->updateNeuronParameters(grpId, izh_a, izh_a_sd, izh_b, izh_b_sd, izh_c, izh_c_sd, izh_d, izh_d_sd);
+}
+
+// changes the Izhikevich parameters of a group after setupNetwork
+void CARLsim::updateNeuronParameters(int grpId, float izh_a, float izh_b, float izh_c, float izh_d) {
+	updateNeuronParameters(grpId, izh_a, 0.0f, izh_b, 0.0f, izh_c, 0.0f, izh_d, 0.0f);
+}
+
+// changes the E-STDP curve of a group after setupNetwork
+void CARLsim::updateESTDP(int grpId, ExpCurve curve) {
+	std::stringstream funcName; funcName << "updateESTDP(" << grpId << ")";
+	checkUpdateSTDP(funcName.str(), grpId, true);
+
+	snn_->updateESTDP(grpId, curve.stdpCurve, curve.alphaPlus, curve.tauPlus, curve.alphaMinus, curve.tauMinus, 0.0f);
+}
+
+// changes the E-STDP curve of a group after setupNetwork
+void CARLsim::updateESTDP(int grpId, TimingBasedCurve curve) {
+	std::stringstream funcName; funcName << "updateESTDP(" << grpId << ")";
+	checkUpdateSTDP(funcName.str(), grpId, true);
+
+	snn_->updateESTDP(grpId, curve.stdpCurve, curve.alphaPlus, curve.tauPlus, curve.alphaMinus, curve.tauMinus,
+		curve.gamma);
+}
+
+// changes the I-STDP curve of a group after setupNetwork
+void CARLsim::updateISTDP(int grpId, ExpCurve curve) {
+	std::stringstream funcName; funcName << "updateISTDP(" << grpId << ")";
+	checkUpdateSTDP(funcName.str(), grpId, false);
+
+	snn_->updateISTDP(grpId, curve.stdpCurve, curve.alphaPlus, curve.alphaMinus, curve.tauPlus, curve.tauMinus);
+}
+
+// changes the I-STDP curve of a group after setupNetwork
+void CARLsim::updateISTDP(int grpId, PulseCurve curve) {
+	std::stringstream funcName; funcName << "updateISTDP(" << grpId << ")";
+	checkUpdateSTDP(funcName.str(), grpId, false);
+
+	snn_->updateISTDP(grpId, curve.stdpCurve, curve.betaLTP, curve.betaLTD, curve.lambda, curve.delta);
+}
+
+// changes the homeostasis parameters of a group after setupNetwork
+void CARLsim::updateHomeostasis(int grpId, float homeoScale, float avgTimeScale) {
+	std::stringstream funcName; funcName << "updateHomeostasis(" << grpId << ")";
+	UserErrors::assertTrue(carlsimState_==SETUP_STATE||carlsimState_==RUN_STATE,
+		UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName.str(), funcName.str(), "SETUP or RUN.");
+	UserErrors::assertTrue(simMode_==CPU_MODE, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName.str(),
+		funcName.str(), "CPU_MODE.");
+	UserErrors::assertTrue(grpId!=ALL, UserErrors::ALL_NOT_ALLOWED, funcName.str(), "grpId");
+	UserErrors::assertTrue(grpId>=0 && grpId<getNumGroups(), UserErrors::MUST_BE_IN_RANGE, funcName.str(),
+		"grpId", "[0,getNumGroups()]");
+	UserErrors::assertTrue(isGroupWithHomeostasis(grpId), UserErrors::WRONG_NEURON_TYPE, funcName.str(),
+		funcName.str(), " Homeostasis must have been enabled with CARLsim::setHomeostasis.");
+	UserErrors::assertTrue(avgTimeScale>0.0f, UserErrors::MUST_BE_POSITIVE, funcName.str(), "avgTimeScale");
+
+	snn_->updateHomeostasis(grpId, homeoScale, avgTimeScale);
+}
+
+// changes the homeostatic target firing rate of a group after setupNetwork
+void CARLsim::updateHomeoBaseFiringRate(int grpId, float baseFiring, float baseFiringSD) {
+	std::stringstream funcName; funcName << "updateHomeoBaseFiringRate(" << grpId << ")";
+	UserErrors::assertTrue(carlsimState_==SETUP_STATE||carlsimState_==RUN_STATE,
+		UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName.str(), funcName.str(), "SETUP or RUN.");
+	UserErrors::assertTrue(simMode_==CPU_MODE, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName.str(),
+		funcName.str(), "CPU_MODE.");
+	UserErrors::assertTrue(grpId!=ALL, UserErrors::ALL_NOT_ALLOWED, funcName.str(), "grpId");
+	UserErrors::assertTrue(grpId>=0 && grpId<getNumGroups(), UserErrors::MUST_BE_IN_RANGE, funcName.str(),
+		"grpId", "[0,getNumGroups()]");
+	UserErrors::assertTrue(isGroupWithHomeostasis(grpId), UserErrors::WRONG_NEURON_TYPE, funcName.str(),
+		funcName.str(), " Homeostasis must have been enabled with CARLsim::setHomeostasis.");
+	UserErrors::assertTrue(baseFiringSD>=0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName.str(), "baseFiringSD");
+
+	snn_->updateHomeoBaseFiringRate(grpId, baseFiring, baseFiringSD);
+}
+
 // scales the weight of every synapse in the connection with a scaling factor
 void CARLsim::scaleWeights(short int connId, float scale, bool updateWeightRange) {
 	std::stringstream funcName;	funcName << "scaleWeights(" << connId << "," << scale << "," << updateWeightRange << ")";
@@ -1155,7 +1450,7 @@ SpikeMonitor* CARLsim::setSpikeMonitor(int grpId, const std::string& fileName) {
 }
 
 // assign spike rate to poisson group
-void CARLsim::setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod) {
+void CARLsim::setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod, bool perStep) {
 	std::string funcName = "setSpikeRate()";
 	UserErrors::assertTrue(carlsimState_==SETUP_STATE || carlsimState_==RUN_STATE,
 					UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
@@ -1165,7 +1460,7 @@ void CARLsim::setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod) {
 	UserErrors::assertTrue(!spikeRate->isOnGPU() || (spikeRate->isOnGPU()&&getSimMode()==GPU_MODE),
 		UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, "PoissonRate on GPU", "GPU_MODE.");
 
-	snn_->setSpikeRate(grpId, spikeRate, refPeriod);
+	snn_->setSpikeRate(grpId, spikeRate, refPeriod, perStep);
 }
 
 void CARLsim::setWeight(short int connId, int neurIdPre, int neurIdPost, float weight, bool updateWeightRange) {
@@ -1180,6 +1475,22 @@ void CARLsim::setWeight(short int connId, int neurIdPre, int neurIdPost, float w
 	snn_->setWeight(connId, neurIdPre, neurIdPost, weight, updateWeightRange);
 }
 
+void CARLsim::setReplicaWeight(short int connId, int replica, float weight, bool updateWeightRange) {
+	std::stringstream funcName;	funcName << "setReplicaWeight(" << connId << "," << replica << "," << updateWeightRange
+		<< ")";
+	UserErrors::assertTrue(carlsimState_==SETUP_STATE || carlsimState_==RUN_STATE,
+		UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName.str(), funcName.str(), "SETUP or RUN.");
+	UserErrors::assertTrue(connId>=0 && connId<getNumConnections(), UserErrors::MUST_BE_IN_RANGE,
+		funcName.str(), "connectionId", "[0,getNumConnections()]");
+	UserErrors::assertTrue(replica>=0 && replica<getNumReplicas(), UserErrors::MUST_BE_IN_RANGE, funcName.str(),
+		"replica", "[0,getNumReplicas()-1]");
+	UserErrors::assertTrue(getBatchSize()==1, UserErrors::CANNOT_BE_CALLED_IN_MODE, funcName.str(), funcName.str(),
+		"batch mode (all samples share the same weights, use setWeight or scaleWeights instead).");
+	UserErrors::assertTrue(weight>=0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName.str(), "Weight value");
+
+	snn_->setReplicaWeight(connId, replica, weight, updateWeightRange);
+}
+
 // function writes population weights from gIDpre to gIDpost to file fname in binary.
 void CARLsim::writePopWeights(std::string fname, int gIDpre, int gIDpost) {
 	std::string funcName = "writePopWeights("+fname+")";
@@ -1367,6 +1678,14 @@ int CARLsim::getNumPostSynapses() {
 
 	return snn_->getNumPostSynapses(); }
 
+int CARLsim::getNumThreads() { return snn_->getNumThreads(); }
+
+int CARLsim::getNumReplicas() { return snn_->getNumReplicas(); }
+
+int CARLsim::getBatchSize() { return snn_->isReplicaSynapsesShared() ? snn_->getNumReplicas() : 1; }
+
+simdIsa_t CARLsim::getSIMD() { return snn_->getSIMD(); }
+
 
 GroupSTDPInfo_t CARLsim::getGroupSTDPInfo(int grpId) {
 	std::string funcName = "getGroupSTDPInfo()";
@@ -1596,6 +1915,22 @@ void CARLsim::setDefaultSTPparams(int neurType, float STP_U, float STP_tau_u, fl
 /// PRIVATE METHODS
 /// **************************************************************************************************************** ///
 
+// checks shared by all functions that change STDP parameters after setupNetwork
+void CARLsim::checkUpdateSTDP(const std::string& funcName, int grpId, bool isExcitatory) {
+	UserErrors::assertTrue(carlsimState_==SETUP_STATE||carlsimState_==RUN_STATE,
+		UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+	UserErrors::assertTrue(simMode_==CPU_MODE, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName,
+		"CPU_MODE.");
+	UserErrors::assertTrue(grpId!=ALL, UserErrors::ALL_NOT_ALLOWED, funcName, "grpId");
+	UserErrors::assertTrue(grpId>=0 && grpId<getNumGroups(), UserErrors::MUST_BE_IN_RANGE, funcName,
+		"grpId", "[0,getNumGroups()]");
+
+	GroupSTDPInfo_t stdpInfo = snn_->getGroupSTDPInfo(grpId);
+	UserErrors::assertTrue(isExcitatory ? stdpInfo.WithESTDP : stdpInfo.WithISTDP, UserErrors::WRONG_NEURON_TYPE,
+		funcName, funcName, isExcitatory ? " E-STDP must have been enabled with CARLsim::setESTDP."
+		: " I-STDP must have been enabled with CARLsim::setISTDP.");
+}
+
 // check whether grpId exists in grpIds_
 bool CARLsim::existsGrpId(int grpId) {
 	return std::find(grpIds_.begin(), grpIds_.end(), grpId)!=grpIds_.end();
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#ifndef _ASYNC_WRITER_H_
+#define _ASYNC_WRITER_H_
+
+#include <stdio.h>					// FILE
+#include <string.h>					// memcpy
+#include <vector>					// std::vector
+#include <deque>					// std::deque
+
+#if !defined(WIN32) && !defined(WIN64)
+#include <pthread.h>				// pthread_t, pthread_mutex_t, pthread_cond_t
+#endif
+
+/*!
+ * \brief Writes the files of all monitors of a network in a background thread
+ *
+ * Every file gets an append buffer, which is filled by the simulation thread (AsyncWriter::append). Full buffers,
+ * and partially filled ones on AsyncWriter::submit, are swapped with an empty buffer and handed to the background
+ * thread, which writes every buffer with a single fwrite. Buffers are recycled, so that no memory is allocated once
+ * the writer has warmed up.
+ *
+ * Memory is bounded: at most maxQueuedBytes can be waiting to be written. A submit that would exceed this limit
+ * blocks until the background thread has caught up (backpressure), so a simulation that produces data faster than
+ * the disk can take it slows down instead of running out of memory.
+ *
+ * The data of a file is written in the order it was appended. A file must not be written to directly once it has
+ * been added to the writer; it is fclosed by the writer (AsyncWriter::closeFile).
+ *
+ * \note On Windows, buffers are currently written synchronously in the calling thread.
+ */
+class AsyncWriter {
+public:
+	//! constructor, starts the background thread
+	AsyncWriter(size_t chunkBytes, size_t maxQueuedBytes);
+
+	//! destructor, writes and fcloses all files that are still open and joins the background thread
+	~AsyncWriter();
+
+	//! adds a file (with its header already written) and returns its ID
+	int addFile(FILE* fp);
+
+	//! appends data to the buffer of a file, which is handed to the background thread once it is full
+	void append(int fileId, const void* data, size_t numBytes) {
+		std::vector<char>& buf = files_[fileId].buf;
+		size_t pos = buf.size();
+		buf.resize(pos + numBytes);
+		memcpy(&buf[pos], data, numBytes);
+		if (buf.size() >= chunkBytes_)
+			enqueue(fileId, false, false);
+	}
+
+	//! hands everything appended to a file to the background thread, which fflushes the file after writing it
+	void submit(int fileId);
+
+	//! hands everything appended to a file to the background thread, which fcloses the file after writing it
+	//! The file ID must not be used anymore.
+	void closeFile(int fileId);
+
+	//! blocks until all submitted data has been written and flushed
+	void waitUntilWritten();
+
+	//! returns the number of times a submit had to wait for the background thread, because the queue was full
+	int getNumStalls() { return numStalls_; }
+
+	//! returns whether an fwrite failed since the last call (errors cannot be reported from the background thread)
+	bool checkAndClearWriteError();
+
+private:
+	//! a buffer waiting to be written, followed by an fflush or fclose
+	struct job_t {
+		FILE* fp;
+		std::vector<char> data;
+		bool flush;
+		bool close;
+	};
+
+	//! the append buffer of a file
+	struct file_t {
+		FILE* fp;					//!< NULL once the file has been closed
+		std::vector<char> buf;
+		bool needsFlush;			//!< whether data was queued since the last fflush
+	};
+
+	//! swaps the append buffer of a file with an empty one and queues the full one (blocks if the queue is full)
+	void enqueue(int fileId, bool flush, bool close);
+
+	//! writes the data of a job, then fflushes or fcloses its file, returns whether fwrite succeeded
+	bool write(job_t& job);
+
+	size_t chunkBytes_;					//!< size at which an append buffer is handed to the background thread
+	size_t maxQueuedBytes_;				//!< maximum number of bytes waiting to be written
+	std::vector<file_t> files_;
+	std::vector<std::vector<char> > freeBufs_;	//!< empty buffers, ready to be used as append buffers
+	int numStalls_;
+	bool writeError_;
+
+#if !defined(WIN32) && !defined(WIN64)
+	//! entry point of the background thread
+	static void* writerMain(void* arg);
+
+	pthread_t thread_;
+	pthread_mutex_t mutex_;				//!< guards everything below and freeBufs_, numStalls_, writeError_
+	pthread_cond_t workCond_;			//!< signals the background thread that a job was queued
+	pthread_cond_t doneCond_;			//!< signals waiting callers that a job was written
+	std::deque<job_t> queue_;			//!< jobs waiting to be written, in order
+	size_t queuedBytes_;				//!< number of bytes in queue_ and in the job currently being written
+	int numBusy_;						//!< number of jobs in queue_ plus the one currently being written
+	bool shutdown_;						//!< set by the destructor to terminate the background thread
+#endif
+};
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#ifndef _COUNTER_RNG_H_
+#define _COUNTER_RNG_H_
+
+#include <stdint.h>					// uint32_t, uint64_t
+
+/*!
+ * \brief A counter-based pseudo-random number generator (Philox4x32-10)
+ *
+ * Unlike drand48() or rand(), a CounterRNG has no hidden global state: the numbers it produces are a pure function
+ * of a 64-bit key (the random seed) and a 64-bit stream ID. Any number of independent streams can thus be created
+ * on the fly (e.g., one per pre-synaptic neuron), and the numbers drawn from a stream do not depend on which thread
+ * draws them or on how many other streams were used before.
+ *
+ * The generator implements the Philox4x32 bijection with 10 rounds as described in Salmon et al. (2011),
+ * "Parallel random numbers: as easy as 1, 2, 3". Every evaluation yields four 32-bit numbers, which are handed
+ * out one at a time before the counter is advanced.
+ */
+class CounterRNG {
+public:
+	/*!
+	 * \brief creates a random stream
+	 * \param[in] seed     the key of the generator, usually the random seed of the network
+	 * \param[in] streamId the ID of the stream; different IDs yield statistically independent sequences
+	 */
+	CounterRNG(uint64_t seed, uint64_t streamId) {
+		key_[0] = (uint32_t)seed;
+		key_[1] = (uint32_t)(seed >> 32);
+		ctr_[0] = 0;
+		ctr_[1] = 0;
+		ctr_[2] = (uint32_t)streamId;
+		ctr_[3] = (uint32_t)(streamId >> 32);
+		bufPos_ = 4;
+	}
+
+	//! returns a uniformly distributed 32-bit unsigned integer
+	uint32_t nextUInt32() {
+		if (bufPos_ == 4) {
+			generateBlock();
+			bufPos_ = 0;
+		}
+		return buf_[bufPos_++];
+	}
+
+	//! returns a uniformly distributed double in [0,1) with 53 bits of randomness, like drand48()
+	double nextDouble() {
+		uint64_t hi = nextUInt32() >> 5; // 27 bits
+		uint64_t lo = nextUInt32() >> 6; // 26 bits
+		return (hi*67108864.0 + lo) * (1.0/9007199254740992.0);
+	}
+
+	//! returns a uniformly distributed integer in [0,n), n>0
+	uint32_t nextInt(uint32_t n) {
+		return (uint32_t)(nextDouble()*n);
+	}
+
+private:
+	static void mulhilo(uint32_t a, uint32_t b, uint32_t* hi, uint32_t* lo) {
+		uint64_t prod = (uint64_t)a * (uint64_t)b;
+		*hi = (uint32_t)(prod >> 32);
+		*lo = (uint32_t)prod;
+	}
+
+	//! evaluates the Philox bijection on the current counter and advances the counter
+	void generateBlock() {
+		uint32_t c0 = ctr_[0], c1 = ctr_[1], c2 = ctr_[2], c3 = ctr_[3];
+		uint32_t k0 = key_[0], k1 = key_[1];
+		for (int r=0; r<10; r++) {
+			uint32_t hi0, lo0, hi1, lo1;
+			mulhilo(0xD2511F53u, c0, &hi0, &lo0);
+			mulhilo(0xCD9E8D57u, c2, &hi1, &lo1);
+			c0 = hi1 ^ c1 ^ k0;
+			c1 = lo1;
+			c2 = hi0 ^ c3 ^ k1;
+			c3 = lo0;
+			k0 += 0x9E3779B9u;
+			k1 += 0xBB67AE85u;
+		}
+		buf_[0] = c0; buf_[1] = c1; buf_[2] = c2; buf_[3] = c3;
+
+		// the lower 64 bits of the counter enumerate the blocks of a stream
+		if (++ctr_[0] == 0)
+			++ctr_[1];
+	}
+
+	uint32_t key_[2];	//!< 64-bit key (seed)
+	uint32_t ctr_[4];	//!< 128-bit counter: block index (low 64 bits) and stream ID (high 64 bits)
+	uint32_t buf_[4];	//!< output of the last evaluation
+	int bufPos_;		//!< next unused entry of buf_
+};
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#ifndef _IZHIKEVICH_SIMD_H_
+#define _IZHIKEVICH_SIMD_H_
+
+#include <carlsim_datastructures.h>	// simdIsa_t
+
+//! all the state a vectorized Izhikevich kernel needs, stored as structure of arrays indexed by neuron ID
+typedef struct izh_kernel_args_s {
+	const float* voltage;		//!< membrane potential at the beginning of the step (read-only)
+	float* nextVoltage;			//!< membrane potential at the end of the step
+	float* recovery;			//!< recovery variable, updated in place
+	bool* curSpike;				//!< set to true for every neuron that spikes
+	const float* extCurrent;
+	const float* current;		//!< synaptic current (CUBA)
+	const float* gAMPA;			//!< conductances (COBA)
+	const float* gNMDA;
+	const float* gNMDA_r;
+	const float* gNMDA_d;
+	const float* gGABAa;
+	const float* gGABAb;
+	const float* gGABAb_r;
+	const float* gGABAb_d;
+	const float* Izh_a;
+	const float* Izh_b;
+	const float* Izh_c;
+	const float* Izh_d;
+	const float* Izh_C;			//!< 9-param model only
+	const float* Izh_k;			//!< 9-param model only
+	const float* Izh_vr;		//!< 9-param model only
+	const float* Izh_vt;		//!< 9-param model only
+	const float* Izh_vpeak;		//!< 9-param model only
+	float timeStep;
+	bool withConductances;		//!< COBA (true) or CUBA (false)
+	bool withNMDARise;
+	bool withGABAbRise;
+	bool withParamModel_9;
+	bool withRungeKutta4;		//!< Runge-Kutta 4th order (true) or forward Euler (false)
+} izh_kernel_args_t;
+
+//! returns the widest instruction set supported by both the compiler and the CPU we are running on
+simdIsa_t getBestSimdIsa();
+
+//! returns whether both the compiler and the CPU we are running on support an instruction set
+bool isSimdIsaSupported(simdIsa_t isa);
+
+/*!
+ * \brief integrates neurons lNeurId..rNeurId (inclusive) by a single integration step using SIMD instructions
+ *
+ * This does the same as CpuSNN::updateNeuronsKernel for groups without compartments, but processes as many neurons
+ * at once as fit into a SIMD register of the given instruction set. Neurons that are left over at the end of the
+ * range are copied to a padded vector, so that all neurons take the same code path. Spike threshold and reset are
+ * done with masks, and the resulting spike bits are written to curSpike.
+ * The kernels are compiled without FMA contraction. Results agree with the scalar kernel up to floating-point
+ * rounding.
+ */
+void updateIzhikevichSIMD(simdIsa_t isa, const izh_kernel_args_t& args, int lNeurId, int rNeurId);
+
+#endif
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+// NOTE: This file deliberately has no include guard. It is included by izhikevich_simd.cpp once per instruction set,
+// each time inside a namespace that defines a vector type Vec (and under a matching "#pragma GCC target"), so
+// that the compiler generates one copy of the kernel per instruction set from a single source.
+//
+// Vec must provide:
+//   type, mask          vector of floats and result of a comparison
+//   width               number of floats in a vector
+//   load, store, set1   unaligned load/store, broadcast
+//   gt, lt, select      comparisons and select(m,a,b) = m ? a : b
+//   bits                comparison mask as an int, one bit per float
+// Arithmetic is written with plain operators, which GCC supports on its vector types (also when mixed with scalars).
+
+// voltage equation of the Izhikevich model, same operations as dvdtIzhikevich4/9 in snn_cpu.cpp
+template<class V, bool IZH9>
+inline typename V::type izhDvdt(typename V::type volt, typename V::type recov, typename V::type invCapac,
+	typename V::type izhK, typename V::type voltRest, typename V::type voltInst, typename V::type totalCurrent,
+	typename V::type timeStep)
+{
+	if (IZH9)
+		return ( (izhK * (volt - voltRest) * (volt - voltInst) - recov + totalCurrent) * invCapac * timeStep );
+	else
+		return ( ((0.04f * volt + 5.0f) * volt + 140.0f - recov + totalCurrent) * timeStep );
+}
+
+// recovery equation of the Izhikevich model, same operations as dudtIzhikevich4/9 in snn_cpu.cpp
+template<class V, bool IZH9>
+inline typename V::type izhDudt(typename V::type volt, typename V::type recov, typename V::type voltRest,
+	typename V::type izhA, typename V::type izhB, typename V::type timeStep)
+{
+	if (IZH9)
+		return ( izhA * (izhB * (volt - voltRest) - recov) * timeStep );
+	else
+		return ( izhA * (izhB * volt - recov) * timeStep );
+}
+
+// integrates as many neurons of lNeurId..rNeurId as fit into whole vectors, returns the first neuron not processed
+template<class V, bool COBA, bool NMDA_RISE, bool GABAB_RISE, bool IZH9, bool RK4>
+int izhLoop(const izh_kernel_args_t& p, int lNeurId, int rNeurId) {
+	typedef typename V::type vec;
+	typedef typename V::mask vmask;
+
+	const vec dt = V::set1(p.timeStep);
+	const vec vMin = V::set1(-90.0f);
+
+	int i = lNeurId;
+	for (; i + V::width - 1 <= rNeurId; i += V::width) {
+		vec v = V::load(p.voltage + i);
+		vec u = V::load(p.recovery + i);
+		vec a = V::load(p.Izh_a + i);
+		vec b = V::load(p.Izh_b + i);
+		vec k = V::set1(0.0f);
+		vec vr = V::set1(0.0f);
+		vec vt = V::set1(0.0f);
+		vec inverse_C = V::set1(1.0f);
+		vec vpeak = V::set1(30.0f);
+		if (IZH9) {
+			k = V::load(p.Izh_k + i);
+			vr = V::load(p.Izh_vr + i);
+			vt = V::load(p.Izh_vt + i);
+			inverse_C = 1.0f / V::load(p.Izh_C + i);
+			vpeak = V::load(p.Izh_vpeak + i);
+		}
+
+		// sum up total current = synaptic + external
+		vec totalCurrent = V::load(p.extCurrent + i);
+		if (COBA) {
+			vec tmp_gNMDA = NMDA_RISE ? V::load(p.gNMDA_d + i) - V::load(p.gNMDA_r + i) : V::load(p.gNMDA + i);
+			vec tmp_gGABAb = GABAB_RISE ? V::load(p.gGABAb_d + i) - V::load(p.gGABAb_r + i) : V::load(p.gGABAb + i);
+			vec tmp_iNMDA = (v + 80.0f) * (v + 80.0f) / 60.0f / 60.0f;
+
+			totalCurrent += -(V::load(p.gAMPA + i) * (v - 0.0f) +
+				tmp_gNMDA * tmp_iNMDA / (1.0f + tmp_iNMDA) * (v - 0.0f) +
+				V::load(p.gGABAa + i) * (v + 70.0f) +
+				tmp_gGABAb * (v + 90.0f));
+		} else {
+			totalCurrent += V::load(p.current + i);
+		}
+
+		vec vNew;
+		vec du = V::set1(0.0f);
+		if (!RK4) {
+			vNew = v + izhDvdt<V,IZH9>(v, u, inverse_C, k, vr, vt, totalCurrent, dt);
+		} else {
+			vec k1 = izhDvdt<V,IZH9>(v, u, inverse_C, k, vr, vt, totalCurrent, dt);
+			vec l1 = izhDudt<V,IZH9>(v, u, vr, a, b, dt);
+
+			vec k2 = izhDvdt<V,IZH9>(v + k1/2.0f, u + l1/2.0f, inverse_C, k, vr, vt, totalCurrent, dt);
+			vec l2 = izhDudt<V,IZH9>(v + k1/2.0f, u + l1/2.0f, vr, a, b, dt);
+
+			vec k3 = izhDvdt<V,IZH9>(v + k2/2.0f, u + l2/2.0f, inverse_C, k, vr, vt, totalCurrent, dt);
+			vec l3 = izhDudt<V,IZH9>(v + k2/2.0f, u + l2/2.0f, vr, a, b, dt);
+
+			vec k4 = izhDvdt<V,IZH9>(v + k3, u + l3, inverse_C, k, vr, vt, totalCurrent, dt);
+			vec l4 = izhDudt<V,IZH9>(v + k3, u + l3, vr, a, b, dt);
+
+			vNew = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+			du = (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+		}
+
+		// masked threshold and reset
+		vmask spk = V::gt(vNew, vpeak);
+		vNew = V::select(spk, V::load(p.Izh_c + i), vNew);
+		u = V::select(spk, u + V::load(p.Izh_d + i), u);
+		vNew = V::select(V::lt(vNew, vMin), vMin, vNew);
+		V::store(p.nextVoltage + i, vNew);
+
+		// To maintain consistency with Izhikevich' original Matlab code, recovery is based on nextVoltage (Euler).
+		if (!RK4) {
+			u += izhDudt<V,IZH9>(vNew, u, vr, a, b, dt);
+		} else {
+			u += du;
+		}
+		V::store(p.recovery + i, u);
+
+		for (int bits=V::bits(spk), j=0; bits!=0; bits>>=1, j++) {
+			if (bits & 1)
+				p.curSpike[i+j] = true;
+		}
+	}
+
+	return i;
+}
+
+// resolve the run-time flags of izh_kernel_args_t to template parameters, one flag at a time
+template<class V, bool COBA, bool NMDA_RISE, bool GABAB_RISE, bool IZH9>
+int izhDispatchRK4(const izh_kernel_args_t& p, int lNeurId, int rNeurId) {
+	return p.withRungeKutta4 ? izhLoop<V,COBA,NMDA_RISE,GABAB_RISE,IZH9,true>(p, lNeurId, rNeurId)
+		: izhLoop<V,COBA,NMDA_RISE,GABAB_RISE,IZH9,false>(p, lNeurId, rNeurId);
+}
+
+template<class V, bool COBA, bool NMDA_RISE, bool GABAB_RISE>
+int izhDispatchIzh9(const izh_kernel_args_t& p, int lNeurId, int rNeurId) {
+	return p.withParamModel_9 ? izhDispatchRK4<V,COBA,NMDA_RISE,GABAB_RISE,true>(p, lNeurId, rNeurId)
+		: izhDispatchRK4<V,COBA,NMDA_RISE,GABAB_RISE,false>(p, lNeurId, rNeurId);
+}
+
+template<class V>
+int izhDispatch(const izh_kernel_args_t& p, int lNeurId, int rNeurId) {
+	// rise times only matter in COBA mode
+	if (!p.withConductances)
+		return izhDispatchIzh9<V,false,false,false>(p, lNeurId, rNeurId);
+	else if (p.withNMDARise)
+		return p.withGABAbRise ? izhDispatchIzh9<V,true,true,true>(p, lNeurId, rNeurId)
+			: izhDispatchIzh9<V,true,true,false>(p, lNeurId, rNeurId);
+	else
+		return p.withGABAbRise ? izhDispatchIzh9<V,true,false,true>(p, lNeurId, rNeurId)
+			: izhDispatchIzh9<V,true,false,false>(p, lNeurId, rNeurId);
+}
+
+// copies n neurons starting at src[i] to dst and pads the rest of the vector with the first of them
+inline const float* izhPadVector(const float* src, int i, int n, float* dst) {
+	if (src == NULL)
+		return NULL;
+	for (int j=0; j<Vec::width; j++)
+		dst[j] = src[i + (j<n ? j : 0)];
+	return dst;
+}
+
+// vectorized main part, then the remaining neurons (if any) as one padded vector
+// This way, every neuron is integrated by the same instructions no matter where the range starts or ends, which keeps
+// multi-threaded results identical to single-threaded ones.
+inline void updateNeurons(const izh_kernel_args_t& p, int lNeurId, int rNeurId) {
+	int i = izhDispatch<Vec>(p, lNeurId, rNeurId);
+	int n = rNeurId - i + 1;
+	if (n <= 0)
+		return;
+
+	float buf[22][Vec::width];
+	bool spike[Vec::width];
+	izh_kernel_args_t q = p;
+	q.voltage = izhPadVector(p.voltage, i, n, buf[0]);
+	q.recovery = buf[1];
+	izhPadVector(p.recovery, i, n, buf[1]);
+	q.nextVoltage = buf[2];
+	q.curSpike = spike;
+	q.extCurrent = izhPadVector(p.extCurrent, i, n, buf[3]);
+	q.current = izhPadVector(p.current, i, n, buf[4]);
+	q.gAMPA = izhPadVector(p.gAMPA, i, n, buf[5]);
+	q.gNMDA = izhPadVector(p.gNMDA, i, n, buf[6]);
+	q.gNMDA_r = izhPadVector(p.gNMDA_r, i, n, buf[7]);
+	q.gNMDA_d = izhPadVector(p.gNMDA_d, i, n, buf[8]);
+	q.gGABAa = izhPadVector(p.gGABAa, i, n, buf[9]);
+	q.gGABAb = izhPadVector(p.gGABAb, i, n, buf[10]);
+	q.gGABAb_r = izhPadVector(p.gGABAb_r, i, n, buf[11]);
+	q.gGABAb_d = izhPadVector(p.gGABAb_d, i, n, buf[12]);
+	q.Izh_a = izhPadVector(p.Izh_a, i, n, buf[13]);
+	q.Izh_b = izhPadVector(p.Izh_b, i, n, buf[14]);
+	q.Izh_c = izhPadVector(p.Izh_c, i, n, buf[15]);
+	q.Izh_d = izhPadVector(p.Izh_d, i, n, buf[16]);
+	q.Izh_C = izhPadVector(p.Izh_C, i, n, buf[17]);
+	q.Izh_k = izhPadVector(p.Izh_k, i, n, buf[18]);
+	q.Izh_vr = izhPadVector(p.Izh_vr, i, n, buf[19]);
+	q.Izh_vt = izhPadVector(p.Izh_vt, i, n, buf[20]);
+	q.Izh_vpeak = izhPadVector(p.Izh_vpeak, i, n, buf[21]);
+	for (int j=0; j<Vec::width; j++)
+		spike[j] = false;
+
+	izhDispatch<Vec>(q, 0, Vec::width-1);
+
+	for (int j=0; j<n; j++) {
+		p.nextVoltage[i+j] = buf[2][j];
+		p.recovery[i+j] = buf[1][j];
+		if (spike[j])
+			p.curSpike[i+j] = true;
+	}
+}
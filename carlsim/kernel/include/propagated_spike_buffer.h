@@ -28,10 +28,17 @@ typedef unsigned short int delay_t;
 //! Type for specifying the delay in time steps
 typedef unsigned short int delaystep_t;
 
-//! The size of one allocation chunk size in PropagatedSpikeBuffer
-#define PROPAGATED_SPIKE_BUFFER_CHUNK_SIZE 1024
+//! The initial capacity (in number of scheduled spikes) of one slot in PropagatedSpikeBuffer
+/*! Slots grow on demand and keep their capacity when they are recycled, so after a short warm-up no more
+ * allocations take place.
+ */
+#define PROPAGATED_SPIKE_BUFFER_CHUNK_SIZE 16
 
 //! Schedule/Store spikes to be delivered at a later point in the simulation
+/*! The buffer is a ring of time slots, each of which holds the spike target groups scheduled for that time step in
+ * a contiguous array. Scheduling a spike appends to the array of the target slot, and reading a slot is a linear
+ * scan over memory. Advancing to the next time step empties the current slot without releasing its memory.
+ */
 class PropagatedSpikeBuffer
 {
 
@@ -40,7 +47,7 @@ public:
     //! New spike buffer
     /*! \param minDelay Minimum delay (in number of time steps) the buffer can handle
     *  \param maxDelay Maximum delay (in number of time steps) the buffer can handle
-    *  \param chunkSize Constant used for internal memory management.
+    *  \param chunkSize Initial capacity of every slot (in number of scheduled spikes).
     *                   Should increase with increasing number of synapses and
     *                   exptected number of spikes.
     */
@@ -56,34 +63,46 @@ public:
      *              identifier in SpikeTargetGroupPool::beginSpikeTarget( stg )
      *  \param delay The number of time steps to delay the deliver of the spike
      */
-    void scheduleSpikeTargetGroup(spikegroupid_t stg, delaystep_t delay);
-
-    //! Structure which stores the index of the spike target group and a pointer to the next element in various lists
+    void scheduleSpikeTargetGroup(spikegroupid_t stg, delaystep_t delay)
+    {
+        //assert( delay < length() );
+        size_t writeIdx = currIdx + delay;
+        if (writeIdx >= ringBuffer.size())
+            writeIdx -= ringBuffer.size();
+
+        StgNode n;
+        n.stg   = stg;
+        n.delay = delay;
+        ringBuffer[writeIdx].push_back(n);
+    }
+
+    //! Structure which stores the index of the spike target group and the delay it was scheduled with
     struct StgNode
     {
         spikegroupid_t stg;
         delaystep_t delay;
-        StgNode *next;
     };
 
     //! Iterator to loop over the scheduled spikes at a certain delay
+    /*! Iterators are invalidated by scheduling a spike into the slot they point to, by nextTimeStep, and by reset.
+     */
     class const_iterator
     {
     public:
         const_iterator(): node(NULL) {};
-        const_iterator(StgNode *n): node(n) {};
+        const_iterator(const StgNode *n): node(n) {};
 
-        StgNode* operator->() { return node; }
+        const StgNode* operator->() { return node; }
         spikegroupid_t operator*() { return node->stg; }
 
         bool operator==(const const_iterator& other) { return ( this->node == other.node ); }
 
         bool operator!=(const const_iterator& other) { return ( this->node != other.node ); }
 
-        inline const_iterator& operator++() { node = node->next; return *this; }
+        inline const_iterator& operator++() { ++node; return *this; }
 
     private:
-        StgNode *node;
+        const StgNode *node;
     };
 
     //! Returns an iterator to loop over all scheduled spike target groups
@@ -92,19 +111,17 @@ public:
      */
     const_iterator beginSpikeTargetGroups(int stepOffset = 0)
     {
-#ifdef DEBUG
-        // this assertion fails if stepOffset < -length()
-        if (const_iterator( ringBufferFront[ (currIdx + stepOffset + length() ) % length()  ] ) != NULL)
-            //        cout << "in beginSTG currT=" << currT << " stepOffset=" << stepOffset << endl;
-            assert( (currIdx + stepOffset + length() ) % length() >= 0 );
-#endif
-        return const_iterator( ringBufferFront[ (currIdx + stepOffset + length() ) % length()  ] );
+        const vector<StgNode>& slot = ringBuffer[ slotIdx(stepOffset) ];
+        return const_iterator( slot.empty() ? NULL : &slot[0] );
     };
 
-    //! End iterator corresponding to beginSynapseGroups
-    const_iterator endSpikeTargetGroups()
+    //! End iterator corresponding to beginSpikeTargetGroups
+    /*! \param stepOffset Must be the same value that was passed to beginSpikeTargetGroups
+     */
+    const_iterator endSpikeTargetGroups(int stepOffset = 0)
     {
-        return const_iterator(NULL);
+        const vector<StgNode>& slot = ringBuffer[ slotIdx(stepOffset) ];
+        return const_iterator( slot.empty() ? NULL : &slot[0] + slot.size() );
     };
 
     //! Must be called to tell the buffer that it should move on to the next time step
@@ -117,48 +134,30 @@ public:
     void reset(int minDelay, int maxDelay);
 
     //! Return the actual length of the buffer
-    inline size_t length() { return ringBufferFront.size(); };
-
-    // PropagatedSpikeBuffer & operator=(const PropagatedSpikeBuffer &src);
+    inline size_t length() { return ringBuffer.size(); };
 
 private :
 
     //! Set up internal memory management
     void init(size_t maxDelaySteps);
 
-    //! Get a new StgNode from the internal memory management
-    StgNode *getFreeNode(void);
+    //! Index into the ring buffer which corresponds to position ( current timestep + stepOffset )
+    inline size_t slotIdx(int stepOffset) {
+        // this assertion fails if stepOffset < -length()
+        assert( (int)currIdx + stepOffset + (int)length() >= 0 );
+        return ( currIdx + stepOffset + length() ) % length();
+    }
 
     //! The index into the ring buffer which corresponds to the current time step
-    int currIdx ;
+    size_t currIdx ;
 
-    //! A ring buffer storing a pointer to the first StgNode of the scheduled spike receiving groups
-    vector< StgNode* > ringBufferFront;
+    //! A ring buffer storing the scheduled spike target groups of every time step
+    vector< vector<StgNode> > ringBuffer;
 
-    //! A ring buffer storing a pointer to the last StgNode of the scheduled spike receiving groups
-    vector< StgNode* > ringBufferBack;
-
-    //! Buffer with pointers to chunks of memory allocated
-    vector< StgNode* > chunkBuffer;
-
-    //! Pointer to array of SrgNodes to take from (from position nextFreeSrgNodeIdx)
-    StgNode *currentFreeChunk;
-
-    //! Index into array currentFreeChunk which specifies the next StgNode to use
-    int  nextFreeSrgNodeIdx;
-
-    //! Index into chunkBuffer which specifies the next free chunk of memory to use
-    size_t nextFreeChunkIdx;
-
-    //! Head of list of SrgNodes which can be reused
-    StgNode* recycledNodes;
-
-    //! Number of SrgNodes per chunk of memory to allocate
+    //! Initial capacity of every slot
     int chunkSize;
 
     int currT;
-
-    double fillitup[32];
 };
 
 #endif /*PROPAGATEDSPIKEBUFFER_H_*/
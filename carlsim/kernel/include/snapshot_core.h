@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#ifndef _SNAPSHOT_CORE_H_
+#define _SNAPSHOT_CORE_H_
+
+#include <propagated_spike_buffer.h>
+
+#include <stddef.h>					// size_t
+#include <stdint.h>					// uint64_t
+#include <vector>					// std::vector
+
+class CpuSNN;
+
+/*!
+ * \brief An immutable, reference-counted copy of a piece of network state
+ *
+ * The synaptic arrays (wt, wtChange, ...) are by far the largest part of the state of a network. Snapshots do not
+ * copy such an array again if it has not changed since the last snapshot, but share the copy of that snapshot (see
+ * CpuSNN::takeSnapshot). Every copy remembers the version of the network array it was taken from, and is deleted
+ * once the last snapshot that uses it has been deleted. The network itself only keeps a weak reference to the most
+ * recent copy of each array, which is reset to NULL when the copy gets deleted.
+ *
+ * \note Reference counting is not thread-safe: the snapshots of a network must not be taken, restored, or deleted
+ * from several threads at the same time.
+ */
+class SharedStateCopy {
+public:
+	//! copies numBytes from src; the creator holds the first reference
+	SharedStateCopy(const void* src, size_t numBytes, uint64_t version);
+
+	void addRef() { numRefs_++; }
+	void release() { if (--numRefs_ == 0) delete this; }
+	int getNumRefs() { return numRefs_; }
+
+	//! makes *ref point to this copy until the copy gets deleted or clearWeakRef is called
+	void setWeakRef(SharedStateCopy** ref) { weakRef_ = ref; *ref = this; }
+	void clearWeakRef() { weakRef_ = NULL; }
+
+	const void* getData() { return data_.empty() ? NULL : &data_[0]; }
+	size_t getNumBytes() { return data_.size(); }
+
+	//! the version of the network array at the time the copy was taken
+	uint64_t getVersion() { return version_; }
+
+private:
+	~SharedStateCopy() { if (weakRef_ != NULL) *weakRef_ = NULL; }	// use release
+
+	std::vector<char> data_;
+	uint64_t version_;
+	int numRefs_;
+	SharedStateCopy** weakRef_;
+};
+
+/*!
+ * \brief The dynamic state of a network at a certain point in time
+ *
+ * Created by CpuSNN::takeSnapshot and written back by CpuSNN::restoreSnapshot. Plain-old-data state (neuron and
+ * synapse arrays, simulation time, counters) is stored as a list of memory regions in the order given by
+ * CpuSNN::getStateRegions: regions without version counter are packed into a single buffer, all others (the synaptic
+ * arrays) are stored as SharedStateCopy. Containers are copied as a whole.
+ */
+class SnapshotCore {
+public:
+	explicit SnapshotCore(const CpuSNN* snn);
+	~SnapshotCore();
+
+	const CpuSNN* snn;							//!< the network the snapshot belongs to
+	uint64_t simTime;							//!< simulation time at which the snapshot was taken (ms)
+
+	std::vector<char> regions;					//!< regions without version counter, packed
+	std::vector<SharedStateCopy*> sharedRegions;	//!< regions with version counter (shared with other snapshots)
+
+	PropagatedSpikeBuffer* pbuf;				//!< scheduled spikes
+	std::vector<std::vector<int> > spikeRingD1;	//!< spikes of the last maxDelay ms (1ms delays)
+	std::vector<std::vector<int> > spikeRingD2;	//!< spikes of the last maxDelay ms (other delays)
+	std::vector<unsigned int> firingLogD1, firingLogD2, firingLogTimeD1, firingLogTimeD2; //!< spikes of this second
+
+	//! approximate number of bytes freed by deleting the snapshot (copies shared with other snapshots excluded)
+	size_t getMemoryUsage();
+
+private:
+	SnapshotCore(const SnapshotCore&);				// not copyable
+	SnapshotCore& operator=(const SnapshotCore&);
+};
+
+#endif
@@ -75,6 +75,11 @@
 #include <snn_datastructures.h>
 
 #include <propagated_spike_buffer.h>
+#include <snapshot_core.h>
+#include <thread_pool.h>
+#include <async_writer.h>
+#include <counter_rng.h>
+#include <izhikevich_simd.h>
 #include <poisson_rate.h>
 #ifndef __NO_CUDA__
 	#include <gpu_random.h>
@@ -223,6 +228,27 @@ public:
 	//! Sets the integration method and the number of integration steps per 1ms simulation time step
 	void setIntegrationMethod(integrationMethod_t method, int numStepsPerMs);
 
+	//! Sets the number of CPU threads that share the neuronal state update and spike delivery in CPU mode
+	void setNumThreads(int numThreads);
+
+	//! Simulates numReplicas copies of every group, all of which share the topology (and possibly the synapses)
+	void setNumReplicas(int numReplicas, bool shareSynapses=false);
+
+	//! Overrides the mean Izhikevich parameters of a group in a single replica
+	void setReplicaNeuronParameters(int grpId, int replica, float izh_a, float izh_b, float izh_c, float izh_d);
+
+	//! Uses per-neuron and -delay spike arrival times instead of per-synapse spike times for STDP in CPU mode
+	void setPerDelayArrivalTimes(bool isSet);
+
+	//! Only updates the weights of synapses whose weight change got modified since the last update in CPU mode
+	void setIncrementalWeightUpdate(bool isSet);
+
+	//! Enables/disables vectorized neuron state update kernels in CPU mode
+	void setSIMD(bool useSIMD);
+
+	//! Uses vectorized neuron state update kernels of a specific instruction set in CPU mode
+	void setSIMD(simdIsa_t isa);
+
 	//! Sets the Izhikevich parameters a, b, c, and d of a neuron group.
 	/*!
 	 * \brief Parameter values for each neuron are given by a normal distribution with mean _a, _b, _c, _d and standard deviation _a_sd, _b_sd, _c_sd, and _d_sd, respectively
@@ -353,6 +379,21 @@ public:
 	 */
 	int runNetwork(int _nsec, int _nmsec, bool printRunSummary, bool copyState);
 
+	//! advances the simulation by numSteps ms, without the per-run overhead of runNetwork (CPU mode)
+	void stepNetwork(int numSteps);
+
+	//! lists the neurons of a group that spiked in the last time step, returns their number
+	int getLastStepSpikes(int grpId, std::vector<int>& neurIds);
+
+	//! paces every simulated ms of runNetwork and stepNetwork against the wall clock (see CARLsim::setRealTimeMode)
+	void setRealTimeMode(bool enable, bool skipMonitorsWhenLate);
+
+	//! returns the deadline statistics of real-time mode since the last resetRealTimeStats
+	RealTimeStats_t getRealTimeStats();
+
+	//! clears the deadline statistics and restarts the real-time clock at the current simTime
+	void resetRealTimeStats();
+
 	/*!
 	 * \brief build the network
 	 * \param[in] removeTempMemory 	remove temp memory after building network
@@ -385,6 +426,32 @@ public:
 	 */
 	void resetSpikeCounter(int grpId);
 
+	//! resets all dynamic state of the network (and simTime) to what it was right after setupNetwork, keeping the weights
+	void resetState();
+
+	//! changes the (4-param) Izhikevich parameters of a group after setupNetwork, without reallocating anything
+	void updateNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
+		float izh_c, float izh_c_sd, float izh_d, float izh_d_sd);
+
+	//! changes the E-STDP curve of a group after setupNetwork (E-STDP must already be enabled)
+	void updateESTDP(int grpId, stdpCurve_t curve, float alphaPlus, float tauPlus, float alphaMinus, float tauMinus,
+		float gamma);
+
+	//! changes the I-STDP curve of a group after setupNetwork (I-STDP must already be enabled)
+	void updateISTDP(int grpId, stdpCurve_t curve, float ab1, float ab2, float tau1, float tau2);
+
+	//! changes the homeostasis parameters of a group after setupNetwork (homeostasis must already be enabled)
+	void updateHomeostasis(int grpId, float homeoScale, float avgTimeScale);
+
+	//! changes the homeostatic target firing rate of a group after setupNetwork
+	void updateHomeoBaseFiringRate(int grpId, float baseFiring, float baseFiringSD);
+
+	//! copies all dynamic state of the network (and simTime) into a new snapshot, see SnapshotCore
+	SnapshotCore* takeSnapshot();
+
+	//! brings all dynamic state of the network (and simTime) back to what it was when the snapshot was taken
+	void restoreSnapshot(SnapshotCore* snap);
+
 	// multiplies every weight with a scaling factor
 	void scaleWeights(short int connId, float scale, bool updateWeightRange=false);
 
@@ -439,12 +506,16 @@ public:
 	 * \param grpId ID of the neuron group
 	 * \param spikeRate pointer to a PoissonRate instance
 	 * \param refPeriod (optional) refractive period,  default = 1
+	 * \param perStep whether to draw the spikes of every time step directly (CPU mode only)
 	 */
-	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod);
+	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod, bool perStep);
 
 	//! sets the weight value of a specific synapse
 	void setWeight(short int connId, int neurIdPre, int neurIdPost, float weight, bool updateWeightRange=false);
 
+	//! sets the weight value of all synapses of a connection that belong to a specific replica
+	void setReplicaWeight(short int connId, int replica, float weight, bool updateWeightRange=false);
+
 	//! enters a testing phase, where all weight updates are disabled
 	void startTesting(bool shallUpdateWeights=true);
 
@@ -533,6 +604,11 @@ public:
 	int getGroupStartNeuronId(int grpId)  { return grp_Info[grpId].StartN; }
 	int getGroupEndNeuronId(int grpId)    { return grp_Info[grpId].EndN; }
 	int getGroupNumNeurons(int grpId)     { return grp_Info[grpId].SizeN; }
+	int getGroupReplicaNumNeurons(int grpId) { return grp_Info[grpId].SizeN/numReplicas_; }
+	//! returns the number of neurons of a group that own synapses (only replica 0 if replicas share synapses)
+	int getGroupNumNeuronsWithSynapses(int grpId) {
+		return replicasShareSynapses_ ? getGroupReplicaNumNeurons(grpId) : grp_Info[grpId].SizeN;
+	}
 
 	std::string getNetworkName() { return networkName_; }
 
@@ -552,6 +628,10 @@ public:
 	int getNumNeuronsGenInh() { return numNInhPois; }
 	int getNumPreSynapses() { return preSynCnt; }
 	int getNumPostSynapses() { return postSynCnt; }
+	int getNumThreads() { return numThreads_; }
+	int getNumReplicas() { return numReplicas_; }
+	bool isReplicaSynapsesShared() { return replicasShareSynapses_; }
+	simdIsa_t getSIMD() { return simdIsa_; }
 
 	int getRandSeed() { return randSeed_; }
 
@@ -567,6 +647,10 @@ public:
 	//! Should not be exposed to user interface
 	SpikeMonitorCore* getSpikeMonitorCore(int grpId);
 
+	//! Returns the writer shared by the files of all monitors (created on first use).
+	//! Should not be exposed to user interface
+	AsyncWriter* getMonitorWriter();
+
 	/*!
 	 * \brief return the number of spikes per neuron for a certain group
 	 * A Spike Counter keeps track of all spikes per neuron for a certain time period (recordDur) at any point in time.
@@ -620,6 +704,7 @@ public:
 	bool isSimulationWithPlasticWeights() { return !sim_with_fixedwts; }
 	bool isSimulationWithSTDP() { return sim_with_stdp; }
 	bool isSimulationWithSTP() { return sim_with_stp; }
+	bool isInTestingMode() { return sim_in_testing; }
 
 /// **************************************************************************************************************** ///
 /// PRIVATE METHODS
@@ -635,7 +720,7 @@ private:
 	void buildNetworkInit();
 
 	//! add the entry that the current neuron has spiked
-	int  addSpikeToTable(int id, int g);
+	void addSpikeToTable(int id, int g);
 
 	void buildGroup(int groupId);
 	void buildNetwork();
@@ -651,18 +736,38 @@ private:
 	void checkSpikeCounterRecordDur();
 
 	void compactConnections(); //!< minimize any other wastage in that array by compacting the store
-	void connectFull(grpConnectInfo_t* info);
-	void connectOneToOne(grpConnectInfo_t* info);
-	void connectRandom(grpConnectInfo_t* info);
-	void connectGaussian(grpConnectInfo_t* info);
+
+	/*!
+	 * \brief generates all synapses of a connection with a built-in topology (random, full, one-to-one, gaussian)
+	 *
+	 * Synapses are first generated per pre-synaptic neuron (in parallel if a ThreadPool exists), each neuron drawing
+	 * from its own counter-based random stream. They are then added to the network serially in the order of
+	 * pre-synaptic neuron IDs, so that the resulting topology depends on the random seed only, not on the number of
+	 * threads.
+	 */
+	void connectPreNeurons(grpConnectInfo_t* info);
+	static void connectPreNeuronsThread(void* snn, int threadId, int numThreads); //!< ThreadPool task
+
+	// the following generate the synapses of a single pre-synaptic neuron preNeurId and append them to syns
+	void connectFull(grpConnectInfo_t* info, int preNeurId, CounterRNG& rng, std::vector<syn_candidate_t>& syns);
+	void connectOneToOne(grpConnectInfo_t* info, int preNeurId, CounterRNG& rng, std::vector<syn_candidate_t>& syns);
+	void connectRandom(grpConnectInfo_t* info, int preNeurId, CounterRNG& rng, std::vector<syn_candidate_t>& syns);
+	void connectGaussian(grpConnectInfo_t* info, int preNeurId, CounterRNG& rng, std::vector<syn_candidate_t>& syns);
 	void connectUserDefined(grpConnectInfo_t* info);
 
 	void deleteObjects();			//!< deallocates all used data structures in snn_cpu.cpp
 
-	void doD1CurrentUpdate();
-	void doD2CurrentUpdate();
+	void doCurrentUpdate(); //!< delivers all spikes of the current time step (2+ms delay, then 1ms delay)
+	static void doCurrentUpdateThread(void* snn, int threadId, int numThreads); //!< ThreadPool task
+	void doD1CurrentUpdate(int threadId, int* daSpikeCnt);
+	void doD2CurrentUpdate(int threadId, int* daSpikeCnt);
+	void deliverSpike(int preId, int tD, int threadId, int* daSpikeCnt); //!< delivers a spike to the synapses of a thread
+	void recordSpikeArrivalTimes(); //!< records the arrival times of this time step's spikes (per-delay arrival times)
 	void doGPUSim();
 	void doSnnSim();
+	void doStep(); //!< simulates one ms, including weight update and end-of-second bookkeeping (CPU and GPU mode)
+	bool isBehindRealTime(); //!< whether the current time step has already missed its deadline (real-time mode)
+	void waitForRealTime(); //!< records the slack or overrun of the current time step and waits for its deadline
 	void globalStateDecay();
 
 	void findFiring();
@@ -672,19 +777,46 @@ private:
 	//! this used to be in updateParameters
 	void findMaxNumSynapses(int* numPostSynapses, int* numPreSynapses);
 
-	void generatePostSpike(unsigned int pre_i, unsigned int idx_d, unsigned int offset, unsigned int tD);
+	//! delivers a spike to a single synapse; dopaminergic spikes are counted per post-synaptic group in daSpikeCnt
+	void generatePostSpike(unsigned int pre_i, unsigned int idx_d, unsigned int offset, unsigned int tD,
+		int replica, int* daSpikeCnt);
 	void generateSpikes();
 	void generateSpikes(int grpId);
 	void generateSpikesFromFuncPtr(int grpId);
 	void generateSpikesFromRate(int grpId);
+	void generateSpikesPerStep(int grpId); //!< draws the Poisson spikes of the current time step (per-step mode)
 
 	//! stops the CPU/GPU timer and retrieves actual execution time for printSimSummary
 	float getActualExecutionTimeMs();
 
 	int getPoissNeuronPos(int nid);
-	float getWeights(int connProp, float initWt, float maxWt, unsigned int nid, int grpId);
+	//! returns the initial weight of a synapse; random weights are drawn from rng
+	float getWeights(int connProp, float initWt, float maxWt, unsigned int nid, int grpId, CounterRNG& rng);
 
 	void globalStateUpdate();
+	void globalStateUpdateNeurons(int lNeurId, int rNeurId); //!< integrates neurons lNeurId..rNeurId by one step
+	static void globalStateUpdateThread(void* snn, int threadId, int numThreads); //!< ThreadPool task
+
+	//! integrates neurons lNeurId..rNeurId of group grpId, specialized for a particular network configuration
+	template<bool COBA, bool NMDA_RISE, bool GABAB_RISE, bool COMPARTMENTS, bool IZH9, bool RK4>
+	void updateNeuronsKernel(int grpId, int lNeurId, int rNeurId);
+	void updateNeuronsSIMD(int grpId, int lNeurId, int rNeurId); //!< neuron update kernel using simdIsa_
+	void initNeuronUpdateKernels(); //!< selects a neuron update kernel for every regular group
+	void initSTDPLookupTables(); //!< samples the STDP curves of all groups at integer spike-time differences
+	double stdpCurve(int g, bool isExc, bool isPlus, int t); //!< evaluates an STDP curve of group g at t ms
+	double stdpLookup(const std::vector<double>& lut, int g, bool isExc, bool isPlus, int t); //!< looks up an STDP table
+	void initThreadSynapseIndex(); //!< sorts the synapses of every neuron by the thread that delivers spikes to them
+	void initPerDelayArrivalTimes(); //!< sorts synaptic delays into pre-synaptic order (per-delay arrival times)
+	void initIncrementalWeightUpdate(); //!< allocates the bookkeeping of setIncrementalWeightUpdate
+
+	//! a piece of dynamic state that is copied byte by byte by takeSnapshot
+	typedef struct {
+		void* ptr;
+		size_t numBytes;
+		uint64_t* version;	//!< version counter of the region (NULL: copied by every snapshot)
+	} state_region_t;
+	void getStateRegions(std::vector<state_region_t>& regions); //!< lists all POD state in a fixed order
+	void addStateRegion(std::vector<state_region_t>& regions, void* ptr, size_t numBytes, uint64_t* version=NULL);
 
 	//! initialize all the synaptic weights to appropriate values.
 	//! total size of the synaptic connection is 'length'
@@ -724,9 +856,10 @@ private:
      * \param[in] currTime       time of current (or "last") spike
      * \param[in] frate          mean firing rate to be achieved (same as \lambda of the exponential distribution)
      * \param[in] refractPeriod  refractory period to be honored (in ms)
+	 * \param[in] rng            random stream to draw the ISIs from
      * \returns next spike time (current time plus generated ISI)
      */
-	unsigned int poissonSpike(unsigned int currTime, float frate, int refractPeriod);
+	unsigned int poissonSpike(unsigned int currTime, float frate, int refractPeriod, CounterRNG& rng);
 
 	// NOTE: all these printer functions should be in printSNNInfo.cpp
 	// FIXME: are any of these actually supposed to be public?? they are not yet in carlsim.h
@@ -756,6 +889,7 @@ private:
 	void resetFiringInformation(); //!< resets the firing information when updateNetwork is called
 	void resetGroups();
 	void resetNeuromodulator(int grpId);
+	void initNeuronParameters(unsigned int nid, int grpId);
 	void resetNeuron(unsigned int nid, int grpId);
 	void resetPointers(bool deallocate=false);
 	void resetPoissonNeuron(unsigned int nid, int grpId);
@@ -793,6 +927,9 @@ private:
 	// float updateTotalCurrent(bool cEval, int cId, int I, int G, float* COUPL_CONSTANTS, int* cNeighbors, int nNeighbors, float const_1, float const_2);
 
 	void updateWeights();
+	void updateSynapticWeight(int g, int i, unsigned int pos, float diff_firing, float homeostasisScale);
+	void catchUpWeight(int g, int i, unsigned int pos); //!< applies pending weight updates (incremental mode)
+	void flushWeightUpdates(); //!< applies all pending weight updates (incremental mode)
 
 
 	// +++++ GPU MODE +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
@@ -918,6 +1055,8 @@ private:
 
 	bool simulatorDeleted;
 	bool spikeRateUpdated;
+	int printFiringRateCnt_;	//!< number of times printFiringRate was called (first call truncates the file)
+	std::vector<float> poissonMaxProb_;	//!< per group: largest firing probability per time step (per-step Poisson)
 
 	float prevCpuExecutionTime;
 	float cpuExecutionTime;
@@ -977,6 +1116,68 @@ private:
 	int simNumStepsPerMs_;	//!< number of integration steps per 1ms simulation time step
 	float timeStep_; //!< the inverse of simNumStepsPerMs_
 
+	int numThreads_;			//!< number of CPU threads used for construction, state update and spike delivery
+	int numReplicas_;			//!< number of copies of every group, laid out replica-major (see setNumReplicas)
+	bool replicasShareSynapses_;	//!< only replica 0 owns synapses, all other replicas use them (batched testing)
+	std::vector<replica_izh_params_t> replicaIzhParams_;	//!< per-replica overrides of the Izhikevich parameters
+	ThreadPool* threadPool_;	//!< thread pool (NULL if single-threaded)
+	AsyncWriter* monWriter_;	//!< writes all monitor files in a background thread (NULL if there are none)
+	std::vector<int> threadDASpikeCnt_;	//!< number of dopaminergic spikes per thread and group (spike delivery)
+	std::vector<unsigned int> threadSynIdx_;	//!< per thread and pre-synaptic neuron: idx_d of the synapses it delivers to
+	std::vector<unsigned int> threadSynStart_;	//!< start of the list of every thread and neuron in threadSynIdx_
+	//! neuron update kernel (an instantiation of updateNeuronsKernel)
+	typedef void (CpuSNN::*neurUpdateKernel_t)(int grpId, int lNeurId, int rNeurId);
+
+	//! the few pieces of group info needed to integrate a regular group, so that the hot loop does not touch grp_Info
+	typedef struct {
+		int grpId;
+		int StartN;
+		int EndN;
+		neurUpdateKernel_t kernel;
+	} neur_update_desc_t;
+	std::vector<neur_update_desc_t> neurUpdateDesc_; //!< one entry per regular group, set by initNeuronUpdateKernels
+	bool stdpPerDelayArrival_;	//!< whether STDP uses spkArrivalTime_ and preSynDelay_ instead of synSpikeTime
+	uint32_t* spkArrivalTime_;	//!< time the last spike of neuron i arrived at its synapses with delay d: [i*maxDelay_+d-1]
+	uint8_t* preSynDelay_;		//!< synaptic delay of every synapse in pre-synaptic order (per-delay arrival times)
+
+	bool wtUpdateIncremental_;	//!< whether updateWeights only visits neurons with modified wtChange
+	uint32_t wtUpdateCnt_;		//!< number of weight updates so far (incremental mode)
+	uint32_t wtUpdateFlushCnt_;	//!< value of wtUpdateCnt_ at the last flushWeightUpdates (incremental mode)
+	uint32_t* synWtUpdateCnt_;	//!< number of weight updates applied to every synapse (incremental mode)
+	uint8_t* wtUpdateDirty_;	//!< whether the wtChange of a neuron got modified since the last weight update
+	std::vector<bool> grpWtUpdateLazy_; //!< whether the weight updates of a group can be deferred
+
+	//! version counters of the synaptic arrays, used by takeSnapshot to share unchanged copies between snapshots
+	//! Whenever an array is modified, its version is set to a new value drawn from stateVersionCnt_.
+	uint64_t stateVersionCnt_;
+	uint64_t wtVersion_;			//!< version of wt, wtChange, maxSynWt, and synWtUpdateCnt_
+	uint64_t synSpikeTimeVersion_;	//!< version of synSpikeTime
+	std::vector<SharedStateCopy*> lastSnapCopies_; //!< weak references to the newest copy of every state region
+
+	bool stepping_;	//!< whether spike generators are set up for stepNetwork (time slice of 1 ms)
+
+	//! real-time mode: time step simTime is due realTimeStartMs_+(simTime-realTimeStartSimTime_) on the wall clock
+	bool realTimeMode_;
+	bool skipMonitorsWhenLate_;		//!< whether to skip ConnectionMonitor snapshots and run summaries when late
+	bool realTimeClockStarted_;		//!< whether realTimeStartMs_ and realTimeStartSimTime_ are valid
+	bool realTimeLastStepLate_;		//!< whether the last time step missed its deadline
+	double realTimeStartMs_;
+	unsigned int realTimeStartSimTime_;
+	double realTimeSumSlackMs_;		//!< sum of the slack of all steps that met their deadline
+	RealTimeStats_t realTimeStats_;
+
+	//! STDP curves sampled at integer spike-time differences (ms), per group: wtChange += lut[tDiff]
+	//! "Plus" tables are used when a post-synaptic spike follows a pre-synaptic one (ALPHA_PLUS, TAU_PLUS), "minus"
+	//! tables in the opposite case. Tables hold at most STDP_LUT_MAX_SIZE entries (see stdpLookup).
+	std::vector<std::vector<double> > stdpLutPlusExc_, stdpLutPlusInh_, stdpLutMinusExc_, stdpLutMinusInh_;
+
+	simdIsa_t simdIsa_;	//!< instruction set of the vectorized neuron update kernels (SIMD_NONE: scalar kernels)
+
+	grpConnectInfo_t* connectInfo_;		//!< connection currently being built by connectPreNeurons
+	std::vector<std::vector<syn_candidate_t> > connectSyns_; //!< generated synapses per pre-neuron of the current chunk
+	int connectChunkStart_;	//!< index of the first pre-neuron (relative to its group) of the current chunk
+	int connectChunkSize_;	//!< number of pre-neurons in the current chunk
+
 	// spiking neural network related information, including neurons, synapses and network parameters
 	int	        	numN;				//!< number of neurons in the spiking neural network
 	int				numPostSynapses_;	//!< maximum number of post-synaptic connections in groups
@@ -1004,7 +1205,7 @@ private:
 	uint32_t    	*lastSpikeTime;	//!< stores the most recent spike time of the neuron
 	float			*wtChange, *wt;	//!< stores the synaptic weight and weight change of a synaptic connection
 	float	 		*maxSynWt;		//!< maximum synaptic weight for given connection..
-	uint32_t    	*synSpikeTime;	//!< stores the spike time of each synapse
+	uint32_t    	*synSpikeTime;	//!< stores the spike time of each synapse (NULL if stdpPerDelayArrival_)
 	unsigned int		postSynCnt; //!< stores the total number of post-synaptic connections in the network
 	unsigned int		preSynCnt; //!< stores the total number of pre-synaptic connections in the network
 	#ifdef NEURON_NOISE
@@ -1037,10 +1238,22 @@ private:
 	unsigned int	preConnCnt;
 
 	//! firing info
-	unsigned int		*timeTableD2;
-	unsigned int		*timeTableD1;
-	unsigned int		*firingTableD2;
-	unsigned int		*firingTableD1;
+	unsigned int		*timeTableD2;	//!< GPU mode only
+	unsigned int		*timeTableD1;	//!< GPU mode only
+	unsigned int		*firingTableD2;	//!< GPU mode only
+	unsigned int		*firingTableD1;	//!< GPU mode only
+
+	//! spikes emitted within one millisecond (CPU mode)
+	typedef struct spike_slot_s {
+		std::vector<int> nidD1;	//!< neurons whose outgoing synapses all have a delay of 1 ms
+		std::vector<int> nidD2;	//!< all other neurons
+	} spike_slot_t;
+	std::vector<spike_slot_t> spikeRing_;	//!< spikes of the last maxDelay_ ms (CPU mode), see SPIKE_RING_POS
+	unsigned int spikeRingMaxSpikes_;		//!< high-water mark: largest number of spikes emitted within one ms
+	//! neurons with 1ms (D1) and 2+ms (D2) delays that fired in the current second, if there are spike monitors
+	std::vector<unsigned int> firingLogD1_, firingLogD2_;
+	//! firing log index of the first spike in every ms of the second
+	std::vector<unsigned int> firingLogTimeD1_, firingLogTimeD2_;
 	unsigned int		maxSpikesD1;
 	unsigned int		maxSpikesD2;
 
@@ -1085,6 +1298,16 @@ private:
 	// \FIXME \DEPRECATED this one moved to group-based
 	int64_t    simTimeLastUpdSpkMon_; //!< last time we ran updateSpikeMonitor
 
+	//! what updateSpikeMonitor does with the spikes of a group
+	struct spkmon_dispatch_t {
+		int msMin;					//!< first ms of the current second to copy (1000 if there is nothing to do)
+		SpikeMonitorCore* mon;
+		int fileId;					//!< ID of the spike file in monWriter_, or -1
+		bool toArray;				//!< whether to push the spikes into the spike vector of the monitor
+		bool toStats;				//!< whether to push the spikes into the spike statistics of the monitor
+	};
+	std::vector<spkmon_dispatch_t> spkMonDispatch_; //!< per group, rebuilt by every updateSpikeMonitor
+
 
 
 	unsigned int	numSpikeGenGrps;
@@ -139,6 +139,20 @@ typedef struct connectData_s {
 	struct connectData_s*    next;
 } grpConnectInfo_t;
 
+//! a synapse generated for a single pre-synaptic neuron during parallel network construction
+typedef struct {
+	int		postId;
+	float	weight;
+	uint8_t	delay;
+} syn_candidate_t;
+
+//! Izhikevich parameters that replace the group's mean parameters in a single replica (see CpuSNN::setNumReplicas)
+typedef struct {
+	int		grpId;
+	int		replica;
+	float	Izh_a, Izh_b, Izh_c, Izh_d;
+} replica_izh_params_t;
+
 typedef struct compConnectData_s {
 	int							grpSrc, grpDest;
 	struct compConnectData_s*   next;
@@ -262,6 +276,7 @@ typedef struct group_info_s {
 	int			SpikeMonitorId;		//!< spike monitor id
 	int			GroupMonitorId; //!< group monitor id
 	float   	RefractPeriod;
+	bool		PoissonPerStep;	//!< whether Poisson spikes are drawn every time step instead of once per time slice
 	int			CurrTimeSlice; //!< timeSlice is used by the Poisson generators in order to note generate too many or too few spikes within a window of time
 	int			NewTimeSlice;
 	uint32_t 	SliceUpdateTime;
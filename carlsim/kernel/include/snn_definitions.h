@@ -105,6 +105,10 @@ inline bool isInhibitoryNeuron (unsigned int& nid, unsigned int& numNInhPois, un
 // at t) and x^- (right before the spike, so at t-1).
 #define STP_BUF_POS(nid,t) ( nid*(maxDelay_+1) + ((t)%(maxDelay_+1)) )
 
+// slot of the spike ring (CPU mode) that holds the spikes emitted tD ms ago (0 <= tD < maxDelay_)
+// Spikes emitted maxDelay_ ms ago have reached all their targets, so their slot is reused for the current time step.
+#define SPIKE_RING_POS(tD) ( (simTime + maxDelay_ - (tD)) % maxDelay_ )
+
 
 // use these macros for logging / error printing
 // every message will be printed to one of fpOut_, fpErr_, fpDeb_ depending on the nature of the message
@@ -141,13 +145,29 @@ inline bool isInhibitoryNeuron (unsigned int& nid, unsigned int& numNInhPois, un
 #define STDP(t,a,b)       ((a)*exp(-(t)*(b))) // consider to use __expf(), which is accelerated by GPU hardware
 
 #define PROPAGATED_BUFFER_SIZE  (1023)
+#define CONNECT_CHUNK_SIZE      (256)	// number of pre-synaptic neurons per thread and chunk in connectPreNeurons
+#define STDP_LUT_MAX_SIZE       (1024)	// max number of entries (ms) per STDP lookup table, see initSTDPLookupTables
 #define MAX_SIMULATION_TIME     ((uint32_t)(0x7fffffff))
 #define LARGE_NEGATIVE_VALUE    (-(1 << 30))
 
+// counter-based random streams are identified by a 64-bit ID: the upper 16 bits denote what the stream is used for,
+// the lower 48 bits are free to use (e.g., connection ID and pre-synaptic neuron)
+#define RNG_STREAM_CONNECT      (1)
+#define RNG_STREAM_RESET_WEIGHTS (2)
+#define RNG_STREAM_POISSON      (3)	// per-step Poisson spikes, keyed by group and time step
+#define RNG_STREAM_POISSON_ISI  (4)	// Poisson inter-spike intervals, keyed by group and start of the time slice
+#define RNG_STREAM_NEURON_PARAMS (5)	// random neuron parameters and homeostatic base firing, keyed by neuron
+#define RNG_STREAM_ID(domain, hi, lo) ( ((uint64_t)(domain) << 48) | ((uint64_t)((hi) & 0xffff) << 32) | (uint64_t)(uint32_t)(lo) )
+
 
 #define MAX_SPIKE_MON_BUFFER_SIZE 52428800 // about 50 MB. size is in bytes. Max size of reduced AER vector in spikeMonitorCore objects.
 #define LONG_SPIKE_MON_DURATION 600000 // about 10 minutes
 #define LARGE_SPIKE_MON_GRP_SIZE 5000 // about 10 minutes
+#define SPK_MON_BLOCK_DURATION 1000 // ms of spikes per block of a SpikeMonitor, see SpikeBlockStore
+#define SPK_MON_STATS_BIN_SIZE 100 // default bin size (ms) of a SpikeMonitor in STATS mode
+
+#define MON_WRITER_CHUNK_SIZE (262144) // bytes per monitor file that are collected before they are written, see AsyncWriter
+#define MON_WRITER_MAX_QUEUED (67108864) // about 64 MB. max number of bytes of monitor files waiting to be written
 
 // This flag is used when having a common poisson generator for both CPU and GPU simulation
 // We basically use the CPU poisson generator. Evaluate if there is any firing due to the
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <vector>					// std::vector
+
+#if !defined(WIN32) && !defined(WIN64)
+#include <pthread.h>				// pthread_t, pthread_mutex_t, pthread_cond_t
+#endif
+
+/*!
+ * \brief A small fork-join thread pool used by the CPU kernel
+ *
+ * The pool owns numThreads-1 worker threads that sleep until ThreadPool::run is called. The calling thread
+ * participates as thread 0, so a pool with a single thread does not spawn any workers at all.
+ * ThreadPool::run blocks until every thread has finished its share of the work, which makes it a barrier: all
+ * writes performed by the task are visible to the caller once run returns.
+ *
+ * The pool keeps track of the wall-clock time every thread spends inside a task, which can be used to check how
+ * well the work is balanced across threads.
+ *
+ * \note On Windows the pool currently executes all thread shares sequentially in the calling thread.
+ */
+class ThreadPool {
+public:
+	//! a task is called once per thread with the ID of the executing thread (0..numThreads-1)
+	//! Tasks must not report errors through KERNEL_ERROR or exitSimulation, which are not safe to call from a worker
+	//! thread: everything that might fail has to be checked before run is called.
+	typedef void (*task_t)(void* arg, int threadId, int numThreads);
+
+	//! constructor, spawns numThreads-1 worker threads
+	explicit ThreadPool(int numThreads);
+
+	//! destructor, joins all worker threads
+	~ThreadPool();
+
+	//! returns the number of threads (including the calling thread)
+	int getNumThreads() { return numThreads_; }
+
+	//! returns the accumulated time (ms) a thread has spent executing tasks
+	double getThreadTimeMs(int threadId);
+
+	//! resets the accumulated per-thread execution times
+	void resetThreadTimes();
+
+	//! executes task(arg, threadId, numThreads) on all threads and returns once all of them are done
+	void run(task_t task, void* arg);
+
+private:
+	//! executes a task for a single thread and accumulates its execution time
+	void execute(int threadId);
+
+	int numThreads_;					//!< number of threads, including the calling thread
+	task_t task_;						//!< the task currently being executed
+	void* taskArg_;						//!< the argument passed to task_
+	std::vector<double> threadTimeMs_;	//!< accumulated execution time per thread (ms)
+
+#if !defined(WIN32) && !defined(WIN64)
+	//! entry point of all worker threads
+	static void* workerMain(void* arg);
+
+	//! thread argument passed to workerMain
+	struct worker_arg_t {
+		ThreadPool* pool;
+		int threadId;
+	};
+
+	std::vector<pthread_t> workers_;	//!< worker thread handles (threads 1..numThreads-1)
+	std::vector<worker_arg_t> workerArgs_;
+	pthread_mutex_t mutex_;
+	pthread_cond_t wakeCond_;			//!< signals workers that a new task is available
+	pthread_cond_t doneCond_;			//!< signals the caller that all workers are done
+	unsigned long generation_;			//!< incremented with every call to run
+	int numBusy_;						//!< number of workers still executing the current task
+	bool shutdown_;						//!< set by the destructor to terminate all workers
+#endif
+};
+
+#endif
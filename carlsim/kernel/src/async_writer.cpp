@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#include <async_writer.h>
+
+#include <assert.h>
+
+AsyncWriter::AsyncWriter(size_t chunkBytes, size_t maxQueuedBytes) {
+	assert(chunkBytes > 0);
+	assert(maxQueuedBytes >= chunkBytes);
+	chunkBytes_ = chunkBytes;
+	maxQueuedBytes_ = maxQueuedBytes;
+	numStalls_ = 0;
+	writeError_ = false;
+
+#if !defined(WIN32) && !defined(WIN64)
+	queuedBytes_ = 0;
+	numBusy_ = 0;
+	shutdown_ = false;
+	pthread_mutex_init(&mutex_, NULL);
+	pthread_cond_init(&workCond_, NULL);
+	pthread_cond_init(&doneCond_, NULL);
+	pthread_create(&thread_, NULL, &AsyncWriter::writerMain, this);
+#endif
+}
+
+AsyncWriter::~AsyncWriter() {
+	for (unsigned int i=0; i<files_.size(); i++) {
+		if (files_[i].fp != NULL)
+			closeFile(i);
+	}
+
+#if !defined(WIN32) && !defined(WIN64)
+	// the background thread empties the queue before it terminates
+	pthread_mutex_lock(&mutex_);
+	shutdown_ = true;
+	pthread_cond_signal(&workCond_);
+	pthread_mutex_unlock(&mutex_);
+	pthread_join(thread_, NULL);
+
+	pthread_cond_destroy(&doneCond_);
+	pthread_cond_destroy(&workCond_);
+	pthread_mutex_destroy(&mutex_);
+#endif
+}
+
+int AsyncWriter::addFile(FILE* fp) {
+	assert(fp != NULL);
+	files_.push_back(file_t());
+	files_.back().fp = fp;
+	files_.back().needsFlush = false;
+	files_.back().buf.reserve(chunkBytes_);
+	return files_.size()-1;
+}
+
+void AsyncWriter::submit(int fileId) {
+	assert(fileId>=0 && fileId<files_.size() && files_[fileId].fp!=NULL);
+	if (!files_[fileId].buf.empty() || files_[fileId].needsFlush)
+		enqueue(fileId, true, false);
+}
+
+void AsyncWriter::closeFile(int fileId) {
+	assert(fileId>=0 && fileId<files_.size() && files_[fileId].fp!=NULL);
+	enqueue(fileId, false, true);
+	files_[fileId].fp = NULL;
+	std::vector<char>().swap(files_[fileId].buf);
+}
+
+void AsyncWriter::waitUntilWritten() {
+#if !defined(WIN32) && !defined(WIN64)
+	pthread_mutex_lock(&mutex_);
+	while (numBusy_ > 0) {
+		pthread_cond_wait(&doneCond_, &mutex_);
+	}
+	pthread_mutex_unlock(&mutex_);
+#endif
+}
+
+bool AsyncWriter::checkAndClearWriteError() {
+#if !defined(WIN32) && !defined(WIN64)
+	pthread_mutex_lock(&mutex_);
+#endif
+	bool hadError = writeError_;
+	writeError_ = false;
+#if !defined(WIN32) && !defined(WIN64)
+	pthread_mutex_unlock(&mutex_);
+#endif
+	return hadError;
+}
+
+void AsyncWriter::enqueue(int fileId, bool flush, bool close) {
+	file_t& file = files_[fileId];
+	file.needsFlush = !flush && !close;
+
+#if defined(WIN32) || defined(WIN64)
+	job_t job;
+	job.fp = file.fp;
+	job.flush = flush;
+	job.close = close;
+	job.data.swap(file.buf);
+	if (!write(job))
+		writeError_ = true;
+	job.data.clear();
+	file.buf.swap(job.data);
+#else
+	size_t numBytes = file.buf.size();
+
+	pthread_mutex_lock(&mutex_);
+	// backpressure: wait until there is room in the queue (a single large buffer may go into an empty queue)
+	if (queuedBytes_ > 0 && queuedBytes_+numBytes > maxQueuedBytes_) {
+		numStalls_++;
+		while (queuedBytes_ > 0 && queuedBytes_+numBytes > maxQueuedBytes_) {
+			pthread_cond_wait(&doneCond_, &mutex_);
+		}
+	}
+
+	queue_.push_back(job_t());
+	job_t& job = queue_.back();
+	job.fp = file.fp;
+	job.flush = flush;
+	job.close = close;
+	job.data.swap(file.buf);
+	queuedBytes_ += numBytes;
+	numBusy_++;
+
+	// the next append buffer is a recycled one, if possible
+	if (!close && !freeBufs_.empty()) {
+		file.buf.swap(freeBufs_.back());
+		freeBufs_.pop_back();
+	}
+
+	pthread_cond_signal(&workCond_);
+	pthread_mutex_unlock(&mutex_);
+#endif
+}
+
+bool AsyncWriter::write(job_t& job) {
+	bool success = true;
+	if (!job.data.empty())
+		success = fwrite(&job.data[0], 1, job.data.size(), job.fp) == job.data.size();
+
+	if (job.close)
+		fclose(job.fp);
+	else if (job.flush)
+		fflush(job.fp);
+
+	return success;
+}
+
+#if !defined(WIN32) && !defined(WIN64)
+void* AsyncWriter::writerMain(void* arg) {
+	AsyncWriter* writer = (AsyncWriter*)arg;
+
+	pthread_mutex_lock(&writer->mutex_);
+	while (true) {
+		while (!writer->shutdown_ && writer->queue_.empty()) {
+			pthread_cond_wait(&writer->workCond_, &writer->mutex_);
+		}
+		if (writer->queue_.empty())
+			break; // shutdown, and everything has been written
+
+		job_t job;
+		job.fp = writer->queue_.front().fp;
+		job.flush = writer->queue_.front().flush;
+		job.close = writer->queue_.front().close;
+		job.data.swap(writer->queue_.front().data);
+		writer->queue_.pop_front();
+		pthread_mutex_unlock(&writer->mutex_);
+
+		bool success = writer->write(job);
+
+		pthread_mutex_lock(&writer->mutex_);
+		if (!success)
+			writer->writeError_ = true;
+		writer->queuedBytes_ -= job.data.size();
+		writer->numBusy_--;
+
+		// keep the buffer for reuse
+		job.data.clear();
+		writer->freeBufs_.push_back(std::vector<char>());
+		writer->freeBufs_.back().swap(job.data);
+
+		pthread_cond_broadcast(&writer->doneCond_);
+	}
+	pthread_mutex_unlock(&writer->mutex_);
+
+	return NULL;
+}
+#endif
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#include <izhikevich_simd.h>
+
+#include <cassert>
+#include <cstddef>			// NULL
+
+// The vectorized kernels rely on GCC's vector extensions and "#pragma GCC target", which allow us to compile code
+// for several instruction sets into the same binary without any special compiler flags. Contraction of multiplies
+// and adds into FMA instructions is turned off, so that without -ffast-math all instruction sets produce the same
+// results as the scalar code, bit for bit. With -ffast-math (release builds) the compiler is free to reorder the
+// scalar and the vector code differently, so spike times may drift apart over time in COBA mode.
+// On other compilers and architectures, getBestSimdIsa reports SIMD_NONE and CpuSNN uses its scalar kernels.
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#define IZH_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#ifdef IZH_SIMD_X86
+
+#pragma GCC push_options
+#pragma GCC target("sse4.2")
+#pragma GCC optimize("fp-contract=off")
+namespace izh_sse42 {
+	struct Vec {
+		typedef __m128 type;
+		typedef __m128 mask;
+		enum { width = 4 };
+		static inline type load(const float* ptr) { return _mm_loadu_ps(ptr); }
+		static inline void store(float* ptr, type v) { _mm_storeu_ps(ptr, v); }
+		static inline type set1(float x) { return _mm_set1_ps(x); }
+		static inline mask gt(type a, type b) { return _mm_cmpgt_ps(a, b); }
+		static inline mask lt(type a, type b) { return _mm_cmplt_ps(a, b); }
+		static inline type select(mask m, type a, type b) { return _mm_blendv_ps(b, a, m); }
+		static inline int bits(mask m) { return _mm_movemask_ps(m); }
+	};
+	#include <izhikevich_simd_kernel.h>
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("fp-contract=off")
+namespace izh_avx2 {
+	struct Vec {
+		typedef __m256 type;
+		typedef __m256 mask;
+		enum { width = 8 };
+		static inline type load(const float* ptr) { return _mm256_loadu_ps(ptr); }
+		static inline void store(float* ptr, type v) { _mm256_storeu_ps(ptr, v); }
+		static inline type set1(float x) { return _mm256_set1_ps(x); }
+		static inline mask gt(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+		static inline mask lt(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static inline type select(mask m, type a, type b) { return _mm256_blendv_ps(b, a, m); }
+		static inline int bits(mask m) { return _mm256_movemask_ps(m); }
+	};
+	#include <izhikevich_simd_kernel.h>
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+namespace izh_avx512 {
+	struct Vec {
+		typedef __m512 type;
+		typedef __mmask16 mask;
+		enum { width = 16 };
+		static inline type load(const float* ptr) { return _mm512_loadu_ps(ptr); }
+		static inline void store(float* ptr, type v) { _mm512_storeu_ps(ptr, v); }
+		static inline type set1(float x) { return _mm512_set1_ps(x); }
+		static inline mask gt(type a, type b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+		static inline mask lt(type a, type b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+		static inline type select(mask m, type a, type b) { return _mm512_mask_blend_ps(m, b, a); }
+		static inline int bits(mask m) { return (int)m; }
+	};
+	#include <izhikevich_simd_kernel.h>
+}
+#pragma GCC pop_options
+
+#endif // IZH_SIMD_X86
+
+bool isSimdIsaSupported(simdIsa_t isa) {
+	switch (isa) {
+		case SIMD_NONE:
+			return true;
+#ifdef IZH_SIMD_X86
+		case SIMD_SSE42:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("sse4.2");
+		case SIMD_AVX2:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+		case SIMD_AVX512:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx512f");
+#endif
+		default:
+			return false;
+	}
+}
+
+simdIsa_t getBestSimdIsa() {
+	if (isSimdIsaSupported(SIMD_AVX512))
+		return SIMD_AVX512;
+	if (isSimdIsaSupported(SIMD_AVX2))
+		return SIMD_AVX2;
+	if (isSimdIsaSupported(SIMD_SSE42))
+		return SIMD_SSE42;
+	return SIMD_NONE;
+}
+
+void updateIzhikevichSIMD(simdIsa_t isa, const izh_kernel_args_t& args, int lNeurId, int rNeurId) {
+	switch (isa) {
+#ifdef IZH_SIMD_X86
+		case SIMD_SSE42:
+			izh_sse42::updateNeurons(args, lNeurId, rNeurId);
+			break;
+		case SIMD_AVX2:
+			izh_avx2::updateNeurons(args, lNeurId, rNeurId);
+			break;
+		case SIMD_AVX512:
+			izh_avx512::updateNeurons(args, lNeurId, rNeurId);
+			break;
+#endif
+		default:
+			// CpuSNN never selects a SIMD kernel without a supported instruction set
+			assert(false);
+	}
+}
@@ -321,7 +321,6 @@ void CpuSNN::printGroupInfo2(FILE* const fpg)
 
 void CpuSNN::printFiringRate(char *fname)
 {
-  static int printCnt = 0;
   FILE *fpg;
   std::string strFname;
   if (fname == NULL)
@@ -330,13 +329,13 @@ void CpuSNN::printFiringRate(char *fname)
 	strFname = fname;
 
   strFname += ".stat";
-  if(printCnt==0)
+  if(printFiringRateCnt_==0)
 	fpg = fopen(strFname.c_str(), "w");
   else
 	fpg = fopen(strFname.c_str(), "a");
 
   fprintf(fpg, "#Average Firing Rate\n");
-  if(printCnt==0) {
+  if(printFiringRateCnt_==0) {
 	fprintf(fpg, "#network %s: size = %d\n", networkName_.c_str(), numN);
 	for(int grpId=0; grpId < numGrp; grpId++) {
 	  fprintf(fpg, "#group %d: name %s : size = %d\n", grpId, grp_Info2[grpId].Name.c_str(), grp_Info[grpId].SizeN);
@@ -357,7 +356,7 @@ void CpuSNN::printFiringRate(char *fname)
 	}
 	fprintf(fpg, " activeNeurons = %3.3f : avgFiring = %3.3f  \n", activeCnt*1.0/grp_Info[grpId].SizeN, (activeCnt==0)?0.0:totSpike*1.0/activeCnt);
   }
-  printCnt++;
+  printFiringRateCnt_++;
   fflush(fpg);
   fclose(fpg);
 }
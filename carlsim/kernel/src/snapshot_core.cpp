@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#include <snapshot_core.h>
+
+#include <string.h>		// memcpy
+
+SharedStateCopy::SharedStateCopy(const void* src, size_t numBytes, uint64_t version)
+	: data_(numBytes), version_(version), numRefs_(1), weakRef_(NULL)
+{
+	if (numBytes > 0)
+		memcpy(&data_[0], src, numBytes);
+}
+
+SnapshotCore::SnapshotCore(const CpuSNN* snn) : snn(snn), simTime(0), pbuf(NULL) {}
+
+SnapshotCore::~SnapshotCore() {
+	for (unsigned int i=0; i<sharedRegions.size(); i++)
+		sharedRegions[i]->release();
+	delete pbuf;
+}
+
+size_t SnapshotCore::getMemoryUsage() {
+	size_t numBytes = regions.size();
+	for (unsigned int i=0; i<sharedRegions.size(); i++)
+		if (sharedRegions[i]->getNumRefs() == 1)
+			numBytes += sharedRegions[i]->getNumBytes();
+
+	for (unsigned int i=0; i<spikeRingD1.size(); i++)
+		numBytes += (spikeRingD1[i].size() + spikeRingD2[i].size()) * sizeof(int);
+	numBytes += (firingLogD1.size() + firingLogD2.size() + firingLogTimeD1.size() + firingLogTimeD2.size())
+		* sizeof(unsigned int);
+	return numBytes;
+}
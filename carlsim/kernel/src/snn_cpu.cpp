@@ -43,12 +43,14 @@
 	#include <Windows.h>
 #else
 	#include <sys/stat.h>		// mkdir
+	#include <pthread.h>		// pthread_mutex_t
+	#include <time.h>			// clock_gettime, nanosleep
 #endif
 
 #include <math.h> 		// fabs
 #include <string.h> 	// std::string, memset
-#include <stdlib.h> 	// abs, drand48
-#include <algorithm> 	// std::min, std::max
+#include <stdlib.h> 	// abs
+#include <algorithm> 	// std::min, std::max, std::sort
 #include <limits.h> 	// UINT_MAX
 
 #include <connection_monitor.h>
@@ -68,6 +70,113 @@
 #define SETPRE_INFO(name, nid, sid, val)  name[cumulativePre[nid]+sid]=val;
 
 
+// All CpuSNN instances of a process share a single stream to the log file "results/carlsim.log": the file is
+// opened by the first instance and closed when the last instance releases it. This way, instances that run
+// concurrently (in different threads) do not truncate or overwrite each other's log messages. Writing to the same
+// FILE* from several threads is safe, because every fprintf locks the stream.
+static FILE* sharedLogFp = NULL;
+static int sharedLogRefCnt = 0;
+#if defined(WIN32) || defined(WIN64)
+static HANDLE sharedLogLock = CreateMutex(NULL, FALSE, NULL);
+#else
+static pthread_mutex_t sharedLogLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// creates the results directory if necessary and returns the shared log stream (NULL on failure)
+static FILE* acquireSharedLog(bool* createdDir) {
+	*createdDir = false;
+#if defined(WIN32) || defined(WIN64)
+	WaitForSingleObject(sharedLogLock, INFINITE);
+#else
+	pthread_mutex_lock(&sharedLogLock);
+#endif
+
+	if (sharedLogFp == NULL) {
+		#if defined(WIN32) || defined(WIN64)
+			CreateDirectory("results", NULL);
+			sharedLogFp = fopen("results/carlsim.log", "w");
+		#else
+			struct stat sb;
+			if (stat("results", &sb) == -1 || !S_ISDIR(sb.st_mode)) {
+				// results dir does not exist, try to create (if this fails, so will fopen)
+				*createdDir = (mkdir("results", 0777) == 0);
+			}
+			sharedLogFp = fopen("results/carlsim.log","w");
+		#endif
+	}
+	if (sharedLogFp != NULL)
+		sharedLogRefCnt++;
+	FILE* fp = sharedLogFp;
+
+#if defined(WIN32) || defined(WIN64)
+	ReleaseMutex(sharedLogLock);
+#else
+	pthread_mutex_unlock(&sharedLogLock);
+#endif
+	return fp;
+}
+
+// closes a log stream (unless it belongs to the user); the shared log stream is only closed once no other instance
+// is using it
+static void releaseLog(FILE* fp, bool isUserFp) {
+	if (fp == NULL || fp == stdout || fp == stderr)
+		return;
+
+#if defined(WIN32) || defined(WIN64)
+	WaitForSingleObject(sharedLogLock, INFINITE);
+#else
+	pthread_mutex_lock(&sharedLogLock);
+#endif
+
+	if (fp != sharedLogFp) {
+		if (!isUserFp)
+			fclose(fp);
+	} else if (--sharedLogRefCnt == 0) {
+		fclose(sharedLogFp);
+		sharedLogFp = NULL;
+	}
+
+#if defined(WIN32) || defined(WIN64)
+	ReleaseMutex(sharedLogLock);
+#else
+	pthread_mutex_unlock(&sharedLogLock);
+#endif
+}
+
+// returns the time in ms from a high-resolution monotonic clock (unaffected by changes to the system time)
+static double getWallTimeMs() {
+#if defined(WIN32) || defined(WIN64)
+	LARGE_INTEGER freq, cnt;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&cnt);
+	return cnt.QuadPart*1000.0/freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec*1000.0 + ts.tv_nsec/1000000.0;
+#endif
+}
+
+// waits until the monotonic clock reaches untilMs
+// Sleeping can overshoot by tens of us, so we sleep for all but the last 0.1 ms and then spin. On Windows, where
+// sleeps have a granularity of 1 ms or worse, we only yield the processor.
+static void waitUntilWallTimeMs(double untilMs) {
+	double nowMs;
+	while ((nowMs=getWallTimeMs()) < untilMs) {
+#if defined(WIN32) || defined(WIN64)
+		Sleep(0);
+#else
+		if (untilMs-nowMs > 0.2) {
+			struct timespec ts;
+			ts.tv_sec = 0;
+			ts.tv_nsec = (long)((untilMs-nowMs-0.1)*1000000.0);
+			nanosleep(&ts, NULL);
+		}
+#endif
+	}
+}
+
+
 
 /// **************************************************************************************************************** ///
 /// CONSTRUCTOR / DESTRUCTOR
@@ -146,20 +255,20 @@ short int CpuSNN::connect(int grpId1, int grpId2, const std::string& _type, floa
 
 	if ( _type.find("random") != std::string::npos) {
 		newInfo->type 	= CONN_RANDOM;
-		newInfo->numPostSynapses = (std::min)(grp_Info[grpId2].SizeN,((int) (prob*grp_Info[grpId2].SizeN +6.5*sqrt(prob*(1-prob)*grp_Info[grpId2].SizeN)+0.5))); // estimate the maximum number of connections we need.  This uses a binomial distribution at 6.5 stds.
-		newInfo->numPreSynapses = (std::min)(grp_Info[grpId1].SizeN,((int) (prob*grp_Info[grpId1].SizeN +6.5*sqrt(prob*(1-prob)*grp_Info[grpId1].SizeN)+0.5))); // estimate the maximum number of connections we need.  This uses a binomial distribution at 6.5 stds.
+		newInfo->numPostSynapses = (std::min)(getGroupReplicaNumNeurons(grpId2),((int) (prob*getGroupReplicaNumNeurons(grpId2) +6.5*sqrt(prob*(1-prob)*getGroupReplicaNumNeurons(grpId2))+0.5))); // estimate the maximum number of connections we need.  This uses a binomial distribution at 6.5 stds.
+		newInfo->numPreSynapses = (std::min)(getGroupReplicaNumNeurons(grpId1),((int) (prob*getGroupReplicaNumNeurons(grpId1) +6.5*sqrt(prob*(1-prob)*getGroupReplicaNumNeurons(grpId1))+0.5))); // estimate the maximum number of connections we need.  This uses a binomial distribution at 6.5 stds.
 	}
 	//so you're setting the size to be prob*Number of synapses in group info + some standard deviation ...
 	else if ( _type.find("full-no-direct") != std::string::npos) {
 		newInfo->type 	= CONN_FULL_NO_DIRECT;
-		newInfo->numPostSynapses = grp_Info[grpId2].SizeN-1;
-		newInfo->numPreSynapses	= grp_Info[grpId1].SizeN-1;
+		newInfo->numPostSynapses = getGroupReplicaNumNeurons(grpId2)-1;
+		newInfo->numPreSynapses	= getGroupReplicaNumNeurons(grpId1)-1;
 	}
 	else if ( _type.find("full") != std::string::npos) {
 		newInfo->type 	= CONN_FULL;
 
-		newInfo->numPostSynapses = grp_Info[grpId2].SizeN;
-		newInfo->numPreSynapses = grp_Info[grpId1].SizeN;
+		newInfo->numPostSynapses = getGroupReplicaNumNeurons(grpId2);
+		newInfo->numPreSynapses = getGroupReplicaNumNeurons(grpId1);
 	}
 	else if ( _type.find("one-to-one") != std::string::npos) {
 		newInfo->type 	= CONN_ONE_TO_ONE;
@@ -168,8 +277,8 @@ short int CpuSNN::connect(int grpId1, int grpId2, const std::string& _type, floa
 	} else if ( _type.find("gaussian") != std::string::npos) {
 		newInfo->type   = CONN_GAUSSIAN;
 		// the following is antiquated, just assume the worst case for now
-		newInfo->numPostSynapses = grp_Info[grpId2].SizeN;
-		newInfo->numPreSynapses = grp_Info[grpId1].SizeN;
+		newInfo->numPostSynapses = getGroupReplicaNumNeurons(grpId2);
+		newInfo->numPreSynapses = getGroupReplicaNumNeurons(grpId1);
 	} else {
 		KERNEL_ERROR("Invalid connection type (should be 'random', 'full', 'one-to-one', 'full-no-direct', or 'gaussian')");
 		exitSimulation(-1);
@@ -217,8 +326,8 @@ short int CpuSNN::connect(int grpId1, int grpId2, ConnectionGeneratorCore* conn,
 	newInfo->mulSynSlow = _mulSynSlow;
 	newInfo->connProp = SET_CONN_PRESENT(1) | SET_FIXED_PLASTIC(synWtType);
 	newInfo->type	  = CONN_USER_DEFINED;
-	newInfo->numPostSynapses = grp_Info[grpId2].SizeN;
-	newInfo->numPreSynapses = grp_Info[grpId1].SizeN;
+	newInfo->numPostSynapses = getGroupReplicaNumNeurons(grpId2);
+	newInfo->numPreSynapses = getGroupReplicaNumNeurons(grpId1);
 	newInfo->conn	= conn;
 	newInfo->ConnectionMonitorId = -1;
 
@@ -282,7 +391,8 @@ int CpuSNN::createGroup(const std::string& grpName, const Grid3D& grid, int neur
 	grp_Info[numGrp].withCompartments = 0;//All groups are non-compartmental by default
 
 	// We don't store the Grid3D struct in grp_Info so we don't have to deal with allocating structs on the GPU
-	grp_Info[numGrp].SizeN  			= grid.x * grid.y * grid.z; // number of neurons in the group
+	int nNeur = grid.N*numReplicas_;	// every replica holds a full copy of the Grid3D
+	grp_Info[numGrp].SizeN  			= nNeur; // number of neurons in the group
 	grp_Info[numGrp].SizeX              = grid.x; // number of neurons in first dim of Grid3D
 	grp_Info[numGrp].SizeY              = grid.y; // number of neurons in second dim of Grid3D
 	grp_Info[numGrp].SizeZ              = grid.z; // number of neurons in third dim of Grid3D
@@ -315,11 +425,11 @@ int CpuSNN::createGroup(const std::string& grpName, const Grid3D& grid, int neur
 
 	// update number of neuron counters
 	if ( (neurType&TARGET_GABAa) || (neurType&TARGET_GABAb))
-		numNInhReg += grid.N; // regular inhibitory neuron
+		numNInhReg += nNeur; // regular inhibitory neuron
 	else
-		numNExcReg += grid.N; // regular excitatory neuron
-	numNReg += grid.N;
-	numN += grid.N;
+		numNExcReg += nNeur; // regular excitatory neuron
+	numNReg += nNeur;
+	numN += nNeur;
 
 	numGrp++;
 	return (numGrp-1);
@@ -331,7 +441,8 @@ int CpuSNN::createSpikeGeneratorGroup(const std::string& grpName, const Grid3D&
 	assert(grid.x*grid.y*grid.z>0);
 	assert(neurType>=0);
 	grp_Info[numGrp].withCompartments = 0;//All groups are non-compartmental by default  FIXME:IS THIS NECESSARY?
-	grp_Info[numGrp].SizeN   		= grid.x * grid.y * grid.z; // number of neurons in the group
+	int nNeur = grid.N*numReplicas_;	// every replica holds a full copy of the Grid3D
+	grp_Info[numGrp].SizeN   		= nNeur; // number of neurons in the group
 	grp_Info[numGrp].SizeX          = grid.x; // number of neurons in first dim of Grid3D
 	grp_Info[numGrp].SizeY          = grid.y; // number of neurons in second dim of Grid3D
 	grp_Info[numGrp].SizeZ          = grid.z; // number of neurons in third dim of Grid3D
@@ -348,11 +459,11 @@ int CpuSNN::createSpikeGeneratorGroup(const std::string& grpName, const Grid3D&
 	grp_Info2[numGrp].Name          = grpName;
 
 	if ( (neurType&TARGET_GABAa) || (neurType&TARGET_GABAb))
-		numNInhPois += grid.N; // inh poisson group
+		numNInhPois += nNeur; // inh poisson group
 	else
-		numNExcPois += grid.N; // exc poisson group
-	numNPois += grid.N;
-	numN += grid.N;
+		numNExcPois += nNeur; // exc poisson group
+	numNPois += nNeur;
+	numN += nNeur;
 
 	numGrp++;
 	numSpikeGenGrps++;
@@ -475,6 +586,70 @@ void CpuSNN::setIntegrationMethod(integrationMethod_t method, int numStepsPerMs)
 	timeStep_ = 1.0f / simNumStepsPerMs_;
 }
 
+// set number of CPU threads used to simulate the network
+void CpuSNN::setNumThreads(int numThreads) {
+	assert(numThreads >= 1 && numThreads <= MAX_NUM_CPU_THREADS);
+	assert(threadPool_ == NULL);
+	numThreads_ = numThreads;
+}
+
+// simulate several copies of the network that share one topology
+// Every group holds numReplicas blocks of neurons (replica-major), so that the neuron state of all replicas is
+// updated in the same sweep. Must be set before the first group is created.
+// If shareSynapses is set, only the neurons of replica 0 own synapses. A spike of any other replica is delivered
+// through the synapses of the corresponding neuron in replica 0, to the corresponding post-synaptic neurons of its
+// own replica. All replicas then read the same weights (see CARLsim::setBatchSize).
+void CpuSNN::setNumReplicas(int numReplicas, bool shareSynapses) {
+	assert(numReplicas >= 1);
+	assert(numGrp == 0);
+	numReplicas_ = numReplicas;
+	replicasShareSynapses_ = shareSynapses && numReplicas > 1;
+}
+
+// override the mean Izhikevich parameters of a group in a single replica (standard deviations stay the same)
+void CpuSNN::setReplicaNeuronParameters(int grpId, int replica, float izh_a, float izh_b, float izh_c, float izh_d) {
+	assert(grpId>=0 && grpId<numGrp);
+	assert(replica>=0 && replica<numReplicas_);
+
+	replica_izh_params_t params;
+	params.grpId = grpId;
+	params.replica = replica;
+	params.Izh_a = izh_a;
+	params.Izh_b = izh_b;
+	params.Izh_c = izh_c;
+	params.Izh_d = izh_d;
+
+	// calling the function again on the same replica replaces the previous values
+	for (unsigned int i=0; i<replicaIzhParams_.size(); i++) {
+		if (replicaIzhParams_[i].grpId==grpId && replicaIzhParams_[i].replica==replica) {
+			replicaIzhParams_[i] = params;
+			return;
+		}
+	}
+	replicaIzhParams_.push_back(params);
+}
+
+// record spike arrival times per pre-synaptic neuron and delay for STDP instead of per synapse
+void CpuSNN::setPerDelayArrivalTimes(bool isSet) {
+	stdpPerDelayArrival_ = isSet && simMode_ == CPU_MODE; // GPU mode keeps using synSpikeTime
+}
+
+// only update the weights of synapses whose wtChange got modified since the last weight update
+void CpuSNN::setIncrementalWeightUpdate(bool isSet) {
+	wtUpdateIncremental_ = isSet && simMode_ == CPU_MODE;
+}
+
+// enable/disable vectorized neuron state update (if the CPU supports it)
+void CpuSNN::setSIMD(bool useSIMD) {
+	simdIsa_ = useSIMD ? getBestSimdIsa() : SIMD_NONE;
+}
+
+// use vectorized neuron state update with a specific instruction set
+void CpuSNN::setSIMD(simdIsa_t isa) {
+	assert(isSimdIsaSupported(isa));
+	simdIsa_ = isa;
+}
+
 // set Izhikevich parameters for group
 void CpuSNN::setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
 								float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
@@ -758,6 +933,7 @@ int CpuSNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary, bool copySta
 	// set the Poisson generation time slice to be at the run duration up to PROPOGATED_BUFFER_SIZE ms.
 	// \TODO: should it be PROPAGATED_BUFFER_SIZE-1 or PROPAGATED_BUFFER_SIZE ?
 	setGrpTimeSlice(ALL, (std::max)(1,(std::min)(runDurationMs,PROPAGATED_BUFFER_SIZE-1)));
+	stepping_ = false;
 
 #ifndef __NO_CUDA__
 	CUDA_RESET_TIMER(timer);
@@ -767,56 +943,7 @@ int CpuSNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary, bool copySta
 	// if nsec=0, simTimeMs=10, we need to run the simulator for 10 timeStep;
 	// if nsec=1, simTimeMs=10, we need to run the simulator for 1*1000+10, time Step;
 	for(int i=0; i<runDurationMs; i++) {
-		if(simMode_ == CPU_MODE) {
-			doSnnSim();
-#ifndef __NO_CUDA__
-		} else {
-			doGPUSim();
-#endif
-		}
-
-		// update weight every updateInterval ms if plastic synapses present
-		if (!sim_with_fixedwts && wtANDwtChangeUpdateInterval_ == ++wtANDwtChangeUpdateIntervalCnt_) {
-			wtANDwtChangeUpdateIntervalCnt_ = 0; // reset counter
-			if (!sim_in_testing) {
-				// keep this if statement separate from the above, so that the counter is updated correctly
-				if (simMode_ == CPU_MODE) {
-					updateWeights();
-#ifndef __NO_CUDA__
-				} else{
-					updateWeights_GPU();
-#endif
-				}
-			}
-		}
-
-		// Note: updateTime() advance simTime, simTimeMs, and simTimeSec accordingly
-		if (updateTime()) {
-			// finished one sec of simulation...
-			if (numSpikeMonitor) {
-				updateSpikeMonitor();
-			}
-			if (numGroupMonitor) {
-				updateGroupMonitor();
-			}
-			if (numConnectionMonitor) {
-				updateConnectionMonitor();
-			}
-
-			if(simMode_ == CPU_MODE) {
-				updateFiringTable();
-#ifndef __NO_CUDA__
-			} else {
-				updateFiringTable_GPU();
-#endif
-			}
-		}
-
-#ifndef __NO_CUDA__
-		if(simMode_ == GPU_MODE) {
-			copyFiringStateFromGPU();
-		}
-#endif
+		doStep();
 	}
 
 #ifndef __NO_CUDA__
@@ -832,8 +959,10 @@ int CpuSNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary, bool copySta
 	}
 #endif
 
-	// user can opt to display some runNetwork summary
-	if (printRunSummary) {
+	// user can opt to display some runNetwork summary (unless a real-time simulation needs to catch up)
+	if (printRunSummary && skipMonitorsWhenLate_ && realTimeLastStepLate_) {
+		realTimeStats_.numSkippedMonitorUpdates++;
+	} else if (printRunSummary) {
 
 		// if there are Monitors available and it's time to show the log, print status for each group
 		if (numSpikeMonitor) {
@@ -854,6 +983,13 @@ int CpuSNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary, bool copySta
 	updateSpikeMonitor();
 	updateGroupMonitor();
 
+	// the monitor files have been written in the background: make sure they are complete once runNetwork returns
+	if (monWriter_!=NULL) {
+		monWriter_->waitUntilWritten();
+		if (monWriter_->checkAndClearWriteError())
+			KERNEL_ERROR("Could not write monitor file (fwrite error)");
+	}
+
 	// keep track of simulation time...
 #ifndef __NO_CUDA__
 	CUDA_STOP_TIMER(timer);
@@ -866,6 +1002,170 @@ int CpuSNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary, bool copySta
 
 
 
+// advances the simulation by numSteps ms, without the per-run work of runNetwork
+// Spike counts are not reset, monitors are only updated once per second (and by their start/stopRecording), and no
+// run summary is printed. Spike generators use a time slice of 1 ms, so that new spike rates take effect right away.
+void CpuSNN::stepNetwork(int numSteps) {
+	assert(doneReorganization);
+	assert(simMode_==CPU_MODE);
+	assert(numSteps>0);
+
+	if (!stepping_) {
+		setGrpTimeSlice(ALL, 1);
+		stepping_ = true;
+	}
+
+	simTimeRunStart = simTime;
+	simTimeRunStop  = simTime+numSteps;
+	if (simTime==0 && numConnectionMonitor) {
+		updateConnectionMonitor();
+	}
+
+	for (int i=0; i<numSteps; i++) {
+		doStep();
+	}
+}
+
+// lists the neurons of a group that spiked in the last time step (neuron IDs relative to the group, ascending)
+int CpuSNN::getLastStepSpikes(int grpId, std::vector<int>& neurIds) {
+	assert(grpId>=0 && grpId<numGrp);
+	assert(simMode_==CPU_MODE);
+
+	neurIds.clear();
+	if (simTime==0)
+		return 0;
+
+	// the slot of the last time step is only cleared at the beginning of the next one
+	const spike_slot_t& slot = spikeRing_[SPIKE_RING_POS(1)];
+	int startN = grp_Info[grpId].StartN;
+	int endN = grp_Info[grpId].EndN;
+	const std::vector<int>& nidList = (grp_Info[grpId].MaxDelay == 1) ? slot.nidD1 : slot.nidD2;
+	for (unsigned int i=0; i<nidList.size(); i++) {
+		if (nidList[i]>=startN && nidList[i]<=endN)
+			neurIds.push_back(nidList[i]-startN);
+	}
+	std::sort(neurIds.begin(), neurIds.end());
+	return neurIds.size();
+}
+
+// paces every simulated ms against the wall clock
+void CpuSNN::setRealTimeMode(bool enable, bool skipMonitorsWhenLate) {
+	realTimeMode_ = enable;
+	skipMonitorsWhenLate_ = enable && skipMonitorsWhenLate;
+	realTimeClockStarted_ = false;
+}
+
+RealTimeStats_t CpuSNN::getRealTimeStats() {
+	RealTimeStats_t stats = realTimeStats_;
+	int numOnTime = stats.numSteps - stats.numOverruns;
+	stats.meanSlackMs = (numOnTime>0) ? realTimeSumSlackMs_/numOnTime : 0.0;
+	return stats;
+}
+
+void CpuSNN::resetRealTimeStats() {
+	memset(&realTimeStats_, 0, sizeof(RealTimeStats_t));
+	realTimeSumSlackMs_ = 0.0;
+	realTimeLastStepLate_ = false;
+	realTimeClockStarted_ = false;
+}
+
+// simulates one time step: neurons and synapses, weight update, and everything that is due at the end of a second
+void CpuSNN::doStep() {
+	if (realTimeMode_ && !realTimeClockStarted_) {
+		// the real-time clock starts with the first paced step
+		realTimeStartMs_ = getWallTimeMs();
+		realTimeStartSimTime_ = simTime;
+		realTimeClockStarted_ = true;
+	}
+
+	if(simMode_ == CPU_MODE) {
+		doSnnSim();
+#ifndef __NO_CUDA__
+	} else {
+		doGPUSim();
+#endif
+	}
+
+	// update weight every updateInterval ms if plastic synapses present
+	if (!sim_with_fixedwts && wtANDwtChangeUpdateInterval_ == ++wtANDwtChangeUpdateIntervalCnt_) {
+		wtANDwtChangeUpdateIntervalCnt_ = 0; // reset counter
+		if (!sim_in_testing) {
+			// keep this if statement separate from the above, so that the counter is updated correctly
+			if (simMode_ == CPU_MODE) {
+				updateWeights();
+#ifndef __NO_CUDA__
+			} else{
+				updateWeights_GPU();
+#endif
+			}
+		}
+	}
+
+	// Note: updateTime() advance simTime, simTimeMs, and simTimeSec accordingly
+	if (updateTime()) {
+		// finished one sec of simulation...
+		if (numSpikeMonitor) {
+			updateSpikeMonitor();
+		}
+		if (numGroupMonitor) {
+			updateGroupMonitor();
+		}
+		if (numConnectionMonitor) {
+			// the snapshot of the weights can be skipped without losing anything else, while spikes and group
+			// data of the last second would be gone for good
+			if (skipMonitorsWhenLate_ && isBehindRealTime()) {
+				realTimeStats_.numSkippedMonitorUpdates++;
+			} else {
+				updateConnectionMonitor();
+			}
+		}
+
+		if(simMode_ == CPU_MODE) {
+			updateFiringTable();
+#ifndef __NO_CUDA__
+		} else {
+			updateFiringTable_GPU();
+#endif
+		}
+	}
+
+#ifndef __NO_CUDA__
+	if(simMode_ == GPU_MODE) {
+		copyFiringStateFromGPU();
+	}
+#endif
+
+	if (realTimeMode_) {
+		waitForRealTime();
+	}
+}
+
+// the deadline of time step simTime-1 (which ends at simTime) is realTimeStartMs_+(simTime-realTimeStartSimTime_)
+bool CpuSNN::isBehindRealTime() {
+	return realTimeMode_ && realTimeClockStarted_
+		&& getWallTimeMs() > realTimeStartMs_ + (simTime-realTimeStartSimTime_);
+}
+
+void CpuSNN::waitForRealTime() {
+	double nowMs = getWallTimeMs();
+	double deadlineMs = realTimeStartMs_ + (simTime-realTimeStartSimTime_);
+	realTimeStats_.numSteps++;
+	realTimeLastStepLate_ = (nowMs > deadlineMs);
+	if (realTimeLastStepLate_) {
+		// no waiting: the following steps run back to back until the simulation has caught up
+		realTimeStats_.numOverruns++;
+		realTimeStats_.maxLatenessMs = (std::max)(realTimeStats_.maxLatenessMs, nowMs-deadlineMs);
+	} else {
+		double slackMs = deadlineMs - nowMs;
+		int numOnTime = realTimeStats_.numSteps - realTimeStats_.numOverruns;
+		realTimeStats_.minSlackMs = (numOnTime==1) ? slackMs : (std::min)(realTimeStats_.minSlackMs, slackMs);
+		realTimeSumSlackMs_ += slackMs;
+		waitUntilWallTimeMs(deadlineMs);
+	}
+}
+
+
+
 /// ************************************************************************************************************ ///
 /// PUBLIC METHODS: INTERACTING WITH A SIMULATION
 /// ************************************************************************************************************ ///
@@ -873,6 +1173,8 @@ int CpuSNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary, bool copySta
 // adds a bias to every weight in the connection
 void CpuSNN::biasWeights(short int connId, float bias, bool updateWeightRange) {
 	assert(connId>=0 && connId<numConnections);
+	flushWeightUpdates();
+	wtVersion_ = ++stateVersionCnt_;
 
 	grpConnectInfo_t* connInfo = getConnectInfo(connId);
 
@@ -975,10 +1277,240 @@ void CpuSNN::resetSpikeCounter(int grpId) {
 	}
 }
 
+// resets all dynamic state to what it was right after setupNetwork: neuron state, conductances, STP, neuromodulators,
+// firing tables, the propagation buffer, spike counters, wtChange, and simTime. Nothing is reallocated. Weights (and all
+// parameters) are kept, so that the next run behaves exactly like the first run after setupNetwork with these weights.
+void CpuSNN::resetState() {
+	assert(doneReorganization);
+	assert(simMode_==CPU_MODE);
+
+	// weights survive the reset: bring them up to date before wtChange is cleared
+	flushWeightUpdates();
+
+	// neurons and Poisson neurons (including lastSpikeTime, STP, homeostasis), currents, and conductances
+	resetGroups();
+	memset(curSpike, 0, sizeof(curSpike[0])*numNReg);
+	for (int g=0; g<numGrp; g++) {
+		resetNeuromodulator(g);
+		poissonMaxProb_[g] = -1.0f;
+	}
+
+	// simTime, propagation buffer, and firing tables
+	resetFiringInformation();
+	resetSpikeCnt(ALL);
+	resetSpikeCounter(ALL);
+
+	// wtChange and pre-synaptic spike times
+	resetSynapticConnections(false);
+	wtVersion_ = ++stateVersionCnt_;
+	synSpikeTimeVersion_ = ++stateVersionCnt_;
+	if (wtUpdateDirty_ != NULL)
+		memset(wtUpdateDirty_, 0, numN);
+	wtANDwtChangeUpdateIntervalCnt_ = 0;
+
+	simTimeRunStart = 0;
+	simTimeRunStop = 0;
+	simTimeLastRunSummary = 0;
+	stepping_ = false;
+	realTimeClockStarted_ = false; // simTime jumped
+
+	// monitors keep their data, but must know that time starts over
+	for (unsigned int i=0; i<numSpikeMonitor; i++)
+		spikeMonCoreList[i]->setLastUpdated(0);
+	for (unsigned int i=0; i<numGroupMonitor; i++)
+		groupMonCoreList[i]->setLastUpdated(0);
+	for (int i=0; i<numConnectionMonitor; i++)
+		connMonCoreList[i]->resetSnapshotTimes();
+}
+
+// changes the Izhikevich parameters of a group after setupNetwork
+// The per-neuron parameters are drawn again in place (with the same random numbers as before); membrane potential
+// and recovery keep their values until the next resetState.
+void CpuSNN::updateNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
+									float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
+{
+	assert(doneReorganization);
+	assert(grpId>=0 && grpId<numGrp);
+	assert(!grp_Info[grpId].isSpikeGenerator && !grp_Info[grpId].withParamModel_9);
+
+	setNeuronParameters(grpId, izh_a, izh_a_sd, izh_b, izh_b_sd, izh_c, izh_c_sd, izh_d, izh_d_sd);
+	for (int nid=grp_Info[grpId].StartN; nid<=grp_Info[grpId].EndN; nid++)
+		initNeuronParameters(nid, grpId);
+}
+
+// changes the E-STDP curve of a group after setupNetwork, keeping the STDP type
+void CpuSNN::updateESTDP(int grpId, stdpCurve_t curve, float alphaPlus, float tauPlus, float alphaMinus,
+						float tauMinus, float gamma)
+{
+	assert(doneReorganization);
+	assert(grpId>=0 && grpId<numGrp);
+	assert(grp_Info[grpId].WithESTDP);
+
+	setESTDP(grpId, true, grp_Info[grpId].WithESTDPtype, curve, alphaPlus, tauPlus, alphaMinus, tauMinus, gamma);
+	initSTDPLookupTables();
+}
+
+// changes the I-STDP curve of a group after setupNetwork, keeping the STDP type
+void CpuSNN::updateISTDP(int grpId, stdpCurve_t curve, float ab1, float ab2, float tau1, float tau2) {
+	assert(doneReorganization);
+	assert(grpId>=0 && grpId<numGrp);
+	assert(grp_Info[grpId].WithISTDP);
+
+	setISTDP(grpId, true, grp_Info[grpId].WithISTDPtype, curve, ab1, ab2, tau1, tau2);
+	initSTDPLookupTables();
+}
+
+// changes the homeostatic scaling factor and averaging time scale of a group after setupNetwork
+void CpuSNN::updateHomeostasis(int grpId, float homeoScale, float avgTimeScale) {
+	assert(doneReorganization);
+	assert(grpId>=0 && grpId<numGrp);
+	assert(grp_Info[grpId].WithHomeostasis);
+
+	setHomeostasis(grpId, true, homeoScale, avgTimeScale);
+}
+
+// changes the homeostatic target firing rate of a group after setupNetwork
+// The average firing rates keep their values until the next resetState.
+void CpuSNN::updateHomeoBaseFiringRate(int grpId, float baseFiring, float baseFiringSD) {
+	assert(doneReorganization);
+	assert(grpId>=0 && grpId<numGrp);
+
+	setHomeoBaseFiringRate(grpId, baseFiring, baseFiringSD);
+	for (int nid=grp_Info[grpId].StartN; nid<=grp_Info[grpId].EndN; nid++)
+		initNeuronParameters(nid, grpId);
+}
+
+// copies all dynamic state of the network into a new snapshot
+// Plain-old-data state is listed by getStateRegions. The synaptic arrays carry a version counter that changes whenever
+// they are modified: if an array has not changed since the last snapshot was taken (or restored), the new snapshot
+// shares the copy of that snapshot instead of copying the array again. Random numbers only depend on the seed and
+// simTime (see CounterRNG), so there is no generator state to store.
+SnapshotCore* CpuSNN::takeSnapshot() {
+	assert(doneReorganization);
+	assert(simMode_==CPU_MODE);
+
+	std::vector<state_region_t> regions;
+	getStateRegions(regions);
+	if (lastSnapCopies_.empty())
+		lastSnapCopies_.assign(regions.size(), NULL); // never resized afterwards: copies keep pointers into it
+	assert(lastSnapCopies_.size() == regions.size());
+
+	SnapshotCore* snap = new SnapshotCore(this);
+	snap->simTime = simTime;
+
+	size_t numBytesPacked = 0;
+	for (unsigned int i=0; i<regions.size(); i++)
+		if (regions[i].version == NULL)
+			numBytesPacked += regions[i].numBytes;
+	snap->regions.resize(numBytesPacked);
+
+	char* dst = snap->regions.empty() ? NULL : &snap->regions[0];
+	for (unsigned int i=0; i<regions.size(); i++) {
+		if (regions[i].version == NULL) {
+			memcpy(dst, regions[i].ptr, regions[i].numBytes);
+			dst += regions[i].numBytes;
+			continue;
+		}
+
+		// copy-on-write: share the newest copy of the array if the array has not changed since
+		SharedStateCopy* copy = lastSnapCopies_[i];
+		if (copy != NULL && copy->getVersion() == *regions[i].version) {
+			copy->addRef();
+		} else {
+			if (copy != NULL)
+				copy->clearWeakRef();
+			copy = new SharedStateCopy(regions[i].ptr, regions[i].numBytes, *regions[i].version);
+			copy->setWeakRef(&lastSnapCopies_[i]);
+		}
+		snap->sharedRegions.push_back(copy);
+	}
+
+	// scheduled and recent spikes
+	snap->pbuf = new PropagatedSpikeBuffer(*pbuf);
+	snap->spikeRingD1.resize(spikeRing_.size());
+	snap->spikeRingD2.resize(spikeRing_.size());
+	for (unsigned int i=0; i<spikeRing_.size(); i++) {
+		snap->spikeRingD1[i] = spikeRing_[i].nidD1;
+		snap->spikeRingD2[i] = spikeRing_[i].nidD2;
+	}
+	snap->firingLogD1 = firingLogD1_;
+	snap->firingLogD2 = firingLogD2_;
+	snap->firingLogTimeD1 = firingLogTimeD1_;
+	snap->firingLogTimeD2 = firingLogTimeD2_;
+
+	return snap;
+}
+
+// brings all dynamic state of the network back to what it was when the snapshot was taken
+// Synaptic arrays that still hold the content of the snapshot (same version) are not copied.
+void CpuSNN::restoreSnapshot(SnapshotCore* snap) {
+	assert(doneReorganization);
+	assert(simMode_==CPU_MODE);
+	assert(snap!=NULL && snap->snn==this);
+
+	std::vector<state_region_t> regions;
+	getStateRegions(regions);
+	assert(lastSnapCopies_.size() == regions.size());
+
+	// several arrays share a version counter: decide what to copy before any of the counters change
+	const char* src = snap->regions.empty() ? NULL : &snap->regions[0];
+	unsigned int k = 0;
+	for (unsigned int i=0; i<regions.size(); i++) {
+		if (regions[i].version == NULL) {
+			memcpy(regions[i].ptr, src, regions[i].numBytes);
+			src += regions[i].numBytes;
+		} else {
+			SharedStateCopy* copy = snap->sharedRegions[k++];
+			assert(copy->getNumBytes() == regions[i].numBytes);
+			if (copy->getVersion() != *regions[i].version)
+				memcpy(regions[i].ptr, copy->getData(), copy->getNumBytes());
+		}
+	}
+	assert(k == snap->sharedRegions.size());
+	assert(src == (snap->regions.empty() ? NULL : &snap->regions[0] + snap->regions.size()));
+
+	// the arrays now hold the content of the copies, so the next snapshot can share them
+	k = 0;
+	for (unsigned int i=0; i<regions.size(); i++) {
+		if (regions[i].version == NULL)
+			continue;
+
+		SharedStateCopy* copy = snap->sharedRegions[k++];
+		*regions[i].version = copy->getVersion();
+		if (lastSnapCopies_[i] != copy) {
+			if (lastSnapCopies_[i] != NULL)
+				lastSnapCopies_[i]->clearWeakRef();
+			copy->setWeakRef(&lastSnapCopies_[i]);
+		}
+	}
+
+	*pbuf = *snap->pbuf;
+	for (unsigned int i=0; i<spikeRing_.size(); i++) {
+		spikeRing_[i].nidD1 = snap->spikeRingD1[i];
+		spikeRing_[i].nidD2 = snap->spikeRingD2[i];
+	}
+	firingLogD1_ = snap->firingLogD1;
+	firingLogD2_ = snap->firingLogD2;
+	firingLogTimeD1_ = snap->firingLogTimeD1;
+	firingLogTimeD2_ = snap->firingLogTimeD2;
+	stepping_ = false; // time slices are part of the snapshot
+	realTimeClockStarted_ = false; // simTime jumped
+
+	// monitors keep their data, but must know that time jumped
+	for (unsigned int i=0; i<numSpikeMonitor; i++)
+		spikeMonCoreList[i]->setLastUpdated(simTime);
+	for (unsigned int i=0; i<numGroupMonitor; i++)
+		groupMonCoreList[i]->setLastUpdated(simTime);
+	for (int i=0; i<numConnectionMonitor; i++)
+		connMonCoreList[i]->resetSnapshotTimes();
+}
+
 // multiplies every weight with a scaling factor
 void CpuSNN::scaleWeights(short int connId, float scale, bool updateWeightRange) {
 	assert(connId>=0 && connId<numConnections);
 	assert(scale>=0.0f);
+	flushWeightUpdates();
+	wtVersion_ = ++stateVersionCnt_;
 
 	grpConnectInfo_t* connInfo = getConnectInfo(connId);
 
@@ -1057,7 +1589,7 @@ GroupMonitor* CpuSNN::setGroupMonitor(int grpId, FILE* fid) {
 	// assign group status file ID if we selected to write to a file, else it's NULL
 	// if file pointer exists, it has already been fopened
 	// this will also write the header section of the group status file
-	// grpMonCoreObj destructor will fclose it
+	// from then on, the file belongs to the monitor writer, which will fclose it
 	grpMonCoreObj->setGroupFileId(fid);
 
 	// create a new GroupMonitor object for the user-interface
@@ -1107,7 +1639,7 @@ ConnectionMonitor* CpuSNN::setConnectionMonitor(int grpIdPre, int grpIdPost, FIL
 	// assign conn file ID if we selected to write to a file, else it's NULL
 	// if file pointer exists, it has already been fopened
 	// this will also write the header section of the conn file
-	// connMonCoreObj destructor will fclose it
+	// from then on, the file belongs to the monitor writer, which will fclose it
 	connMonCoreObj->setConnectFileId(fid);
 
 	// create a new ConnectionMonitor object for the user-interface
@@ -1181,6 +1713,12 @@ void CpuSNN::setSpikeCounter(int grpId, int recordDur) {
 		recordDur);
 }
 
+AsyncWriter* CpuSNN::getMonitorWriter() {
+	if (monWriter_==NULL)
+		monWriter_ = new AsyncWriter(MON_WRITER_CHUNK_SIZE, MON_WRITER_MAX_QUEUED);
+	return monWriter_;
+}
+
 // record spike information, return a SpikeInfo object
 SpikeMonitor* CpuSNN::setSpikeMonitor(int grpId, FILE* fid) {
 	// check whether group already has a SpikeMonitor
@@ -1203,7 +1741,7 @@ SpikeMonitor* CpuSNN::setSpikeMonitor(int grpId, FILE* fid) {
 		// assign spike file ID if we selected to write to a file, else it's NULL
 		// if file pointer exists, it has already been fopened
 		// this will also write the header section of the spike file
-		// spkMonCoreObj destructor will fclose it
+		// from then on, the file belongs to the monitor writer, which will fclose it
 		spkMonCoreObj->setSpikeFileId(fid);
 
 		// create a new SpikeMonitor object for the user-interface
@@ -1226,7 +1764,7 @@ SpikeMonitor* CpuSNN::setSpikeMonitor(int grpId, FILE* fid) {
 }
 
 // assigns spike rate to group
-void CpuSNN::setSpikeRate(int grpId, PoissonRate* ratePtr, int refPeriod) {
+void CpuSNN::setSpikeRate(int grpId, PoissonRate* ratePtr, int refPeriod, bool perStep) {
 	assert(grpId>=0 && grpId<numGrp);
 	assert(ratePtr);
 	assert(grp_Info[grpId].isSpikeGenerator);
@@ -1235,6 +1773,8 @@ void CpuSNN::setSpikeRate(int grpId, PoissonRate* ratePtr, int refPeriod) {
 
 	grp_Info[grpId].RatePtr = ratePtr;
 	grp_Info[grpId].RefractPeriod   = refPeriod;
+	grp_Info[grpId].PoissonPerStep = perStep && simMode_ == CPU_MODE; // GPU mode has its own Poisson generator
+	poissonMaxProb_[grpId] = -1.0f; // look at the rates again in the next time step
 	spikeRateUpdated = true;
 }
 
@@ -1246,6 +1786,8 @@ void CpuSNN::setWeight(short int connId, int neurIdPre, int neurIdPost, float we
 	grpConnectInfo_t* connInfo = getConnectInfo(connId);
 	assert(neurIdPre>=0  && neurIdPre<getGroupNumNeurons(connInfo->grpSrc));
 	assert(neurIdPost>=0 && neurIdPost<getGroupNumNeurons(connInfo->grpDest));
+	flushWeightUpdates();
+	wtVersion_ = ++stateVersionCnt_;
 
 	float maxWt = fabs(connInfo->maxWt);
 	float minWt = 0.0f;
@@ -1314,6 +1856,55 @@ void CpuSNN::setWeight(short int connId, int neurIdPre, int neurIdPost, float we
 }
 
 
+// sets the weight value of all synapses of a connection whose post-synaptic neuron belongs to a replica
+void CpuSNN::setReplicaWeight(short int connId, int replica, float weight, bool updateWeightRange) {
+	assert(connId>=0 && connId<getNumConnections());
+	assert(replica>=0 && replica<numReplicas_);
+	assert(weight>=0.0f);
+	flushWeightUpdates();
+	wtVersion_ = ++stateVersionCnt_;
+
+	grpConnectInfo_t* connInfo = getConnectInfo(connId);
+	float maxWt = fabs(connInfo->maxWt);
+	float minWt = 0.0f;
+
+	// same range handling as setWeight
+	if (updateWeightRange) {
+		maxWt = fmax(maxWt, weight);
+	} else {
+		weight = fmin(weight, maxWt);
+		weight = fmax(weight, minWt);
+	}
+	float sign = isExcitatoryGroup(connInfo->grpSrc) ? 1.0f : -1.0f;
+
+	// synapses never cross replicas: all synapses onto the neurons of the replica belong to the replica
+	int sizeNPost = getGroupReplicaNumNeurons(connInfo->grpDest);
+	int startNPost = grp_Info[connInfo->grpDest].StartN + replica*sizeNPost;
+	for (int i=startNPost; i<startNPost+sizeNPost; i++) {
+		unsigned int cumIdx = cumulativePre[i];
+		unsigned int pos_ij = cumIdx;
+		for (int j=0; j<Npre[i]; pos_ij++, j++) {
+			if (cumConnIdPre[pos_ij]==connId) {
+				wt[pos_ij] = sign*weight;
+				maxSynWt[pos_ij] = sign*maxWt;
+			}
+		}
+
+#ifndef __NO_CUDA__
+		// update GPU datastructures in batches, grouped by post-neuron
+		if (simMode_==GPU_MODE) {
+			CUDA_CHECK_ERRORS( cudaMemcpy(&(cpu_gpuNetPtrs.wt[cumIdx]), &(wt[cumIdx]), sizeof(float)*Npre[i],
+				cudaMemcpyHostToDevice) );
+			if (cpu_gpuNetPtrs.maxSynWt!=NULL) {
+				CUDA_CHECK_ERRORS( cudaMemcpy(&(cpu_gpuNetPtrs.maxSynWt[cumIdx]), &(maxSynWt[cumIdx]),
+					sizeof(float)*Npre[i], cudaMemcpyHostToDevice));
+			}
+		}
+#endif
+	}
+}
+
+
 // writes network state to file
 // handling of file pointer should be handled externally: as far as this function is concerned, it is simply
 // trying to write to file
@@ -1321,6 +1912,8 @@ void CpuSNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 	int tmpInt;
 	float tmpFloat;
 
+	flushWeightUpdates();
+
 	// +++++ WRITE HEADER SECTION +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
 	// write file signature
@@ -1431,6 +2024,7 @@ void CpuSNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 // writes population weights from gIDpre to gIDpost to file fname in binary
 void CpuSNN::writePopWeights(std::string fname, int grpIdPre, int grpIdPost) {
 	assert(grpIdPre>=0); assert(grpIdPost>=0);
+	flushWeightUpdates();
 
 	float* weights;
 	int matrixSize;
@@ -1528,8 +2122,7 @@ void CpuSNN::setLogsFp(FILE* fpInf, FILE* fpErr, FILE* fpDeb, FILE* fpLog) {
 	}
 
 	if (fpLog!=NULL) {
-		if (fpLog_!=NULL && fpLog_!=stdout && fpLog_!=stderr)
-			fclose(fpLog_);
+		releaseLog(fpLog_, false);
 		fpLog_ = fpLog;
 	}
 }
@@ -1675,7 +2268,7 @@ uint8_t* CpuSNN::getDelays(int gIDpre, int gIDpost, int& Npre, int& Npost, uint8
 	if (delays == NULL) delays = new uint8_t[Npre*Npost];
 	memset(delays,0,Npre*Npost);
 
-	for (int i=grp_Info[gIDpre].StartN;i<grp_Info[gIDpre].EndN;i++) {
+	for (int i=grp_Info[gIDpre].StartN;i<=grp_Info[gIDpre].EndN;i++) {
 		unsigned int offset = cumulativePost[i];
 
 		for (int t=0;t<maxDelay_;t++) {
@@ -1697,7 +2290,7 @@ uint8_t* CpuSNN::getDelays(int gIDpre, int gIDpost, int& Npre, int& Npost, uint8
 					// get the cumulative position for quick access...
 //					unsigned int pos_i = cumulativePre[p_i] + s_i;
 
-					delays[i+Npre*(p_i-grp_Info[gIDpost].StartN)] = t+1;
+					delays[(i-grp_Info[gIDpre].StartN)+Npre*(p_i-grp_Info[gIDpost].StartN)] = t+1;
 				}
 			}
 		}
@@ -1792,6 +2385,9 @@ Point3D CpuSNN::getNeuronLocation3D(int grpId, int relNeurId) {
 	assert(grpId>=0 && grpId<numGrp);
 	assert(relNeurId>=0 && relNeurId<getGroupNumNeurons(grpId));
 
+	// all replicas of a group occupy the same locations
+	relNeurId %= getGroupReplicaNumNeurons(grpId);
+
 	// coordinates are in x e[-SizeX/2,SizeX/2], y e[-SizeY/2,SizeY/2], z e[-SizeZ/2,SizeZ/2]
 	// instead of x e[0,SizeX], etc.
 	int intX = relNeurId % grp_Info[grpId].SizeX;
@@ -1941,39 +2537,19 @@ void CpuSNN::CpuSNNinit() {
 		exit(1);
 	}
 
-	// try to open log file in results folder: create if not exists
-	#if defined(WIN32) || defined(WIN64)
-		CreateDirectory("results", NULL);
-		fpLog_ = fopen("results/carlsim.log", "w");
-	#else
-		struct stat sb;
-		int createDir = 1;
-		if (stat("results", &sb) == -1 || !S_ISDIR(sb.st_mode)) {
-			// results dir does not exist, try to create:
-			createDir = mkdir("results", 0777);
-		}
-
-		if (createDir == -1) {
-			// tried to create dir, but failed
-			fprintf(stderr, "Could not create directory \"results/\", which is required to "
-				"store simulation results. Aborting simulation...\n");
-			exit(1);
-		} else {
-			// open log file
-			fpLog_ = fopen("results/carlsim.log","w");
-
-			if (createDir == 0) {
-				// newly created dir: now that fpLog_/fpInf_ exist, inform user
-				KERNEL_INFO("Created results directory \"results/\".");
-			}
-		}
-	#endif
+	// open log file in results folder (shared among all instances): create if not exists
+	bool createdDir;
+	fpLog_ = acquireSharedLog(&createdDir);
 	if (fpLog_ == NULL) {
 		fprintf(stderr, "Could not create the directory \"results/\" or the log file \"results/carlsim.log\""
 			", which is required to store simulation results. Aborting simulation...\n");
 		exit(1);
 	}
-	
+	if (createdDir) {
+		// newly created dir: now that fpLog_/fpInf_ exist, inform user
+		KERNEL_INFO("Created results directory \"results/\".");
+	}
+
 	#ifdef __REGRESSION_TESTING__
 	#if defined(WIN32) || defined(WIN64)
 		fpInf_ = fopen("nul","w");
@@ -1996,14 +2572,20 @@ void CpuSNN::CpuSNNinit() {
 		loggerMode_string[loggerMode_]);
 	KERNEL_INFO("Random number seed: %d",randSeed_);
 
+	// localtime and asctime share a static buffer among all threads
 	time_t rawtime;
-	struct tm * timeinfo;
+	struct tm timeinfo;
+	char timeStr[64];
 	time(&rawtime);
-	timeinfo = localtime(&rawtime);
-	KERNEL_DEBUG("Current local time and date: %s", asctime(timeinfo));
+	#if defined(WIN32) || defined(WIN64)
+		localtime_s(&timeinfo, &rawtime);
+	#else
+		localtime_r(&rawtime, &timeinfo);
+	#endif
+	strftime(timeStr, sizeof(timeStr), "%c", &timeinfo);
+	KERNEL_DEBUG("Current local time and date: %s", timeStr);
 
-	// init random seed
-	srand48(randSeed_);
+	// all random numbers are drawn from CounterRNG streams keyed by randSeed_, so there is no global RNG to seed
 	//getRand.seed(randSeed_*2);
 	//getRandClosed.seed(randSeed_*3);
 
@@ -2037,6 +2619,8 @@ void CpuSNN::CpuSNNinit() {
 	gpuExecutionTime = 0.0;
 
 	spikeRateUpdated = false;
+	printFiringRateCnt_ = 0;
+	poissonMaxProb_.assign(MAX_GRP_PER_SNN, -1.0f);
 	numSpikeMonitor = 0;
 	numGroupMonitor = 0;
 	numConnectionMonitor = 0;
@@ -2082,6 +2666,34 @@ void CpuSNN::CpuSNNinit() {
 	// default integration method: Forward-Euler with 0.5ms integration step
 	setIntegrationMethod(FORWARD_EULER, 2);
 
+	// by default, CPU mode runs single-threaded; the thread pool is created in setupNetwork
+	numThreads_ = 1;
+	threadPool_ = NULL;
+	monWriter_ = NULL;
+	numReplicas_ = 1;
+	replicasShareSynapses_ = false;
+	connectInfo_ = NULL;
+	connectChunkStart_ = 0;
+	connectChunkSize_ = 0;
+	simdIsa_ = SIMD_NONE; // scalar kernels unless setSIMD is called
+	stdpPerDelayArrival_ = false;
+	spkArrivalTime_ = NULL;
+	preSynDelay_ = NULL;
+	spikeRingMaxSpikes_ = 0;
+	wtUpdateIncremental_ = false;
+	wtUpdateCnt_ = 0;
+	wtUpdateFlushCnt_ = 0;
+	synWtUpdateCnt_ = NULL;
+	wtUpdateDirty_ = NULL;
+	stateVersionCnt_ = 0;
+	wtVersion_ = 0;
+	synSpikeTimeVersion_ = 0;
+	stepping_ = false;
+
+	realTimeMode_ = false;
+	skipMonitorsWhenLate_ = false;
+	resetRealTimeStats();
+
 #ifndef __NO_CUDA__
 	// each CpuSNN object hold its own random number object
 	gpuPoissonRand = NULL;
@@ -2124,6 +2736,7 @@ void CpuSNN::CpuSNNinit() {
 		// if any incoming  connections are plastic
 		grp_Info[i].isSpikeGenerator = false;
 		grp_Info[i].RatePtr = NULL;
+		grp_Info[i].PoissonPerStep = false;
 
 		grp_Info[i].homeoId = -1;
 		grp_Info[i].avgTimeScale  = 10000.0;
@@ -2299,10 +2912,11 @@ void CpuSNN::buildNetworkInit() {
 	preSynCnt  = 0;
 	for(int g=0; g<numGrp; g++) {
 		// check for INT overflow: postSynCnt is O(numNeurons*numSynapses), must be able to fit within u int limit
-		assert(postSynCnt < UINT_MAX - (grp_Info[g].SizeN * grp_Info[g].numPostSynapses));
-		assert(preSynCnt < UINT_MAX - (grp_Info[g].SizeN * grp_Info[g].numPreSynapses));
-		postSynCnt += (grp_Info[g].SizeN * grp_Info[g].numPostSynapses);
-		preSynCnt  += (grp_Info[g].SizeN * grp_Info[g].numPreSynapses);
+		int sizeN = getGroupNumNeuronsWithSynapses(g);
+		assert(postSynCnt < UINT_MAX - (sizeN * grp_Info[g].numPostSynapses));
+		assert(preSynCnt < UINT_MAX - (sizeN * grp_Info[g].numPreSynapses));
+		postSynCnt += (sizeN * grp_Info[g].numPostSynapses);
+		preSynCnt  += (sizeN * grp_Info[g].numPreSynapses);
 	}
 	assert(postSynCnt/numN <= (unsigned int)numPostSynapses_); // divide by numN to prevent INT overflow
 	postSynapticIds		= new post_info_t[postSynCnt+100];
@@ -2323,18 +2937,22 @@ void CpuSNN::buildNetworkInit() {
 	// size due to weights and maximum weights
 	cpuSnnSz.synapticInfoSize += ((sizeof(int) + 2 * sizeof(float) + sizeof(post_info_t)) * (preSynCnt + 100));
 
-	timeTableD2  = new unsigned int[1000 + maxDelay_ + 1];
-	timeTableD1  = new unsigned int[1000 + maxDelay_ + 1];
+	if (simMode_ == GPU_MODE) {
+		timeTableD2  = new unsigned int[1000 + maxDelay_ + 1];
+		timeTableD1  = new unsigned int[1000 + maxDelay_ + 1];
+		cpuSnnSz.spikingInfoSize += sizeof(int) * 2 * (1000 + maxDelay_ + 1);
+	}
+	spikeRing_.resize(maxDelay_);
+	firingLogTimeD1_.resize(1000+1);
+	firingLogTimeD2_.resize(1000+1);
 	resetTimingTable();
-	cpuSnnSz.spikingInfoSize += sizeof(int) * 2 * (1000 + maxDelay_ + 1);
 
 	// poisson Firing Rate
 	cpuSnnSz.neuronInfoSize += (sizeof(int) * numNPois);
 }
 
 
-int CpuSNN::addSpikeToTable(int nid, int g) {
-	int spikeBufferFull = 0;
+void CpuSNN::addSpikeToTable(int nid, int g) {
 	lastSpikeTime[nid] = simTime;
 	nSpikeCnt[nid]++;
 	if (sim_with_homeostasis)
@@ -2344,7 +2962,7 @@ int CpuSNN::addSpikeToTable(int nid, int g) {
 	if (simMode_ == GPU_MODE) {
 		assert(grp_Info[g].isSpikeGenerator == true);
 		setSpikeGenBit_GPU(nid, g);
-		return 0;
+		return;
 	}
 #endif
 
@@ -2361,26 +2979,23 @@ int CpuSNN::addSpikeToTable(int nid, int g) {
 		stpx[ind_plus] -= stpu[ind_plus]*stpx[ind_minus];
 	}
 
+	// the spike ring grows on demand, so spikes never get dropped
+	spike_slot_t& slot = spikeRing_[SPIKE_RING_POS(0)];
 	if (grp_Info[g].MaxDelay == 1) {
 		assert(nid < numN);
-		firingTableD1[secD1fireCntHost] = nid;
+		slot.nidD1.push_back(nid);
 		secD1fireCntHost++;
 		grp_Info[g].FiringCount1sec++;
-		if (secD1fireCntHost >= maxSpikesD1) {
-			spikeBufferFull = 2;
-			secD1fireCntHost = maxSpikesD1-1;
-		}
+		if (numSpikeMonitor)
+			firingLogD1_.push_back(nid);
 	} else {
 		assert(nid < numN);
-		firingTableD2[secD2fireCntHost] = nid;
+		slot.nidD2.push_back(nid);
 		grp_Info[g].FiringCount1sec++;
 		secD2fireCntHost++;
-		if (secD2fireCntHost >= maxSpikesD2) {
-			spikeBufferFull = 1;
-			secD2fireCntHost = maxSpikesD2-1;
-		}
+		if (numSpikeMonitor)
+			firingLogD2_.push_back(nid);
 	}
-	return spikeBufferFull;
 }
 
 
@@ -2405,8 +3020,10 @@ void CpuSNN::buildGroup(int grpId) {
 		Npost[i]	  	= 0;
 		cumulativePost[i] = allocatedPost;
 		cumulativePre[i]  = allocatedPre;
-		allocatedPost    += grp_Info[grpId].numPostSynapses;
-		allocatedPre     += grp_Info[grpId].numPreSynapses;
+		if (i < grp_Info[grpId].StartN + getGroupNumNeuronsWithSynapses(grpId)) {
+			allocatedPost    += grp_Info[grpId].numPostSynapses;
+			allocatedPre     += grp_Info[grpId].numPreSynapses;
+		}
 	}
 
 	assert(allocatedPost <= postSynCnt);
@@ -2570,19 +3187,11 @@ void CpuSNN::buildNetwork() {
 				if( ((con == 0) && (synWtType == SYN_PLASTIC)) || ((con == 1) && (synWtType == SYN_FIXED))) {
 					switch(newInfo->type) {
 						case CONN_RANDOM:
-							connectRandom(newInfo);
-							break;
 						case CONN_FULL:
-							connectFull(newInfo);
-							break;
 						case CONN_FULL_NO_DIRECT:
-							connectFull(newInfo);
-							break;
 						case CONN_ONE_TO_ONE:
-							connectOneToOne(newInfo);
-							break;
 						case CONN_GAUSSIAN:
-							connectGaussian(newInfo);
+							connectPreNeurons(newInfo);
 							break;
 						case CONN_USER_DEFINED:
 							connectUserDefined(newInfo);
@@ -2618,8 +3227,10 @@ void CpuSNN::buildPoissonGroup(int grpId) {
 		Npost[i]	      = 0;
 		cumulativePost[i] = allocatedPost;
 		cumulativePre[i]  = allocatedPre;
-		allocatedPost    += grp_Info[grpId].numPostSynapses;
-		allocatedPre     += grp_Info[grpId].numPreSynapses;
+		if (i < grp_Info[grpId].StartN + getGroupNumNeuronsWithSynapses(grpId)) {
+			allocatedPost    += grp_Info[grpId].numPostSynapses;
+			allocatedPre     += grp_Info[grpId].numPreSynapses;
+		}
 	}
 	assert(allocatedPost <= postSynCnt);
 	assert(allocatedPre  <= preSynCnt);
@@ -2772,8 +3383,86 @@ void CpuSNN::compactConnections() {
 	postSynCnt	= tmp_postSynCnt;
 }
 
+// generate the synapses of a connection per pre-synaptic neuron (in parallel), then add them to the network
+// in the order of pre-synaptic neuron IDs
+// The pre-synaptic neurons are processed in chunks, so that only the synapses of one chunk are held in temporary
+// memory at any time.
+// With replicas, the synapses are only generated between the neurons of replica 0, and then copied to every other
+// replica, so that all replicas share the same topology (and there are no synapses across replicas). If replicas
+// share synapses, only replica 0 gets any.
+void CpuSNN::connectPreNeurons(grpConnectInfo_t* info) {
+	int grpSrc = info->grpSrc;
+	int grpDest = info->grpDest;
+	int sizeN = getGroupReplicaNumNeurons(grpSrc);
+	int sizeNDest = getGroupReplicaNumNeurons(grpDest);
+	int numSynReplicas = replicasShareSynapses_ ? 1 : numReplicas_; // number of replicas that own synapses
+	int chunkSize = CONNECT_CHUNK_SIZE*numThreads_;
+
+	connectInfo_ = info;
+	connectSyns_.resize((std::min)(chunkSize, sizeN));
+	for (connectChunkStart_=0; connectChunkStart_<sizeN; connectChunkStart_+=chunkSize) {
+		connectChunkSize_ = (std::min)(chunkSize, sizeN-connectChunkStart_);
+		if (threadPool_ != NULL)
+			threadPool_->run(&CpuSNN::connectPreNeuronsThread, this);
+		else
+			connectPreNeuronsThread(this, 0, 1);
+
+		for (int i=0; i<connectChunkSize_; i++) {
+			int pre_nid = grp_Info[grpSrc].StartN + connectChunkStart_ + i;
+			std::vector<syn_candidate_t>& syns = connectSyns_[i];
+			for (int r=0; r<numSynReplicas; r++) {
+				for (unsigned int k=0; k<syns.size(); k++) {
+					setConnection(grpSrc, grpDest, pre_nid+r*sizeN, syns[k].postId+r*sizeNDest, syns[k].weight,
+						info->maxWt, syns[k].delay, info->connProp, info->connId);
+				}
+			}
+			info->numberOfConnections += syns.size()*numSynReplicas;
+		}
+	}
+	std::vector<std::vector<syn_candidate_t> >().swap(connectSyns_); // free temporary memory
+	connectInfo_ = NULL;
+
+	grp_Info2[grpSrc].sumPostConn += info->numberOfConnections;
+	grp_Info2[grpDest].sumPreConn += info->numberOfConnections;
+}
+
+// every thread generates the synapses of a contiguous block of pre-synaptic neurons of the current chunk
+void CpuSNN::connectPreNeuronsThread(void* snn, int threadId, int numThreads) {
+	CpuSNN* s = (CpuSNN*)snn;
+	grpConnectInfo_t* info = s->connectInfo_;
+	int startN = s->grp_Info[info->grpSrc].StartN + s->connectChunkStart_;
+	int sizeN = s->connectChunkSize_;
+	int lIdx = (int)((long long)sizeN*threadId/numThreads);
+	int rIdx = (int)((long long)sizeN*(threadId+1)/numThreads);
+
+	for (int i=lIdx; i<rIdx; i++) {
+		// every pre-neuron has its own random stream, so the synapses do not depend on the thread that creates them
+		CounterRNG rng(s->randSeed_, RNG_STREAM_ID(RNG_STREAM_CONNECT, info->connId, s->connectChunkStart_+i));
+		std::vector<syn_candidate_t>& syns = s->connectSyns_[i];
+		syns.clear();
+
+		switch (info->type) {
+			case CONN_RANDOM:
+				s->connectRandom(info, startN+i, rng, syns);
+				break;
+			case CONN_FULL:
+			case CONN_FULL_NO_DIRECT:
+				s->connectFull(info, startN+i, rng, syns);
+				break;
+			case CONN_ONE_TO_ONE:
+				s->connectOneToOne(info, startN+i, rng, syns);
+				break;
+			case CONN_GAUSSIAN:
+				s->connectGaussian(info, startN+i, rng, syns);
+				break;
+			default:
+				assert(false); // user-defined connections are built serially by connectUserDefined
+		}
+	}
+}
+
 // make 'C' full connections from grpSrc to grpDest
-void CpuSNN::connectFull(grpConnectInfo_t* info) {
+void CpuSNN::connectFull(grpConnectInfo_t* info, int preNeurId, CounterRNG& rng, std::vector<syn_candidate_t>& syns) {
 	int grpSrc = info->grpSrc;
 	int grpDest = info->grpDest;
 	bool noDirect = (info->type == CONN_FULL_NO_DIRECT);
@@ -2781,33 +3470,31 @@ void CpuSNN::connectFull(grpConnectInfo_t* info) {
 	// rebuild struct for easier handling
 	RadiusRF radius(info->radX, info->radY, info->radZ);
 
-	for(int i = grp_Info[grpSrc].StartN; i <= grp_Info[grpSrc].EndN; i++)  {
-		Point3D loc_i = getNeuronLocation3D(i); // 3D coordinates of i
-		for(int j = grp_Info[grpDest].StartN; j <= grp_Info[grpDest].EndN; j++) { // j: the temp neuron id
-			// if flag is set, don't connect direct connections
-			if((noDirect) && (i - grp_Info[grpSrc].StartN) == (j - grp_Info[grpDest].StartN))
-				continue;
-
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D loc_j = getNeuronLocation3D(j); // 3D coordinates of j
-			if (!isPoint3DinRF(radius, loc_i, loc_j))
-				continue;
+	int i = preNeurId;
+	Point3D loc_i = getNeuronLocation3D(i); // 3D coordinates of i
+	int endN = grp_Info[grpDest].StartN + getGroupReplicaNumNeurons(grpDest) - 1; // last neuron of replica 0
+	for(int j = grp_Info[grpDest].StartN; j <= endN; j++) { // j: the temp neuron id
+		// if flag is set, don't connect direct connections
+		if((noDirect) && (i - grp_Info[grpSrc].StartN) == (j - grp_Info[grpDest].StartN))
+			continue;
 
-			//uint8_t dVal = info->minDelay + (int)(0.5 + (drand48() * (info->maxDelay - info->minDelay)));
-			uint8_t dVal = info->minDelay + rand() % (info->maxDelay - info->minDelay + 1);
-			assert((dVal >= info->minDelay) && (dVal <= info->maxDelay));
-			float synWt = getWeights(info->connProp, info->initWt, info->maxWt, i, grpSrc);
+		// check whether pre-neuron location is in RF of post-neuron
+		Point3D loc_j = getNeuronLocation3D(j); // 3D coordinates of j
+		if (!isPoint3DinRF(radius, loc_i, loc_j))
+			continue;
 
-			setConnection(grpSrc, grpDest, i, j, synWt, info->maxWt, dVal, info->connProp, info->connId);
-			info->numberOfConnections++;
-		}
+		syn_candidate_t syn;
+		syn.postId = j;
+		syn.delay = info->minDelay + rng.nextInt(info->maxDelay - info->minDelay + 1);
+		assert((syn.delay >= info->minDelay) && (syn.delay <= info->maxDelay));
+		syn.weight = getWeights(info->connProp, info->initWt, info->maxWt, i, grpSrc, rng);
+		syns.push_back(syn);
 	}
-
-	grp_Info2[grpSrc].sumPostConn += info->numberOfConnections;
-	grp_Info2[grpDest].sumPreConn += info->numberOfConnections;
 }
 
-void CpuSNN::connectGaussian(grpConnectInfo_t* info) {
+void CpuSNN::connectGaussian(grpConnectInfo_t* info, int preNeurId, CounterRNG& rng,
+	std::vector<syn_candidate_t>& syns)
+{
 	// rebuild struct for easier handling
 	// adjust with sqrt(2) in order to make the Gaussian kernel depend on 2*sigma^2
 	RadiusRF radius(info->radX, info->radY, info->radZ);
@@ -2819,88 +3506,81 @@ void CpuSNN::connectGaussian(grpConnectInfo_t* info) {
 	Grid3D grid_j = getGroupGrid3D(grpDest);
 	Point3D scalePre = Point3D(grid_j.x, grid_j.y, grid_j.z) / Point3D(grid_i.x, grid_i.y, grid_i.z);
 
-	for(int i = grp_Info[grpSrc].StartN; i <= grp_Info[grpSrc].EndN; i++)  {
-		Point3D loc_i = getNeuronLocation3D(i)*scalePre; // i: adjusted 3D coordinates
+	Point3D loc_i = getNeuronLocation3D(preNeurId)*scalePre; // i: adjusted 3D coordinates
 
-		for(int j = grp_Info[grpDest].StartN; j <= grp_Info[grpDest].EndN; j++) { // j: the temp neuron id
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D loc_j = getNeuronLocation3D(j); // 3D coordinates of j
+	int endN = grp_Info[grpDest].StartN + getGroupReplicaNumNeurons(grpDest) - 1; // last neuron of replica 0
+	for(int j = grp_Info[grpDest].StartN; j <= endN; j++) { // j: the temp neuron id
+		// check whether pre-neuron location is in RF of post-neuron
+		Point3D loc_j = getNeuronLocation3D(j); // 3D coordinates of j
 
-			// make sure point is in RF
-			double rfDist = getRFDist3D(radius,loc_i,loc_j);
-			if (rfDist < 0.0 || rfDist > 1.0)
-				continue;
+		// make sure point is in RF
+		double rfDist = getRFDist3D(radius,loc_i,loc_j);
+		if (rfDist < 0.0 || rfDist > 1.0)
+			continue;
 
-			// if rfDist is valid, it returns a number between 0 and 1
-			// we want these numbers to fit to Gaussian weigths, so that rfDist=0 corresponds to max Gaussian weight
-			// and rfDist=1 corresponds to 0.1 times max Gaussian weight
-			// so we're looking at gauss = exp(-a*rfDist), where a such that exp(-a)=0.1
-			// solving for a, we find that a = 2.3026
-			double gauss = exp(-2.3026*rfDist);
-			if (gauss < 0.1)
-				continue;
+		// if rfDist is valid, it returns a number between 0 and 1
+		// we want these numbers to fit to Gaussian weigths, so that rfDist=0 corresponds to max Gaussian weight
+		// and rfDist=1 corresponds to 0.1 times max Gaussian weight
+		// so we're looking at gauss = exp(-a*rfDist), where a such that exp(-a)=0.1
+		// solving for a, we find that a = 2.3026
+		double gauss = exp(-2.3026*rfDist);
+		if (gauss < 0.1)
+			continue;
 
-			if (drand48() < info->p) {
-				uint8_t dVal = info->minDelay + rand() % (info->maxDelay - info->minDelay + 1);
-				assert((dVal >= info->minDelay) && (dVal <= info->maxDelay));
-				float synWt = gauss * info->initWt; // scale weight according to gauss distance
-				setConnection(grpSrc, grpDest, i, j, synWt, info->maxWt, dVal, info->connProp, info->connId);
-				info->numberOfConnections++;
-			}
+		if (rng.nextDouble() < info->p) {
+			syn_candidate_t syn;
+			syn.postId = j;
+			syn.delay = info->minDelay + rng.nextInt(info->maxDelay - info->minDelay + 1);
+			assert((syn.delay >= info->minDelay) && (syn.delay <= info->maxDelay));
+			syn.weight = gauss * info->initWt; // scale weight according to gauss distance
+			syns.push_back(syn);
 		}
 	}
-
-	grp_Info2[grpSrc].sumPostConn += info->numberOfConnections;
-	grp_Info2[grpDest].sumPreConn += info->numberOfConnections;
 }
 
-void CpuSNN::connectOneToOne (grpConnectInfo_t* info) {
+void CpuSNN::connectOneToOne(grpConnectInfo_t* info, int preNeurId, CounterRNG& rng,
+	std::vector<syn_candidate_t>& syns)
+{
 	int grpSrc = info->grpSrc;
 	int grpDest = info->grpDest;
 	assert( grp_Info[grpDest].SizeN == grp_Info[grpSrc].SizeN );
 
 	// NOTE: RadiusRF does not make a difference here: ignore
-	for(int nid=grp_Info[grpSrc].StartN,j=grp_Info[grpDest].StartN; nid<=grp_Info[grpSrc].EndN; nid++, j++)  {
-		uint8_t dVal = info->minDelay + rand() % (info->maxDelay - info->minDelay + 1);
-		assert((dVal >= info->minDelay) && (dVal <= info->maxDelay));
-		float synWt = getWeights(info->connProp, info->initWt, info->maxWt, nid, grpSrc);
-		setConnection(grpSrc, grpDest, nid, j, synWt, info->maxWt, dVal, info->connProp, info->connId);
-		info->numberOfConnections++;
-	}
-
-	grp_Info2[grpSrc].sumPostConn += info->numberOfConnections;
-	grp_Info2[grpDest].sumPreConn += info->numberOfConnections;
+	syn_candidate_t syn;
+	syn.postId = grp_Info[grpDest].StartN + (preNeurId - grp_Info[grpSrc].StartN);
+	syn.delay = info->minDelay + rng.nextInt(info->maxDelay - info->minDelay + 1);
+	assert((syn.delay >= info->minDelay) && (syn.delay <= info->maxDelay));
+	syn.weight = getWeights(info->connProp, info->initWt, info->maxWt, preNeurId, grpSrc, rng);
+	syns.push_back(syn);
 }
 
 // make 'C' random connections from grpSrc to grpDest
-void CpuSNN::connectRandom (grpConnectInfo_t* info) {
+void CpuSNN::connectRandom(grpConnectInfo_t* info, int preNeurId, CounterRNG& rng,
+	std::vector<syn_candidate_t>& syns)
+{
 	int grpSrc = info->grpSrc;
 	int grpDest = info->grpDest;
 
 	// rebuild struct for easier handling
 	RadiusRF radius(info->radX, info->radY, info->radZ);
 
-	for(int pre_nid=grp_Info[grpSrc].StartN; pre_nid<=grp_Info[grpSrc].EndN; pre_nid++) {
-		Point3D loc_pre = getNeuronLocation3D(pre_nid); // 3D coordinates of i
-		for(int post_nid=grp_Info[grpDest].StartN; post_nid<=grp_Info[grpDest].EndN; post_nid++) {
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D loc_post = getNeuronLocation3D(post_nid); // 3D coordinates of j
-			if (!isPoint3DinRF(radius, loc_pre, loc_post))
-				continue;
+	Point3D loc_pre = getNeuronLocation3D(preNeurId); // 3D coordinates of i
+	int endN = grp_Info[grpDest].StartN + getGroupReplicaNumNeurons(grpDest) - 1; // last neuron of replica 0
+	for(int post_nid=grp_Info[grpDest].StartN; post_nid<=endN; post_nid++) {
+		// check whether pre-neuron location is in RF of post-neuron
+		Point3D loc_post = getNeuronLocation3D(post_nid); // 3D coordinates of j
+		if (!isPoint3DinRF(radius, loc_pre, loc_post))
+			continue;
 
-			if (drand48() < info->p) {
-				//uint8_t dVal = info->minDelay + (int)(0.5+(drand48()*(info->maxDelay-info->minDelay)));
-				uint8_t dVal = info->minDelay + rand() % (info->maxDelay - info->minDelay + 1);
-				assert((dVal >= info->minDelay) && (dVal <= info->maxDelay));
-				float synWt = getWeights(info->connProp, info->initWt, info->maxWt, pre_nid, grpSrc);
-				setConnection(grpSrc, grpDest, pre_nid, post_nid, synWt, info->maxWt, dVal, info->connProp, info->connId);
-				info->numberOfConnections++;
-			}
+		if (rng.nextDouble() < info->p) {
+			syn_candidate_t syn;
+			syn.postId = post_nid;
+			syn.delay = info->minDelay + rng.nextInt(info->maxDelay - info->minDelay + 1);
+			assert((syn.delay >= info->minDelay) && (syn.delay <= info->maxDelay));
+			syn.weight = getWeights(info->connProp, info->initWt, info->maxWt, preNeurId, grpSrc, rng);
+			syns.push_back(syn);
 		}
 	}
-
-	grp_Info2[grpSrc].sumPostConn += info->numberOfConnections;
-	grp_Info2[grpDest].sumPreConn += info->numberOfConnections;
 }
 
 // user-defined functions called here...
@@ -2908,9 +3588,14 @@ void CpuSNN::connectRandom (grpConnectInfo_t* info) {
 void CpuSNN::connectUserDefined (grpConnectInfo_t* info) {
 	int grpSrc = info->grpSrc;
 	int grpDest = info->grpDest;
+	int sizeN = getGroupReplicaNumNeurons(grpSrc);
+	int sizeNDest = getGroupReplicaNumNeurons(grpDest);
+	int numSynReplicas = replicasShareSynapses_ ? 1 : numReplicas_; // number of replicas that own synapses
 	info->maxDelay = 0;
-	for(int nid=grp_Info[grpSrc].StartN; nid<=grp_Info[grpSrc].EndN; nid++) {
-		for(int nid2=grp_Info[grpDest].StartN; nid2 <= grp_Info[grpDest].EndN; nid2++) {
+
+	// the callback is only asked about the neurons of replica 0; every synapse is copied to all replicas
+	for(int nid=grp_Info[grpSrc].StartN; nid<grp_Info[grpSrc].StartN+sizeN; nid++) {
+		for(int nid2=grp_Info[grpDest].StartN; nid2<grp_Info[grpDest].StartN+sizeNDest; nid2++) {
 			int srcId  = nid  - grp_Info[grpSrc].StartN;
 			int destId = nid2 - grp_Info[grpDest].StartN;
 			float weight, maxWt, delay;
@@ -2931,8 +3616,11 @@ void CpuSNN::connectUserDefined (grpConnectInfo_t* info) {
 				weight = isExcitatoryGroup(grpSrc) ? fabs(weight) : -1.0*fabs(weight);
 				maxWt  = isExcitatoryGroup(grpSrc) ? fabs(maxWt)  : -1.0*fabs(maxWt);
 
-				setConnection(grpSrc, grpDest, nid, nid2, weight, maxWt, delay, info->connProp, info->connId);
-				info->numberOfConnections++;
+				for (int r=0; r<numSynReplicas; r++) {
+					setConnection(grpSrc, grpDest, nid+r*sizeN, nid2+r*sizeNDest, weight, maxWt, delay, info->connProp,
+						info->connId);
+				}
+				info->numberOfConnections += numSynReplicas;
 				if(delay > info->maxDelay) {
 					info->maxDelay = delay;
 				}
@@ -2966,6 +3654,17 @@ void CpuSNN::printSimSummary() {
 	KERNEL_INFO("Overall Firing Count:\t2+ms delay = %d", spikeCountD2Host);
 	KERNEL_INFO("\t\t\t1ms delay = %d", spikeCountD1Host);
 	KERNEL_INFO("\t\t\tTotal = %d", spikeCountAllHost);
+	if (simMode_ == CPU_MODE) {
+		KERNEL_INFO("Spike Buffer:\t\tpeak = %u spikes/ms", spikeRingMaxSpikes_);
+		KERNEL_INFO("SIMD Kernels:\t\t%s", simdIsa_string[simdIsa_]);
+	}
+	if (threadPool_ != NULL) {
+		KERNEL_INFO("CPU Threads:\t\tnumThreads = %d", threadPool_->getNumThreads());
+		for (int t=0; t<threadPool_->getNumThreads(); t++) {
+			KERNEL_INFO("\t\t\tThread %d: Busy Time = %4.2f sec", t,
+				threadPool_->getThreadTimeMs(t)/1000.0);
+		}
+	}
 	KERNEL_INFO("*********************************************************************************\n");
 }
 
@@ -3000,12 +3699,18 @@ void CpuSNN::deleteObjects() {
 			fclose(fpErr_);
 		if (fpDeb_!=NULL && fpDeb_!=stdout && fpDeb_!=stderr)
 			fclose(fpDeb_);
-		if (fpLog_!=NULL && fpLog_!=stdout && fpLog_!=stderr)
-			fclose(fpLog_);
 	}
+	releaseLog(fpLog_, loggerMode_ == CUSTOM);
+	fpLog_ = NULL;
 
 	resetPointers(true); // deallocate pointers
 
+	// snapshots may outlive the network: they must no longer clear our weak references when they die
+	for (unsigned int i=0; i<lastSnapCopies_.size(); i++)
+		if (lastSnapCopies_[i] != NULL)
+			lastSnapCopies_[i]->clearWeakRef();
+	lastSnapCopies_.clear();
+
 #ifndef __NO_CUDA__
 	// do the same as above, but for snn_gpu.cu
 	deleteObjects_GPU();
@@ -3016,68 +3721,167 @@ void CpuSNN::deleteObjects() {
 
 
 
-// This method loops through all spikes that are generated by neurons with a delay of 1ms
-// and delivers the spikes to the appropriate post-synaptic neuron
-void CpuSNN::doD1CurrentUpdate() {
-	int k     = secD1fireCntHost-1;
-	int k_end = timeTableD1[simTimeMs+maxDelay_];
+// delivers the spike of neuron preId to all its synapses with delay tD+1 that are owned by thread threadId
+// If the network is simulated by a single thread (threadSynIdx_ empty), all synapses are visited. Otherwise, only the
+// synapses onto the post-synaptic neurons owned by the thread are visited, in the same order as the single-threaded
+// version, so that all updates to a post-synaptic neuron are applied in the exact same order.
+inline void CpuSNN::deliverSpike(int preId, int tD, int threadId, int* daSpikeCnt) {
+	// if replicas share synapses, the spike travels along the synapses of the same neuron in replica 0
+	int synPreId = preId;
+	int replica = 0;
+	if (replicasShareSynapses_) {
+		int grpId = grpIds[preId];
+		int sizeN = getGroupReplicaNumNeurons(grpId);
+		replica = (preId - grp_Info[grpId].StartN)/sizeN;
+		synPreId = preId - replica*sizeN;
+	}
 
-	while((k>=k_end) && (k>=0)) {
+	delay_info_t dPar = postDelayInfo[synPreId*(maxDelay_+1)+tD];
+	unsigned int offset = cumulativePost[synPreId];
+	unsigned int idxStart = dPar.delay_index_start;
+	unsigned int idxEnd = dPar.delay_index_start + dPar.delay_length;
 
-		int neuron_id      = firingTableD1[k];
-		assert(neuron_id<numN);
-
-		delay_info_t dPar = postDelayInfo[neuron_id*(maxDelay_+1)];
+	if (threadSynIdx_.empty()) {
+		for (unsigned int idx_d=idxStart; idx_d<idxEnd; idx_d++)
+			generatePostSpike(preId, idx_d, offset, tD, replica, daSpikeCnt);
+	} else {
+		// the synapses of this thread are sorted by idx_d, and synapses with the same delay are stored contiguously
+		const unsigned int* first = &threadSynIdx_[0] + threadSynStart_[threadId*(numN+1)+preId];
+		const unsigned int* last = &threadSynIdx_[0] + threadSynStart_[threadId*(numN+1)+preId+1];
+		for (const unsigned int* p=std::lower_bound(first, last, idxStart); p!=last && *p<idxEnd; ++p)
+			generatePostSpike(preId, *p, offset, tD, replica, daSpikeCnt);
+	}
+}
 
-		unsigned int  offset = cumulativePost[neuron_id];
+// This method loops through all spikes that are generated by neurons with a delay of 1ms
+// and delivers the spikes to the appropriate post-synaptic neuron
+// Only synapses onto post-synaptic neurons owned by thread threadId are considered. This allows multiple threads to
+// deliver spikes in parallel without ever writing to the same post-synaptic neuron.
+void CpuSNN::doD1CurrentUpdate(int threadId, int* daSpikeCnt) {
+	// spikes of the current time step, latest spike first
+	const std::vector<int>& spikes = spikeRing_[SPIKE_RING_POS(0)].nidD1;
+
+	for (int k=(int)spikes.size()-1; k>=0; k--) {
+		int neuron_id      = spikes[k];
+		assert(neuron_id<numN);
 
-		for(int idx_d = dPar.delay_index_start;
-			idx_d < (dPar.delay_index_start + dPar.delay_length);
-			idx_d = idx_d+1) {
-				generatePostSpike( neuron_id, idx_d, offset, 0);
-		}
-		k=k-1;
+		deliverSpike(neuron_id, 0, threadId, daSpikeCnt);
 	}
 }
 
 // This method loops through all spikes that are generated by neurons with a delay of 2+ms
 // and delivers the spikes to the appropriate post-synaptic neuron
-void CpuSNN::doD2CurrentUpdate() {
-	int k = secD2fireCntHost-1;
-	int k_end = timeTableD2[simTimeMs+1];
-	int t_pos = simTimeMs;
+// Only synapses onto post-synaptic neurons owned by thread threadId are considered.
+void CpuSNN::doD2CurrentUpdate(int threadId, int* daSpikeCnt) {
+	// a spike emitted tD ms ago is delivered to all synapses with delay tD+1
+	// latest spike first: this is the order in which spikes used to be stored in the firing table
+	for (int tD=0; tD<maxDelay_; tD++) {
+		const std::vector<int>& spikes = spikeRing_[SPIKE_RING_POS(tD)].nidD2;
+
+		for (int k=(int)spikes.size()-1; k>=0; k--) {
+			int i = spikes[k];
+			assert(i<numN);
+
+			deliverSpike(i, tD, threadId, daSpikeCnt);
+		}
+	}
+}
+
+// thread pool entry point for spike delivery: every thread owns a contiguous block of post-synaptic neurons
+// Every thread walks through the spikes in the same order as the single-threaded version, but only visits the
+// synapses it owns (see initThreadSynapseIndex).
+void CpuSNN::doCurrentUpdateThread(void* snn, int threadId, int numThreads) {
+	CpuSNN* self = (CpuSNN*)snn;
 
-	while((k>=k_end)&& (k >=0)) {
+	// dopamine concentration is per group, and groups can be split among threads: count the dopaminergic spikes
+	// per thread and apply them in doCurrentUpdate once all threads are done
+	int* daSpikeCnt = &self->threadDASpikeCnt_[threadId*self->numGrp];
+	memset(daSpikeCnt, 0, sizeof(int)*self->numGrp);
+
+	self->doD2CurrentUpdate(threadId, daSpikeCnt);
+	self->doD1CurrentUpdate(threadId, daSpikeCnt);
+}
 
-		// get the neuron id from the index k
-		int i  = firingTableD2[k];
+// sorts the synapses of every pre-synaptic neuron by the thread that owns their post-synaptic neuron
+// Thread t owns the block of regular neurons numNReg*t/numThreads_ .. numNReg*(t+1)/numThreads_-1. For every thread
+// and pre-synaptic neuron, threadSynIdx_ lists the positions (idx_d) of the synapses onto neurons owned by that
+// thread in increasing order; threadSynStart_ points to the beginning of that list.
+void CpuSNN::initThreadSynapseIndex() {
+	threadSynIdx_.clear();
+	threadSynStart_.clear();
+	if (numThreads_ <= 1)
+		return;
+
+	threadSynIdx_.reserve(postSynCnt);
+	threadSynStart_.resize(numThreads_*(numN+1));
+	for (int t=0; t<numThreads_; t++) {
+		unsigned int lNeurId = (unsigned int)((long long)numNReg * t / numThreads_);
+		unsigned int rNeurId = (unsigned int)((long long)numNReg * (t+1) / numThreads_); // exclusive
+		for (int i=0; i<numN; i++) {
+			threadSynStart_[t*(numN+1)+i] = threadSynIdx_.size();
+
+			// with shared synapses, neuron i uses the synapses of replica 0 (see deliverSpike)
+			int synPreId = i;
+			int replica = 0;
+			if (replicasShareSynapses_) {
+				int sizeN = getGroupReplicaNumNeurons(grpIds[i]);
+				replica = (i - grp_Info[grpIds[i]].StartN)/sizeN;
+				synPreId = i - replica*sizeN;
+			}
 
-		// find the time of firing from the timeTable using index k
-		while (!(((unsigned int)k >= timeTableD2[t_pos+maxDelay_]) 
-			&& ((unsigned int)k < timeTableD2[t_pos+maxDelay_+1]))) {
-			t_pos = t_pos - 1;
-			assert((t_pos+maxDelay_-1)>=0);
+			unsigned int offset = cumulativePost[synPreId];
+			for (unsigned int idx_d=0; idx_d<Npost[synPreId]; idx_d++) {
+				unsigned int post_i = GET_CONN_NEURON_ID(postSynapticIds[offset + idx_d]);
+				if (replica > 0)
+					post_i += replica*getGroupReplicaNumNeurons(grpIds[post_i]);
+				if (post_i >= lNeurId && post_i < rNeurId)
+					threadSynIdx_.push_back(idx_d);
+			}
 		}
+		threadSynStart_[t*(numN+1)+numN] = threadSynIdx_.size();
+	}
+	cpuSnnSz.synapticInfoSize += sizeof(unsigned int)*(threadSynIdx_.size() + threadSynStart_.size());
+}
 
-		// \TODO: Instead of using the complex timeTable, can neuronFiringTime value...???
-		// Calculate the time difference between time of firing of neuron and the current time...
-		int tD = simTimeMs - t_pos;
+// records the time at which the spikes delivered in this time step arrive at their synapses (per-delay arrival times)
+// This happens before and independently of spike delivery, so the threads delivering spikes never write to
+// spkArrivalTime_. It is read by findFiring in the next time step, when a post-synaptic neuron fires.
+void CpuSNN::recordSpikeArrivalTimes() {
+	const std::vector<int>& spikesD1 = spikeRing_[SPIKE_RING_POS(0)].nidD1;
+	for (unsigned int k=0; k<spikesD1.size(); k++)
+		spkArrivalTime_[spikesD1[k]*maxDelay_] = simTime;
 
-		assert((tD<maxDelay_)&&(tD>=0));
-		assert(i<numN);
+	// a spike emitted tD ms ago arrives at all synapses with delay tD+1
+	for (int tD=0; tD<maxDelay_; tD++) {
+		const std::vector<int>& spikes = spikeRing_[SPIKE_RING_POS(tD)].nidD2;
+		for (unsigned int k=0; k<spikes.size(); k++)
+			spkArrivalTime_[spikes[k]*maxDelay_ + tD] = simTime;
+	}
+}
 
-		delay_info_t dPar = postDelayInfo[i*(maxDelay_+1)+tD];
+// delivers all spikes (2+ms delay first, then 1ms delay) to their post-synaptic neurons
+void CpuSNN::doCurrentUpdate() {
+	if (stdpPerDelayArrival_)
+		recordSpikeArrivalTimes();
 
-		unsigned int offset = cumulativePost[i];
+	int numThreads = 1;
+	if (threadPool_ != NULL) {
+		numThreads = threadPool_->getNumThreads();
+		threadPool_->run(&CpuSNN::doCurrentUpdateThread, this);
+	} else {
+		doCurrentUpdateThread(this, 0, 1);
+	}
 
-		// for each delay variables
-		for(int idx_d = dPar.delay_index_start;
-			idx_d < (dPar.delay_index_start + dPar.delay_length);
-			idx_d = idx_d+1) {
-			generatePostSpike( i, idx_d, offset, tD);
+	// every dopaminergic spike increases the concentration of the post-synaptic group by the same amount
+	// the total number of spikes per group is independent of the number of threads, and so is the result
+	for (int g=0; g<numGrp; g++) {
+		int daSpikeCnt = 0;
+		for (int t=0; t<numThreads; t++) {
+			daSpikeCnt += threadDASpikeCnt_[t*numGrp+g];
+		}
+		for (int n=0; n<daSpikeCnt; n++) {
+			cpuNetPtrs.grpDA[g] += 0.04;
 		}
-
-		k=k-1;
 	}
 }
 
@@ -3087,6 +3891,11 @@ void CpuSNN::doSnnSim() {
 		checkSpikeCounterRecordDur();
 	}
 
+	// the slot of the current time step held the spikes of maxDelay_ ms ago, which have all been delivered
+	spike_slot_t& slot = spikeRing_[SPIKE_RING_POS(0)];
+	slot.nidD1.clear();
+	slot.nidD2.clear();
+
 	// decay STP vars and conductances
 	globalStateDecay();
 
@@ -3098,11 +3907,18 @@ void CpuSNN::doSnnSim() {
 	// find the neurons that has fired..
 	findFiring();
 
-	timeTableD2[simTimeMs+maxDelay_+1] = secD2fireCntHost;
-	timeTableD1[simTimeMs+maxDelay_+1] = secD1fireCntHost;
+	// the synaptic arrays change during this time step (see takeSnapshot)
+	if (sim_with_stdp && !sim_in_testing)
+		wtVersion_ = ++stateVersionCnt_;
+	if (synSpikeTime != NULL && !replicasShareSynapses_)
+		synSpikeTimeVersion_ = ++stateVersionCnt_;
+
+	firingLogTimeD1_[simTimeMs+1] = firingLogD1_.size();
+	firingLogTimeD2_[simTimeMs+1] = firingLogD2_.size();
+	if (slot.nidD1.size() + slot.nidD2.size() > spikeRingMaxSpikes_)
+		spikeRingMaxSpikes_ = slot.nidD1.size() + slot.nidD2.size();
 
-	doD2CurrentUpdate();
-	doD1CurrentUpdate();
+	doCurrentUpdate();
 
 	globalStateUpdate();
 
@@ -3110,13 +3926,11 @@ void CpuSNN::doSnnSim() {
 }
 
 void CpuSNN::globalStateDecay() {
-	int spikeBufferFull = 0;
-
 	// having outer loop is grpId produces slightly more code (every flag needs its own neurId inner loop)
 	// but avoids having to check the condition for every neuron in the network (= faster)
 
 	// decay the STP variables before adding new spikes.
-	for (int grpId=0; (grpId < numGrp) & !spikeBufferFull; grpId++) {
+	for (int grpId=0; grpId < numGrp; grpId++) {
 		// decay homeostasis avg firing
 		if (grp_Info[grpId].WithHomeostasis) {
 			for(int i=grp_Info[grpId].StartN; i<=grp_Info[grpId].EndN; i++) {
@@ -3174,9 +3988,7 @@ void CpuSNN::globalStateDecay() {
 }
 
 void CpuSNN::findFiring() {
-	int spikeBufferFull = 0;
-
-	for(int g=0; (g < numGrp) & !spikeBufferFull; g++) {
+	for(int g=0; g < numGrp; g++) {
 		// given group of neurons belong to the poisson group....
 		if (grp_Info[g].Type&POISSON_NEURON)
 			continue;
@@ -3197,60 +4009,37 @@ void CpuSNN::findFiring() {
 					int bufNeur = i-grp_Info[g].StartN;
 					spkCntBuf[bufPos][bufNeur]++;
 				}
-				spikeBufferFull = addSpikeToTable(i, g);
-
-				if (spikeBufferFull)
-					break;
+				addSpikeToTable(i, g);
 
 				// STDP calculation: the post-synaptic neuron fires after the arrival of a pre-synaptic spike
 				if (!sim_in_testing && grp_Info[g].WithSTDP) {
+					const std::vector<double>& lutExc = stdpLutPlusExc_[g];
+					const std::vector<double>& lutInh = stdpLutPlusInh_[g];
 					unsigned int pos_ij = cumulativePre[i]; // the index of pre-synaptic neuron
+					if (wtUpdateIncremental_)
+						wtUpdateDirty_[i] = 1;
 					for(int j=0; j < Npre_plastic[i]; pos_ij++, j++) {
-						int stdp_tDiff = (simTime-synSpikeTime[pos_ij]);
-						assert(!((stdp_tDiff < 0) && (synSpikeTime[pos_ij] != MAX_SIMULATION_TIME)));
+						if (wtUpdateIncremental_ && synWtUpdateCnt_[pos_ij] < wtUpdateCnt_)
+							catchUpWeight(g, i, pos_ij);
+
+						int stdp_tDiff;
+						if (stdpPerDelayArrival_) {
+							// all synapses of a pre-neuron with the same delay receive its spikes at the same time
+							int preId = GET_CONN_NEURON_ID(preSynapticIds[pos_ij]);
+							uint32_t arrivalTime = spkArrivalTime_[preId*maxDelay_ + preSynDelay_[pos_ij]-1];
+							stdp_tDiff = (simTime-arrivalTime);
+							assert(!((stdp_tDiff < 0) && (arrivalTime != MAX_SIMULATION_TIME)));
+						} else {
+							stdp_tDiff = (simTime-synSpikeTime[pos_ij]);
+							assert(!((stdp_tDiff < 0) && (synSpikeTime[pos_ij] != MAX_SIMULATION_TIME)));
+						}
 
 						if (stdp_tDiff > 0) {
 							// check this is an excitatory or inhibitory synapse
 							if (grp_Info[g].WithESTDP && maxSynWt[pos_ij] >= 0) { // excitatory synapse
-								// Handle E-STDP curve
-								switch (grp_Info[g].WithESTDPcurve) {
-								case EXP_CURVE: // exponential curve
-									if (stdp_tDiff * grp_Info[g].TAU_PLUS_INV_EXC < 25)
-										wtChange[pos_ij] += STDP(stdp_tDiff, grp_Info[g].ALPHA_PLUS_EXC, grp_Info[g].TAU_PLUS_INV_EXC);
-									break;
-								case TIMING_BASED_CURVE: // sc curve
-									if (stdp_tDiff * grp_Info[g].TAU_PLUS_INV_EXC < 25) {
-										if (stdp_tDiff <= grp_Info[g].GAMMA)
-											wtChange[pos_ij] += grp_Info[g].OMEGA + grp_Info[g].KAPPA * STDP(stdp_tDiff, grp_Info[g].ALPHA_PLUS_EXC, grp_Info[g].TAU_PLUS_INV_EXC);
-										else // stdp_tDiff > GAMMA
-											wtChange[pos_ij] -= STDP(stdp_tDiff, grp_Info[g].ALPHA_PLUS_EXC, grp_Info[g].TAU_PLUS_INV_EXC);
-									}
-									break;
-								default:
-									KERNEL_ERROR("Invalid E-STDP curve!");
-									break;
-								}
+								wtChange[pos_ij] += stdpLookup(lutExc, g, true, true, stdp_tDiff);
 							} else if (grp_Info[g].WithISTDP && maxSynWt[pos_ij] < 0) { // inhibitory synapse
-								// Handle I-STDP curve
-								switch (grp_Info[g].WithISTDPcurve) {
-								case EXP_CURVE: // exponential curve
-									if (stdp_tDiff * grp_Info[g].TAU_PLUS_INV_INB < 25) { // LTP of inhibitory synapse, which decreases synapse weight
-										wtChange[pos_ij] -= STDP(stdp_tDiff, grp_Info[g].ALPHA_PLUS_INB, grp_Info[g].TAU_PLUS_INV_INB);
-									}
-									break;
-								case PULSE_CURVE: // pulse curve
-									if (stdp_tDiff <= grp_Info[g].LAMBDA) { // LTP of inhibitory synapse, which decreases synapse weight
-										wtChange[pos_ij] -= grp_Info[g].BETA_LTP;
-										//printf("I-STDP LTP\n");
-									} else if (stdp_tDiff <= grp_Info[g].DELTA) { // LTD of inhibitory syanpse, which increase sysnapse weight
-										wtChange[pos_ij] -= grp_Info[g].BETA_LTD;
-										//printf("I-STDP LTD\n");
-									} else { /*do nothing*/}
-									break;
-								default:
-									KERNEL_ERROR("Invalid I-STDP curve!");
-									break;
-								}
+								wtChange[pos_ij] += stdpLookup(lutInh, g, false, true, stdp_tDiff);
 							}
 						}
 					}
@@ -3288,24 +4077,31 @@ void CpuSNN::findMaxNumSynapses(int* numPostSynapses, int* numPreSynapses) {
 	}
 }
 
-void CpuSNN::generatePostSpike(unsigned int pre_i, unsigned int idx_d, unsigned int offset, unsigned int tD) {
+void CpuSNN::generatePostSpike(unsigned int pre_i, unsigned int idx_d, unsigned int offset, unsigned int tD,
+	int replica, int* daSpikeCnt)
+{
 	// get synaptic info...
 	post_info_t post_info = postSynapticIds[offset + idx_d];
 
-	// get post-neuron id
-	unsigned int post_i = GET_CONN_NEURON_ID(post_info);
-	assert(post_i<(unsigned int)numN);
+	// get post-neuron id (of the neuron that owns the synapse)
+	unsigned int synPost_i = GET_CONN_NEURON_ID(post_info);
+	assert(synPost_i<(unsigned int)numN);
 
 	// get syn id
 	int s_i = GET_CONN_SYN_ID(post_info);
-	assert(s_i<(Npre[post_i]));
+	assert(s_i<(Npre[synPost_i]));
 
 	// get the cumulative position for quick access
-	unsigned int pos_i = cumulativePre[post_i] + s_i;
-	assert(post_i < (unsigned int)numNReg); // \FIXME is this assert supposed to be for pos_i?
+	unsigned int pos_i = cumulativePre[synPost_i] + s_i;
 
 	// get group id of pre- / post-neuron
-	short int post_grpId = grpIds[post_i];
+	short int post_grpId = grpIds[synPost_i];
+
+	// with shared synapses, the spike goes to the same post-synaptic neuron in the replica of the pre-synaptic neuron
+	unsigned int post_i = synPost_i;
+	if (replica > 0)
+		post_i += replica*getGroupReplicaNumNeurons(post_grpId);
+	assert(post_i < (unsigned int)numNReg); // \FIXME is this assert supposed to be for pos_i?
 	short int pre_grpId = grpIds[pre_i];
 
 	unsigned int pre_type = grp_Info[pre_grpId].Type;
@@ -3318,6 +4114,10 @@ void CpuSNN::generatePostSpike(unsigned int pre_i, unsigned int idx_d, unsigned
 	assert(mulIndex>=0 && mulIndex<numConnections);
 
 
+	// incremental weight update: the weight might not be up to date
+	if (wtUpdateIncremental_ && synWtUpdateCnt_[pos_i] < wtUpdateCnt_)
+		catchUpWeight(post_grpId, synPost_i, pos_i);
+
 	// for each presynaptic spike, postsynaptic (synaptic) current is going to increase by some amplitude (change)
 	// generally speaking, this amplitude is the weight; but it can be modulated by STP
 	float change = wt[pos_i];
@@ -3367,49 +4167,26 @@ void CpuSNN::generatePostSpike(unsigned int pre_i, unsigned int idx_d, unsigned
 		current[post_i] += change;
 	}
 
-	synSpikeTime[pos_i] = simTime;
+	if (!stdpPerDelayArrival_ && !replicasShareSynapses_) // shared synapses are only used in testing mode
+		synSpikeTime[pos_i] = simTime;
 
 	// Got one spike from dopaminergic neuron, increase dopamine concentration in the target area
+	// (counted per group, will be applied in doCurrentUpdate)
 	if (pre_type & TARGET_DA) {
-		cpuNetPtrs.grpDA[post_grpId] += 0.04;
+		daSpikeCnt[post_grpId]++;
 	}
 
 	// STDP calculation: the post-synaptic neuron fires before the arrival of a pre-synaptic spike
 	if (!sim_in_testing && grp_Info[post_grpId].WithSTDP) {
 		int stdp_tDiff = (simTime-lastSpikeTime[post_i]);
+		if (wtUpdateIncremental_)
+			wtUpdateDirty_[post_i] = 1;
 
 		if (stdp_tDiff >= 0) {
 			if (grp_Info[post_grpId].WithISTDP && ((pre_type & TARGET_GABAa) || (pre_type & TARGET_GABAb))) { // inhibitory syanpse
-				// Handle I-STDP curve
-				switch (grp_Info[post_grpId].WithISTDPcurve) {
-				case EXP_CURVE: // exponential curve
-					if ((stdp_tDiff*grp_Info[post_grpId].TAU_MINUS_INV_INB)<25) { // LTD of inhibitory syanpse, which increase synapse weight
-						wtChange[pos_i] -= STDP(stdp_tDiff, grp_Info[post_grpId].ALPHA_MINUS_INB, grp_Info[post_grpId].TAU_MINUS_INV_INB);
-					}
-					break;
-				case PULSE_CURVE: // pulse curve
-					if (stdp_tDiff <= grp_Info[post_grpId].LAMBDA) { // LTP of inhibitory synapse, which decreases synapse weight
-						wtChange[pos_i] -= grp_Info[post_grpId].BETA_LTP;
-					} else if (stdp_tDiff <= grp_Info[post_grpId].DELTA) { // LTD of inhibitory syanpse, which increase synapse weight
-						wtChange[pos_i] -= grp_Info[post_grpId].BETA_LTD;
-					} else { /*do nothing*/ }
-					break;
-				default:
-					KERNEL_ERROR("Invalid I-STDP curve");
-					break;
-				}
+				wtChange[pos_i] += stdpLookup(stdpLutMinusInh_[post_grpId], post_grpId, false, false, stdp_tDiff);
 			} else if (grp_Info[post_grpId].WithESTDP && ((pre_type & TARGET_AMPA) || (pre_type & TARGET_NMDA))) { // excitatory synapse
-				// Handle E-STDP curve
-				switch (grp_Info[post_grpId].WithESTDPcurve) {
-				case EXP_CURVE: // exponential curve
-				case TIMING_BASED_CURVE: // sc curve
-					if (stdp_tDiff * grp_Info[post_grpId].TAU_MINUS_INV_EXC < 25)
-						wtChange[pos_i] += STDP(stdp_tDiff, grp_Info[post_grpId].ALPHA_MINUS_EXC, grp_Info[post_grpId].TAU_MINUS_INV_EXC);
-					break;
-				default:
-					KERNEL_ERROR("Invalid E-STDP curve");
-					break;
-				}
+				wtChange[pos_i] += stdpLookup(stdpLutMinusExc_[post_grpId], post_grpId, true, false, stdp_tDiff);
 			} else { /*do nothing*/ }
 		}
 		assert(!((stdp_tDiff < 0) && (lastSpikeTime[post_i] != MAX_SIMULATION_TIME)));
@@ -3434,6 +4211,12 @@ void CpuSNN::generateSpikes() {
 
 	// advance the time step to the next phase...
 	pbuf->nextTimeStep();
+
+	// Poisson groups in per-step mode bypass the spike buffer
+	for (int g=0; g<numGrp; g++) {
+		if (grp_Info[g].PoissonPerStep)
+			generateSpikesPerStep(g);
+	}
 }
 
 void CpuSNN::generateSpikesFromFuncPtr(int grpId) {
@@ -3510,6 +4293,8 @@ void CpuSNN::generateSpikesFromRate(int grpId) {
 		exitSimulation(1);
 	}
 
+	// one stream per group and time slice, drawn from in neuron order
+	CounterRNG rng(randSeed_, RNG_STREAM_ID(RNG_STREAM_POISSON_ISI, grpId, currTime));
 	for (int neurId=0; neurId<nNeur; neurId++) {
 		float frate = rate->getRate(neurId);
 
@@ -3520,7 +4305,7 @@ void CpuSNN::generateSpikesFromRate(int grpId) {
 
 		done = false;
 		while (!done && frate>0) {
-			nextTime = poissonSpike(nextTime, frate/1000.0, refPeriod);
+			nextTime = poissonSpike(nextTime, frate/1000.0, refPeriod, rng);
 			// found a valid timeSlice
 			if (nextTime < (currTime+timeSlice)) {
 				if (nextTime >= currTime) {
@@ -3528,16 +4313,75 @@ void CpuSNN::generateSpikesFromRate(int grpId) {
 					pbuf->scheduleSpikeTargetGroup(grp_Info[grpId].StartN + neurId, nextTime-currTime);
 					spikeCnt++;
 
-					// update number of spikes if SpikeCounter set
-					if (grp_Info[grpId].withSpikeCounter) {
-						int bufPos = grp_Info[grpId].spkCntBufPos; // retrieve buf pos
-						spkCntBuf[bufPos][neurId]++;
-					}
-				}
-			}
-			else {
-				done=true;
-			}
+					// update number of spikes if SpikeCounter set
+					if (grp_Info[grpId].withSpikeCounter) {
+						int bufPos = grp_Info[grpId].spkCntBufPos; // retrieve buf pos
+						spkCntBuf[bufPos][neurId]++;
+					}
+				}
+			}
+			else {
+				done=true;
+			}
+		}
+	}
+}
+
+// per-step Poisson mode: draws the spikes of the current time step and adds them to the firing table right away
+// Every neuron that is not refractory fires with probability rate/1000. Instead of drawing a random number for every
+// neuron, we draw the distance to the next candidate neuron from a geometric distribution with the largest firing
+// probability in the group (pMax), and accept every candidate with probability p/pMax (thinning). This needs a
+// number of random draws proportional to the number of spikes rather than the number of neurons.
+// Random numbers come from a stream keyed by group and time step, so they are the same no matter when or how often
+// the group is evaluated.
+void CpuSNN::generateSpikesPerStep(int grpId) {
+	PoissonRate* rate = grp_Info[grpId].RatePtr;
+	if (rate == NULL)
+		return;
+
+	assert(!rate->isOnGPU());
+	const float* rates = rate->getRatePtrCPU();
+	const int nNeur = grp_Info[grpId].SizeN;
+
+	// rates are read once per time slice, just like in the default mode
+	float pMax = poissonMaxProb_[grpId];
+	if (pMax < 0.0f) {
+		pMax = 0.0f;
+		for (int neurId=0; neurId<nNeur; neurId++)
+			pMax = (std::max)(pMax, rates[neurId]/1000.0f);
+		pMax = (std::min)(pMax, 1.0f);
+		poissonMaxProb_[grpId] = pMax;
+	}
+	if (pMax == 0.0f)
+		return;
+
+	CounterRNG rng(randSeed_, RNG_STREAM_ID(RNG_STREAM_POISSON, grpId, simTime));
+	const double logQ = log(1.0 - pMax); // -inf if pMax==1: every neuron is a candidate
+	const unsigned int refPeriod = (unsigned int)grp_Info[grpId].RefractPeriod;
+	int neurId = -1;
+	while (true) {
+		// number of neurons to skip until the next candidate, drawn from (0,1] so that log is finite
+		double skip = (pMax < 1.0f) ? floor(log(1.0 - rng.nextDouble()) / logQ) : 0.0;
+		if (neurId + 1 + skip >= nNeur)
+			break;
+		neurId += 1 + (int)skip;
+
+		float p = rates[neurId]/1000.0f;
+		if (p < pMax && rng.nextDouble()*pMax >= p)
+			continue;
+
+		int nid = grp_Info[grpId].StartN + neurId;
+		if (lastSpikeTime[nid] != MAX_SIMULATION_TIME && simTime - lastSpikeTime[nid] < refPeriod)
+			continue; // refractory
+
+		addSpikeToTable(nid, grpId);
+		spikeCountAll1secHost++;
+		nPoissonSpikes++;
+
+		// update number of spikes if SpikeCounter set
+		if (grp_Info[grpId].withSpikeCounter) {
+			int bufPos = grp_Info[grpId].spkCntBufPos; // retrieve buf pos
+			spkCntBuf[bufPos][neurId]++;
 		}
 	}
 }
@@ -3553,7 +4397,7 @@ inline int CpuSNN::getPoissNeuronPos(int nid) {
 //We need pass the neuron id (nid) and the grpId just for the case when we want to
 //ramp up/down the weights.  In that case we need to set the weights of each synapse
 //depending on their nid (their position with respect to one another). -- KDC
-float CpuSNN::getWeights(int connProp, float initWt, float maxWt, unsigned int nid, int grpId) {
+float CpuSNN::getWeights(int connProp, float initWt, float maxWt, unsigned int nid, int grpId, CounterRNG& rng) {
 	float actWts;
 	// \FIXME: are these ramping thingies still supported?
 	bool setRandomWeights   = GET_INITWTS_RANDOM(connProp);
@@ -3561,7 +4405,7 @@ float CpuSNN::getWeights(int connProp, float initWt, float maxWt, unsigned int n
 	bool setRampUpWeights   = GET_INITWTS_RAMPUP(connProp);
 
 	if (setRandomWeights)
-		actWts = initWt * drand48();
+		actWts = initWt * rng.nextDouble();
 	else if (setRampUpWeights)
 		actWts = (initWt + ((nid - grp_Info[grpId].StartN) * (maxWt - initWt) / grp_Info[grpId].SizeN));
 	else if (setRampDownWeights)
@@ -3626,179 +4470,360 @@ void  CpuSNN::globalStateUpdate() {
 
 			// update group dopamine
 			cpuNetPtrs.grpDABuffer[g][simTimeMs] = cpuNetPtrs.grpDA[g];
+		}
 
-			for (int i=grp_Info[g].StartN; i<=grp_Info[g].EndN; i++) {
-				// pre-load izhikevich variables to avoid unnecessary memory accesses + unclutter the code.
-				float k = Izh_k[i];
-				float vr = Izh_vr[i];
-				float vt = Izh_vt[i];
-				float inverse_C = 1.0f / Izh_C[i];
-				float a = Izh_a[i];
-				float b = Izh_b[i];
-
-				// sum up total current = synaptic + external + compartmental
-				float totalCurrent = extCurrent[i];
-				if (sim_with_conductances) { // COBA model
-					float tmp_gNMDA = sim_with_NMDA_rise ? gNMDA_d[i]-gNMDA_r[i] : gNMDA[i];
-					float tmp_gGABAb = sim_with_GABAb_rise ? gGABAb_d[i]-gGABAb_r[i] : gGABAb[i];
-					float tmp_iNMDA = (voltage[i] + 80.0f) * (voltage[i] + 80.0f) / 60.0f / 60.0f;
-
-					totalCurrent += -(gAMPA[i] * (voltage[i] - 0.0f) +
-						tmp_gNMDA * tmp_iNMDA / (1.0f + tmp_iNMDA) * (voltage[i] - 0.0f) +
-						gGABAa[i] * (voltage[i] + 70.0f) +
-						tmp_gGABAb * (voltage[i] + 90.0f));
-				} else { // CUBA model
-					totalCurrent += current[i];
-				}
-				if (grp_Info[g].withCompartments) {
-					totalCurrent += getCompCurrent(g, i);
-				}
-
-				switch (simIntegrationMethod_) {
-				case FORWARD_EULER:
-					if (!grp_Info[g].withParamModel_9) {
-						// 4-param Izhikevich
-						nextVoltage[i] = voltage[i] + dvdtIzhikevich4(voltage[i], recovery[i], totalCurrent, timeStep_);
-						if (nextVoltage[i] > 30.0f) {
-							nextVoltage[i] = 30.0f;
-							curSpike[i] = true;
-							nextVoltage[i] = Izh_c[i];
-							recovery[i] += Izh_d[i];
-						}
-					} else {
-						// 9-param Izhikevich
-						nextVoltage[i] = voltage[i] + dvdtIzhikevich9(voltage[i], recovery[i], inverse_C, k, vr, vt, 
-							totalCurrent, timeStep_);
-						if (nextVoltage[i] > Izh_vpeak[i]) {
-							nextVoltage[i] = Izh_vpeak[i];
-							curSpike[i] = true;
-							nextVoltage[i] = Izh_c[i];
-							recovery[i] += Izh_d[i];
-						}
-					}
-					if (nextVoltage[i] < -90.0f) {
-						nextVoltage[i] = -90.0f;
-					}
-					#if defined(WIN32) || defined(WIN64)
-						assert(!_isnan(nextVoltage[i]));
-						assert(_finite(nextVoltage[i]));
-					#else
-						assert(!isnan(nextVoltage[i]));
-						assert(!isinf(nextVoltage[i]));
-					#endif
-
-					// To maintain consistency with Izhikevich' original Matlab code, recovery is based on nextVoltage.
-					if (!grp_Info[g].withParamModel_9) {
-						recovery[i] += dudtIzhikevich4(nextVoltage[i], recovery[i], a, b, timeStep_);
-					} else {
-						recovery[i] += dudtIzhikevich9(nextVoltage[i], recovery[i], vr, a, b, timeStep_);
-					}
-
-					break;
-				case RUNGE_KUTTA4:
-					// TODO for Stas
-					if (!grp_Info[g].withParamModel_9) {
-						// 4-param Izhikevich
-						float k1 = dvdtIzhikevich4(voltage[i], recovery[i], totalCurrent, timeStep_);
-						float l1 = dudtIzhikevich4(voltage[i], recovery[i], a, b, timeStep_);
-
-						float k2 = dvdtIzhikevich4(voltage[i] + k1/2.0f, recovery[i] + l1/2.0f, totalCurrent, 
-							timeStep_);
-						float l2 = dudtIzhikevich4(voltage[i] + k1/2.0f, recovery[i] + l1/2.0f, a, b, timeStep_);
-
-						float k3 = dvdtIzhikevich4(voltage[i] + k2/2.0f, recovery[i] + l2/2.0f, totalCurrent, 
-							timeStep_);
-						float l3 = dudtIzhikevich4(voltage[i] + k2/2.0f, recovery[i] + l2/2.0f, a, b, timeStep_);
-
-						float k4 = dvdtIzhikevich4(voltage[i] + k3, recovery[i] + l3, totalCurrent, timeStep_);
-						float l4 = dudtIzhikevich4(voltage[i] + k3, recovery[i] + l3, a, b, timeStep_);
-
-						nextVoltage[i] = voltage[i] + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
-						if (nextVoltage[i] > 30.0f) {
-							nextVoltage[i] = 30.0f;
-							curSpike[i] = true;
-							nextVoltage[i] = Izh_c[i];
-							recovery[i] += Izh_d[i];
-						}
-						if (nextVoltage[i] < -90.0f) {
-							nextVoltage[i] = -90.0f;
-						}
-						#if defined(WIN32) || defined(WIN64)
-						assert(!_isnan(nextVoltage[i]));
-						assert(_finite(nextVoltage[i]));
-						#else
-						assert(!isnan(nextVoltage[i]));
-						assert(!isinf(nextVoltage[i]));
-						#endif
-
-						recovery[i] += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
-					} else {
-						// 9-param Izhikevich
-
-						float k1 = dvdtIzhikevich9(voltage[i], recovery[i], inverse_C, k, vr, vt, totalCurrent, 
-							timeStep_);
-						float l1 = dudtIzhikevich9(voltage[i], recovery[i], vr, a, b, timeStep_);
-
-						float k2 = dvdtIzhikevich9(voltage[i] + k1/2.0f, recovery[i] + l1/2.0f, inverse_C, k, vr, vt, 
-							totalCurrent, timeStep_);
-						float l2 = dudtIzhikevich9(voltage[i] + k1/2.0f, recovery[i] + l1/2.0f, vr, a, b, timeStep_);
-
-						float k3 = dvdtIzhikevich9(voltage[i] + k2/2.0f, recovery[i] + l2/2.0f, inverse_C, k, vr, vt,
-							totalCurrent, timeStep_);
-						float l3 = dudtIzhikevich9(voltage[i] + k2/2.0f, recovery[i] + l2/2.0f, vr, a, b, timeStep_);
-
-						float k4 = dvdtIzhikevich9(voltage[i] + k3, recovery[i] + l3, inverse_C, k, vr, vt, 
-							totalCurrent, timeStep_);
-						float l4 = dudtIzhikevich9(voltage[i] + k3, recovery[i] + l3, vr, a, b, timeStep_);
-
-						nextVoltage[i] = voltage[i] + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
-
-						if (nextVoltage[i] > Izh_vpeak[i]) {
-							nextVoltage[i] = Izh_vpeak[i];
-							curSpike[i] = true;
-							nextVoltage[i] = Izh_c[i];
-							recovery[i] += Izh_d[i];
-						}
-
-						if (nextVoltage[i] < -90.0f) {
-							nextVoltage[i] = -90.0f;
-						}
-						#if defined(WIN32) || defined(WIN64)
-						assert(!_isnan(nextVoltage[i]));
-						assert(_finite(nextVoltage[i]));
-						#else
-						assert(!isnan(nextVoltage[i]));
-						assert(!isinf(nextVoltage[i]));
-						#endif
-
-						recovery[i] += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
-					}
-					break;
-				case UNKNOWN_INTEGRATION:
-				default:
-					KERNEL_ERROR("Unknown integration method.");
-					exitSimulation(1);
-				}
-			}  // end StartN...EndN
-		}  // end numGrp
+		// Every neuron only writes to its own entries of nextVoltage, recovery, and curSpike, and only reads from
+		// voltage. Thus the neurons can be split among threads without changing the result.
+		if (threadPool_ != NULL) {
+			threadPool_->run(&CpuSNN::globalStateUpdateThread, this);
+		} else {
+			globalStateUpdateNeurons(0, numNReg-1);
+		}
 
 		// Only after we are done computing nextVoltage for all neurons do we copy the new values to the voltage array.
-		// This is crucial for GPU (asynchronous kernel launch) and in the future for a multi-threaded CARLsim version.
+		// This is crucial for GPU (asynchronous kernel launch) and for multi-threaded CPU mode.
 		memcpy(voltage, nextVoltage, sizeof(float)*numNReg);
 	}  // end simNumStepsPerMs_ loop
 }
 
+// integrates the state of all regular neurons with ID lNeurId..rNeurId (inclusive) by a single integration step
+void CpuSNN::globalStateUpdateNeurons(int lNeurId, int rNeurId) {
+	for (unsigned int k=0; k<neurUpdateDesc_.size(); k++) {
+		const neur_update_desc_t& desc = neurUpdateDesc_[k];
+		int startN = desc.StartN > lNeurId ? desc.StartN : lNeurId;
+		int endN = desc.EndN < rNeurId ? desc.EndN : rNeurId;
+		if (startN <= endN)
+			(this->*desc.kernel)(desc.grpId, startN, endN);
+	}
+}
+
+// voltage equation of the Izhikevich model, the number of parameters is resolved at compile time
+template<bool IZH9>
+inline float dvdtIzhikevich(float volt, float recov, float invCapac, float izhK, float voltRest, float voltInst,
+	float totalCurrent, float timeStep)
+{
+	return IZH9 ? dvdtIzhikevich9(volt, recov, invCapac, izhK, voltRest, voltInst, totalCurrent, timeStep)
+		: dvdtIzhikevich4(volt, recov, totalCurrent, timeStep);
+}
+
+// recovery equation of the Izhikevich model, the number of parameters is resolved at compile time
+template<bool IZH9>
+inline float dudtIzhikevich(float volt, float recov, float voltRest, float izhA, float izhB, float timeStep) {
+	return IZH9 ? dudtIzhikevich9(volt, recov, voltRest, izhA, izhB, timeStep)
+		: dudtIzhikevich4(volt, recov, izhA, izhB, timeStep);
+}
+
+// State update of neurons lNeurId..rNeurId of group grpId. All model flags are template parameters, so that every
+// instantiation is a straight loop without any per-neuron branching on the network configuration.
+template<bool COBA, bool NMDA_RISE, bool GABAB_RISE, bool COMPARTMENTS, bool IZH9, bool RK4>
+void CpuSNN::updateNeuronsKernel(int grpId, int lNeurId, int rNeurId) {
+	// local copies of all pointers: keeps the compiler from reloading them after every store
+	const float* vCur = voltage;
+	float* vNext = nextVoltage;
+	float* u = recovery;
+	bool* spike = curSpike;
+	const float* iExt = extCurrent;
+	const float dt = timeStep_;
+
+	for (int i=lNeurId; i<=rNeurId; i++) {
+		// pre-load izhikevich variables to avoid unnecessary memory accesses + unclutter the code.
+		float v = vCur[i];
+		float k = IZH9 ? Izh_k[i] : 0.0f;
+		float vr = IZH9 ? Izh_vr[i] : 0.0f;
+		float vt = IZH9 ? Izh_vt[i] : 0.0f;
+		float inverse_C = IZH9 ? 1.0f / Izh_C[i] : 1.0f;
+		float vpeak = IZH9 ? Izh_vpeak[i] : 30.0f;
+		float a = Izh_a[i];
+		float b = Izh_b[i];
+
+		// sum up total current = synaptic + external + compartmental
+		float totalCurrent = iExt[i];
+		if (COBA) {
+			float tmp_gNMDA = NMDA_RISE ? gNMDA_d[i]-gNMDA_r[i] : gNMDA[i];
+			float tmp_gGABAb = GABAB_RISE ? gGABAb_d[i]-gGABAb_r[i] : gGABAb[i];
+			float tmp_iNMDA = (v + 80.0f) * (v + 80.0f) / 60.0f / 60.0f;
+
+			totalCurrent += -(gAMPA[i] * (v - 0.0f) +
+				tmp_gNMDA * tmp_iNMDA / (1.0f + tmp_iNMDA) * (v - 0.0f) +
+				gGABAa[i] * (v + 70.0f) +
+				tmp_gGABAb * (v + 90.0f));
+		} else {
+			totalCurrent += current[i];
+		}
+		if (COMPARTMENTS) {
+			totalCurrent += getCompCurrent(grpId, i);
+		}
+
+		float vNew;
+		float du = 0.0f;
+		if (!RK4) {
+			// forward Euler
+			vNew = v + dvdtIzhikevich<IZH9>(v, u[i], inverse_C, k, vr, vt, totalCurrent, dt);
+		} else {
+			// Runge-Kutta 4th order
+			float k1 = dvdtIzhikevich<IZH9>(v, u[i], inverse_C, k, vr, vt, totalCurrent, dt);
+			float l1 = dudtIzhikevich<IZH9>(v, u[i], vr, a, b, dt);
+
+			float k2 = dvdtIzhikevich<IZH9>(v + k1/2.0f, u[i] + l1/2.0f, inverse_C, k, vr, vt, totalCurrent, dt);
+			float l2 = dudtIzhikevich<IZH9>(v + k1/2.0f, u[i] + l1/2.0f, vr, a, b, dt);
+
+			float k3 = dvdtIzhikevich<IZH9>(v + k2/2.0f, u[i] + l2/2.0f, inverse_C, k, vr, vt, totalCurrent, dt);
+			float l3 = dudtIzhikevich<IZH9>(v + k2/2.0f, u[i] + l2/2.0f, vr, a, b, dt);
+
+			float k4 = dvdtIzhikevich<IZH9>(v + k3, u[i] + l3, inverse_C, k, vr, vt, totalCurrent, dt);
+			float l4 = dudtIzhikevich<IZH9>(v + k3, u[i] + l3, vr, a, b, dt);
+
+			vNew = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+			du = (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+		}
+
+		if (vNew > vpeak) {
+			spike[i] = true;
+			vNew = Izh_c[i];
+			u[i] += Izh_d[i];
+		}
+		if (vNew < -90.0f) {
+			vNew = -90.0f;
+		}
+		#if defined(WIN32) || defined(WIN64)
+			assert(!_isnan(vNew));
+			assert(_finite(vNew));
+		#else
+			assert(!isnan(vNew));
+			assert(!isinf(vNew));
+		#endif
+		vNext[i] = vNew;
+
+		if (!RK4) {
+			// To maintain consistency with Izhikevich' original Matlab code, recovery is based on nextVoltage.
+			u[i] += dudtIzhikevich<IZH9>(vNew, u[i], vr, a, b, dt);
+		} else {
+			u[i] += du;
+		}
+	}
+}
+
+// neuron update kernel for groups without compartments, vectorized with the instruction set simdIsa_
+void CpuSNN::updateNeuronsSIMD(int grpId, int lNeurId, int rNeurId) {
+	izh_kernel_args_t args;
+	args.voltage = voltage;
+	args.nextVoltage = nextVoltage;
+	args.recovery = recovery;
+	args.curSpike = curSpike;
+	args.extCurrent = extCurrent;
+	args.current = current;
+	args.gAMPA = gAMPA;
+	args.gNMDA = gNMDA;
+	args.gNMDA_r = gNMDA_r;
+	args.gNMDA_d = gNMDA_d;
+	args.gGABAa = gGABAa;
+	args.gGABAb = gGABAb;
+	args.gGABAb_r = gGABAb_r;
+	args.gGABAb_d = gGABAb_d;
+	args.Izh_a = Izh_a;
+	args.Izh_b = Izh_b;
+	args.Izh_c = Izh_c;
+	args.Izh_d = Izh_d;
+	args.Izh_C = Izh_C;
+	args.Izh_k = Izh_k;
+	args.Izh_vr = Izh_vr;
+	args.Izh_vt = Izh_vt;
+	args.Izh_vpeak = Izh_vpeak;
+	args.timeStep = timeStep_;
+	args.withConductances = sim_with_conductances;
+	args.withNMDARise = sim_with_NMDA_rise;
+	args.withGABAbRise = sim_with_GABAb_rise;
+	args.withParamModel_9 = grp_Info[grpId].withParamModel_9;
+	args.withRungeKutta4 = (simIntegrationMethod_ == RUNGE_KUTTA4);
+
+	updateIzhikevichSIMD(simdIsa_, args, lNeurId, rNeurId);
+}
+
+// Picks the instantiation of updateNeuronsKernel that matches the configuration of every regular group. This is done
+// once at setupNetwork, so that globalStateUpdate does not have to look at the network configuration at all.
+void CpuSNN::initNeuronUpdateKernels() {
+	#define NEUR_KERNEL(c,n,g,m,p,r) &CpuSNN::updateNeuronsKernel<c,n,g,m,p,r>
+	#define NEUR_KERNEL_R(c,n,g,m,p) NEUR_KERNEL(c,n,g,m,p,false), NEUR_KERNEL(c,n,g,m,p,true)
+	#define NEUR_KERNEL_P(c,n,g,m) NEUR_KERNEL_R(c,n,g,m,false), NEUR_KERNEL_R(c,n,g,m,true)
+	#define NEUR_KERNEL_M(c,n,g) NEUR_KERNEL_P(c,n,g,false), NEUR_KERNEL_P(c,n,g,true)
+	#define NEUR_KERNEL_G(c,n) NEUR_KERNEL_M(c,n,false), NEUR_KERNEL_M(c,n,true)
+	#define NEUR_KERNEL_N(c) NEUR_KERNEL_G(c,false), NEUR_KERNEL_G(c,true)
+
+	// indexed by the bits (COBA, NMDA_RISE, GABAB_RISE, COMPARTMENTS, IZH9, RK4), from high to low
+	static const neurUpdateKernel_t kernels[64] = { NEUR_KERNEL_N(false), NEUR_KERNEL_N(true) };
+
+	#undef NEUR_KERNEL_N
+	#undef NEUR_KERNEL_G
+	#undef NEUR_KERNEL_M
+	#undef NEUR_KERNEL_P
+	#undef NEUR_KERNEL_R
+	#undef NEUR_KERNEL
+
+	if (simIntegrationMethod_ != FORWARD_EULER && simIntegrationMethod_ != RUNGE_KUTTA4) {
+		KERNEL_ERROR("Unknown integration method.");
+		exitSimulation(1);
+	}
+
+	neurUpdateDesc_.clear();
+	for (int g=0; g<numGrp; g++) {
+		if (grp_Info[g].Type & POISSON_NEURON)
+			continue;
+
+		// rise times only matter in COBA mode
+		int idx = (sim_with_conductances ? 32 : 0)
+			+ ((sim_with_conductances && sim_with_NMDA_rise) ? 16 : 0)
+			+ ((sim_with_conductances && sim_with_GABAb_rise) ? 8 : 0)
+			+ (grp_Info[g].withCompartments ? 4 : 0)
+			+ (grp_Info[g].withParamModel_9 ? 2 : 0)
+			+ ((simIntegrationMethod_ == RUNGE_KUTTA4) ? 1 : 0);
+
+		neur_update_desc_t desc;
+		desc.grpId = g;
+		desc.StartN = grp_Info[g].StartN;
+		desc.EndN = grp_Info[g].EndN;
+		desc.kernel = kernels[idx];
+
+		// compartmental currents depend on the voltage of neighboring neurons: leave those to the scalar kernels
+		if (simdIsa_ != SIMD_NONE && !grp_Info[g].withCompartments)
+			desc.kernel = &CpuSNN::updateNeuronsSIMD;
+		neurUpdateDesc_.push_back(desc);
+	}
+}
+
+// thread pool entry point for globalStateUpdate: every thread integrates a contiguous block of regular neurons
+void CpuSNN::globalStateUpdateThread(void* snn, int threadId, int numThreads) {
+	CpuSNN* self = (CpuSNN*)snn;
+	int lNeurId = (int)((long long)self->numNReg * threadId / numThreads);
+	int rNeurId = (int)((long long)self->numNReg * (threadId+1) / numThreads) - 1;
+	self->globalStateUpdateNeurons(lNeurId, rNeurId);
+}
+
 // initialize all the synaptic weights to appropriate values..
 // total size of the synaptic connection is 'length' ...
 void CpuSNN::initSynapticWeights() {
 	// Initialize the network wtChange, wt, synaptic firing time
 	wtChange         = new float[preSynCnt];
-	synSpikeTime     = new uint32_t[preSynCnt];
-	cpuSnnSz.synapticInfoSize = sizeof(float)*(preSynCnt*2);
+	cpuSnnSz.synapticInfoSize = sizeof(float)*preSynCnt;
+	if (stdpPerDelayArrival_) {
+		spkArrivalTime_  = new uint32_t[numN*maxDelay_];
+		cpuSnnSz.synapticInfoSize += sizeof(uint32_t)*numN*maxDelay_;
+	} else {
+		synSpikeTime     = new uint32_t[preSynCnt];
+		cpuSnnSz.synapticInfoSize += sizeof(uint32_t)*preSynCnt;
+	}
 
 	resetSynapticConnections(false);
 }
 
+// evaluates the STDP curve of group g at spike-time difference t (ms): the weight change of an excitatory (isExc) or
+// inhibitory synapse when a post-synaptic spike follows a pre-synaptic one (isPlus), or the other way around.
+// Returns zero beyond the end of the curve.
+double CpuSNN::stdpCurve(int g, bool isExc, bool isPlus, int t) {
+	const group_info_t& gi = grp_Info[g];
+	if (isExc) {
+		if (!isPlus) // LTD is exponential for both curves
+			return (t * gi.TAU_MINUS_INV_EXC < 25) ? STDP(t, gi.ALPHA_MINUS_EXC, gi.TAU_MINUS_INV_EXC) : 0.0;
+		if (t * gi.TAU_PLUS_INV_EXC >= 25)
+			return 0.0;
+		if (gi.WithESTDPcurve == TIMING_BASED_CURVE)
+			return (t <= gi.GAMMA) ? gi.OMEGA + gi.KAPPA * STDP(t, gi.ALPHA_PLUS_EXC, gi.TAU_PLUS_INV_EXC)
+				: -STDP(t, gi.ALPHA_PLUS_EXC, gi.TAU_PLUS_INV_EXC);
+		return STDP(t, gi.ALPHA_PLUS_EXC, gi.TAU_PLUS_INV_EXC);
+	}
+
+	if (gi.WithISTDPcurve == PULSE_CURVE) { // the same for both directions
+		if (t <= gi.LAMBDA) // LTP of inhibitory synapse, which decreases synapse weight
+			return -gi.BETA_LTP;
+		if (t <= gi.DELTA) // LTD of inhibitory syanpse, which increase sysnapse weight
+			return -gi.BETA_LTD;
+		return 0.0;
+	}
+	if (isPlus) // LTP of inhibitory synapse, which decreases synapse weight
+		return (t * gi.TAU_PLUS_INV_INB < 25) ? -STDP(t, gi.ALPHA_PLUS_INB, gi.TAU_PLUS_INV_INB) : 0.0;
+	// LTD of inhibitory syanpse, which increase synapse weight
+	return (t * gi.TAU_MINUS_INV_INB < 25) ? -STDP(t, gi.ALPHA_MINUS_INB, gi.TAU_MINUS_INV_INB) : 0.0;
+}
+
+// looks up the weight change at spike-time difference t in an STDP table
+// Tables are cut off at STDP_LUT_MAX_SIZE entries; beyond that, the curve is evaluated directly.
+inline double CpuSNN::stdpLookup(const std::vector<double>& lut, int g, bool isExc, bool isPlus, int t) {
+	if ((unsigned int)t < lut.size())
+		return lut[t];
+	return (lut.size() == STDP_LUT_MAX_SIZE) ? stdpCurve(g, isExc, isPlus, t) : 0.0;
+}
+
+// Samples the STDP curves of every group at integer spike-time differences, so that findFiring and
+// generatePostSpike can look up the weight change instead of evaluating exp() for every pair of spikes.
+// Every entry holds exactly the value the per-spike code used to add to wtChange, so results are unchanged.
+// A table ends where its curve ends (25 time constants, or the end of the pulse), but never holds more than
+// STDP_LUT_MAX_SIZE entries, so that very long time constants do not blow up memory (see stdpLookup).
+void CpuSNN::initSTDPLookupTables() {
+	stdpLutPlusExc_.assign(numGrp, std::vector<double>());
+	stdpLutPlusInh_.assign(numGrp, std::vector<double>());
+	stdpLutMinusExc_.assign(numGrp, std::vector<double>());
+	stdpLutMinusInh_.assign(numGrp, std::vector<double>());
+
+	for (int g=0; g<numGrp; g++) {
+		if (!grp_Info[g].WithSTDP)
+			continue;
+
+		if (grp_Info[g].WithESTDP) {
+			if (grp_Info[g].WithESTDPcurve != EXP_CURVE && grp_Info[g].WithESTDPcurve != TIMING_BASED_CURVE)
+				KERNEL_ERROR("Invalid E-STDP curve!");
+			for (int t=0; t<STDP_LUT_MAX_SIZE && t * grp_Info[g].TAU_PLUS_INV_EXC < 25; t++)
+				stdpLutPlusExc_[g].push_back(stdpCurve(g, true, true, t));
+			for (int t=0; t<STDP_LUT_MAX_SIZE && t * grp_Info[g].TAU_MINUS_INV_EXC < 25; t++)
+				stdpLutMinusExc_[g].push_back(stdpCurve(g, true, false, t));
+		}
+
+		if (grp_Info[g].WithISTDP) {
+			switch (grp_Info[g].WithISTDPcurve) {
+			case EXP_CURVE: // exponential curve
+				for (int t=0; t<STDP_LUT_MAX_SIZE && t * grp_Info[g].TAU_PLUS_INV_INB < 25; t++)
+					stdpLutPlusInh_[g].push_back(stdpCurve(g, false, true, t));
+				for (int t=0; t<STDP_LUT_MAX_SIZE && t * grp_Info[g].TAU_MINUS_INV_INB < 25; t++)
+					stdpLutMinusInh_[g].push_back(stdpCurve(g, false, false, t));
+				break;
+			case PULSE_CURVE: // pulse curve, the same for both directions
+				for (int t=0; t<STDP_LUT_MAX_SIZE && (t <= grp_Info[g].LAMBDA || t <= grp_Info[g].DELTA); t++)
+					stdpLutPlusInh_[g].push_back(stdpCurve(g, false, true, t));
+				stdpLutMinusInh_[g] = stdpLutPlusInh_[g];
+				break;
+			default:
+				KERNEL_ERROR("Invalid I-STDP curve!");
+				break;
+			}
+		}
+	}
+}
+
+// per-delay arrival times: instead of stamping every synapse with the arrival time of the last spike (synSpikeTime),
+// we record the arrival time once per pre-synaptic neuron and delay (spkArrivalTime_), and look it up via the delay of
+// the synapse (preSynDelay_)
+void CpuSNN::initPerDelayArrivalTimes() {
+	assert(stdpPerDelayArrival_);
+	if (preSynDelay_ != NULL)
+		return; // already done
+
+	// the delay of a synapse is only stored in post-synaptic order: sort it into pre-synaptic order
+	preSynDelay_ = new uint8_t[preSynCnt];
+	memset(preSynDelay_, 0, preSynCnt);
+	cpuSnnSz.synapticInfoSize += sizeof(uint8_t)*preSynCnt;
+	for (int i=0; i<numN; i++) {
+		unsigned int offset = cumulativePost[i];
+		for (int t=0; t<maxDelay_; t++) {
+			delay_info_t dPar = postDelayInfo[i*(maxDelay_+1)+t];
+			for (int idx_d=dPar.delay_index_start; idx_d<dPar.delay_index_start+dPar.delay_length; idx_d++) {
+				post_info_t post_info = postSynapticIds[offset + idx_d];
+				unsigned int post_i = GET_CONN_NEURON_ID(post_info);
+				unsigned int pos_i = cumulativePre[post_i] + GET_CONN_SYN_ID(post_info);
+				assert(pos_i < preSynCnt);
+				preSynDelay_[pos_i] = t+1;
+			}
+		}
+	}
+}
+
 // checks whether a connection ID contains plastic synapses O(#connections)
 bool CpuSNN::isConnectionPlastic(short int connId) {
 	assert(connId!=ALL);
@@ -4064,7 +5089,7 @@ void CpuSNN::makePtrInfo() {
 // The time between each pair of consecutive events has an exponential distribution with parameter \lambda and
 // each of these ISI values is assumed to be independent of other ISI values.
 // What follows a Poisson distribution is the actual number of spikes sent during a certain interval.
-unsigned int CpuSNN::poissonSpike(unsigned int currTime, float frate, int refractPeriod) {
+unsigned int CpuSNN::poissonSpike(unsigned int currTime, float frate, int refractPeriod, CounterRNG& rng) {
 	// refractory period must be 1 or greater, 0 means could have multiple spikes specified at the same time.
 	assert(refractPeriod>0);
 	assert(frate>=0.0f);
@@ -4073,11 +5098,11 @@ unsigned int CpuSNN::poissonSpike(unsigned int currTime, float frate, int refrac
 	unsigned int nextTime = 0;
 	while (!done) {
 		// A Poisson process will always generate inter-spike-interval (ISI) values from an exponential distribution.
-		float randVal = drand48();
+		float randVal = 1.0-rng.nextDouble(); // in (0,1], so that log is finite
 		unsigned int tmpVal  = -log(randVal)/frate;
 
 		// add new ISI to current time
-		// this might be faster than keeping currTime fixed until drand48() returns a large enough value for the ISI
+		// this might be faster than keeping currTime fixed until rng returns a large enough value for the ISI
 		nextTime = currTime + tmpVal;
 
 		// reject new firing time if ISI is smaller than refractory period
@@ -4515,46 +5540,70 @@ void CpuSNN::resetNeuromodulator(int grpId) {
 	grpNE[grpId] = grp_Info[grpId].baseNE;
 }
 
-void CpuSNN::resetNeuron(unsigned int neurId, int grpId) {
+// draws the Izhikevich parameters (and the homeostatic base firing rate) of a neuron from the group parameters
+void CpuSNN::initNeuronParameters(unsigned int neurId, int grpId) {
 	assert(neurId < (unsigned int)numNReg);
     if (grp_Info2[grpId].Izh_a == -1) {
 		KERNEL_ERROR("setNeuronParameters must be called for group %s (%d)",grp_Info2[grpId].Name.c_str(),grpId);
 		exitSimulation(1);
 	}
 
-	Izh_C[neurId] = grp_Info2[grpId].Izh_C + grp_Info2[grpId].Izh_C_sd*(float)drand48();
-	Izh_k[neurId] = grp_Info2[grpId].Izh_k + grp_Info2[grpId].Izh_k_sd*(float)drand48();
-	Izh_vr[neurId] = grp_Info2[grpId].Izh_vr + grp_Info2[grpId].Izh_vr_sd*(float)drand48();
-	Izh_vt[neurId] = grp_Info2[grpId].Izh_vt + grp_Info2[grpId].Izh_vt_sd*(float)drand48();
-	Izh_a[neurId] = grp_Info2[grpId].Izh_a + grp_Info2[grpId].Izh_a_sd*(float)drand48();
-	Izh_b[neurId] = grp_Info2[grpId].Izh_b + grp_Info2[grpId].Izh_b_sd*(float)drand48();
-	Izh_vpeak[neurId] = grp_Info2[grpId].Izh_vpeak + grp_Info2[grpId].Izh_vpeak_sd*(float)drand48();
-	Izh_c[neurId] = grp_Info2[grpId].Izh_c + grp_Info2[grpId].Izh_c_sd*(float)drand48();
-	Izh_d[neurId] = grp_Info2[grpId].Izh_d + grp_Info2[grpId].Izh_d_sd*(float)drand48();
-
-	// initialize membrane potential to reset potential
-	float vreset = grp_Info[grpId].withParamModel_9 ? Izh_vr[neurId] : Izh_c[neurId];
-	voltage[neurId] = nextVoltage[neurId] = vreset;
+	// a replica might replace the mean values of the group
+	float izh_a = grp_Info2[grpId].Izh_a;
+	float izh_b = grp_Info2[grpId].Izh_b;
+	float izh_c = grp_Info2[grpId].Izh_c;
+	float izh_d = grp_Info2[grpId].Izh_d;
+	if (!replicaIzhParams_.empty()) {
+		int replica = (neurId-grp_Info[grpId].StartN)/getGroupReplicaNumNeurons(grpId);
+		for (unsigned int i=0; i<replicaIzhParams_.size(); i++) {
+			if (replicaIzhParams_[i].grpId==grpId && replicaIzhParams_[i].replica==replica) {
+				izh_a = replicaIzhParams_[i].Izh_a;
+				izh_b = replicaIzhParams_[i].Izh_b;
+				izh_c = replicaIzhParams_[i].Izh_c;
+				izh_d = replicaIzhParams_[i].Izh_d;
+			}
+		}
+	}
 
-	// recovery is initialized to 0 in 9-param model
-	recovery[neurId] = grp_Info[grpId].withParamModel_9 ? 0.0f : Izh_b[neurId]*voltage[neurId];
+	// parameters depend only on the seed and the neuron, so a reset restores exactly the same neuron
+	CounterRNG rng(randSeed_, RNG_STREAM_ID(RNG_STREAM_NEURON_PARAMS, 0, neurId));
+	Izh_C[neurId] = grp_Info2[grpId].Izh_C + grp_Info2[grpId].Izh_C_sd*(float)rng.nextDouble();
+	Izh_k[neurId] = grp_Info2[grpId].Izh_k + grp_Info2[grpId].Izh_k_sd*(float)rng.nextDouble();
+	Izh_vr[neurId] = grp_Info2[grpId].Izh_vr + grp_Info2[grpId].Izh_vr_sd*(float)rng.nextDouble();
+	Izh_vt[neurId] = grp_Info2[grpId].Izh_vt + grp_Info2[grpId].Izh_vt_sd*(float)rng.nextDouble();
+	Izh_a[neurId] = izh_a + grp_Info2[grpId].Izh_a_sd*(float)rng.nextDouble();
+	Izh_b[neurId] = izh_b + grp_Info2[grpId].Izh_b_sd*(float)rng.nextDouble();
+	Izh_vpeak[neurId] = grp_Info2[grpId].Izh_vpeak + grp_Info2[grpId].Izh_vpeak_sd*(float)rng.nextDouble();
+	Izh_c[neurId] = izh_c + grp_Info2[grpId].Izh_c_sd*(float)rng.nextDouble();
+	Izh_d[neurId] = izh_d + grp_Info2[grpId].Izh_d_sd*(float)rng.nextDouble();
 
  	if (grp_Info[grpId].WithHomeostasis) {
 		// set the baseFiring with some standard deviation.
-		if (drand48()>0.5)   {
-			baseFiring[neurId] = grp_Info2[grpId].baseFiring + grp_Info2[grpId].baseFiringSD*-log(drand48());
+		if (rng.nextDouble()>0.5)   {
+			baseFiring[neurId] = grp_Info2[grpId].baseFiring + grp_Info2[grpId].baseFiringSD*-log(1.0-rng.nextDouble());
 		} else  {
-			baseFiring[neurId] = grp_Info2[grpId].baseFiring - grp_Info2[grpId].baseFiringSD*-log(drand48());
+			baseFiring[neurId] = grp_Info2[grpId].baseFiring - grp_Info2[grpId].baseFiringSD*-log(1.0-rng.nextDouble());
 			if(baseFiring[neurId] < 0.1) baseFiring[neurId] = 0.1;
 		}
 
-		if (grp_Info2[grpId].baseFiring != 0.0) {
-			avgFiring[neurId]  = baseFiring[neurId];
-		} else {
+		if (grp_Info2[grpId].baseFiring == 0.0)
 			baseFiring[neurId] = 0.0;
-			avgFiring[neurId]  = 0;
-		}
 	}
+}
+
+void CpuSNN::resetNeuron(unsigned int neurId, int grpId) {
+	initNeuronParameters(neurId, grpId);
+
+	// initialize membrane potential to reset potential
+	float vreset = grp_Info[grpId].withParamModel_9 ? Izh_vr[neurId] : Izh_c[neurId];
+	voltage[neurId] = nextVoltage[neurId] = vreset;
+
+	// recovery is initialized to 0 in 9-param model
+	recovery[neurId] = grp_Info[grpId].withParamModel_9 ? 0.0f : Izh_b[neurId]*voltage[neurId];
+
+	// the average firing rate starts out at the target rate
+	if (grp_Info[grpId].WithHomeostasis)
+		avgFiring[neurId] = baseFiring[neurId];
 
 	lastSpikeTime[neurId]  = MAX_SIMULATION_TIME;
 
@@ -4595,6 +5644,10 @@ void CpuSNN::resetPointers(bool deallocate) {
 		connMonList[i]=NULL;
 	}
 
+	// the monitor cores have handed their files to the writer, which writes and closes them
+	if (monWriter_!=NULL && deallocate) delete monWriter_;
+	monWriter_=NULL;
+
 	// delete all Spike Counters
 	for (int i=0; i<numSpkCnt; i++) {
 		if (spkCntBuf[i]!=NULL && deallocate)
@@ -4606,6 +5659,9 @@ void CpuSNN::resetPointers(bool deallocate) {
 	if (spikeGenBits!=NULL && deallocate) delete[] spikeGenBits;
 	pbuf=NULL; spikeGenBits=NULL;
 
+	if (threadPool_!=NULL && deallocate) delete threadPool_;
+	threadPool_=NULL;
+
 	// clear all existing connection info
 	if (deallocate) {
 		while (connectBegin) {
@@ -4710,6 +5766,12 @@ void CpuSNN::resetPointers(bool deallocate) {
 
 	if (lastSpikeTime!=NULL && deallocate) delete[] lastSpikeTime;
 	if (synSpikeTime !=NULL && deallocate) delete[] synSpikeTime;
+	if (spkArrivalTime_!=NULL && deallocate) delete[] spkArrivalTime_;
+	if (preSynDelay_!=NULL && deallocate) delete[] preSynDelay_;
+	spkArrivalTime_=NULL; preSynDelay_=NULL;
+	if (synWtUpdateCnt_!=NULL && deallocate) delete[] synWtUpdateCnt_;
+	if (wtUpdateDirty_!=NULL && deallocate) delete[] wtUpdateDirty_;
+	synWtUpdateCnt_=NULL; wtUpdateDirty_=NULL;
 	if (nSpikeCnt!=NULL && deallocate) delete[] nSpikeCnt;
 	lastSpikeTime=NULL; synSpikeTime=NULL; nSpikeCnt=NULL;
 
@@ -4761,7 +5823,7 @@ void CpuSNN::resetPoissonNeuron(unsigned int nid, int grpId) {
 }
 
 void CpuSNN::resetPropogationBuffer() {
-	pbuf->reset(0, 1023);
+	pbuf->reset(0, PROPAGATED_BUFFER_SIZE);
 }
 
 // resets nSpikeCnt[]
@@ -4793,6 +5855,11 @@ void CpuSNN::resetSpikeCnt(int grpId) {
 //are but we should be able to change them to plastic or fixed synapses. -- KDC
 void CpuSNN::resetSynapticConnections(bool changeWeights) {
 	int j;
+	if (stdpPerDelayArrival_) {
+		for (int i=0; i<numN*maxDelay_; i++)
+			spkArrivalTime_[i] = MAX_SIMULATION_TIME;
+	}
+
 	// Reset wt,wtChange,pre-firingtime values to default values...
 	for(int destGrp=0; destGrp < numGrp; destGrp++) {
 		const char* updateStr = (grp_Info[destGrp].newUpdates == true)?"(**)":"";
@@ -4802,10 +5869,13 @@ void CpuSNN::resetSynapticConnections(bool changeWeights) {
 					grp_Info[destGrp].EndN, updateStr);
 
 		for(int nid=grp_Info[destGrp].StartN; nid <= grp_Info[destGrp].EndN; nid++) {
+			// random initial weights are redrawn from a stream per post-synaptic neuron: the same every time
+			CounterRNG rng(randSeed_, RNG_STREAM_ID(RNG_STREAM_RESET_WEIGHTS, 0, nid));
 			unsigned int offset = cumulativePre[nid];
 			for (j=0;j<Npre[nid]; j++) {
 				wtChange[offset+j] = 0.0;						// synaptic derivatives is reset
-				synSpikeTime[offset+j] = MAX_SIMULATION_TIME;	// some large negative value..
+				if (!stdpPerDelayArrival_)
+					synSpikeTime[offset+j] = MAX_SIMULATION_TIME;	// some large negative value..
 			}
 			post_info_t *preIdPtr = &preSynapticIds[cumulativePre[nid]];
 			float* synWtPtr       = &wt[cumulativePre[nid]];
@@ -4847,7 +5917,7 @@ void CpuSNN::resetSynapticConnections(bool changeWeights) {
 				// if connection was plastic or if the connection weights were updated we need to reset the weights
 				// TODO: How to account for user-defined connection reset
 				if ((synWtType == SYN_PLASTIC) || connInfo->newUpdates) {
-					*synWtPtr = getWeights(connInfo->connProp, connInfo->initWt, connInfo->maxWt, nid, srcGrp);
+					*synWtPtr = getWeights(connInfo->connProp, connInfo->initWt, connInfo->maxWt, nid, srcGrp, rng);
 					*maxWtPtr = connInfo->maxWt;
 				}
 			}
@@ -4864,8 +5934,19 @@ void CpuSNN::resetSynapticConnections(bool changeWeights) {
 }
 
 void CpuSNN::resetTimingTable() {
+	if (simMode_ == GPU_MODE) {
 		memset(timeTableD2, 0, sizeof(int) * (1000 + maxDelay_ + 1));
 		memset(timeTableD1, 0, sizeof(int) * (1000 + maxDelay_ + 1));
+	}
+
+	for (unsigned int t=0; t<spikeRing_.size(); t++) {
+		spikeRing_[t].nidD1.clear();
+		spikeRing_[t].nidD2.clear();
+	}
+	firingLogD1_.clear();
+	firingLogD2_.clear();
+	std::fill(firingLogTimeD1_.begin(), firingLogTimeD1_.end(), 0);
+	std::fill(firingLogTimeD2_.begin(), firingLogTimeD2_.end(), 0);
 }
 
 
@@ -4979,13 +6060,37 @@ int CpuSNN::setRandSeed(int seed) {
 // of all variable for carrying out the simulation..
 // this code is run only one time during network initialization
 void CpuSNN::setupNetwork(bool removeTempMem) {
+	// the thread pool is needed early on: it builds the network in both CPU_MODE and GPU_MODE (see setNumThreads),
+	// and simulates it in CPU_MODE
+	if (numThreads_ > 1 && threadPool_ == NULL) {
+		threadPool_ = new ThreadPool(numThreads_);
+		KERNEL_INFO("Using %d CPU threads", numThreads_);
+	}
+
 	if(!doneReorganization)
 		reorganizeNetwork(removeTempMem);
 
+	// in GPU_MODE the pool has no more work to do once the network is built: do not keep idle threads around
+	if (simMode_ == GPU_MODE && threadPool_ != NULL) {
+		delete threadPool_;
+		threadPool_ = NULL;
+	}
+
 #ifndef __NO_CUDA__
 	if((simMode_ == GPU_MODE) && (cpu_gpuNetPtrs.allocated == false))
 		allocateSNN_GPU();
 #endif
+
+	if (simMode_ == CPU_MODE) {
+		threadDASpikeCnt_.assign(numThreads_*numGrp, 0);
+		initThreadSynapseIndex();
+		initNeuronUpdateKernels();
+		initSTDPLookupTables();
+		if (stdpPerDelayArrival_)
+			initPerDelayArrivalTimes();
+		if (wtUpdateIncremental_)
+			initIncrementalWeightUpdate();
+	}
 }
 
 #ifndef __NO_CUDA__
@@ -5016,10 +6121,12 @@ void CpuSNN::startTesting(bool shallUpdateWeights) {
 		// careful: need to temporarily adjust stdpScaleFactor to make this right
 		if (wtANDwtChangeUpdateIntervalCnt_) {
 			float storeScaleSTDP = stdpScaleFactor_;
+			flushWeightUpdates(); // pending updates must use the regular scale factor
 			stdpScaleFactor_ = 1.0f/wtANDwtChangeUpdateIntervalCnt_;
 
 			if (simMode_ == CPU_MODE) {
 				updateWeights();
+				flushWeightUpdates();
 #ifndef __NO_CUDA__
 			} else{
 				updateWeights_GPU();
@@ -5110,6 +6217,7 @@ void CpuSNN::updateConnectionMonitor(short int connId) {
 
 std::vector< std::vector<float> > CpuSNN::getWeightMatrix2D(short int connId) {
 	assert(connId!=ALL);
+	flushWeightUpdates();
 	grpConnectInfo_t* connInfo = connectBegin;
 	std::vector< std::vector<float> > wtConnId;
 
@@ -5214,8 +6322,8 @@ void CpuSNN::updateGroupMonitor(int grpId) {
 		grpMonObj->setLastUpdated(getSimTime());
 
 		// prepare fast access
-		FILE* grpFileId = groupMonCoreList[monitorId]->getGroupFileId();
-		bool writeGroupToFile = grpFileId != NULL;
+		int grpFileId = groupMonCoreList[monitorId]->getGroupFileWriterId();
+		bool writeGroupToFile = grpFileId>=0;
 		bool writeGroupToArray = grpMonObj->isRecording();
 		float data;
 
@@ -5237,8 +6345,8 @@ void CpuSNN::updateGroupMonitor(int grpId) {
 			}
 		}
 
-		if (grpFileId!=NULL) // flush group status file
-			fflush(grpFileId);
+		if (writeGroupToFile) // hand the group status to the writer, which flushes the file
+			monWriter_->submit(grpFileId);
 	}
 }
 
@@ -5259,6 +6367,9 @@ void CpuSNN::updateSpikesFromGrp(int grpId) {
 
 	if (grp_Info[grpId].spikeGen) {
 		generateSpikesFromFuncPtr(grpId);
+	} else if (grp_Info[grpId].PoissonPerStep) {
+		// spikes are drawn every time step (see generateSpikesPerStep); only pick up changed rates
+		poissonMaxProb_[grpId] = -1.0f;
 	} else {
 		// current mode is GPU, and GPU would take care of poisson generators
 		// and other information about refractor period etc. So no need to continue further...
@@ -5347,47 +6458,42 @@ int CpuSNN::updateSpikeTables() {
 			maxSpikesD2 += (grp_Info[g].SizeN * grp_Info[g].MaxFiringRate);
 	}
 
-	if ((maxSpikesD1 + maxSpikesD2) < (unsigned int) (numNExcReg + numNInhReg + numNPois)
-		 * UNKNOWN_NEURON_MAX_FIRING_RATE) {
-		KERNEL_ERROR("Insufficient amount of buffer allocated...");
-		exitSimulation(1);
-	}
+	// the firing tables are only needed in GPU mode, CPU mode uses the spike ring (which grows on demand)
+	if (simMode_ == GPU_MODE) {
+		if ((maxSpikesD1 + maxSpikesD2) < (unsigned int) (numNExcReg + numNInhReg + numNPois)
+			 * UNKNOWN_NEURON_MAX_FIRING_RATE) {
+			KERNEL_ERROR("Insufficient amount of buffer allocated...");
+			exitSimulation(1);
+		}
 
-	firingTableD2 = new unsigned int[maxSpikesD2];
-	firingTableD1 = new unsigned int[maxSpikesD1];
-	cpuSnnSz.spikingInfoSize += sizeof(int) * ((maxSpikesD2 + maxSpikesD1) + 2* (1000 + maxDelay_ + 1));
+		firingTableD2 = new unsigned int[maxSpikesD2];
+		firingTableD1 = new unsigned int[maxSpikesD1];
+		cpuSnnSz.spikingInfoSize += sizeof(int) * ((maxSpikesD2 + maxSpikesD1) + 2* (1000 + maxDelay_ + 1));
+	}
 
 	return curD;
 }
 
 // This function is called every second by simulator...
-// This function updates the firingTable by removing older firing values...
+// Spikes are delivered from the spike ring, which does not need any maintenance. All that is left to do is to
+// accumulate the spike counts and to empty the firing log (spike monitors have already been updated).
 void CpuSNN::updateFiringTable() {
-	// Read the neuron ids that fired in the last maxDelay_ seconds
-	// and put it to the beginning of the firing table...
-	for(unsigned int p=timeTableD2[999],k=0;p<timeTableD2[999+maxDelay_+1];p++,k++) {
-		firingTableD2[k]=firingTableD2[p];
-	}
-
-	for(int i=0; i < maxDelay_; i++) {
-		timeTableD2[i+1] = timeTableD2[1000+i+1]-timeTableD2[1000];
-	}
-
-	timeTableD1[maxDelay_] = 0;
-
-	/* the code of weight update has been moved to CpuSNN::updateWeights() */
-
 	spikeCountAllHost	+= spikeCountAll1secHost;
-	spikeCountD2Host += (secD2fireCntHost-timeTableD2[maxDelay_]);
+	spikeCountD2Host += secD2fireCntHost;
 	spikeCountD1Host += secD1fireCntHost;
 
 	secD1fireCntHost  = 0;
 	spikeCountAll1secHost = 0;
-	secD2fireCntHost = timeTableD2[maxDelay_];
+	secD2fireCntHost = 0;
 
 	for (int i=0; i < numGrp; i++) {
 		grp_Info[i].FiringCount1sec=0;
 	}
+
+	firingLogD1_.clear();
+	firingLogD2_.clear();
+	std::fill(firingLogTimeD1_.begin(), firingLogTimeD1_.end(), 0);
+	std::fill(firingLogTimeD2_.begin(), firingLogTimeD2_.end(), 0);
 }
 
 // updates simTime, returns true when new second started
@@ -5417,18 +6523,33 @@ void CpuSNN::updateSpikeMonitor(int grpId) {
 	if (!numSpikeMonitor)
 		return;
 
-	if (grpId==ALL) {
-		for (int g=0; g<numGrp; g++)
-			updateSpikeMonitor(g);
-	} else {
-		// update spike monitor of a specific group
-
-		// find index in spike monitor arrays
-		int monitorId = grp_Info[grpId].SpikeMonitorId;
+	// find the time interval in which to update spikes
+	// usually, we call updateSpikeMonitor once every second, so the time interval is [0,1000)
+	// however, updateSpikeMonitor can be called at any time t \in [0,1000)... so we can have the cases
+	// [0,t), [t,1000), and even [t1, t2)
+	int numMsMax = getSimTimeMs(); // upper bound is given by current time
+	if (numMsMax==0)
+		numMsMax = 1000; // special case: full second
+
+	// current time is last completed second in milliseconds (plus t to be added below)
+	// special case is after each completed second where !getSimTimeMs(): here we look 1s back
+	int currentTimeSec = getSimTimeSec();
+	if (!getSimTimeMs())
+		currentTimeSec--;
+
+	// All monitors are updated in a single pass over the spikes, instead of one pass per monitor. So first find the
+	// monitors that need an update, and the first ms they need (lower bound is given by their last update).
+	// Groups that need no update keep msMin=numMsMax, so that all of their spikes are skipped.
+	spkMonDispatch_.resize(numGrp);
+	int numMsMinAll = numMsMax;
+	for (int g=0; g<numGrp; g++) {
+		spkmon_dispatch_t& dispatch = spkMonDispatch_[g];
+		dispatch.msMin = numMsMax;
 
 		// don't continue if no spike monitor enabled for this group
-		if (monitorId<0)
-			return;
+		int monitorId = grp_Info[g].SpikeMonitorId;
+		if (monitorId<0 || (grpId!=ALL && g!=grpId))
+			continue;
 
 		// find last update time for this group
 		SpikeMonitorCore* spkMonObj = spikeMonCoreList[monitorId];
@@ -5436,94 +6557,111 @@ void CpuSNN::updateSpikeMonitor(int grpId) {
 
 		// don't continue if time interval is zero (nothing to update)
 		if ( ((int64_t)getSimTime()) - lastUpdate <=0)
-			return;
+			continue;
 
 		if ( ((int64_t)getSimTime()) - lastUpdate > 1000)
-			KERNEL_ERROR("updateSpikeMonitor(grpId=%d) must be called at least once every second",grpId);
+			KERNEL_ERROR("updateSpikeMonitor(grpId=%d) must be called at least once every second",g);
 
         // AER buffer max size warning here.
         // Because of C++ short-circuit evaluation, the last condition should not be evaluated
         // if the previous conditions are false.
         if (spkMonObj->getAccumTime() > LONG_SPIKE_MON_DURATION \
-                && this->getGroupNumNeurons(grpId) > LARGE_SPIKE_MON_GRP_SIZE \
+                && this->getGroupNumNeurons(g) > LARGE_SPIKE_MON_GRP_SIZE \
                 && spkMonObj->isBufferBig()){
             // change this warning message to correct message
-            KERNEL_WARN("updateSpikeMonitor(grpId=%d) is becoming very large. (>%ld MB)",grpId,(int64_t) MAX_SPIKE_MON_BUFFER_SIZE/1024 );// make this better
-            KERNEL_WARN("Reduce the cumulative recording time (currently %lu minutes) or the group size (currently %d) to avoid this.",spkMonObj->getAccumTime()/(1000*60),this->getGroupNumNeurons(grpId));
-		}
-#ifndef __NO_CUDA__
-		if (simMode_ == GPU_MODE) {
-			// copy the neuron firing information from the GPU to the CPU..
-			copyFiringInfo_GPU();
+            KERNEL_WARN("updateSpikeMonitor(grpId=%d) is becoming very large. (>%ld MB)",g,(int64_t) MAX_SPIKE_MON_BUFFER_SIZE/1024 );// make this better
+            KERNEL_WARN("Reduce the cumulative recording time (currently %lu minutes) or the group size (currently %d) to avoid this.",spkMonObj->getAccumTime()/(1000*60),this->getGroupNumNeurons(g));
 		}
-#endif
-
-		// find the time interval in which to update spikes
-		// usually, we call updateSpikeMonitor once every second, so the time interval is [0,1000)
-		// however, updateSpikeMonitor can be called at any time t \in [0,1000)... so we can have the cases
-		// [0,t), [t,1000), and even [t1, t2)
-		int numMsMin = lastUpdate%1000; // lower bound is given by last time we called update
-		int numMsMax = getSimTimeMs(); // upper bound is given by current time
-		if (numMsMax==0)
-			numMsMax = 1000; // special case: full second
-		assert(numMsMin<numMsMax);
-
-		// current time is last completed second in milliseconds (plus t to be added below)
-		// special case is after each completed second where !getSimTimeMs(): here we look 1s back
-		int currentTimeSec = getSimTimeSec();
-		if (!getSimTimeMs())
-			currentTimeSec--;
 
 		// save current time as last update time
 		spkMonObj->setLastUpdated( (int64_t)getSimTime() );
 
 		// prepare fast access
-		FILE* spkFileId = spikeMonCoreList[monitorId]->getSpikeFileId();
-		bool writeSpikesToFile = spkFileId!=NULL;
-		bool writeSpikesToArray = spkMonObj->getMode()==AER && spkMonObj->isRecording();
-
-		// Read one spike at a time from the buffer and put the spikes to an appopriate monitor buffer. Later the user
-		// may need need to dump these spikes to an output file
-		for (int k=0; k < 2; k++) {
-			unsigned int* timeTablePtr = (k==0)?timeTableD2:timeTableD1;
-			unsigned int* fireTablePtr = (k==0)?firingTableD2:firingTableD1;
-			for(int t=numMsMin; t<numMsMax; t++) {
-				for(unsigned int i=timeTablePtr[t+maxDelay_]; i<timeTablePtr[t+maxDelay_+1];i++) {
-					// retrieve the neuron id
-					int nid   = fireTablePtr[i];
-					if (simMode_ == GPU_MODE)
-						nid = GET_FIRING_TABLE_NID(nid);
-					assert(nid < numN);
-
-					// make sure neuron belongs to currently relevant group
-					int this_grpId = grpIds[nid];
-					if (this_grpId != grpId)
-						continue;
+		dispatch.mon = spkMonObj;
+		dispatch.fileId = spkMonObj->getSpikeFileWriterId();
+		dispatch.toArray = spkMonObj->getMode()==AER && spkMonObj->isRecording();
+		dispatch.toStats = spkMonObj->getMode()==STATS && spkMonObj->isRecording();
+		if (dispatch.fileId<0 && !dispatch.toArray && !dispatch.toStats)
+			continue; // spikes have nowhere to go
 
-					// adjust nid to be 0-indexed for each group
-					// this way, if a group has 10 neurons, their IDs in the spike file and spike monitor will be
-					// indexed from 0..9, no matter what their real nid is
-					nid -= grp_Info[grpId].StartN;
-					assert(nid>=0);
+		dispatch.msMin = lastUpdate%1000;
+		assert(dispatch.msMin<numMsMax);
+		numMsMinAll = (std::min)(numMsMinAll, dispatch.msMin);
+	}
 
-					// current time is last completed second plus whatever is leftover in t
-					int time = currentTimeSec*1000 + t;
+	// don't continue if all monitors are up-to-date
+	if (numMsMinAll==numMsMax)
+		return;
 
-					if (writeSpikesToFile) {
-						int cnt;
-						cnt = fwrite(&time, sizeof(int), 1, spkFileId); assert(cnt==1);
-						cnt = fwrite(&nid,  sizeof(int), 1, spkFileId); assert(cnt==1);
-					}
+#ifndef __NO_CUDA__
+	if (simMode_ == GPU_MODE) {
+		// copy the neuron firing information from the GPU to the CPU..
+		copyFiringInfo_GPU();
+	}
+#endif
 
-					if (writeSpikesToArray) {
-						spkMonObj->pushAER(time,nid);
-					}
+	// Read one spike at a time from the buffer and put the spikes to an appopriate monitor buffer. Later the user
+	// may need need to dump these spikes to an output file
+	// In CPU mode, the spikes are in the firing logs; in GPU mode, they are in the firing tables
+	// Either way, spikes of neurons with delays of 2+ms come first, then those with 1ms delay
+	for (int k=0; k < 2; k++) {
+		const unsigned int* timeTablePtr;
+		const unsigned int* fireTablePtr;
+		if (simMode_ == GPU_MODE) {
+			timeTablePtr = ((k==0)?timeTableD2:timeTableD1) + maxDelay_;
+			fireTablePtr = (k==0)?firingTableD2:firingTableD1;
+		} else {
+			const std::vector<unsigned int>& firingLog = (k==0) ? firingLogD2_ : firingLogD1_;
+			timeTablePtr = (k==0) ? &firingLogTimeD2_[0] : &firingLogTimeD1_[0];
+			fireTablePtr = firingLog.empty() ? NULL : &firingLog[0];
+		}
+		for(int t=numMsMinAll; t<numMsMax; t++) {
+			// current time is last completed second plus whatever is leftover in t
+			int time = currentTimeSec*1000 + t;
+
+			for(unsigned int i=timeTablePtr[t]; i<timeTablePtr[t+1];i++) {
+				// retrieve the neuron id
+				int nid   = fireTablePtr[i];
+				if (simMode_ == GPU_MODE)
+					nid = GET_FIRING_TABLE_NID(nid);
+				assert(nid < numN);
+
+				// make sure the group of the neuron has a monitor that needs this ms
+				int this_grpId = grpIds[nid];
+				const spkmon_dispatch_t& dispatch = spkMonDispatch_[this_grpId];
+				if (t < dispatch.msMin)
+					continue;
+
+				// adjust nid to be 0-indexed for each group
+				// this way, if a group has 10 neurons, their IDs in the spike file and spike monitor will be
+				// indexed from 0..9, no matter what their real nid is
+				nid -= grp_Info[this_grpId].StartN;
+				assert(nid>=0);
+
+				if (dispatch.fileId>=0) {
+					int aer[2] = {time, nid};
+					monWriter_->append(dispatch.fileId, aer, sizeof(aer));
+				}
+
+				if (dispatch.toArray) {
+					dispatch.mon->pushAER(time,nid);
+				}
+
+				if (dispatch.toStats) {
+					dispatch.mon->pushSpikeStats(time,nid);
 				}
 			}
 		}
+	}
 
-		if (spkFileId!=NULL) // flush spike file
-			fflush(spkFileId);
+	// hand the spikes to the writer, which flushes the files, and close the bins that are now complete
+	for (int g=0; g<numGrp; g++) {
+		if (spkMonDispatch_[g].msMin>=numMsMax)
+			continue;
+		if (spkMonDispatch_[g].fileId>=0)
+			monWriter_->submit(spkMonDispatch_[g].fileId);
+		if (spkMonDispatch_[g].toStats)
+			spkMonDispatch_[g].mon->closeStatsBins((int64_t)getSimTime());
 	}
 }
 
@@ -5532,6 +6670,10 @@ void CpuSNN::updateWeights() {
 	// at this point we have already checked for sim_in_testing and sim_with_fixedwts
 	assert(sim_in_testing==false);
 	assert(sim_with_fixedwts==false);
+	wtVersion_ = ++stateVersionCnt_;
+
+	if (wtUpdateIncremental_)
+		wtUpdateCnt_++;
 
 	// update synaptic weights here for all the neurons..
 	for(int g = 0; g < numGrp; g++) {
@@ -5542,6 +6684,18 @@ void CpuSNN::updateWeights() {
 		for(int i = grp_Info[g].StartN; i <= grp_Info[g].EndN; i++) {
 			assert(i < numNReg);
 			unsigned int offset = cumulativePre[i];
+
+			// incremental weight update: only visit neurons whose wtChange got modified since the last update; the
+			// weights of all others are brought up to date once they are used again (see catchUpWeight)
+			if (wtUpdateIncremental_ && grpWtUpdateLazy_[g]) {
+				if (!wtUpdateDirty_[i])
+					continue;
+				wtUpdateDirty_[i] = 0;
+				for(int j = 0; j < Npre_plastic[i]; j++)
+					catchUpWeight(g, i, offset+j);
+				continue;
+			}
+
 			float diff_firing = 0.0;
 			float homeostasisScale = 1.0;
 
@@ -5557,75 +6711,256 @@ void CpuSNN::updateWeights() {
 			for(int j = 0; j < Npre_plastic[i]; j++) {
 				//	if (i==grp_Info[g].StartN)
 				//		KERNEL_DEBUG("%1.2f %1.2f \t", wt[offset+j]*10, wtChange[offset+j]*10);
-				float effectiveWtChange = stdpScaleFactor_ * wtChange[offset + j];
-//				if (wtChange[offset+j])
-//					printf("connId=%d, wtChange[%d]=%f\n",cumConnIdPre[offset+j],offset+j,wtChange[offset+j]);
-
-				// homeostatic weight update
-				// FIXME: check WithESTDPtype and WithISTDPtype first and then do weight change update
-				switch (grp_Info[g].WithESTDPtype) {
-				case STANDARD:
-					if (grp_Info[g].WithHomeostasis) {
-						wt[offset+j] += (diff_firing*wt[offset+j]*homeostasisScale + wtChange[offset+j])*baseFiring[i]/grp_Info[g].avgTimeScale/(1+fabs(diff_firing)*50);
-					} else {
-						// just STDP weight update
-						wt[offset+j] += effectiveWtChange;
-					}
-					break;
-				case DA_MOD:
-					if (grp_Info[g].WithHomeostasis) {
-						effectiveWtChange = cpuNetPtrs.grpDA[g] * effectiveWtChange;
-						wt[offset+j] += (diff_firing*wt[offset+j]*homeostasisScale + effectiveWtChange)*baseFiring[i]/grp_Info[g].avgTimeScale/(1+fabs(diff_firing)*50);
-					} else {
-						wt[offset+j] += cpuNetPtrs.grpDA[g] * effectiveWtChange;
-					}
-					break;
-				case UNKNOWN_STDP:
-				default:
-					// we shouldn't even be in here if !WithSTDP
-					break;
-				}
+				updateSynapticWeight(g, i, offset+j, diff_firing, homeostasisScale);
+			}
+		}
+	}
+}
 
-				switch (grp_Info[g].WithISTDPtype) {
-				case STANDARD:
-					if (grp_Info[g].WithHomeostasis) {
-						wt[offset+j] += (diff_firing*wt[offset+j]*homeostasisScale + wtChange[offset+j])*baseFiring[i]/grp_Info[g].avgTimeScale/(1+fabs(diff_firing)*50);
-					} else {
-						// just STDP weight update
-						wt[offset+j] += effectiveWtChange;
-					}
-					break;
-				case DA_MOD:
-					if (grp_Info[g].WithHomeostasis) {
-						effectiveWtChange = cpuNetPtrs.grpDA[g] * effectiveWtChange;
-						wt[offset+j] += (diff_firing*wt[offset+j]*homeostasisScale + effectiveWtChange)*baseFiring[i]/grp_Info[g].avgTimeScale/(1+fabs(diff_firing)*50);
-					} else {
-						wt[offset+j] += cpuNetPtrs.grpDA[g] * effectiveWtChange;
-					}
-					break;
-				case UNKNOWN_STDP:
-				default:
-					// we shouldn't even be in here if !WithSTDP
-					break;
-				}
+// applies one weight update to synapse pos of post-synaptic neuron i in group g
+void CpuSNN::updateSynapticWeight(int g, int i, unsigned int pos, float diff_firing, float homeostasisScale) {
+	float effectiveWtChange = stdpScaleFactor_ * wtChange[pos];
+//	if (wtChange[pos])
+//		printf("connId=%d, wtChange[%d]=%f\n",cumConnIdPre[pos],pos,wtChange[pos]);
 
-				// It is users' choice to decay weight change or not
-				// see setWeightAndWeightChangeUpdate()
-				wtChange[offset+j] *= wtChangeDecay_;
+	// homeostatic weight update
+	// FIXME: check WithESTDPtype and WithISTDPtype first and then do weight change update
+	switch (grp_Info[g].WithESTDPtype) {
+	case STANDARD:
+		if (grp_Info[g].WithHomeostasis) {
+			wt[pos] += (diff_firing*wt[pos]*homeostasisScale + wtChange[pos])*baseFiring[i]/grp_Info[g].avgTimeScale/(1+fabs(diff_firing)*50);
+		} else {
+			// just STDP weight update
+			wt[pos] += effectiveWtChange;
+		}
+		break;
+	case DA_MOD:
+		if (grp_Info[g].WithHomeostasis) {
+			effectiveWtChange = cpuNetPtrs.grpDA[g] * effectiveWtChange;
+			wt[pos] += (diff_firing*wt[pos]*homeostasisScale + effectiveWtChange)*baseFiring[i]/grp_Info[g].avgTimeScale/(1+fabs(diff_firing)*50);
+		} else {
+			wt[pos] += cpuNetPtrs.grpDA[g] * effectiveWtChange;
+		}
+		break;
+	case UNKNOWN_STDP:
+	default:
+		// we shouldn't even be in here if !WithSTDP
+		break;
+	}
 
-				// if this is an excitatory or inhibitory synapse
-				if (maxSynWt[offset + j] >= 0) {
-					if (wt[offset + j] >= maxSynWt[offset + j])
-						wt[offset + j] = maxSynWt[offset + j];
-					if (wt[offset + j] < 0)
-						wt[offset + j] = 0.0;
-				} else {
-					if (wt[offset + j] <= maxSynWt[offset + j])
-						wt[offset + j] = maxSynWt[offset + j];
-					if (wt[offset+j] > 0)
-						wt[offset+j] = 0.0;
-				}
-			}
+	switch (grp_Info[g].WithISTDPtype) {
+	case STANDARD:
+		if (grp_Info[g].WithHomeostasis) {
+			wt[pos] += (diff_firing*wt[pos]*homeostasisScale + wtChange[pos])*baseFiring[i]/grp_Info[g].avgTimeScale/(1+fabs(diff_firing)*50);
+		} else {
+			// just STDP weight update
+			wt[pos] += effectiveWtChange;
+		}
+		break;
+	case DA_MOD:
+		if (grp_Info[g].WithHomeostasis) {
+			effectiveWtChange = cpuNetPtrs.grpDA[g] * effectiveWtChange;
+			wt[pos] += (diff_firing*wt[pos]*homeostasisScale + effectiveWtChange)*baseFiring[i]/grp_Info[g].avgTimeScale/(1+fabs(diff_firing)*50);
+		} else {
+			wt[pos] += cpuNetPtrs.grpDA[g] * effectiveWtChange;
+		}
+		break;
+	case UNKNOWN_STDP:
+	default:
+		// we shouldn't even be in here if !WithSTDP
+		break;
+	}
+
+	// It is users' choice to decay weight change or not
+	// see setWeightAndWeightChangeUpdate()
+	wtChange[pos] *= wtChangeDecay_;
+
+	// if this is an excitatory or inhibitory synapse
+	if (maxSynWt[pos] >= 0) {
+		if (wt[pos] >= maxSynWt[pos])
+			wt[pos] = maxSynWt[pos];
+		if (wt[pos] < 0)
+			wt[pos] = 0.0;
+	} else {
+		if (wt[pos] <= maxSynWt[pos])
+			wt[pos] = maxSynWt[pos];
+		if (wt[pos] > 0)
+			wt[pos] = 0.0;
+	}
+}
+
+// incremental weight update: applies all weight updates synapse pos has missed since it was last used
+// Lazy groups use neither homeostasis nor DA_MOD, so every update adds stdpScaleFactor_*wtChange once per STANDARD
+// STDP type (E and I), and then decays wtChange. After n updates, wtChange has been decayed by decay^n, and the
+// weight has moved by the geometric sum stdpScaleFactor_*wtChange*(1+decay+...+decay^(n-1)). Because all n
+// increments have the same sign, clamping the weight once at the end is the same as clamping it after every update.
+// The result equals n calls to updateSynapticWeight up to floating-point rounding.
+void CpuSNN::catchUpWeight(int g, int i, unsigned int pos) {
+	if (synWtUpdateCnt_[pos] >= wtUpdateCnt_)
+		return;
+	uint32_t n = wtUpdateCnt_ - synWtUpdateCnt_[pos];
+	synWtUpdateCnt_[pos] = wtUpdateCnt_;
+	if (wtChange[pos] == 0.0f)
+		return; // wt is clamped already
+
+	int numStandard = (grp_Info[g].WithESTDPtype == STANDARD ? 1 : 0) + (grp_Info[g].WithISTDPtype == STANDARD ? 1 : 0);
+	double decay = wtChangeDecay_;
+	double decayN = pow(decay, (double)n);
+	double geomSum = (decay == 1.0) ? n : (1.0 - decayN) / (1.0 - decay);
+	wt[pos] += (float)(numStandard * stdpScaleFactor_ * wtChange[pos] * geomSum);
+	wtChange[pos] = (float)(wtChange[pos] * decayN);
+
+	// if this is an excitatory or inhibitory synapse
+	if (maxSynWt[pos] >= 0) {
+		if (wt[pos] >= maxSynWt[pos])
+			wt[pos] = maxSynWt[pos];
+		if (wt[pos] < 0)
+			wt[pos] = 0.0;
+	} else {
+		if (wt[pos] <= maxSynWt[pos])
+			wt[pos] = maxSynWt[pos];
+		if (wt[pos] > 0)
+			wt[pos] = 0.0;
+	}
+}
+
+// incremental weight update: brings all synaptic weights up to date, so they can be read or modified from outside
+// This is called whenever weights are accessed (e.g., getWeightMatrix2D, saveSimulation, setWeight), not after every
+// run. Nothing needs to be done if there was no weight update since the last flush.
+void CpuSNN::flushWeightUpdates() {
+	if (!wtUpdateIncremental_ || synWtUpdateCnt_ == NULL || wtUpdateFlushCnt_ == wtUpdateCnt_)
+		return;
+	wtUpdateFlushCnt_ = wtUpdateCnt_;
+	wtVersion_ = ++stateVersionCnt_; // wt and synWtUpdateCnt_ change, see takeSnapshot
+
+	for (int g = 0; g < numGrp; g++) {
+		if (!grpWtUpdateLazy_[g])
+			continue;
+
+		for (int i = grp_Info[g].StartN; i <= grp_Info[g].EndN; i++) {
+			unsigned int offset = cumulativePre[i];
+			for (int j = 0; j < Npre_plastic[i]; j++)
+				catchUpWeight(g, i, offset+j);
+		}
+	}
+}
+
+// lists all plain-old-data state of the network that changes during a simulation (see takeSnapshot)
+// The list only depends on the network configuration, so it is the same for every call after setupNetwork.
+void CpuSNN::getStateRegions(std::vector<state_region_t>& regions) {
+	regions.clear();
+
+	// neurons
+	addStateRegion(regions, voltage, sizeof(float)*numNReg);
+	addStateRegion(regions, nextVoltage, sizeof(float)*numNReg);
+	addStateRegion(regions, recovery, sizeof(float)*numNReg);
+	addStateRegion(regions, current, sizeof(float)*numNReg);
+	addStateRegion(regions, extCurrent, sizeof(float)*numNReg);
+	addStateRegion(regions, curSpike, sizeof(bool)*numNReg);
+	addStateRegion(regions, nSpikeCnt, sizeof(int)*numN);
+	addStateRegion(regions, lastSpikeTime, sizeof(uint32_t)*numN);
+	addStateRegion(regions, avgFiring, sizeof(float)*numN);
+	addStateRegion(regions, stpu, sizeof(float)*numN*(maxDelay_+1));
+	addStateRegion(regions, stpx, sizeof(float)*numN*(maxDelay_+1));
+
+	// conductances and neuromodulators
+	addStateRegion(regions, gAMPA, sizeof(float)*numNReg);
+	addStateRegion(regions, gNMDA, sizeof(float)*numNReg);
+	addStateRegion(regions, gNMDA_r, sizeof(float)*numNReg);
+	addStateRegion(regions, gNMDA_d, sizeof(float)*numNReg);
+	addStateRegion(regions, gGABAa, sizeof(float)*numNReg);
+	addStateRegion(regions, gGABAb, sizeof(float)*numNReg);
+	addStateRegion(regions, gGABAb_r, sizeof(float)*numNReg);
+	addStateRegion(regions, gGABAb_d, sizeof(float)*numNReg);
+	addStateRegion(regions, grpDA, sizeof(float)*numGrp);
+	addStateRegion(regions, grp5HT, sizeof(float)*numGrp);
+	addStateRegion(regions, grpACh, sizeof(float)*numGrp);
+	addStateRegion(regions, grpNE, sizeof(float)*numGrp);
+
+	// synapses
+	addStateRegion(regions, wt, sizeof(float)*preSynCnt, &wtVersion_);
+	addStateRegion(regions, wtChange, sizeof(float)*preSynCnt, &wtVersion_);
+	addStateRegion(regions, maxSynWt, sizeof(float)*preSynCnt, &wtVersion_);
+	addStateRegion(regions, synWtUpdateCnt_, sizeof(uint32_t)*preSynCnt, &wtVersion_);
+	addStateRegion(regions, synSpikeTime, sizeof(uint32_t)*preSynCnt, &synSpikeTimeVersion_);
+	addStateRegion(regions, spkArrivalTime_, sizeof(uint32_t)*numN*maxDelay_);
+	addStateRegion(regions, wtUpdateDirty_, sizeof(uint8_t)*numN);
+
+	// spike counters and spike generators
+	for (int g=0; g<numGrp; g++)
+		if (grp_Info[g].withSpikeCounter)
+			addStateRegion(regions, spkCntBuf[grp_Info[g].spkCntBufPos], sizeof(int)*grp_Info[g].SizeN);
+	addStateRegion(regions, spikeGenBits, sizeof(uint32_t)*(NgenFunc/32+1));
+	for (int g=0; g<numGrp; g++) {
+		addStateRegion(regions, &grp_Info[g].CurrTimeSlice, sizeof(grp_Info[g].CurrTimeSlice));
+		addStateRegion(regions, &grp_Info[g].NewTimeSlice, sizeof(grp_Info[g].NewTimeSlice));
+		addStateRegion(regions, &grp_Info[g].SliceUpdateTime, sizeof(grp_Info[g].SliceUpdateTime));
+		addStateRegion(regions, &grp_Info[g].FiringCount1sec, sizeof(grp_Info[g].FiringCount1sec));
+		addStateRegion(regions, &grp_Info[g].spkCntRecordDurHelper, sizeof(grp_Info[g].spkCntRecordDurHelper));
+		addStateRegion(regions, &grp_Info[g].lastSTPupdate, sizeof(grp_Info[g].lastSTPupdate));
+	}
+
+	// time and counters
+	addStateRegion(regions, &simTime, sizeof(simTime));
+	addStateRegion(regions, &simTimeMs, sizeof(simTimeMs));
+	addStateRegion(regions, &simTimeSec, sizeof(simTimeSec));
+	addStateRegion(regions, &simTimeRunStart, sizeof(simTimeRunStart));
+	addStateRegion(regions, &simTimeRunStop, sizeof(simTimeRunStop));
+	addStateRegion(regions, &simTimeLastRunSummary, sizeof(simTimeLastRunSummary));
+	addStateRegion(regions, &spikeCountAll1secHost, sizeof(spikeCountAll1secHost));
+	addStateRegion(regions, &secD1fireCntHost, sizeof(secD1fireCntHost));
+	addStateRegion(regions, &secD2fireCntHost, sizeof(secD2fireCntHost));
+	addStateRegion(regions, &spikeCountAllHost, sizeof(spikeCountAllHost));
+	addStateRegion(regions, &spikeCountD1Host, sizeof(spikeCountD1Host));
+	addStateRegion(regions, &spikeCountD2Host, sizeof(spikeCountD2Host));
+	addStateRegion(regions, &nPoissonSpikes, sizeof(nPoissonSpikes));
+	addStateRegion(regions, &wtANDwtChangeUpdateIntervalCnt_, sizeof(wtANDwtChangeUpdateIntervalCnt_));
+	addStateRegion(regions, &wtUpdateCnt_, sizeof(wtUpdateCnt_));
+	addStateRegion(regions, &wtUpdateFlushCnt_, sizeof(wtUpdateFlushCnt_));
+}
+
+// appends a state region to the list, unless the array is not allocated
+void CpuSNN::addStateRegion(std::vector<state_region_t>& regions, void* ptr, size_t numBytes, uint64_t* version) {
+	if (ptr == NULL)
+		return;
+
+	state_region_t r;
+	r.ptr = ptr;
+	r.numBytes = numBytes;
+	r.version = version;
+	regions.push_back(r);
+}
+
+// incremental weight update: allocates per-synapse update counters and per-neuron dirty flags
+// Weight updates can only be deferred if they do not depend on state that changes over time, which rules out
+// homeostasis and dopamine-modulated STDP: such groups are still visited in every update.
+void CpuSNN::initIncrementalWeightUpdate() {
+	assert(wtUpdateIncremental_);
+	if (synWtUpdateCnt_ != NULL)
+		return; // already done
+
+	grpWtUpdateLazy_.assign(numGrp, false);
+	for (int g = 0; g < numGrp; g++) {
+		grpWtUpdateLazy_[g] = grp_Info[g].WithSTDP && !grp_Info[g].FixedInputWts && !grp_Info[g].WithHomeostasis
+			&& grp_Info[g].WithESTDPtype != DA_MOD && grp_Info[g].WithISTDPtype != DA_MOD;
+	}
+
+	// synapses that are never updated lazily get a count that is never smaller than wtUpdateCnt_
+	wtUpdateCnt_ = 0;
+	wtUpdateFlushCnt_ = 0;
+	synWtUpdateCnt_ = new uint32_t[preSynCnt];
+	for (unsigned int k = 0; k < preSynCnt; k++)
+		synWtUpdateCnt_[k] = 0xFFFFFFFF;
+	for (int g = 0; g < numGrp; g++) {
+		if (!grpWtUpdateLazy_[g])
+			continue;
+		for (int i = grp_Info[g].StartN; i <= grp_Info[g].EndN; i++) {
+			for (int j = 0; j < Npre_plastic[i]; j++)
+				synWtUpdateCnt_[cumulativePre[i]+j] = 0;
 		}
 	}
+
+	wtUpdateDirty_ = new uint8_t[numN];
+	memset(wtUpdateDirty_, 0, numN);
+	cpuSnnSz.synapticInfoSize += sizeof(uint32_t)*preSynCnt + sizeof(uint8_t)*numN;
 }
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#include <thread_pool.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+#if defined(WIN32) || defined(WIN64)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// returns the time in ms from a monotonic clock (unaffected by changes to the system time)
+static double getWallTimeMs() {
+#if defined(WIN32) || defined(WIN64)
+	return (double)GetTickCount();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec*1000.0 + ts.tv_nsec/1000000.0;
+#endif
+}
+
+ThreadPool::ThreadPool(int numThreads) {
+	assert(numThreads >= 1);
+	numThreads_ = numThreads;
+	task_ = NULL;
+	taskArg_ = NULL;
+	threadTimeMs_.assign(numThreads_, 0.0);
+
+#if !defined(WIN32) && !defined(WIN64)
+	generation_ = 0;
+	numBusy_ = 0;
+	shutdown_ = false;
+	pthread_mutex_init(&mutex_, NULL);
+	pthread_cond_init(&wakeCond_, NULL);
+	pthread_cond_init(&doneCond_, NULL);
+
+	// thread 0 is the calling thread, so we only need to spawn numThreads-1 workers
+	// the arguments need to be in place before the first thread is created, because the vector must not reallocate
+	workers_.resize(numThreads_-1);
+	workerArgs_.resize(numThreads_-1);
+	for (int t=1; t<numThreads_; t++) {
+		workerArgs_[t-1].pool = this;
+		workerArgs_[t-1].threadId = t;
+	}
+	for (int t=1; t<numThreads_; t++) {
+		pthread_create(&workers_[t-1], NULL, &ThreadPool::workerMain, &workerArgs_[t-1]);
+	}
+#endif
+}
+
+ThreadPool::~ThreadPool() {
+#if !defined(WIN32) && !defined(WIN64)
+	pthread_mutex_lock(&mutex_);
+	shutdown_ = true;
+	pthread_cond_broadcast(&wakeCond_);
+	pthread_mutex_unlock(&mutex_);
+
+	for (unsigned int t=0; t<workers_.size(); t++) {
+		pthread_join(workers_[t], NULL);
+	}
+
+	pthread_cond_destroy(&doneCond_);
+	pthread_cond_destroy(&wakeCond_);
+	pthread_mutex_destroy(&mutex_);
+#endif
+}
+
+double ThreadPool::getThreadTimeMs(int threadId) {
+	assert(threadId >= 0 && threadId < numThreads_);
+	return threadTimeMs_[threadId];
+}
+
+void ThreadPool::resetThreadTimes() {
+	threadTimeMs_.assign(numThreads_, 0.0);
+}
+
+void ThreadPool::run(task_t task, void* arg) {
+	assert(task != NULL);
+	task_ = task;
+	taskArg_ = arg;
+
+#if defined(WIN32) || defined(WIN64)
+	for (int t=0; t<numThreads_; t++) {
+		execute(t);
+	}
+#else
+	if (numThreads_ == 1) {
+		execute(0);
+		return;
+	}
+
+	// wake up all workers
+	pthread_mutex_lock(&mutex_);
+	numBusy_ = numThreads_-1;
+	generation_++;
+	pthread_cond_broadcast(&wakeCond_);
+	pthread_mutex_unlock(&mutex_);
+
+	// the calling thread takes over the share of thread 0
+	execute(0);
+
+	// wait until all workers are done
+	pthread_mutex_lock(&mutex_);
+	while (numBusy_ > 0) {
+		pthread_cond_wait(&doneCond_, &mutex_);
+	}
+	pthread_mutex_unlock(&mutex_);
+#endif
+}
+
+void ThreadPool::execute(int threadId) {
+	double startMs = getWallTimeMs();
+	task_(taskArg_, threadId, numThreads_);
+	threadTimeMs_[threadId] += getWallTimeMs() - startMs;
+}
+
+#if !defined(WIN32) && !defined(WIN64)
+void* ThreadPool::workerMain(void* arg) {
+	worker_arg_t* workerArg = (worker_arg_t*)arg;
+	ThreadPool* pool = workerArg->pool;
+	unsigned long lastGeneration = 0;
+
+	while (true) {
+		pthread_mutex_lock(&pool->mutex_);
+		while (!pool->shutdown_ && pool->generation_ == lastGeneration) {
+			pthread_cond_wait(&pool->wakeCond_, &pool->mutex_);
+		}
+		if (pool->shutdown_) {
+			pthread_mutex_unlock(&pool->mutex_);
+			break;
+		}
+		lastGeneration = pool->generation_;
+		pthread_mutex_unlock(&pool->mutex_);
+
+		pool->execute(workerArg->threadId);
+
+		pthread_mutex_lock(&pool->mutex_);
+		if (--pool->numBusy_ == 0) {
+			pthread_cond_signal(&pool->doneCond_);
+		}
+		pthread_mutex_unlock(&pool->mutex_);
+	}
+
+	return NULL;
+}
+#endif
@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#include <spike_block_store.h>
+
+#include <snn_definitions.h>	// SPK_MON_BLOCK_DURATION
+
+#include <algorithm>			// std::sort, std::min, std::max
+#include <assert.h>				// assert
+
+
+// returns the index of the lowest set bit of a non-zero word
+static inline int findLowestBit(uint32_t word) {
+	assert(word);
+#if defined(__GNUC__)
+	return __builtin_ctz(word);
+#else
+	int bit = 0;
+	while (!(word & 1u)) {
+		word >>= 1;
+		bit++;
+	}
+	return bit;
+#endif
+}
+
+// returns the number of set bits of a word
+static inline int countBits(uint32_t word) {
+#if defined(__GNUC__)
+	return __builtin_popcount(word);
+#else
+	word = word - ((word >> 1) & 0x55555555u);
+	word = (word & 0x33333333u) + ((word >> 2) & 0x33333333u);
+	return (((word + (word >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+}
+
+
+// +++++ SpikeIterator ++++++++++++++++++++++++++++++++++++++++++++++++++//
+
+SpikeIterator::SpikeIterator(const SpikeBlockStore* store, int blk, int ms, int pos) {
+	store_ = store;
+	blk_ = blk;
+	ms_ = ms;
+	pos_ = pos;
+	time_ = -1;
+	neurId_ = -1;
+	settle();
+}
+
+void SpikeIterator::settle() {
+	int numBlocks = store_->blocks_.size();
+	while (blk_ < numBlocks) {
+		const SpikeBlockStore::spk_block_t& blk = store_->blocks_[blk_];
+		if (blk.format == SpikeBlockStore::BITMAP_BLOCK) {
+			// find the next set bit at or after neuron pos_ in the row of ms_
+			int wordsPerMs = store_->wordsPerMs_;
+			while (ms_ < blk.numMs) {
+				const uint32_t* row = &blk.data[ms_*wordsPerMs];
+				for (int w=pos_/32; w<wordsPerMs; w++) {
+					uint32_t word = row[w];
+					if (w==pos_/32)
+						word &= ~0u << (pos_%32);
+					if (word) {
+						pos_ = w*32 + findLowestBit(word);
+						time_ = blk.startMs + ms_;
+						neurId_ = pos_;
+						return;
+					}
+				}
+				ms_++;
+				pos_ = 0;
+			}
+		} else if (pos_ < blk.numSpikes) {
+			if (blk.format == SpikeBlockStore::AER_BLOCK) {
+				// the spikes of ms_ are at [offsets[ms_], offsets[ms_+1])
+				while (pos_ >= (int)blk.offsets[ms_+1])
+					ms_++;
+			} else {
+				ms_ = blk.spikeMs[pos_];
+			}
+			time_ = blk.startMs + ms_;
+			neurId_ = blk.data[pos_];
+			return;
+		}
+
+		// move on to the next block
+		blk_++;
+		ms_ = 0;
+		pos_ = 0;
+	}
+
+	// end of the store
+	ms_ = 0;
+	pos_ = 0;
+	time_ = -1;
+	neurId_ = -1;
+}
+
+
+// +++++ SpikeBlockStore ++++++++++++++++++++++++++++++++++++++++++++++++//
+
+SpikeBlockStore::SpikeBlockStore(int numNeurons) {
+	assert(numNeurons>0);
+	nNeurons_ = numNeurons;
+	wordsPerMs_ = (numNeurons+31)/32;
+	clear();
+}
+
+void SpikeBlockStore::clear() {
+	blocks_.clear();
+	openTimes_.clear();
+	openNeurIds_.clear();
+	openBlockStart_ = 0;
+	openBlockEnd_ = 0;
+	isTimeSorted_ = true;
+	neurNumSpikes_.assign(nNeurons_, 0);
+	numSpikes_ = 0;
+	sizeBytes_ = 0;
+}
+
+void SpikeBlockStore::openBlock(int time) {
+	assert(time>=0);
+
+	// simulation time was reset: blocks are no longer sorted by spike time
+	if (!blocks_.empty() && time < blocks_.back().startMs + blocks_.back().numMs)
+		isTimeSorted_ = false;
+
+	// blocks are aligned to multiples of SPK_MON_BLOCK_DURATION
+	openBlockStart_ = (time/SPK_MON_BLOCK_DURATION)*SPK_MON_BLOCK_DURATION;
+	openBlockEnd_ = openBlockStart_ + SPK_MON_BLOCK_DURATION;
+
+	// a block that was sealed early (e.g., by SpikeMonitor::stopRecording) may still cover the beginning of this one
+	if (!blocks_.empty() && isTimeSorted_)
+		openBlockStart_ = std::max(openBlockStart_, blocks_.back().startMs + blocks_.back().numMs);
+}
+
+void SpikeBlockStore::seal() {
+	if (openTimes_.empty())
+		return;
+
+	int numSpk = openTimes_.size();
+	int minMs = openTimes_[0], maxMs = openTimes_[0];
+	for (int i=1; i<numSpk; i++) {
+		minMs = std::min(minMs, openTimes_[i]);
+		maxMs = std::max(maxMs, openTimes_[i]);
+	}
+
+	blocks_.push_back(spk_block_t());
+	spk_block_t& blk = blocks_.back();
+	blk.startMs = minMs;
+	blk.numMs = maxMs - minMs + 1;
+	blk.numSpikes = numSpk;
+
+	// choose the format that takes less memory
+	int64_t aerBytes = ((int64_t)blk.numMs + 1 + numSpk)*sizeof(uint32_t);
+	int64_t sparseBytes = (int64_t)numSpk*(sizeof(uint32_t) + sizeof(uint16_t));
+	int64_t bitmapBytes = (int64_t)blk.numMs*wordsPerMs_*sizeof(uint32_t);
+	if (bitmapBytes < aerBytes && bitmapBytes < sparseBytes) {
+		blk.format = BITMAP_BLOCK;
+		blk.data.assign(blk.numMs*wordsPerMs_, 0);
+		for (int i=0; i<numSpk; i++) {
+			int nid = openNeurIds_[i];
+			uint32_t& word = blk.data[(openTimes_[i]-minMs)*wordsPerMs_ + nid/32];
+			if (word & (1u << (nid%32))) {
+				// same spike recorded twice, which a bitmap cannot represent
+				blk.data.clear();
+				break;
+			}
+			word |= 1u << (nid%32);
+		}
+	}
+
+	if (blk.data.empty()) {
+		blk.format = (sparseBytes < aerBytes) ? SPARSE_AER_BLOCK : AER_BLOCK;
+
+		// counting sort by spike time, then sort the neuron IDs of every ms
+		blk.offsets.assign(blk.numMs+1, 0);
+		for (int i=0; i<numSpk; i++)
+			blk.offsets[openTimes_[i]-minMs+1]++;
+		for (int ms=0; ms<blk.numMs; ms++)
+			blk.offsets[ms+1] += blk.offsets[ms];
+
+		std::vector<uint32_t> next(blk.offsets.begin(), blk.offsets.end()-1);
+		blk.data.resize(numSpk);
+		for (int i=0; i<numSpk; i++)
+			blk.data[next[openTimes_[i]-minMs]++] = openNeurIds_[i];
+		for (int ms=0; ms<blk.numMs; ms++) {
+			if (blk.offsets[ms+1] - blk.offsets[ms] > 1)
+				std::sort(blk.data.begin()+blk.offsets[ms], blk.data.begin()+blk.offsets[ms+1]);
+		}
+
+		if (blk.format == SPARSE_AER_BLOCK) {
+			// replace the per-ms offsets by the ms of every spike
+			assert(SPK_MON_BLOCK_DURATION <= 65536);
+			blk.spikeMs.resize(numSpk);
+			for (int ms=0; ms<blk.numMs; ms++) {
+				for (unsigned int i=blk.offsets[ms]; i<blk.offsets[ms+1]; i++)
+					blk.spikeMs[i] = ms;
+			}
+			std::vector<uint32_t>().swap(blk.offsets);
+		}
+	}
+
+	numSpikes_ += numSpk;
+	if (blk.format == BITMAP_BLOCK)
+		sizeBytes_ += bitmapBytes;
+	else
+		sizeBytes_ += (blk.format == AER_BLOCK) ? aerBytes : sparseBytes;
+
+	openTimes_.clear();
+	openNeurIds_.clear();
+}
+
+SpikeIterator SpikeBlockStore::begin(int startTime) const {
+	assert(!hasOpenBlock());
+
+	// find the first block that ends after startTime
+	int numBlocks = blocks_.size();
+	int b = 0;
+	if (isTimeSorted_) {
+		int hi = numBlocks;
+		while (b < hi) {
+			int mid = (b+hi)/2;
+			if (blocks_[mid].startMs + blocks_[mid].numMs <= startTime)
+				b = mid+1;
+			else
+				hi = mid;
+		}
+	} else {
+		while (b < numBlocks && blocks_[b].startMs + blocks_[b].numMs <= startTime)
+			b++;
+	}
+	if (b == numBlocks)
+		return end();
+
+	// jump to the first ms at or after startTime
+	int pos;
+	int ms = getBlockFirstMs(blocks_[b], startTime, &pos);
+	return SpikeIterator(this, b, ms, pos);
+}
+
+int SpikeBlockStore::getBlockFirstMs(const spk_block_t& blk, int startTime, int* pos) const {
+	int ms = std::min(blk.numMs, std::max(0, startTime - blk.startMs));
+	switch (blk.format) {
+	case AER_BLOCK:
+		*pos = blk.offsets[ms];
+		break;
+	case SPARSE_AER_BLOCK:
+		*pos = std::lower_bound(blk.spikeMs.begin(), blk.spikeMs.end(), ms) - blk.spikeMs.begin();
+		break;
+	case BITMAP_BLOCK:
+		*pos = 0;
+		break;
+	}
+	return ms;
+}
+
+int SpikeBlockStore::getBlockNumSpikes(const spk_block_t& blk, int msMin, int msMax) const {
+	if (msMin==0 && msMax==blk.numMs)
+		return blk.numSpikes;
+
+	if (blk.format != BITMAP_BLOCK) {
+		int posMin, posMax;
+		getBlockFirstMs(blk, blk.startMs + msMin, &posMin);
+		getBlockFirstMs(blk, blk.startMs + msMax, &posMax);
+		return posMax - posMin;
+	}
+
+	int numSpk = 0;
+	for (int i=msMin*wordsPerMs_; i<msMax*wordsPerMs_; i++)
+		numSpk += countBits(blk.data[i]);
+	return numSpk;
+}
+
+int SpikeBlockStore::getNumSpikesInRange(int startTime, int endTime) const {
+	assert(!hasOpenBlock());
+
+	int numSpk = 0;
+	for (int b=0; b<(int)blocks_.size(); b++) {
+		const spk_block_t& blk = blocks_[b];
+		if (blk.startMs >= endTime && isTimeSorted_)
+			break;
+		int msMin = std::max(0, startTime - blk.startMs);
+		int msMax = std::min(blk.numMs, endTime - blk.startMs);
+		if (msMin < msMax)
+			numSpk += getBlockNumSpikes(blk, msMin, msMax);
+	}
+	return numSpk;
+}
+
+void SpikeBlockStore::getSpikesInRange(int startTime, int endTime, std::vector<int>& spkTimes,
+	std::vector<int>& neurIds) const
+{
+	assert(!hasOpenBlock());
+
+	for (int b=0; b<(int)blocks_.size(); b++) {
+		const spk_block_t& blk = blocks_[b];
+		if (blk.startMs >= endTime && isTimeSorted_)
+			break;
+		if (blk.startMs >= endTime || blk.startMs + blk.numMs <= startTime)
+			continue;
+
+		// visit the spikes of this block from the first ms at or after startTime
+		int pos;
+		int ms = getBlockFirstMs(blk, startTime, &pos);
+		for (SpikeIterator it(this, b, ms, pos); it.blk_==b && it.getTime()<endTime; ++it) {
+			spkTimes.push_back(it.getTime());
+			neurIds.push_back(it.getNeurId());
+		}
+	}
+}
+
+std::vector<std::vector<int> > SpikeBlockStore::getSpikeVector2D() const {
+	assert(!hasOpenBlock());
+
+	std::vector<std::vector<int> > spkVector(nNeurons_);
+	for (int i=0; i<nNeurons_; i++)
+		spkVector[i].reserve(neurNumSpikes_[i]);
+
+	// unpack block by block, which is faster than going through SpikeIterator
+	for (int b=0; b<(int)blocks_.size(); b++) {
+		const spk_block_t& blk = blocks_[b];
+		switch (blk.format) {
+		case AER_BLOCK:
+			for (int ms=0; ms<blk.numMs; ms++) {
+				for (unsigned int i=blk.offsets[ms]; i<blk.offsets[ms+1]; i++)
+					spkVector[blk.data[i]].push_back(blk.startMs + ms);
+			}
+			break;
+		case SPARSE_AER_BLOCK:
+			for (int i=0; i<blk.numSpikes; i++)
+				spkVector[blk.data[i]].push_back(blk.startMs + blk.spikeMs[i]);
+			break;
+		case BITMAP_BLOCK:
+			for (int ms=0; ms<blk.numMs; ms++) {
+				for (int w=0; w<wordsPerMs_; w++) {
+					uint32_t word = blk.data[ms*wordsPerMs_ + w];
+					while (word) {
+						spkVector[w*32 + findLowestBit(word)].push_back(blk.startMs + ms);
+						word &= word-1; // clear lowest set bit
+					}
+				}
+			}
+			break;
+		}
+	}
+
+	return spkVector;
+}
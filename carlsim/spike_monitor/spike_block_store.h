@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2014 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *************************************************************************
+ * CARLsim
+ * created by: 		(MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:	(MA) Mike Avery <averym@uci.edu>, (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ *					(KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ *					(TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 11/12/2014
+ */
+
+#ifndef _SPIKE_BLOCK_STORE_H_
+#define _SPIKE_BLOCK_STORE_H_
+
+#include <stdint.h>					// int64_t, uint32_t, uint16_t
+#include <stddef.h>					// NULL, size_t
+#include <stdio.h>					// FILE
+#include <string>					// std::string
+#include <vector>					// std::vector
+#include <deque>					// std::deque
+
+class SpikeBlockStore; // forward declaration
+
+/*!
+ * \brief Iterates over recorded spikes in order of spike time
+ *
+ * Spikes are visited in order of spike time, and spikes with the same spike time in order of neuron ID. If the
+ * simulation time was reset between recording periods (see CARLsim::resetState), each recording period is visited
+ * in the order it was recorded.
+ * A SpikeIterator is obtained from SpikeMonitor::getSpikesBegin, and the last spike has been visited once the
+ * iterator compares equal to SpikeMonitor::getSpikesEnd. Example:
+ * \code
+ * for (SpikeIterator it=spkMon->getSpikesBegin(); it!=spkMon->getSpikesEnd(); ++it)
+ *     printf("neuron %d spiked at t=%d ms\n", it.getNeurId(), it.getTime());
+ * \endcode
+ *
+ * \attention An iterator becomes invalid when new spikes are recorded or the monitor is cleared.
+ */
+class SpikeIterator {
+public:
+	//! creates an iterator that does not point to any spike
+	SpikeIterator() : store_(NULL), blk_(0), ms_(0), pos_(0), time_(-1), neurId_(-1) {}
+
+	//! returns the spike time (ms) of the current spike
+	int getTime() const { return time_; }
+
+	//! returns the neuron ID (0-indexed within the group) of the current spike
+	int getNeurId() const { return neurId_; }
+
+	//! advances to the next spike
+	SpikeIterator& operator++() { pos_++; settle(); return *this; }
+
+	bool operator==(const SpikeIterator& rhs) const {
+		return store_==rhs.store_ && blk_==rhs.blk_ && ms_==rhs.ms_ && pos_==rhs.pos_;
+	}
+	bool operator!=(const SpikeIterator& rhs) const { return !(*this==rhs); }
+
+private:
+	friend class SpikeBlockStore;
+
+	//! points to the first spike at or after (blk, ms, pos), see SpikeBlockStore::spk_block_t
+	SpikeIterator(const SpikeBlockStore* store, int blk, int ms, int pos);
+
+	//! moves forward to the next valid position, or the end of the store
+	void settle();
+
+	const SpikeBlockStore* store_;
+	int blk_;		//!< index of the current block
+	int ms_;		//!< ms within the current block
+	int pos_;		//!< AER block: index of the current spike; bitmap block: neuron ID to look at next
+	int time_;		//!< spike time of the current spike
+	int neurId_;	//!< neuron ID of the current spike
+};
+
+/*!
+ * \brief Compact, time-sorted storage of the spikes recorded by a SpikeMonitor
+ *
+ * Spikes are stored in blocks that cover at most SPK_MON_BLOCK_DURATION ms of simulation time each. Within a block,
+ * spikes are sorted by spike time, then by neuron ID, and stored in one of three formats, whichever takes less memory:
+ * - AER:        a column of neuron IDs, plus the index of the first spike of every ms.
+ * - sparse AER: a column of neuron IDs, plus a column of 16-bit spike times (for groups that rarely spike).
+ * - bitmap:     one bit per neuron and ms (for dense groups).
+ *
+ * Spikes are first collected in an open block, in any order, which is sorted and compacted once a spike outside of
+ * the block arrives or SpikeBlockStore::seal is called. Queries are only allowed when there is no open block.
+ * Blocks are kept in the order they were recorded. This is also the order of spike time, unless the simulation time
+ * was reset while keeping the spikes (persistent mode); range queries work either way.
+ *
+ * Compared to a vector of spike times per neuron, this does not allocate memory per neuron, lets range queries jump
+ * to the right ms (or binary search for it), and needs less than 4 bytes per spike for dense groups.
+ *
+ * Memory can be bounded by a retention policy (see setRetention): once a sealed block falls out of the time window
+ * or the memory budget, it is evicted. Evicted blocks are dropped, or, if a spill file is set (see setSpillFile),
+ * written to that file and read back on demand, so that queries still see them. Spike counts always include all
+ * spikes, evicted or not.
+ */
+class SpikeBlockStore {
+public:
+	//! constructor, for a group of numNeurons neurons
+	SpikeBlockStore(int numNeurons);
+
+	//! destructor, closes the spill file
+	~SpikeBlockStore();
+
+	//! deletes all spikes
+	void clear();
+
+	//! adds a spike of neuron neurId (0-indexed) at time (ms) to the open block
+	void push(int time, int neurId) {
+		if (!openTimes_.empty() && (time >= openBlockEnd_ || time < openBlockStart_))
+			seal();
+		if (openTimes_.empty())
+			openBlock(time);
+		openTimes_.push_back(time);
+		openNeurIds_.push_back(neurId);
+		neurNumSpikes_[neurId]++;
+	}
+
+	//! sorts and compacts the spikes of the open block, so that they can be queried
+	void seal();
+
+	//! returns an iterator pointing to the first spike at or after time startTime (ms)
+	SpikeIterator begin(int startTime=0) const;
+
+	//! returns an iterator pointing past the last spike
+	SpikeIterator end() const { return SpikeIterator(this, blocks_.size(), 0, 0); }
+
+	//! returns the number of spikes in [startTime,endTime) (ms)
+	int getNumSpikesInRange(int startTime, int endTime) const;
+
+	//! appends spike times and neuron IDs of all spikes in [startTime,endTime) (ms) to the two vectors
+	void getSpikesInRange(int startTime, int endTime, std::vector<int>& spkTimes, std::vector<int>& neurIds) const;
+
+	//! returns the total number of spikes
+	int getNumSpikes() const { return numSpikes_ + openTimes_.size(); }
+
+	//! returns the number of spikes of a specific neuron
+	int getNeuronNumSpikes(int neurId) const { return neurNumSpikes_[neurId]; }
+
+	//! returns a 2D vector of spike times per neuron (a copy)
+	std::vector<std::vector<int> > getSpikeVector2D() const;
+
+	//! returns the approximate memory taken by the spikes in bytes (spilled blocks not included)
+	int64_t getSizeBytes() const { return sizeBytes_ + openTimes_.size()*2*sizeof(int); }
+
+	//! returns the number of bytes written to the spill file
+	int64_t getSpilledSizeBytes() const { return spillEnd_; }
+
+	//! returns the number of spikes that were evicted without a spill file, and can no longer be queried
+	int getNumDroppedSpikes() const { return numDroppedSpikes_; }
+
+	/*!
+	 * \brief sets the retention policy
+	 *
+	 * Sealed blocks are evicted, oldest first, as long as they end windowMs or more before the end of the newest
+	 * block, or the sealed blocks in memory take more than maxBytes. A value of 0 means no limit.
+	 */
+	void setRetention(int windowMs, int64_t maxBytes);
+
+	/*!
+	 * \brief sets the file evicted blocks are spilled to
+	 *
+	 * The file is created (or truncated), and kept open until the store is destroyed or another file is set. An
+	 * empty file name means evicted blocks are dropped, which also drops all blocks that were spilled so far.
+	 * \returns false if the file could not be opened
+	 */
+	bool setSpillFile(const std::string& fileName);
+
+	//! returns whether there is an open block
+	bool hasOpenBlock() const { return !openTimes_.empty(); }
+
+private:
+	friend class SpikeIterator;
+
+	// the spill file is not meant to be shared
+	SpikeBlockStore(const SpikeBlockStore&);
+	SpikeBlockStore& operator=(const SpikeBlockStore&);
+
+	//! storage formats of a block
+	enum spk_block_format_t { AER_BLOCK, SPARSE_AER_BLOCK, BITMAP_BLOCK };
+
+	//! a block of spikes, sorted by spike time and neuron ID
+	struct spk_block_t {
+		int startMs;					//!< spike time of the first ms in the block
+		int numMs;						//!< number of ms covered by the block (up to the last spike)
+		int numSpikes;					//!< number of spikes in the block
+		spk_block_format_t format;		//!< how the spikes are stored
+		std::vector<uint32_t> offsets;	//!< AER: index of the first spike of every ms, plus the number of spikes
+		std::vector<uint16_t> spikeMs;	//!< sparse AER: ms (within the block) of every spike
+		std::vector<uint32_t> data;		//!< (sparse) AER: neuron IDs; bitmap: numMs rows of wordsPerMs_ words
+		int64_t spillOffset;			//!< position of the block in the spill file, or -1 if it is in memory
+	};
+
+	//! returns a block with its spikes, which are read from the spill file if necessary
+	//! \attention the reference is only valid until the next call
+	const spk_block_t& getBlock(int b) const;
+
+	//! evicts the oldest blocks until the retention policy is met
+	void evict();
+
+	//! writes the spikes of a block to the spill file, and frees their memory
+	void spill(spk_block_t& blk);
+
+	//! returns the memory taken by the spikes of a block in bytes
+	int64_t getBlockSizeBytes(const spk_block_t& blk) const;
+
+	//! starts a new open block that contains spike time time
+	void openBlock(int time);
+
+	//! returns the number of spikes in ms [msMin,msMax) of a block
+	int getBlockNumSpikes(const spk_block_t& blk, int msMin, int msMax) const;
+
+	//! returns the first ms of a block at or after startTime (or numMs), and the corresponding iterator position
+	int getBlockFirstMs(const spk_block_t& blk, int startTime, int* pos) const;
+
+	int nNeurons_;							//!< number of neurons in the group
+	int wordsPerMs_;						//!< number of 32-bit words per ms in a bitmap block
+
+	std::deque<spk_block_t> blocks_;		//!< sealed blocks, in order of spike time
+	std::vector<int> openTimes_;			//!< spike times of the open block
+	std::vector<int> openNeurIds_;			//!< neuron IDs of the open block
+	int openBlockStart_;					//!< first spike time of the open block
+	int openBlockEnd_;						//!< first spike time after the open block
+	bool isTimeSorted_;						//!< whether blocks_ is sorted by spike time
+
+	std::vector<int> neurNumSpikes_;		//!< number of spikes per neuron
+	int numSpikes_;							//!< number of spikes in sealed blocks
+	int64_t sizeBytes_;						//!< memory taken by sealed blocks in memory
+	int numDroppedSpikes_;					//!< number of spikes in evicted blocks that were not spilled
+
+	// retention policy
+	int retentionWindow_;					//!< time window (ms) to keep in memory, or 0
+	int64_t retentionBytes_;				//!< memory budget (bytes) for sealed blocks, or 0
+	int firstRamBlock_;						//!< blocks before this one are in the spill file
+
+	FILE* spillFile_;						//!< file evicted blocks are spilled to, or NULL
+	int64_t spillEnd_;						//!< end of the spilled data in spillFile_
+	mutable spk_block_t cacheBlk_;			//!< the spilled block that was read last
+	mutable int cacheIdx_;					//!< index of cacheBlk_ in blocks_, or -1
+};
+
+#endif
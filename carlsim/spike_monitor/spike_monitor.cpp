@@ -45,12 +45,38 @@ int SpikeMonitor::getPopNumSpikes() {
 	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
 
 	// \TODO
-	UserErrors::assertTrue(getMode()==AER, UserErrors::UNKNOWN, funcName, "",
+	UserErrors::assertTrue(getMode()==AER || getMode()==STATS, UserErrors::UNKNOWN, funcName, "",
 		"This function is not yet supported in this mode.");
 
 	return spikeMonitorCorePtr_->getPopNumSpikes();	
 }
 
+float SpikeMonitor::getReplicaMeanFiringRate(int replica) {
+	std::string funcName = "getReplicaMeanFiringRate()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(replica>=0 && replica<spikeMonitorCorePtr_->getNumReplicas(), UserErrors::MUST_BE_IN_RANGE,
+		funcName, "replica", "[0,getNumReplicas()-1]");
+
+	// \TODO
+	UserErrors::assertTrue(getMode()==AER || getMode()==STATS, UserErrors::UNKNOWN, funcName, "",
+		"This function is not yet supported in this mode.");
+
+	return spikeMonitorCorePtr_->getReplicaMeanFiringRate(replica);
+}
+
+int SpikeMonitor::getReplicaNumSpikes(int replica) {
+	std::string funcName = "getReplicaNumSpikes()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(replica>=0 && replica<spikeMonitorCorePtr_->getNumReplicas(), UserErrors::MUST_BE_IN_RANGE,
+		funcName, "replica", "[0,getNumReplicas()-1]");
+
+	// \TODO
+	UserErrors::assertTrue(getMode()==AER || getMode()==STATS, UserErrors::UNKNOWN, funcName, "",
+		"This function is not yet supported in this mode.");
+
+	return spikeMonitorCorePtr_->getReplicaNumSpikes(replica);
+}
+
 float SpikeMonitor::getMaxFiringRate(){
 	std::string funcName = "getMaxFiringRate()";
 	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
@@ -85,7 +111,7 @@ int SpikeMonitor::getNeuronNumSpikes(int neurId) {
 	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
 
 	// \TODO
-	UserErrors::assertTrue(getMode()==AER, UserErrors::UNKNOWN, funcName, "",
+	UserErrors::assertTrue(getMode()==AER || getMode()==STATS, UserErrors::UNKNOWN, funcName, "",
 		"This function is not yet supported in this mode.");
 
 	return spikeMonitorCorePtr_->getNeuronNumSpikes(neurId);
@@ -132,6 +158,121 @@ std::vector<std::vector<int> > SpikeMonitor::getSpikeVector2D() {
 	return spikeMonitorCorePtr_->getSpikeVector2D();
 }
 
+SpikeIterator SpikeMonitor::getSpikesBegin(int startTime) {
+	std::string funcName = "getSpikesBegin()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==AER, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "AER");
+	UserErrors::assertTrue(startTime>=0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "startTime");
+
+	return spikeMonitorCorePtr_->getSpikesBegin(startTime);
+}
+
+SpikeIterator SpikeMonitor::getSpikesEnd() {
+	std::string funcName = "getSpikesEnd()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==AER, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "AER");
+
+	return spikeMonitorCorePtr_->getSpikesEnd();
+}
+
+int SpikeMonitor::getNumSpikesInRange(int startTime, int endTime) {
+	std::string funcName = "getNumSpikesInRange()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==AER, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "AER");
+	UserErrors::assertTrue(startTime>=0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "startTime");
+	UserErrors::assertTrue(endTime>=startTime, UserErrors::CANNOT_BE_LARGER, funcName, "startTime", "endTime");
+
+	return spikeMonitorCorePtr_->getNumSpikesInRange(startTime, endTime);
+}
+
+void SpikeMonitor::getSpikesInRange(int startTime, int endTime, std::vector<int>& spkTimes,
+	std::vector<int>& neurIds)
+{
+	std::string funcName = "getSpikesInRange()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==AER, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "AER");
+	UserErrors::assertTrue(startTime>=0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "startTime");
+	UserErrors::assertTrue(endTime>=startTime, UserErrors::CANNOT_BE_LARGER, funcName, "startTime", "endTime");
+
+	spikeMonitorCorePtr_->getSpikesInRange(startTime, endTime, spkTimes, neurIds);
+}
+
+float SpikeMonitor::getNeuronISICV(int neurId) {
+	std::string funcName = "getNeuronISICV()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==STATS, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "STATS");
+	UserErrors::assertTrue(neurId>=0 && neurId<spikeMonitorCorePtr_->getGrpNumNeurons(), UserErrors::MUST_BE_IN_RANGE,
+		funcName, "neurId", "[0,getGroupNumNeurons()-1]");
+
+	return spikeMonitorCorePtr_->getNeuronISICV(neurId);
+}
+
+std::vector<float> SpikeMonitor::getAllISICV() {
+	std::string funcName = "getAllISICV()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==STATS, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "STATS");
+
+	return spikeMonitorCorePtr_->getAllISICV();
+}
+
+float SpikeMonitor::getPopMeanISICV() {
+	std::string funcName = "getPopMeanISICV()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==STATS, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "STATS");
+
+	return spikeMonitorCorePtr_->getPopMeanISICV();
+}
+
+float SpikeMonitor::getNeuronFanoFactor(int neurId) {
+	std::string funcName = "getNeuronFanoFactor()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==STATS, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "STATS");
+	UserErrors::assertTrue(neurId>=0 && neurId<spikeMonitorCorePtr_->getGrpNumNeurons(), UserErrors::MUST_BE_IN_RANGE,
+		funcName, "neurId", "[0,getGroupNumNeurons()-1]");
+
+	return spikeMonitorCorePtr_->getNeuronFanoFactor(neurId);
+}
+
+std::vector<float> SpikeMonitor::getAllFanoFactors() {
+	std::string funcName = "getAllFanoFactors()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==STATS, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "STATS");
+
+	return spikeMonitorCorePtr_->getAllFanoFactors();
+}
+
+float SpikeMonitor::getPopFanoFactor() {
+	std::string funcName = "getPopFanoFactor()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==STATS, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "STATS");
+
+	return spikeMonitorCorePtr_->getPopFanoFactor();
+}
+
+float SpikeMonitor::getPopStdBinnedRate() {
+	std::string funcName = "getPopStdBinnedRate()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==STATS, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "STATS");
+
+	return spikeMonitorCorePtr_->getPopStdBinnedRate();
+}
+
+float SpikeMonitor::getPopMaxBinnedRate() {
+	std::string funcName = "getPopMaxBinnedRate()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==STATS, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "STATS");
+
+	return spikeMonitorCorePtr_->getPopMaxBinnedRate();
+}
+
+int SpikeMonitor::getStatsNumBins() {
+	std::string funcName = "getStatsNumBins()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(getMode()==STATS, UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, funcName, "STATS");
+
+	return spikeMonitorCorePtr_->getStatsNumBins();
+}
+
 std::vector<float> SpikeMonitor::getAllFiringRatesSorted(){
 	std::string funcName = "getAllFiringRatesSorted()";
 	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
@@ -205,13 +346,28 @@ spikeMonMode_t SpikeMonitor::getMode() {
 }
 
 void SpikeMonitor::setMode(spikeMonMode_t mode) {
+	std::string funcName = "setMode()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+
 	// \TODO
-	UserErrors::assertTrue(false, UserErrors::UNKNOWN, "setMode()", "",
-		"This function call is not yet supported.");
+	UserErrors::assertTrue(mode==AER || mode==STATS, UserErrors::UNKNOWN, funcName, "",
+		"This mode is not yet supported.");
 
 	spikeMonitorCorePtr_->setMode(mode);
 }
 
+int SpikeMonitor::getStatsBinSize() {
+	return spikeMonitorCorePtr_->getStatsBinSize();
+}
+
+void SpikeMonitor::setStatsBinSize(int binSize) {
+	std::string funcName = "setStatsBinSize()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(binSize>0, UserErrors::MUST_BE_POSITIVE, funcName, "binSize");
+
+	spikeMonitorCorePtr_->setStatsBinSize(binSize);
+}
+
 void SpikeMonitor::setLogFile(const std::string& fileName) {
 	std::string funcName = "setLogFile";
 
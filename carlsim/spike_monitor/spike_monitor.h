@@ -45,6 +45,7 @@
 #define _SPIKE_MON_H_
 
 #include <carlsim_datastructures.h> // spikeMonMode_t
+#include <spike_block_store.h>		// SpikeIterator
 #include <vector>					// std::vector
 #include <stdint.h>
 
@@ -58,16 +59,25 @@ class SpikeMonitorCore; // forward declaration of implementation
  * the method CARLsim::setSpikeMonitor must be called with the group ID of the desired group as an
  * argument. The setSpikeMonitor call returns a pointer to a SpikeMonitor object which can be queried for spike data.
  *
- * There are two different modes that define what information is collected exactly.
- * - AER:   AER mode will collect the exact spike times of all neurons in the group and store them in a 2D spike
- *          spike vector. The first dimension of the vector is neuron id, the second dimension is spike times. Each
- *          element spkVector[i] is thus a vector of all spike times for the i-th neuron in the group.
+ * There are different modes that define what information is collected exactly.
+ * - AER:   AER mode will collect the exact spike times of all neurons in the group. They can be retrieved as a 2D
+ *          spike vector, where the first dimension of the vector is neuron id, the second dimension is spike times.
+ *          Each element spkVector[i] is thus a vector of all spike times for the i-th neuron in the group. They can
+ *          also be visited in order of spike time (getSpikesBegin), or queried for a time range (getSpikesInRange).
+ *          Internally, spikes are stored in compact blocks of up to a second each, sorted by spike time.
  *          This mode is activated by default.
  *          Because of the sheer amount of information, it is unwise to run this mode for extended periods of time.
  *          Note that recording in this mode may significantly slow down your simulation.
  * - COUNT:	SpikeCount mode will only collect spike count information, such as the number of spikes per neuron. This
  *          mode cannot retrieve exact spike times. Thus it is not possible to calculate some of the more elaborate
  *          metrics, such as spike-time correlations.
+ * - STATS: SpikeStats mode does not store any spikes. Instead, it updates a number of statistics on the fly as the
+ *          spikes arrive: spike counts and firing rates, the coefficient of variation (CV) of the inter-spike
+ *          intervals (ISIs) of every neuron, and the Fano factor of the spike counts in bins of
+ *          getStatsBinSize() ms, both per neuron and for the whole group. Memory use depends on the number of
+ *          neurons only, no matter how long the recording lasts, which makes this mode suitable for long runs.
+ *          Only complete bins enter the binned statistics; a partial bin at the end of a recording period is
+ *          dropped.
  *
  * Spike data will not be recorded until the SpikeMonitor member function startRecording() is called.
  * Before any metrics can be computed, the user must call stopRecording(). In general, a new recording period
@@ -304,6 +314,27 @@ class SpikeMonitor {
 	 */
 	int getPopNumSpikes();
 
+	/*!
+	 * \brief Returns the mean firing rate of the neurons of a single replica
+	 *
+	 * This function returns the average firing rate of all the neurons in the group that belong to a specific replica
+	 * (see CARLsim::setNumReplicas) in spikes/sec (Hz), averaged over the recording time window. With a single
+	 * replica, this is the same as getPopMeanFiringRate.
+	 * The total time over which the metric is calculated can be retrieved by calling getRecordingTotalTime().
+	 * \param[in] replica the replica (0-indexed, must be smaller than CARLsim::getNumReplicas)
+	 * \returns the average firing rate of all the neurons of the replica
+	 */
+	float getReplicaMeanFiringRate(int replica);
+
+	/*!
+	 * \brief Returns the total number of spikes of the neurons of a single replica
+	 *
+	 * This function returns the total number of spikes emitted by the neurons in the group that belong to a specific
+	 * replica (see CARLsim::setNumReplicas) in the recording period.
+	 * \param[in] replica the replica (0-indexed, must be smaller than CARLsim::getNumReplicas)
+	 */
+	int getReplicaNumSpikes(int replica);
+
 	/*!
 	 *\brief returns the 2D spike vector
 	 *
@@ -318,6 +349,139 @@ class SpikeMonitor {
 	 */
 	std::vector<std::vector<int> > getSpikeVector2D();
 
+	/*!
+	 * \brief Returns an iterator pointing to the first recorded spike at or after a point in time
+	 *
+	 * This function returns a SpikeIterator, which visits the recorded spikes in order of spike time (and spikes
+	 * with the same spike time in order of neuron ID), starting at the first spike at or after startTime. Unlike
+	 * getSpikeVector2D, this does not copy any spikes. The last spike has been visited once the iterator compares
+	 * equal to getSpikesEnd().
+	 * Example:
+	 * \code
+	 * for (SpikeIterator it=spkMon->getSpikesBegin(); it!=spkMon->getSpikesEnd(); ++it)
+	 *     printf("neuron %d spiked at t=%d ms\n", it.getNeurId(), it.getTime());
+	 * \endcode
+	 * \param[in] startTime simulation time (ms) of the first spike to visit
+	 * \attention The iterator becomes invalid when recording is started again or the monitor is cleared.
+	 * \since v3.1
+	 */
+	SpikeIterator getSpikesBegin(int startTime=0);
+
+	/*!
+	 * \brief Returns an iterator pointing past the last recorded spike
+	 *
+	 * \see getSpikesBegin
+	 * \since v3.1
+	 */
+	SpikeIterator getSpikesEnd();
+
+	/*!
+	 * \brief Returns the number of recorded spikes in a time range
+	 *
+	 * This function returns the number of spikes of all neurons in the group with spike time in [startTime,endTime).
+	 * The spikes are counted without being copied.
+	 * \param[in] startTime start of the time range (ms), inclusive
+	 * \param[in] endTime end of the time range (ms), exclusive
+	 * \since v3.1
+	 */
+	int getNumSpikesInRange(int startTime, int endTime);
+
+	/*!
+	 * \brief Returns all recorded spikes in a time range
+	 *
+	 * This function appends the spike times and neuron IDs of all spikes with spike time in [startTime,endTime) to
+	 * spkTimes and neurIds, respectively, sorted by spike time and neuron ID (AER format).
+	 * \param[in] startTime start of the time range (ms), inclusive
+	 * \param[in] endTime end of the time range (ms), exclusive
+	 * \param[out] spkTimes spike times (ms)
+	 * \param[out] neurIds neuron IDs (0-indexed within the group)
+	 * \since v3.1
+	 */
+	void getSpikesInRange(int startTime, int endTime, std::vector<int>& spkTimes, std::vector<int>& neurIds);
+
+	/*!
+	 * \brief Returns the coefficient of variation of the ISIs of a specific neuron
+	 *
+	 * This function returns the coefficient of variation (standard deviation over mean) of the inter-spike intervals
+	 * of a specific neuron. ISIs do not span different recording periods. If the neuron has fewer than two ISIs, the
+	 * function returns zero. Can only be called in STATS mode.
+	 * \param[in] neurId the neuron ID (0-indexed, must be smaller than getNumNeurons)
+	 * \since v3.1
+	 */
+	float getNeuronISICV(int neurId);
+
+	/*!
+	 * \brief Returns the ISI coefficients of variation of all neurons in the group
+	 *
+	 * \see getNeuronISICV
+	 * \since v3.1
+	 */
+	std::vector<float> getAllISICV();
+
+	/*!
+	 * \brief Returns the mean ISI coefficient of variation of the group
+	 *
+	 * This function returns the ISI coefficient of variation averaged over all neurons in the group that have at
+	 * least two ISIs. Can only be called in STATS mode.
+	 * \since v3.1
+	 */
+	float getPopMeanISICV();
+
+	/*!
+	 * \brief Returns the Fano factor of the spike counts of a specific neuron
+	 *
+	 * This function returns the Fano factor (variance over mean) of the number of spikes a specific neuron emitted
+	 * per bin (see setStatsBinSize). If the neuron did not spike in any complete bin, the function returns zero.
+	 * Can only be called in STATS mode.
+	 * \param[in] neurId the neuron ID (0-indexed, must be smaller than getNumNeurons)
+	 * \since v3.1
+	 */
+	float getNeuronFanoFactor(int neurId);
+
+	/*!
+	 * \brief Returns the Fano factors of the spike counts of all neurons in the group
+	 *
+	 * \see getNeuronFanoFactor
+	 * \since v3.1
+	 */
+	std::vector<float> getAllFanoFactors();
+
+	/*!
+	 * \brief Returns the Fano factor of the spike counts of the group
+	 *
+	 * This function returns the Fano factor (variance over mean) of the number of spikes all neurons in the group
+	 * emitted per bin (see setStatsBinSize). Can only be called in STATS mode.
+	 * \since v3.1
+	 */
+	float getPopFanoFactor();
+
+	/*!
+	 * \brief Returns the standard deviation of the binned population firing rate (Hz)
+	 *
+	 * This function returns the standard deviation over bins (see setStatsBinSize) of the mean firing rate of the
+	 * neurons in the group. Unlike getPopStdFiringRate, which measures the spread across neurons, this measures the
+	 * fluctuations over time. Can only be called in STATS mode.
+	 * \since v3.1
+	 */
+	float getPopStdBinnedRate();
+
+	/*!
+	 * \brief Returns the largest binned population firing rate (Hz)
+	 *
+	 * This function returns the largest mean firing rate of the neurons in the group over all bins
+	 * (see setStatsBinSize). Can only be called in STATS mode.
+	 * \since v3.1
+	 */
+	float getPopMaxBinnedRate();
+
+	/*!
+	 * \brief Returns the number of complete bins the binned statistics are based on
+	 *
+	 * \see setStatsBinSize
+	 * \since v3.1
+	 */
+	int getStatsNumBins();
+
 	/*!
 	 * \brief Recording status (true=recording, false=not recording)
 	 *
@@ -432,21 +596,45 @@ class SpikeMonitor {
 	 *          neuron, and is thus not capable of computing spike train correlation etc.
 	 * AER:     Will collect spike information in AER format (will collect both neuron IDs and
 	 *          spike times).
+	 * STATS:   Will collect spike counts and running spike train statistics (ISI CV, Fano factor,
+	 *          binned population rate), but not the explicit spike times.
 	 */
 	spikeMonMode_t getMode();
 
 	/*!
 	 * \brief Sets the current SpikeMonitor mode
 	 *
-	 * This function returns the current SpikeMonitor mode.
+	 * This function sets the current SpikeMonitor mode, and deletes all recorded data. It cannot be called while
+	 * recording. COUNT mode is not yet supported.
 	 * COUNT:	Will collect only spike count information (such as number of spikes per neuron),
 	 *          not the explicit spike times. COUNT mode cannot retrieve exact spike times per
 	 *          neuron, and is thus not capable of computing spike train correlation etc.
 	 * AER:     Will collect spike information in AER format (will collect both neuron IDs and
 	 *          spike times).
+	 * STATS:   Will collect spike counts and running spike train statistics (ISI CV, Fano factor,
+	 *          binned population rate), but not the explicit spike times.
 	 */
 	void setMode(spikeMonMode_t mode=AER);
 
+	/*!
+	 * \brief Returns the bin size (ms) of STATS mode
+	 *
+	 * \see setStatsBinSize
+	 * \since v3.1
+	 */
+	int getStatsBinSize();
+
+	/*!
+	 * \brief Sets the bin size (ms) of STATS mode
+	 *
+	 * This function sets the size of the time bins (ms) in which STATS mode counts spikes to compute Fano factors
+	 * and binned population rates. Bins are aligned to the start of a recording period. It cannot be called while
+	 * recording, and deletes all recorded data. The default is 100 ms.
+	 * \param[in] binSize bin size (ms), must be positive
+	 * \since v3.1
+	 */
+	void setStatsBinSize(int binSize);
+
 	/*!
 	 * \brief Sets the name of the spike file binary
 	 *
@@ -8,12 +8,13 @@
 
 
 // we aren't using namespace std so pay attention!
-SpikeMonitorCore::SpikeMonitorCore(CpuSNN* snn, int monitorId, int grpId) {
+SpikeMonitorCore::SpikeMonitorCore(CpuSNN* snn, int monitorId, int grpId) : spkStore_(snn->getGroupNumNeurons(grpId)) {
 	snn_ = snn;
 	grpId_= grpId;
 	monitorId_ = monitorId;
 	nNeurons_ = -1;
 	spikeFileId_ = NULL;
+	spikeFileWriterId_ = -1;
 	recordSet_ = false;
 	spkMonLastUpdated_ = 0;
 
@@ -23,6 +24,7 @@ SpikeMonitorCore::SpikeMonitorCore(CpuSNN* snn, int monitorId, int grpId) {
 	needToWriteFileHeader_ = true;
 	spikeFileSignature_ = 206661989;
 	spikeFileVersion_ = 0.2f;
+	statsBinSize_ = SPK_MON_STATS_BIN_SIZE;
 
 	// defer all unsafe operations to init function
 	init();
@@ -32,11 +34,6 @@ void SpikeMonitorCore::init() {
 	nNeurons_ = snn_->getGroupNumNeurons(grpId_);
 	assert(nNeurons_>0);
 
-	// spike vector will be a 2D structure that holds a list of spike times for each neuron in the group
-	// so the first dimension is neuron ID, and each spkVector_[i] holds the list of spike times of that neuron
-	// fix the first dimension of spike vector
-	spkVector_.resize(nNeurons_);
-
 	clear();
 
 	// use KERNEL_{ERROR|WARNING|etc} typesetting (const FILE*)
@@ -48,8 +45,10 @@ void SpikeMonitorCore::init() {
 
 SpikeMonitorCore::~SpikeMonitorCore() {
 	if (spikeFileId_!=NULL) {
-		fclose(spikeFileId_);
+		// the writer fcloses the file once everything has been written
+		snn_->getMonitorWriter()->closeFile(spikeFileWriterId_);
 		spikeFileId_ = NULL;
+		spikeFileWriterId_ = -1;
 	}
 }
 
@@ -65,8 +64,19 @@ void SpikeMonitorCore::clear() {
 	accumTime_ = 0;
 	totalTime_ = -1;
 
-	for (int i=0; i<nNeurons_; i++)
-		spkVector_[i].clear();
+	spkStore_.clear();
+
+	neuron_stats_t neurStats;
+	neurStats.numSpikes = 0;
+	neurStats.lastSpikeTime = -1;
+	neurStats.curBin = 0;
+	neurStats.curBinCnt = 0;
+	neurStats_.assign(nNeurons_, neurStats);
+	popNumSpikes_ = 0;
+	binOffset_ = 0;
+	popBinsDone_ = 0;
+	popBinCnt_.clear();
+	popBins_ = running_stats_t();
 
 	needToCalculateFiringRates_ = true;
 	needToSortFiringRates_ = true;
@@ -106,8 +116,32 @@ float SpikeMonitorCore::getPopStdFiringRate() {
 int SpikeMonitorCore::getPopNumSpikes() {
 	assert(!isRecording());
 
+	if (mode_==STATS)
+		return popNumSpikes_;
+
+	return spkStore_.getNumSpikes();
+}
+
+int SpikeMonitorCore::getNumReplicas() { return snn_->getNumReplicas(); }
+
+float SpikeMonitorCore::getReplicaMeanFiringRate(int replica) {
+	assert(!isRecording());
+
+	if (totalTime_==0)
+		return 0.0f;
+
+	int nNeurReplica = nNeurons_/snn_->getNumReplicas();
+	return getReplicaNumSpikes(replica)*1000.0/(getRecordingTotalTime()*nNeurReplica);
+}
+
+int SpikeMonitorCore::getReplicaNumSpikes(int replica) {
+	assert(!isRecording());
+	assert(replica>=0 && replica<snn_->getNumReplicas());
+
+	// replicas occupy contiguous blocks of neuron IDs
+	int nNeurReplica = nNeurons_/snn_->getNumReplicas();
 	int nSpk = 0;
-	for (int i=0; i<nNeurons_; i++)
+	for (int i=replica*nNeurReplica; i<(replica+1)*nNeurReplica; i++)
 		nSpk += getNeuronNumSpikes(i);
 
 	return nSpk;
@@ -148,9 +182,12 @@ float SpikeMonitorCore::getNeuronMeanFiringRate(int neurId) {
 int SpikeMonitorCore::getNeuronNumSpikes(int neurId) {
 	assert(!isRecording());
 	assert(neurId>=0 && neurId<nNeurons_);
-	assert(getMode()==AER);
+	assert(getMode()==AER || getMode()==STATS);
 
-	return spkVector_[neurId].size();
+	if (mode_==STATS)
+		return neurStats_[neurId].numSpikes;
+
+	return spkStore_.getNeuronNumSpikes(neurId);
 }
 
 std::vector<float> SpikeMonitorCore::getAllFiringRatesSorted() {
@@ -204,7 +241,16 @@ std::vector<std::vector<int> > SpikeMonitorCore::getSpikeVector2D(){
 	assert(!isRecording());
 	assert(mode_==AER);
 
-	return spkVector_;
+	return spkStore_.getSpikeVector2D();
+}
+
+void SpikeMonitorCore::getSpikesInRange(int startTime, int endTime, std::vector<int>& spkTimes,
+	std::vector<int>& neurIds)
+{
+	assert(!isRecording());
+	assert(mode_==AER);
+
+	spkStore_.getSpikesInRange(startTime, endTime, spkTimes, neurIds);
 }
 
 void SpikeMonitorCore::print(bool printSpikeTimes) {
@@ -222,8 +268,21 @@ void SpikeMonitorCore::print(bool printSpikeTimes) {
 		getPopMeanFiringRate(),
 		getPopStdFiringRate());
 
+	if (mode_==STATS) {
+		KERNEL_INFO("ISI CV = %.2f (mean over neurons), Fano factor = %.2f, binned rate = %.2f +/- %.2f Hz "
+			"(max %.2f Hz, %d bins of %d ms)",
+			getPopMeanISICV(),
+			getPopFanoFactor(),
+			popBins_.mean*1000.0/(statsBinSize_*nNeurons_),
+			getPopStdBinnedRate(),
+			getPopMaxBinnedRate(),
+			getStatsNumBins(),
+			statsBinSize_);
+	}
+
 	if (printSpikeTimes && mode_==AER) {
 		// spike times only available in AER mode
+		std::vector<std::vector<int> > spkVector = getSpikeVector2D();
 		KERNEL_INFO("| Neur ID | Rate (Hz) | Spike Times (ms)");
 		KERNEL_INFO("|- - - - -|- - - - - -|- - - - - - - - - - - - - - - - -- - - - - - - - - - - - -")
 
@@ -234,13 +293,13 @@ void SpikeMonitorCore::print(bool printSpikeTimes) {
 #else
 			snprintf(buffer, 200, "| %7d | % 9.2f | ", i, getNeuronMeanFiringRate(i));
 #endif
-			int nSpk = spkVector_[i].size();
+			int nSpk = spkVector[i].size();
 			for (int j=0; j<nSpk; j++) {
 				char times[10];
 #if defined(WIN32) || defined(WIN64)
-				_snprintf(times, 10, "%8d", spkVector_[i][j]);
+				_snprintf(times, 10, "%8d", spkVector[i][j]);
 #else
-				snprintf(times, 10, "%8d", spkVector_[i][j]);
+				snprintf(times, 10, "%8d", spkVector[i][j]);
 #endif
 				strcat(buffer, times);
 				if (j%dispSpkTimPerRow == dispSpkTimPerRow-1 && j<nSpk-1) {
@@ -257,7 +316,179 @@ void SpikeMonitorCore::pushAER(int time, int neurId) {
 	assert(isRecording());
 	assert(getMode()==AER);
 
-	spkVector_[neurId].push_back(time);
+	spkStore_.push(time, neurId);
+}
+
+void SpikeMonitorCore::pushSpikeStats(int time, int neurId) {
+	assert(isRecording());
+	assert(getMode()==STATS);
+
+	// the spikes of a neuron arrive in order of spike time
+	neuron_stats_t& stats = neurStats_[neurId];
+	stats.numSpikes++;
+	popNumSpikes_++;
+	if (stats.lastSpikeTime>=0 && time>stats.lastSpikeTime)
+		stats.isi.add(time-stats.lastSpikeTime);
+	stats.lastSpikeTime = time;
+
+	int64_t bin = getStatsBin(time);
+	foldNeuronBins(stats, bin);
+	stats.curBinCnt++;
+
+	// the spikes of different neurons do not, so bins stay open until closeStatsBins
+	int64_t openBin = bin - popBinsDone_;
+	assert(openBin>=0);
+	if (openBin >= (int64_t)popBinCnt_.size())
+		popBinCnt_.resize(openBin+1, 0);
+	popBinCnt_[openBin]++;
+}
+
+void SpikeMonitorCore::closeStatsBins(int64_t time) {
+	assert(getMode()==STATS);
+
+	int64_t bin = getStatsBin(time);
+	if (bin <= popBinsDone_)
+		return;
+
+	int numDone = bin - popBinsDone_;
+	int numCounted = std::min(numDone, (int)popBinCnt_.size());
+	for (int i=0; i<numCounted; i++)
+		popBins_.add(popBinCnt_[i]);
+	popBins_.addZeros(numDone-numCounted);
+	popBinCnt_.erase(popBinCnt_.begin(), popBinCnt_.begin()+numCounted);
+	popBinsDone_ = bin;
+}
+
+void SpikeMonitorCore::foldNeuronBins(neuron_stats_t& stats, int64_t bin) {
+	if (bin <= stats.curBin)
+		return;
+
+	stats.binCnt.add(stats.curBinCnt);
+	stats.binCnt.addZeros(bin-stats.curBin-1);
+	stats.curBin = bin;
+	stats.curBinCnt = 0;
+}
+
+void SpikeMonitorCore::running_stats_t::add(double x) {
+	n++;
+	double delta = x-mean;
+	mean += delta/n;
+	m2 += delta*(x-mean);
+	max = (n==1) ? x : std::max(max, x);
+}
+
+void SpikeMonitorCore::running_stats_t::addZeros(int k) {
+	if (k<=0)
+		return;
+
+	// merge with the statistics of k zeros (mean 0, no variance)
+	double delta = -mean;
+	int nNew = n+k;
+	m2 += delta*delta*n*k/nNew;
+	mean += delta*k/nNew;
+	max = (n==0) ? 0.0 : std::max(max, 0.0);
+	n = nNew;
+}
+
+float SpikeMonitorCore::getNeuronISICV(int neurId) {
+	assert(!isRecording());
+	assert(neurId>=0 && neurId<nNeurons_);
+	assert(getMode()==STATS);
+
+	const running_stats_t& isi = neurStats_[neurId].isi;
+	if (isi.n<2 || isi.mean<=0.0)
+		return 0.0f;
+
+	return sqrt(isi.getVar())/isi.mean;
+}
+
+std::vector<float> SpikeMonitorCore::getAllISICV() {
+	assert(!isRecording());
+
+	std::vector<float> cv(nNeurons_);
+	for (int i=0; i<nNeurons_; i++)
+		cv[i] = getNeuronISICV(i);
+
+	return cv;
+}
+
+float SpikeMonitorCore::getPopMeanISICV() {
+	assert(!isRecording());
+	assert(getMode()==STATS);
+
+	// only neurons with at least two ISIs have a CV
+	double sumCV = 0.0;
+	int numNeur = 0;
+	for (int i=0; i<nNeurons_; i++) {
+		if (neurStats_[i].isi.n>=2) {
+			sumCV += getNeuronISICV(i);
+			numNeur++;
+		}
+	}
+
+	return (numNeur>0) ? sumCV/numNeur : 0.0f;
+}
+
+float SpikeMonitorCore::getNeuronFanoFactor(int neurId) {
+	assert(!isRecording());
+	assert(neurId>=0 && neurId<nNeurons_);
+	assert(getMode()==STATS);
+
+	const running_stats_t& binCnt = neurStats_[neurId].binCnt;
+	if (binCnt.mean<=0.0)
+		return 0.0f;
+
+	return binCnt.getVar()/binCnt.mean;
+}
+
+std::vector<float> SpikeMonitorCore::getAllFanoFactors() {
+	assert(!isRecording());
+
+	std::vector<float> fano(nNeurons_);
+	for (int i=0; i<nNeurons_; i++)
+		fano[i] = getNeuronFanoFactor(i);
+
+	return fano;
+}
+
+float SpikeMonitorCore::getPopFanoFactor() {
+	assert(!isRecording());
+	assert(getMode()==STATS);
+
+	if (popBins_.mean<=0.0)
+		return 0.0f;
+
+	return popBins_.getVar()/popBins_.mean;
+}
+
+float SpikeMonitorCore::getPopStdBinnedRate() {
+	assert(!isRecording());
+	assert(getMode()==STATS);
+
+	// spike count per bin -> mean firing rate of a neuron in Hz
+	return sqrt(popBins_.getVar())*1000.0/(statsBinSize_*nNeurons_);
+}
+
+float SpikeMonitorCore::getPopMaxBinnedRate() {
+	assert(!isRecording());
+	assert(getMode()==STATS);
+
+	return popBins_.max*1000.0/(statsBinSize_*nNeurons_);
+}
+
+void SpikeMonitorCore::setMode(spikeMonMode_t mode) {
+	assert(!isRecording());
+
+	mode_ = mode;
+	clear();
+}
+
+void SpikeMonitorCore::setStatsBinSize(int binSize) {
+	assert(!isRecording());
+	assert(binSize>0);
+
+	statsBinSize_ = binSize;
+	clear();
 }
 
 void SpikeMonitorCore::startRecording() {
@@ -290,6 +521,15 @@ void SpikeMonitorCore::startRecording() {
 		startTimeLast_ = currentTime;
 		accumTime_ = 0;
 	}
+
+	// ISIs do not span recording periods, and bins start over after the bins of previous periods
+	for (int i=0; i<nNeurons_; i++) {
+		neurStats_[i].lastSpikeTime = -1;
+		neurStats_[i].curBin = binOffset_;
+		neurStats_[i].curBinCnt = 0;
+	}
+	popBinsDone_ = binOffset_;
+	popBinCnt_.clear();
 }
 
 void SpikeMonitorCore::stopRecording() {
@@ -302,8 +542,24 @@ void SpikeMonitorCore::stopRecording() {
 
 	recordSet_ = false;
     userHasBeenWarned_ = false;
+
+	// sort and compact the last spikes, so that they can be queried
+	spkStore_.seal();
+
 	stopTime_ = snn_->getSimTimeSec()*1000+snn_->getSimTimeMs();
 
+	if (getMode()==STATS) {
+		// fold all complete bins into the statistics, and drop the partial bin at the end
+		closeStatsBins(stopTime_);
+		int64_t numBins = getStatsBin(stopTime_);
+		for (int i=0; i<nNeurons_; i++) {
+			foldNeuronBins(neurStats_[i], numBins);
+			neurStats_[i].curBinCnt = 0;
+		}
+		popBinCnt_.clear();
+		binOffset_ = numBins;
+	}
+
 	// total time is the amount of time of the last probe plus all accumulated time from previous probes
 	totalTime_ = stopTime_-startTimeLast_ + accumTime_;
 	assert(totalTime_>=0);
@@ -312,10 +568,11 @@ void SpikeMonitorCore::stopRecording() {
 void SpikeMonitorCore::setSpikeFileId(FILE* spikeFileId) {
 	assert(!isRecording());
 
-	// close previous file pointer if exists
+	// close previous file pointer if exists (after the spikes still waiting to be written)
 	if (spikeFileId_!=NULL) {
-		fclose(spikeFileId_);
+		snn_->getMonitorWriter()->closeFile(spikeFileWriterId_);
 		spikeFileId_ = NULL;
+		spikeFileWriterId_ = -1;
 	}
 
 	// set it to new file id
@@ -327,6 +584,9 @@ void SpikeMonitorCore::setSpikeFileId(FILE* spikeFileId) {
 		// file pointer has changed, so we need to write header (again)
 		needToWriteFileHeader_ = true;
 		writeSpikeFileHeader();
+
+		// spikes are written in the background
+		spikeFileWriterId_ = snn_->getMonitorWriter()->addFile(spikeFileId_);
 	}
 }
 
@@ -336,7 +596,7 @@ void SpikeMonitorCore::calculateFiringRates() {
 	if (!needToCalculateFiringRates_)
 		return;
 
-	assert(getMode()==AER);
+	assert(getMode()==AER || getMode()==STATS);
 
 	// clear, so we get the same answer every time.
 	firingRates_.assign(nNeurons_,0);
@@ -351,7 +611,7 @@ void SpikeMonitorCore::calculateFiringRates() {
 	// compute firing rate
 	assert(totalTime_>0); // avoid division by zero
 	for(int i=0;i<nNeurons_;i++) {
-		firingRates_[i]=spkVector_[i].size()*1000.0f/totalTime_;
+		firingRates_[i]=getNeuronNumSpikes(i)*1000.0f/totalTime_;
 	}
 
 	needToCalculateFiringRates_ = false;
@@ -404,15 +664,10 @@ void SpikeMonitorCore::writeSpikeFileHeader() {
 	needToWriteFileHeader_ = false;
 }
 
-// Iterate through 2D spike vector and approximate size in memory.
-// This is not exact, we are not counting the buffer overhead, only
-// the size each subvector is memory.
+// Approximate size of the spike store in memory.
+// This is not exact, we are not counting the buffer overhead.
 int64_t SpikeMonitorCore::getBufferSize(){
-    int64_t bufferSize=0; // in bytes
-    for(int i=0; i<spkVector_.size();i++){
-        bufferSize+=spkVector_[i].size()*sizeof(int);
-    }
-    return bufferSize;
+    return spkStore_.getSizeBytes();
 }
 
 // check if the spike vector is getting large. If it is, return true once until
@@ -43,6 +43,7 @@
 #define _SPIKE_MON_CORE_H_
 
 #include <carlsim_datastructures.h>	// spikeMonMode_t
+#include <spike_block_store.h>		// SpikeBlockStore, SpikeIterator
 #include <stdio.h>					// FILE
 #include <stdint.h>					// int64_t
 #include <vector>					// std::vector
@@ -84,6 +85,9 @@ public:
 	//! returns number of neurons in the group
 	int getGrpNumNeurons() { return nNeurons_; }
 
+	//! returns the number of replicas of the network (see CpuSNN::setNumReplicas)
+	int getNumReplicas();
+
 	//! returns the largest recorded firing rate
 	float getMaxFiringRate();
 
@@ -99,6 +103,36 @@ public:
 	//! returns the recorded mean firing rate for a specific neuron
 	float getNeuronMeanFiringRate(int neurId);
 
+	//! returns the coefficient of variation of the ISIs of a specific neuron (STATS mode)
+	float getNeuronISICV(int neurId);
+
+	//! returns the coefficients of variation of the ISIs of all neurons (STATS mode)
+	std::vector<float> getAllISICV();
+
+	//! returns the mean ISI coefficient of variation over all neurons with at least two ISIs (STATS mode)
+	float getPopMeanISICV();
+
+	//! returns the Fano factor of the binned spike counts of a specific neuron (STATS mode)
+	float getNeuronFanoFactor(int neurId);
+
+	//! returns the Fano factors of the binned spike counts of all neurons (STATS mode)
+	std::vector<float> getAllFanoFactors();
+
+	//! returns the Fano factor of the binned spike counts of the group (STATS mode)
+	float getPopFanoFactor();
+
+	//! returns the standard deviation of the binned population firing rate (STATS mode)
+	float getPopStdBinnedRate();
+
+	//! returns the largest binned population firing rate (STATS mode)
+	float getPopMaxBinnedRate();
+
+	//! returns the number of complete bins over all recording periods (STATS mode)
+	int getStatsNumBins() { return popBins_.n; }
+
+	//! returns the bin size (ms) of STATS mode
+	int getStatsBinSize() { return statsBinSize_; }
+
 	//! returns the number of recorded spikes of a specific neuron
 	int getNeuronNumSpikes(int neurId);
 
@@ -126,6 +160,12 @@ public:
 	//! computes the standard deviation of firing rates in the group
 	float getPopStdFiringRate();
 
+	//! returns the recorded mean firing rate of the neurons of a replica
+	float getReplicaMeanFiringRate(int replica);
+
+	//! returns the total number of recorded spikes of the neurons of a replica
+	int getReplicaNumSpikes(int replica);
+
 	//! returns the total recorded time in ms
 	int64_t getRecordingTotalTime() { return totalTime_; }
 
@@ -138,20 +178,41 @@ public:
 	//! returns the timestamp of stopRecording
 	int64_t getRecordingStopTime() { return stopTime_; }
 
-	//! returns the 2D AER vector
+	//! returns the 2D AER vector (built from the spike store)
 	std::vector<std::vector<int> > getSpikeVector2D();
 
+	//! returns an iterator pointing to the first recorded spike at or after startTime (ms)
+	SpikeIterator getSpikesBegin(int startTime) { return spkStore_.begin(startTime); }
+
+	//! returns an iterator pointing past the last recorded spike
+	SpikeIterator getSpikesEnd() { return spkStore_.end(); }
+
+	//! returns the number of recorded spikes in [startTime,endTime) (ms)
+	int getNumSpikesInRange(int startTime, int endTime) { return spkStore_.getNumSpikesInRange(startTime, endTime); }
+
+	//! appends the spike times and neuron IDs of all recorded spikes in [startTime,endTime) (ms) to the two vectors
+	void getSpikesInRange(int startTime, int endTime, std::vector<int>& spkTimes, std::vector<int>& neurIds);
+
 	//! returns recording status
 	bool isRecording() { return recordSet_; }
 
 	//! prints the AER vector in human-readable format
 	void print(bool printSpikeTimes);
 
-	//! inserts a (time,neurId) tupel into the 2D spike vector
+	//! inserts a (time,neurId) tupel into the spike store
 	void pushAER(int time, int neurId);
 
-	//! sets recording mode
-	void setMode(spikeMonMode_t mode) { mode_ = mode; }
+	//! updates the spike statistics with a spike of neuron neurId at time (STATS mode)
+	void pushSpikeStats(int time, int neurId);
+
+	//! folds the population spike counts of all bins that are complete at time into the statistics (STATS mode)
+	void closeStatsBins(int64_t time);
+
+	//! sets recording mode (deletes all recorded data)
+	void setMode(spikeMonMode_t mode);
+
+	//! sets the bin size (ms) of STATS mode (deletes all recorded data)
+	void setStatsBinSize(int binSize);
 
 	//! sets status of PersistentData mode
 	void setPersistentData(bool persistentData) { persistentData_ = persistentData; }
@@ -165,12 +226,15 @@ public:
 
 	// +++++ PUBLIC METHODS THAT SHOULD NOT BE EXPOSED TO INTERFACE +++++++++//
 
-	//! deletes data from the 2D spike vector
+	//! deletes data from the spike store
 	void clear();
 
 	//! returns a pointer to the spike file
 	FILE* getSpikeFileId() { return spikeFileId_; }
 
+	//! returns the ID of the spike file in the monitor writer (see CpuSNN::getMonitorWriter), or -1
+	int getSpikeFileWriterId() { return spikeFileWriterId_; }
+
 	//! sets pointer to spike file
 	void setSpikeFileId(FILE* spikeFileId);
 
@@ -183,7 +247,7 @@ public:
     //! returns true if spike buffer is close to maxAllowedBufferSize
     bool isBufferBig();
 
-    //! returns the approximate size of the spike vector in bytes
+    //! returns the approximate size of the spike store in bytes
     int64_t getBufferSize();
 
     //! returns the total accumulated time
@@ -202,6 +266,35 @@ private:
 	//! writes the header section (file signature, version number) of a spike file
 	void writeSpikeFileHeader();
 
+	//! online mean and variance of a series of values (Welford's algorithm)
+	struct running_stats_t {
+		int n;			//!< number of values
+		double mean;	//!< mean of the values
+		double m2;		//!< sum of squared deviations from the mean
+		double max;		//!< largest value
+
+		running_stats_t() : n(0), mean(0.0), m2(0.0), max(0.0) {}
+		void add(double x);
+		void addZeros(int k);
+		double getVar() const { return (n>1) ? m2/(n-1) : 0.0; }
+	};
+
+	//! spike statistics of a neuron (STATS mode)
+	struct neuron_stats_t {
+		int numSpikes;			//!< number of spikes
+		int lastSpikeTime;		//!< time of the last spike in this recording period, or -1
+		running_stats_t isi;	//!< ISIs (ms)
+		int64_t curBin;			//!< bin of the last spike (bins of previous recording periods included)
+		int curBinCnt;			//!< number of spikes in curBin, not yet folded into binCnt
+		running_stats_t binCnt;	//!< spike counts per bin (complete bins before curBin)
+	};
+
+	//! folds the spike counts of a neuron of all bins before bin into its statistics
+	void foldNeuronBins(neuron_stats_t& stats, int64_t bin);
+
+	//! returns the bin a spike at time falls into (STATS mode)
+	int64_t getStatsBin(int64_t time) { return binOffset_ + (time-startTimeLast_)/statsBinSize_; }
+
 	//! whether we have to perform calculateFiringRates()
 	bool needToCalculateFiringRates_;
 
@@ -217,11 +310,21 @@ private:
 	int nNeurons_;	//!< number of neurons in the group
 
 	FILE* spikeFileId_;	//!< file pointer to the spike file or NULL
+	int spikeFileWriterId_;	//!< ID of the spike file in the monitor writer, or -1
 	int spikeFileSignature_; //!< int signature of spike file
 	float spikeFileVersion_; //!< version number of spike file
 
 	//! Used to analyzed the spike information
-	std::vector<std::vector<int> > spkVector_;
+	SpikeBlockStore spkStore_;
+
+	// STATS mode: memory depends on the number of neurons, not on the recording time
+	int statsBinSize_;						//!< bin size (ms)
+	std::vector<neuron_stats_t> neurStats_;	//!< statistics per neuron
+	int popNumSpikes_;						//!< number of spikes of all neurons
+	int64_t binOffset_;						//!< number of complete bins of previous recording periods
+	int64_t popBinsDone_;					//!< first bin whose population spike count is still open
+	std::vector<int> popBinCnt_;			//!< population spike counts of the open bins, from popBinsDone_
+	running_stats_t popBins_;				//!< population spike counts per bin (complete bins)
 
 	std::vector<float> firingRates_;
 	std::vector<float> firingRatesSorted_;
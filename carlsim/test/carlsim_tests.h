@@ -93,4 +93,12 @@
 void readAndReturnSpikeFile(const std::string fileName, int*& AERArray, int64_t &arraySize);
 void readAndPrintSpikeFile(const std::string fileName);
 
+//! expects two weight matrices (as returned by ConnectionMonitor::takeSnapshot) to be equal
+//! Non-existent synapses (NaN) must be non-existent in both matrices. Weights are compared exactly if tolerance is 0.
+void expectEqualWeights(const std::vector<std::vector<float> >& wtA, const std::vector<std::vector<float> >& wtB,
+	float tolerance=0.0f);
+
+//! expects two delay matrices (as returned by CARLsim::getDelays) of numPre*numPost entries to be equal
+void expectEqualDelays(const uint8_t* delaysA, const uint8_t* delaysB, int numPre, int numPost);
+
 #endif // _CARLSIM_TEST_H_
@@ -1,6 +1,8 @@
 #include "carlsim_tests.h"
+#include "gtest/gtest.h"
 
 #include <stdio.h>			// fopen, fseek, fclose, etc.
+#include <math.h>			// isnan
 #include <cassert>			// assert
 #include <string.h>			// std::string
 
@@ -66,4 +68,37 @@ void readAndPrintSpikeFile(const std::string fileName){
 
 	for (int i=0; i<arraySize; i+=2)
 		printf("time = %d, nid = %d\n",arrayAER[i],arrayAER[i+1]);
-}
\ No newline at end of file
+}
+
+/// ****************************************************************************
+/// Functions for comparing weight and delay matrices
+/// ****************************************************************************
+void expectEqualWeights(const std::vector<std::vector<float> >& wtA, const std::vector<std::vector<float> >& wtB,
+	float tolerance)
+{
+	ASSERT_EQ(wtA.size(), wtB.size());
+	for (unsigned int i=0; i<wtA.size(); i++) {
+		ASSERT_EQ(wtA[i].size(), wtB[i].size());
+		for (unsigned int j=0; j<wtA[i].size(); j++) {
+			// non-existent synapses are reported as NaN
+#if defined(WIN32) || defined(WIN64)
+			if (_isnan(wtA[i][j])) {
+				EXPECT_TRUE(_isnan(wtB[i][j]));
+#else
+			if (isnan(wtA[i][j])) {
+				EXPECT_TRUE(isnan(wtB[i][j]));
+#endif
+			} else if (tolerance > 0.0f) {
+				EXPECT_NEAR(wtA[i][j], wtB[i][j], tolerance);
+			} else {
+				EXPECT_EQ(wtA[i][j], wtB[i][j]);
+			}
+		}
+	}
+}
+
+void expectEqualDelays(const uint8_t* delaysA, const uint8_t* delaysB, int numPre, int numPost) {
+	for (int i=0; i<numPre*numPost; i++) {
+		EXPECT_EQ(delaysA[i], delaysB[i]);
+	}
+}
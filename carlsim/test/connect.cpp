@@ -405,3 +405,55 @@ TEST(CONNECT, connectGaussian) {
 		}
 	}
 }
+
+//! the synapses of the built-in connection types must only depend on the random seed, not on the number of threads
+//! used to build the network
+TEST(CONNECT, connectParallelDeterministic) {
+	int numThreads[] = {1, 2, 3, 7};
+	std::vector< std::vector<float> > wtSerial[4];
+	uint8_t* delaySerial[4] = {NULL, NULL, NULL, NULL};
+
+	for (int nt=0; nt<4; nt++) {
+		CARLsim* sim = new CARLsim("CONNECT.connectParallelDeterministic",CPU_MODE,SILENT,0,42);
+		int g0=sim->createGroup("excit0", Grid3D(10,10,1), EXCITATORY_NEURON);
+		int g1=sim->createGroup("excit1", Grid3D(8,8,2), EXCITATORY_NEURON);
+		int g2=sim->createGroup("excit2", Grid3D(10,10,1), EXCITATORY_NEURON);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g2, 0.02f, 0.2f, -65.0f, 8.0f);
+
+		// gaussian weights depend on the distance between pre and post
+		int c[4];
+		c[0]=sim->connect(g0, g1, "random", RangeWeight(0.0f, 0.1f, 0.2f), 0.3f, RangeDelay(1,20), RadiusRF(-1),
+			SYN_PLASTIC);
+		c[1]=sim->connect(g0, g2, "one-to-one", RangeWeight(0.2f), 1.0f, RangeDelay(1,10));
+		c[2]=sim->connect(g1, g2, "gaussian", RangeWeight(0.3f), 0.7f, RangeDelay(1,15), RadiusRF(3,3,1));
+		c[3]=sim->connect(g2, g1, "full", RangeWeight(0.4f), 1.0f, RangeDelay(1,5), RadiusRF(2,2,-1));
+		sim->setNumThreads(numThreads[nt]);
+		sim->setupNetwork();
+
+		int grpPre[4] = {g0, g0, g1, g2}, grpPost[4] = {g1, g2, g2, g1};
+		for (int i=0; i<4; i++) {
+			ConnectionMonitor* CM = sim->setConnectionMonitor(grpPre[i], grpPost[i], "NULL");
+			std::vector< std::vector<float> > wt = CM->takeSnapshot();
+			int Npre, Npost;
+			uint8_t* delays = sim->getDelays(grpPre[i], grpPost[i], Npre, Npost);
+			EXPECT_EQ(sim->getNumSynapticConnections(c[i]), CM->getNumSynapses());
+			EXPECT_GT(CM->getNumSynapses(), 0);
+
+			if (nt==0) {
+				wtSerial[i] = wt;
+				delaySerial[i] = delays;
+			} else {
+				expectEqualWeights(wtSerial[i], wt);
+				expectEqualDelays(delaySerial[i], delays, Npre, Npost);
+				delete[] delays;
+			}
+		}
+
+		delete sim;
+	}
+
+	for (int i=0; i<4; i++)
+		delete[] delaySerial[i];
+}
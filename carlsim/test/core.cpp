@@ -3,6 +3,13 @@
 
 #include <carlsim.h>
 #include <vector>
+#include <sstream>
+#include <algorithm>	// std::lower_bound
+
+#if !defined(WIN32) && !defined(WIN64)
+#include <pthread.h>
+#include <time.h>		// clock_gettime, nanosleep
+#endif
 
 #if defined(WIN32) || defined(WIN64)
 #include <periodic_spikegen.h>
@@ -797,3 +804,828 @@ TEST(CORE, setNeuronParameters) {
 		}
 	}
 }
+
+// multi-threaded neuronal state update and spike delivery in CPU mode must produce the exact same spike trains and
+// weights as the single-threaded version, regardless of how the neurons are split among threads
+TEST(CORE, setNumThreads) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	for (int coba=0; coba<=1; coba++) {
+		std::vector<std::vector<int> > spkVecSerial;
+		std::vector<std::vector<float> > wtSerial;
+		int numThreads[] = {1, 3, 4};
+		for (int nt=0; nt<3; nt++) {
+			CARLsim* sim = new CARLsim("CORE.setNumThreads", CPU_MODE, SILENT, 0, 42);
+			int gIn = sim->createSpikeGeneratorGroup("input", 50, EXCITATORY_NEURON);
+			int gExc = sim->createGroup("exc", 80, EXCITATORY_NEURON);
+			int gInh = sim->createGroup("inh", 21, INHIBITORY_NEURON);
+			int gDA = sim->createGroup("da", 7, DOPAMINERGIC_NEURON);
+			sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+			sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f); // FS
+			sim->setNeuronParameters(gDA, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+			sim->connect(gIn, gExc, "random", RangeWeight(0.0f, coba?0.5f:20.0f, coba?1.0f:40.0f), 0.2f,
+				RangeDelay(1,10), RadiusRF(-1), SYN_PLASTIC);
+			float wt = coba ? 0.05f : 4.0f;
+			sim->connect(gExc, gExc, "random", RangeWeight(wt), 0.1f, RangeDelay(1,20));
+			sim->connect(gExc, gInh, "random", RangeWeight(wt), 0.1f, RangeDelay(1,20));
+			sim->connect(gInh, gExc, "random", RangeWeight(wt), 0.1f, RangeDelay(1));
+			sim->connect(gIn, gDA, "random", RangeWeight(coba?0.5f:20.0f), 0.2f, RangeDelay(1,5));
+			sim->connect(gDA, gExc, "random", RangeWeight(wt), 0.2f, RangeDelay(1,5));
+			sim->setESTDP(gExc, true, DA_MOD, ExpCurve(2e-4f,20.0f, -6.6e-5f,60.0f));
+			sim->setConductances(coba>0);
+			sim->setNumThreads(numThreads[nt]);
+			EXPECT_EQ(sim->getNumThreads(), numThreads[nt]);
+			sim->setupNetwork();
+
+			SpikeMonitor* SM = sim->setSpikeMonitor(gExc, "NULL");
+			ConnectionMonitor* CM = sim->setConnectionMonitor(gIn, gExc, "NULL");
+			PoissonRate PR(50);
+			PR.setRates(20.0f);
+			sim->setSpikeRate(gIn, &PR);
+
+			SM->startRecording();
+			sim->runNetwork(2, 0, false);
+			SM->stopRecording();
+
+			if (nt == 0) {
+				spkVecSerial = SM->getSpikeVector2D();
+				wtSerial = CM->takeSnapshot();
+				EXPECT_GT(SM->getPopNumSpikes(), 0);
+			} else {
+				// plastic weights depend on the order of STDP updates during spike delivery
+				expectEqualWeights(wtSerial, CM->takeSnapshot());
+
+				std::vector<std::vector<int> > spkVec = SM->getSpikeVector2D();
+				ASSERT_EQ(spkVec.size(), spkVecSerial.size());
+				for (unsigned int i=0; i<spkVec.size(); i++) {
+					ASSERT_EQ(spkVec[i].size(), spkVecSerial[i].size());
+					for (unsigned int j=0; j<spkVec[i].size(); j++) {
+						EXPECT_EQ(spkVec[i][j], spkVecSerial[i][j]);
+					}
+				}
+			}
+
+			delete sim;
+		}
+	}
+
+	CARLsim* sim = new CARLsim("CORE.setNumThreads", CPU_MODE, SILENT, 0, 42);
+	EXPECT_DEATH({sim->setNumThreads(0);},"");
+	EXPECT_DEATH({sim->setNumThreads(MAX_NUM_CPU_THREADS+1);},"");
+	delete sim;
+}
+
+// builds a small network that draws random numbers in every stage: neuron parameters, connectivity, initial
+// weights, and Poisson input
+static CARLsim* createRandomNetwork(const std::string& name, int randSeed, int numThreads, PoissonRate* rate,
+	SpikeMonitor** spkMon)
+{
+	CARLsim* sim = new CARLsim(name, CPU_MODE, SILENT, 0, randSeed);
+	int gIn = sim->createSpikeGeneratorGroup("input", 50, EXCITATORY_NEURON);
+	int gExc = sim->createGroup("exc", 80, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gExc, 0.02f, 0.01f, 0.2f, 0.02f, -65.0f, 5.0f, 8.0f, 2.0f);
+	sim->connect(gIn, gExc, "random", RangeWeight(0.0f, 10.0f, 20.0f), 0.2f, RangeDelay(1,10), RadiusRF(-1),
+		SYN_PLASTIC);
+	sim->connect(gExc, gExc, "random", RangeWeight(2.0f), 0.1f, RangeDelay(1,20));
+	sim->setConductances(false);
+	sim->setNumThreads(numThreads);
+	*spkMon = sim->setSpikeMonitor(gExc, "NULL");
+	sim->setupNetwork();
+	sim->setSpikeRate(gIn, rate);
+	return sim;
+}
+
+// the random numbers of a network depend only on its seed: a network must produce the same spikes whether it runs
+// alone or interleaved with another network in the same process
+TEST(CORE, randomStreamsPerInstance) {
+	PoissonRate rate(50);
+	rate.setRates(20.0f);
+
+	SpikeMonitor* spkMon;
+	CARLsim* sim = createRandomNetwork("CORE.randomStreams", 42, 1, &rate, &spkMon);
+	spkMon->startRecording();
+	for (int i=0; i<10; i++)
+		sim->runNetwork(0, 100, false); // Poisson time slices depend on the run duration
+	spkMon->stopRecording();
+	std::vector<std::vector<int> > spkVecAlone = spkMon->getSpikeVector2D();
+	EXPECT_GT(spkMon->getPopNumSpikes(), 0);
+	delete sim;
+
+	SpikeMonitor *spkMonA, *spkMonB;
+	CARLsim* simA = createRandomNetwork("CORE.randomStreamsA", 42, 1, &rate, &spkMonA);
+	CARLsim* simB = createRandomNetwork("CORE.randomStreamsB", 7, 1, &rate, &spkMonB);
+	spkMonA->startRecording();
+	spkMonB->startRecording();
+	for (int i=0; i<10; i++) {
+		simA->runNetwork(0, 100, false);
+		simB->runNetwork(0, 100, false);
+	}
+	spkMonA->stopRecording();
+	spkMonB->stopRecording();
+
+	EXPECT_TRUE(spkMonA->getSpikeVector2D() == spkVecAlone);
+	EXPECT_FALSE(spkMonB->getSpikeVector2D() == spkVecAlone); // a different seed must give different spikes
+	delete simA;
+	delete simB;
+}
+
+#if !defined(WIN32) && !defined(WIN64)
+struct concurrent_run_t {
+	int id;
+	int numThreads;
+	int numSpikes;
+	std::vector<std::vector<int> > spkVec;
+};
+
+// builds and runs the network of a concurrent_run_t, can be used as a pthread entry point
+static void* runRandomNetwork(void* arg) {
+	concurrent_run_t* run = (concurrent_run_t*)arg;
+	std::stringstream name;
+	name << "CORE.concurrentInstances" << run->id;
+
+	PoissonRate rate(50);
+	rate.setRates(20.0f);
+	SpikeMonitor* spkMon;
+	CARLsim* sim = createRandomNetwork(name.str(), 42+run->id, run->numThreads, &rate, &spkMon);
+	spkMon->startRecording();
+	sim->runNetwork(0, 500, false);
+	spkMon->stopRecording();
+	run->numSpikes = spkMon->getPopNumSpikes();
+	run->spkVec = spkMon->getSpikeVector2D();
+	delete sim;
+	return NULL;
+}
+
+// independent networks must be safe to set up and run concurrently from different threads, and must produce the
+// same spikes as when run alone
+TEST(CORE, concurrentInstances) {
+	const int numInstances = 8;
+	concurrent_run_t alone[numInstances], concurrent[numInstances];
+	for (int i=0; i<numInstances; i++) {
+		alone[i].id = concurrent[i].id = i;
+		alone[i].numThreads = concurrent[i].numThreads = 1 + i%2; // some of them with a thread pool of their own
+		runRandomNetwork(&alone[i]);
+	}
+
+	pthread_t threads[numInstances];
+	for (int i=0; i<numInstances; i++)
+		ASSERT_EQ(pthread_create(&threads[i], NULL, &runRandomNetwork, &concurrent[i]), 0);
+	for (int i=0; i<numInstances; i++)
+		pthread_join(threads[i], NULL);
+
+	for (int i=0; i<numInstances; i++) {
+		EXPECT_GT(alone[i].numSpikes, 0);
+		EXPECT_TRUE(concurrent[i].spkVec == alone[i].spkVec);
+	}
+}
+#endif
+
+//! a COBA network with STP, whose input weights can be changed after setup (one-to-one connection)
+static CARLsim* createResetNetwork(const std::string& name, float wtIn, PoissonRate* rate, SpikeMonitor** spkMon,
+	short int* connIn)
+{
+	CARLsim* sim = new CARLsim(name, CPU_MODE, SILENT, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", 20, EXCITATORY_NEURON);
+	int gExc = sim->createGroup("exc", 20, EXCITATORY_NEURON);
+	int gInh = sim->createGroup("inh", 10, INHIBITORY_NEURON);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+	*connIn = sim->connect(gIn, gExc, "one-to-one", RangeWeight(0.0f, wtIn, 1.0f), 1.0f, RangeDelay(1),
+		RadiusRF(-1), SYN_PLASTIC);
+	sim->connect(gExc, gInh, "random", RangeWeight(0.1f), 0.5f, RangeDelay(1));
+	sim->connect(gInh, gExc, "random", RangeWeight(0.1f), 0.5f, RangeDelay(1));
+	sim->setSTP(gIn, true, 0.2f, 20.0f, 700.0f);
+	sim->setConductances(true);
+	*spkMon = sim->setSpikeMonitor(gExc, "NULL");
+	sim->setupNetwork();
+	sim->setSpikeRate(gIn, rate);
+	return sim;
+}
+
+// after resetState, a network must behave exactly like a new network with the same weights
+TEST(CORE, resetState) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+	PoissonRate rate(20);
+	rate.setRates(30.0f);
+
+	SpikeMonitor *spkMon, *spkMonNew;
+	short int connIn, connInNew;
+	CARLsim* sim = createResetNetwork("CORE.resetState", 0.5f, &rate, &spkMon, &connIn);
+	spkMon->startRecording();
+	sim->runNetwork(0, 500, false);
+	spkMon->stopRecording();
+	std::vector<std::vector<int> > spkVecFirst = spkMon->getSpikeVector2D();
+	EXPECT_GT(spkMon->getPopNumSpikes(), 0);
+
+	// same weights: the run must be repeated exactly
+	sim->resetState();
+	EXPECT_EQ(sim->getSimTime(), 0);
+	spkMon->startRecording();
+	sim->runNetwork(0, 500, false);
+	spkMon->stopRecording();
+	EXPECT_TRUE(spkMon->getSpikeVector2D() == spkVecFirst);
+
+	// new weights: same as a network built with these weights
+	sim->resetState();
+	for (int i=0; i<20; i++)
+		sim->setWeight(connIn, i, i, 0.8f);
+	spkMon->startRecording();
+	sim->runNetwork(0, 500, false);
+	spkMon->stopRecording();
+
+	CARLsim* simNew = createResetNetwork("CORE.resetStateNew", 0.8f, &rate, &spkMonNew, &connInNew);
+	spkMonNew->startRecording();
+	simNew->runNetwork(0, 500, false);
+	spkMonNew->stopRecording();
+	EXPECT_TRUE(spkMon->getSpikeVector2D() == spkMonNew->getSpikeVector2D());
+	EXPECT_FALSE(spkMon->getSpikeVector2D() == spkVecFirst);
+
+	// cannot reset while recording
+	spkMon->startRecording();
+	EXPECT_DEATH({sim->resetState();},"");
+
+	delete simNew;
+	delete sim;
+}
+
+//! parameters of the network built by createUpdateNetwork
+struct update_params_t {
+	float c, d;               //!< Izhikevich parameters c and d of the excitatory group
+	float alphaPlus;          //!< E-STDP amplitude
+	float homeoScale, avgTimeScale, baseFiring; //!< homeostasis parameters
+};
+
+//! a plastic network with E-STDP and homeostasis on the excitatory group
+static CARLsim* createUpdateNetwork(const std::string& name, const update_params_t& p, PoissonRate* rate,
+	SpikeMonitor** spkMon, ConnectionMonitor** connMon, int* gExc)
+{
+	CARLsim* sim = new CARLsim(name, CPU_MODE, SILENT, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", 20, EXCITATORY_NEURON);
+	*gExc = sim->createGroup("exc", 20, EXCITATORY_NEURON);
+	sim->setNeuronParameters(*gExc, 0.02f, 0.0f, 0.2f, 0.0f, p.c, 0.0f, p.d, 1.0f);
+	sim->connect(gIn, *gExc, "random", RangeWeight(0.0f, 0.4f, 1.0f), 0.5f, RangeDelay(1,5), RadiusRF(-1),
+		SYN_PLASTIC);
+	sim->setESTDP(*gExc, true, STANDARD, ExpCurve(p.alphaPlus, 20.0f, 0.001f, 20.0f));
+	sim->setHomeostasis(*gExc, true, p.homeoScale, p.avgTimeScale);
+	sim->setHomeoBaseFiringRate(*gExc, p.baseFiring, 1.0f);
+	sim->setConductances(true);
+	*spkMon = sim->setSpikeMonitor(*gExc, "NULL");
+	sim->setupNetwork();
+	*connMon = sim->setConnectionMonitor(gIn, *gExc, "NULL");
+	sim->setSpikeRate(gIn, rate);
+	return sim;
+}
+
+// parameters changed after setup must give the same result as a network built with these parameters
+TEST(CORE, updateParametersAfterSetup) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+	PoissonRate rate(20);
+	rate.setRates(30.0f);
+
+	update_params_t pOld = {-65.0f, 8.0f, 0.001f, 1.0f, 2.0f, 10.0f};
+	update_params_t pNew = {-60.0f, 4.0f, 0.005f, 0.5f, 5.0f, 20.0f};
+
+	SpikeMonitor *spkMon, *spkMonNew;
+	ConnectionMonitor *connMon, *connMonNew;
+	int gExc, gExcNew;
+	CARLsim* sim = createUpdateNetwork("CORE.updateParameters", pOld, &rate, &spkMon, &connMon, &gExc);
+
+	// a first trial with the old parameters, which must not change the weights
+	sim->startTesting();
+	sim->runNetwork(0, 200, false);
+	sim->stopTesting();
+
+	sim->updateNeuronParameters(gExc, 0.02f, 0.0f, 0.2f, 0.0f, pNew.c, 0.0f, pNew.d, 1.0f);
+	sim->updateESTDP(gExc, ExpCurve(pNew.alphaPlus, 20.0f, 0.001f, 20.0f));
+	sim->updateHomeostasis(gExc, pNew.homeoScale, pNew.avgTimeScale);
+	sim->updateHomeoBaseFiringRate(gExc, pNew.baseFiring, 1.0f);
+	sim->resetState();
+	spkMon->startRecording();
+	sim->runNetwork(1, 0, false);
+	spkMon->stopRecording();
+
+	CARLsim* simNew = createUpdateNetwork("CORE.updateParametersNew", pNew, &rate, &spkMonNew, &connMonNew,
+		&gExcNew);
+	spkMonNew->startRecording();
+	simNew->runNetwork(1, 0, false);
+	spkMonNew->stopRecording();
+
+	EXPECT_GT(spkMonNew->getPopNumSpikes(), 0);
+	EXPECT_TRUE(spkMon->getSpikeVector2D() == spkMonNew->getSpikeVector2D());
+	expectEqualWeights(connMon->takeSnapshot(), connMonNew->takeSnapshot());
+
+	// only parameters of features that were enabled before setup can be changed
+	EXPECT_DEATH({sim->updateISTDP(gExc, PulseCurve(0.1f, -0.1f, 10.0f, 20.0f));},"");
+	EXPECT_DEATH({sim->updateNeuronParameters(0, 0.02f, 0.2f, -65.0f, 8.0f);},""); // spike generator
+	EXPECT_DEATH({sim->updateNeuronParameters(ALL, 0.02f, 0.2f, -65.0f, 8.0f);},"");
+
+	delete simNew;
+	delete sim;
+}
+
+// restoring a snapshot must rewind the network: running it again gives the same spikes and weights
+TEST(CORE, snapshotRestore) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+	PoissonRate rate(20);
+	rate.setRates(30.0f);
+	update_params_t p = {-65.0f, 8.0f, 0.001f, 1.0f, 2.0f, 10.0f};
+
+	SpikeMonitor *spkMon, *spkMonOther;
+	ConnectionMonitor *connMon, *connMonOther;
+	int gExc, gExcOther;
+	CARLsim* sim = createUpdateNetwork("CORE.snapshotRestore", p, &rate, &spkMon, &connMon, &gExc);
+	sim->runNetwork(0, 700, false);
+	SimulationSnapshot* snap = sim->snapshot();
+	EXPECT_EQ(snap->getSimTime(), 700);
+	std::vector<std::vector<float> > wtSnap = connMon->takeSnapshot();
+
+	// the probe crosses a second boundary, so that the weights get updated
+	spkMon->startRecording();
+	sim->runNetwork(0, 800, false);
+	spkMon->stopRecording();
+	std::vector<std::vector<int> > spkVecProbe = spkMon->getSpikeVector2D();
+	std::vector<std::vector<float> > wtProbe = connMon->takeSnapshot();
+	EXPECT_GT(spkMon->getPopNumSpikes(), 0);
+
+	for (int i=0; i<2; i++) {
+		sim->restore(snap);
+		EXPECT_EQ(sim->getSimTime(), 700);
+		expectEqualWeights(connMon->takeSnapshot(), wtSnap);
+
+		spkMon->clear();
+		spkMon->startRecording();
+		sim->runNetwork(0, 800, false);
+		spkMon->stopRecording();
+		EXPECT_TRUE(spkMon->getSpikeVector2D() == spkVecProbe);
+		expectEqualWeights(connMon->takeSnapshot(), wtProbe);
+	}
+
+	// in testing mode the weights do not change, so that snapshots share them
+	sim->startTesting();
+	SimulationSnapshot* snapTest = sim->snapshot();
+	size_t memTest = snapTest->getMemoryUsage();
+	sim->runNetwork(0, 100, false);
+	SimulationSnapshot* snapTest2 = sim->snapshot();
+	EXPECT_LT(snapTest->getMemoryUsage(), memTest);
+	EXPECT_LT(snapTest2->getMemoryUsage(), memTest);
+	sim->stopTesting();
+
+	CARLsim* simOther = createUpdateNetwork("CORE.snapshotRestoreOther", p, &rate, &spkMonOther, &connMonOther,
+		&gExcOther);
+	EXPECT_DEATH({simOther->restore(snap);},"");
+	EXPECT_DEATH({sim->restore(NULL);},"");
+	spkMon->startRecording();
+	EXPECT_DEATH({sim->restore(snap);},"");
+	spkMon->stopRecording();
+
+	// snapshots may outlive their network
+	delete simOther;
+	delete sim;
+	delete snapTest2;
+	delete snapTest;
+	delete snap;
+}
+
+// stepping must simulate exactly what runNetwork(0,1) does, and expose the spikes of every step
+TEST(CORE, stepMatchesRunNetwork) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+	PoissonRate rate(20);
+	rate.setRates(30.0f);
+	update_params_t p = {-65.0f, 8.0f, 0.001f, 1.0f, 2.0f, 10.0f};
+
+	SpikeMonitor *spkMonRun, *spkMonStep;
+	ConnectionMonitor *connMonRun, *connMonStep;
+	int gExcRun, gExcStep;
+	CARLsim* simRun = createUpdateNetwork("CORE.stepRun", p, &rate, &spkMonRun, &connMonRun, &gExcRun);
+	CARLsim* simStep = createUpdateNetwork("CORE.stepStep", p, &rate, &spkMonStep, &connMonStep, &gExcStep);
+
+	spkMonRun->startRecording();
+	for (int t=0; t<1500; t++)
+		simRun->runNetwork(0, 1, false);
+	spkMonRun->stopRecording();
+
+	// the steps cross a second boundary, so that the weights get updated
+	std::vector<std::vector<int> > spkVecStep(simStep->getGroupNumNeurons(gExcStep));
+	std::vector<int> spikes;
+	spkMonStep->startRecording();
+	simStep->stepN(500);
+	for (int t=500; t<1500; t++) {
+		simStep->step();
+		int numSpikes = simStep->getLastStepSpikes(gExcStep, spikes);
+		EXPECT_EQ(numSpikes, spikes.size());
+		for (unsigned int i=0; i<spikes.size(); i++)
+			spkVecStep[spikes[i]].push_back(t);
+	}
+	spkMonStep->stopRecording();
+	EXPECT_EQ(simStep->getSimTime(), 1500);
+
+	EXPECT_GT(spkMonStep->getPopNumSpikes(), 0);
+	EXPECT_TRUE(spkMonStep->getSpikeVector2D() == spkMonRun->getSpikeVector2D());
+	expectEqualWeights(connMonStep->takeSnapshot(), connMonRun->takeSnapshot());
+
+	// the spikes of the last 1000 steps, as recorded by the SpikeMonitor
+	std::vector<std::vector<int> > spkVecMon = spkMonStep->getSpikeVector2D();
+	for (unsigned int i=0; i<spkVecMon.size(); i++)
+		spkVecMon[i].erase(spkVecMon[i].begin(), std::lower_bound(spkVecMon[i].begin(), spkVecMon[i].end(), 500));
+	EXPECT_TRUE(spkVecStep == spkVecMon);
+
+	EXPECT_DEATH({simStep->stepN(0);},"");
+	EXPECT_DEATH({simStep->getLastStepSpikes(ALL, spikes);},"");
+
+	delete simStep;
+	delete simRun;
+}
+
+static double getWallTimeMs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec*1000.0 + ts.tv_nsec/1000000.0;
+}
+
+// real-time mode must pace the simulation without changing what is simulated, and must count late steps
+TEST(CORE, realTimeMode) {
+	PoissonRate rate(20);
+	rate.setRates(30.0f);
+	update_params_t p = {-65.0f, 8.0f, 0.001f, 1.0f, 2.0f, 10.0f};
+
+	SpikeMonitor *spkMon, *spkMonRT;
+	ConnectionMonitor *connMon, *connMonRT;
+	int gExc, gExcRT;
+	CARLsim* sim = createUpdateNetwork("CORE.realTimeOff", p, &rate, &spkMon, &connMon, &gExc);
+	CARLsim* simRT = createUpdateNetwork("CORE.realTimeOn", p, &rate, &spkMonRT, &connMonRT, &gExcRT);
+
+	spkMon->startRecording();
+	sim->runNetwork(0, 300, false);
+	spkMon->stopRecording();
+
+	simRT->setRealTimeMode(true);
+	spkMonRT->startRecording();
+	double startMs = getWallTimeMs();
+	simRT->runNetwork(0, 300, false);
+	double durMs = getWallTimeMs() - startMs;
+	spkMonRT->stopRecording();
+
+	EXPECT_GE(durMs, 300.0);
+	EXPECT_GT(spkMonRT->getPopNumSpikes(), 0);
+	EXPECT_TRUE(spkMonRT->getSpikeVector2D() == spkMon->getSpikeVector2D());
+
+	RealTimeStats_t stats = simRT->getRealTimeStats();
+	EXPECT_EQ(stats.numSteps, 300);
+	EXPECT_LE(stats.numOverruns, stats.numSteps);
+	EXPECT_EQ(stats.numSkippedMonitorUpdates, 0);
+	if (stats.numOverruns < stats.numSteps) {
+		EXPECT_GE(stats.minSlackMs, 0.0);
+		EXPECT_LE(stats.minSlackMs, stats.meanSlackMs);
+		EXPECT_LE(stats.meanSlackMs, 1.0);
+	}
+
+	// user code that takes 5 ms makes the next step late, which happens to end a second: the ConnectionMonitor
+	// snapshot gets skipped
+	simRT->setRealTimeMode(false);
+	simRT->runNetwork(0, 698, false);
+	simRT->setRealTimeMode(true, true);
+	simRT->resetRealTimeStats();
+	simRT->step();
+	struct timespec ts = {0, 5000000};
+	nanosleep(&ts, NULL);
+	simRT->step();
+	EXPECT_EQ(simRT->getSimTime(), 1000);
+
+	stats = simRT->getRealTimeStats();
+	EXPECT_EQ(stats.numSteps, 2);
+	EXPECT_GE(stats.numOverruns, 1);
+	EXPECT_GE(stats.maxLatenessMs, 3.0);
+	EXPECT_EQ(stats.numSkippedMonitorUpdates, 1);
+
+	// without real-time mode nothing is counted
+	simRT->setRealTimeMode(false);
+	simRT->resetRealTimeStats();
+	simRT->runNetwork(0, 10, false);
+	EXPECT_EQ(simRT->getRealTimeStats().numSteps, 0);
+
+	delete simRT;
+	delete sim;
+}
+
+//! builds a network with numReplicas replicas, where replica r uses d=dExc[r] and input weight wtIn[r]
+static CARLsim* createReplicaNetwork(const std::string& name, int numReplicas, const float* dExc, const float* wtIn,
+	SpikeMonitor** spkMon, short int* connIn)
+{
+	CARLsim* sim = new CARLsim(name, CPU_MODE, SILENT, 0, 42);
+	sim->setNumReplicas(numReplicas);
+	int gIn = sim->createGroup("input", 10, EXCITATORY_NEURON);
+	int gExc = sim->createGroup("exc", Grid3D(4,5), EXCITATORY_NEURON);
+	sim->setNeuronParameters(gIn, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	for (int r=0; r<numReplicas; r++)
+		sim->setReplicaNeuronParameters(gExc, r, 0.02f, 0.2f, -65.0f, dExc[r]);
+	*connIn = sim->connect(gIn, gExc, "random", RangeWeight(1.0f), 0.5f, RangeDelay(1,5));
+	sim->connect(gExc, gExc, "gaussian", RangeWeight(0.5f), 0.5f, RangeDelay(1), RadiusRF(2,2,0));
+	sim->setConductances(false);
+	*spkMon = sim->setSpikeMonitor(gExc, "NULL");
+	sim->setupNetwork();
+	for (int r=0; r<numReplicas; r++)
+		sim->setReplicaWeight(*connIn, r, wtIn[r], true);
+
+	// every replica gets the same input
+	std::vector<float> current(sim->getGroupNumNeurons(gIn));
+	for (unsigned int i=0; i<current.size(); i++)
+		current[i] = 5.0f + (i%10);
+	sim->setExternalCurrent(gIn, current);
+	return sim;
+}
+
+// every replica must behave exactly like a network of its own with the parameters of that replica
+TEST(CORE, replicasMatchSingleNetworks) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+	const int numReplicas = 3;
+	const float dExc[numReplicas] = {8.0f, 4.0f, 2.0f};
+	const float wtIn[numReplicas] = {8.0f, 12.0f, 16.0f};
+
+	SpikeMonitor* spkMon;
+	short int connIn;
+	CARLsim* sim = createReplicaNetwork("CORE.replicas", numReplicas, dExc, wtIn, &spkMon, &connIn);
+	EXPECT_EQ(sim->getNumReplicas(), numReplicas);
+	EXPECT_EQ(sim->getGroupNumNeurons(1), numReplicas*20);
+	EXPECT_EQ(sim->getNeuronLocation3D(1, 20+7), sim->getNeuronLocation3D(1, 7));
+	spkMon->startRecording();
+	sim->runNetwork(1, 0, false);
+	spkMon->stopRecording();
+	std::vector<std::vector<int> > spkVec = spkMon->getSpikeVector2D();
+
+	for (int r=0; r<numReplicas; r++) {
+		SpikeMonitor* spkMonSingle;
+		short int connInSingle;
+		CARLsim* simSingle = createReplicaNetwork("CORE.replicasSingle", 1, &dExc[r], &wtIn[r], &spkMonSingle,
+			&connInSingle);
+		EXPECT_EQ(sim->getNumSynapticConnections(connIn), numReplicas*simSingle->getNumSynapticConnections(connIn));
+		spkMonSingle->startRecording();
+		simSingle->runNetwork(1, 0, false);
+		spkMonSingle->stopRecording();
+
+		std::vector<std::vector<int> > spkVecSingle = spkMonSingle->getSpikeVector2D();
+		EXPECT_GT(spkMonSingle->getPopNumSpikes(), 0);
+		EXPECT_EQ(spkMon->getReplicaNumSpikes(r), spkMonSingle->getPopNumSpikes());
+		EXPECT_FLOAT_EQ(spkMon->getReplicaMeanFiringRate(r), spkMonSingle->getPopMeanFiringRate());
+		for (int i=0; i<20; i++)
+			EXPECT_TRUE(spkVec[r*20+i] == spkVecSingle[i]);
+		delete simSingle;
+	}
+
+	// different parameters must lead to different activity
+	EXPECT_NE(spkMon->getReplicaNumSpikes(0), spkMon->getReplicaNumSpikes(numReplicas-1));
+
+	// replicas must be set before the first group is created
+	EXPECT_DEATH({CARLsim simDeath("CORE.replicasDeath", CPU_MODE, SILENT, 0, 42);
+		simDeath.createGroup("exc", 10, EXCITATORY_NEURON);
+		simDeath.setNumReplicas(2);},"");
+
+	delete sim;
+}
+
+//! builds a network that simulates batchSize samples, where sample b gets the external current curIn[b]+i
+static CARLsim* createBatchNetwork(const std::string& name, int batchSize, int numThreads, const float* curIn,
+	SpikeMonitor** spkMon)
+{
+	CARLsim* sim = new CARLsim(name, CPU_MODE, SILENT, 0, 42);
+	sim->setBatchSize(batchSize);
+	sim->setNumThreads(numThreads);
+	int gIn = sim->createGroup("input", 10, EXCITATORY_NEURON);
+	int gExc = sim->createGroup("exc", Grid3D(4,5), EXCITATORY_NEURON);
+	int gInh = sim->createGroup("inh", 10, INHIBITORY_NEURON);
+	sim->setNeuronParameters(gIn, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+	sim->connect(gIn, gExc, "random", RangeWeight(0.0f, 0.2f, 0.5f), 0.5f, RangeDelay(1), RadiusRF(-1),
+		SYN_PLASTIC);
+	sim->connect(gExc, gExc, "gaussian", RangeWeight(0.05f), 0.5f, RangeDelay(1,5), RadiusRF(2,2,0));
+	sim->connect(gExc, gInh, "random", RangeWeight(0.1f), 0.5f, RangeDelay(1,3));
+	sim->connect(gInh, gExc, "random", RangeWeight(0.1f), 0.5f, RangeDelay(1));
+	sim->setESTDP(gExc, true, STANDARD, ExpCurve(0.001f, 20.0f, -0.0012f, 20.0f));
+	sim->setConductances(true);
+	*spkMon = sim->setSpikeMonitor(gExc, "NULL");
+	sim->setupNetwork();
+
+	std::vector<float> current(sim->getGroupNumNeurons(gIn));
+	for (unsigned int i=0; i<current.size(); i++)
+		current[i] = curIn[i/10] + (i%10);
+	sim->setExternalCurrent(gIn, current);
+	return sim;
+}
+
+// every sample of a batch must behave exactly like a network that only simulates that sample
+TEST(CORE, batchMatchesSingleSamples) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+	const int batchSize = 4;
+	const float curIn[batchSize] = {4.0f, 6.0f, 8.0f, 10.0f};
+
+	for (int numThreads=1; numThreads<=3; numThreads+=2) {
+		SpikeMonitor* spkMon;
+		CARLsim* sim = createBatchNetwork("CORE.batch", batchSize, numThreads, curIn, &spkMon);
+		EXPECT_EQ(sim->getBatchSize(), batchSize);
+		EXPECT_EQ(sim->getNumReplicas(), batchSize);
+
+		// weights are frozen in testing mode, which is required for plastic synapses
+		EXPECT_DEATH({sim->runNetwork(0, 10, false);},"");
+		sim->startTesting();
+		spkMon->startRecording();
+		sim->runNetwork(1, 0, false);
+		spkMon->stopRecording();
+		std::vector<std::vector<int> > spkVec = spkMon->getSpikeVector2D();
+
+		for (int b=0; b<batchSize; b++) {
+			SpikeMonitor* spkMonSingle;
+			CARLsim* simSingle = createBatchNetwork("CORE.batchSingle", 1, 1, &curIn[b], &spkMonSingle);
+
+			// all samples share the same synapses
+			EXPECT_EQ(sim->getNumPreSynapses(), simSingle->getNumPreSynapses());
+			EXPECT_EQ(sim->getNumPostSynapses(), simSingle->getNumPostSynapses());
+			for (int c=0; c<sim->getNumConnections(); c++)
+				EXPECT_EQ(sim->getNumSynapticConnections(c), simSingle->getNumSynapticConnections(c));
+
+			simSingle->startTesting();
+			spkMonSingle->startRecording();
+			simSingle->runNetwork(1, 0, false);
+			spkMonSingle->stopRecording();
+
+			std::vector<std::vector<int> > spkVecSingle = spkMonSingle->getSpikeVector2D();
+			EXPECT_GT(spkMonSingle->getPopNumSpikes(), 0);
+			EXPECT_EQ(spkMon->getReplicaNumSpikes(b), spkMonSingle->getPopNumSpikes());
+			for (int i=0; i<20; i++)
+				EXPECT_TRUE(spkVec[b*20+i] == spkVecSingle[i]);
+			delete simSingle;
+		}
+		delete sim;
+	}
+}
+
+//! returns the number of spikes in spkTimesA that have no spike in spkTimesB within +- tolerance ms
+static int countUnmatchedSpikes(const std::vector<int>& spkTimesA, const std::vector<int>& spkTimesB, int tolerance) {
+	int numUnmatched = 0;
+	for (unsigned int i=0; i<spkTimesA.size(); i++) {
+		std::vector<int>::const_iterator it = std::lower_bound(spkTimesB.begin(), spkTimesB.end(),
+			spkTimesA[i]-tolerance);
+		if (it == spkTimesB.end() || *it > spkTimesA[i]+tolerance)
+			numUnmatched++;
+	}
+	return numUnmatched;
+}
+
+//! the vectorized neuron update must produce the same spike trains as the scalar one, up to floating-point rounding:
+//! spike counts per neuron must agree within 10%, and 80% of all spikes must have a counterpart within one time step
+//! in the other spike train. All instruction sets supported by the machine are tested.
+TEST(CORE, setSIMD) {
+	simdIsa_t isa[] = {SIMD_NONE, SIMD_SSE42, SIMD_AVX2, SIMD_AVX512};
+	for (int coba=0; coba<=1; coba++) {
+		for (int izh9=0; izh9<=1; izh9++) {
+			for (int rk4=0; rk4<=1; rk4++) {
+				std::vector<std::vector<int> > spkVecScalar;
+				for (int k=0; k<4; k++) {
+					CARLsim* sim = new CARLsim("CORE.setSIMD", CPU_MODE, SILENT, 0, 42);
+					if (!sim->isSIMDSupported(isa[k])) {
+						delete sim;
+						continue;
+					}
+					int gIn = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON);
+					int gExc = sim->createGroup("exc", 203, EXCITATORY_NEURON); // not a multiple of any SIMD width
+					if (izh9) {
+						sim->setNeuronParameters(gExc, 100.0f, 0.7f, -60.0f, -40.0f, 0.03f, -2.0f, 35.0f, -50.0f,
+							100.0f); // RS
+					} else {
+						sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+					}
+					float wt = coba ? 0.3f : (izh9 ? 300.0f : 8.0f);
+					sim->connect(gIn, gExc, "random", RangeWeight(wt), 0.1f, RangeDelay(1,10));
+					sim->setConductances(coba>0);
+					sim->setIntegrationMethod(rk4 ? RUNGE_KUTTA4 : FORWARD_EULER, 2);
+					EXPECT_EQ(sim->getSIMD(), SIMD_NONE); // off by default
+					sim->setSIMD(isa[k]);
+					EXPECT_EQ(sim->getSIMD(), isa[k]);
+					sim->setupNetwork();
+
+					PoissonRate PR(100);
+					PR.setRates(20.0f);
+					sim->setSpikeRate(gIn, &PR);
+					SpikeMonitor* SM = sim->setSpikeMonitor(gExc, "NULL");
+
+					SM->startRecording();
+					sim->runNetwork(1, 0, false);
+					SM->stopRecording();
+
+					EXPECT_GT(SM->getPopNumSpikes(), 0);
+					std::vector<std::vector<int> > spkVec = SM->getSpikeVector2D();
+					delete sim;
+
+					if (isa[k] == SIMD_NONE) {
+						spkVecScalar = spkVec;
+						continue;
+					}
+
+					// without -ffast-math, all spike times are identical. With -ffast-math, the compiler may reorder
+					// scalar and vector code differently: rounding differences then shift spikes by a time step, and
+					// in COBA mode they can add up until a neuron gains or loses a spike. Spike counts must still be
+					// close, and the vast majority of spikes must occur within one time step of the scalar ones.
+					ASSERT_EQ(spkVec.size(), spkVecScalar.size());
+					int numSpk = 0, numUnmatched = 0;
+					for (unsigned int i=0; i<spkVec.size(); i++) {
+						int numSpkScalar = spkVecScalar[i].size();
+						EXPECT_NEAR(spkVec[i].size(), numSpkScalar, std::max(2, numSpkScalar/10));
+						numUnmatched += countUnmatchedSpikes(spkVec[i], spkVecScalar[i], 1)
+							+ countUnmatchedSpikes(spkVecScalar[i], spkVec[i], 1);
+						numSpk += numSpkScalar;
+					}
+					EXPECT_LE(numUnmatched, std::max(2, numSpk/5));
+				}
+			}
+		}
+	}
+
+	// the widest supported instruction set is picked by setSIMD(true)
+	CARLsim* sim = new CARLsim("CORE.setSIMD", CPU_MODE, SILENT, 0, 42);
+	sim->setSIMD(true);
+	for (int k=3; k>=0; k--) {
+		if (sim->isSIMDSupported(isa[k])) {
+			EXPECT_EQ(sim->getSIMD(), isa[k]);
+			break;
+		}
+	}
+	sim->setSIMD(false);
+	EXPECT_EQ(sim->getSIMD(), SIMD_NONE);
+	delete sim;
+}
+
+//! every neuron of a group spikes exactly once, neuron i at spkTimes[i]
+class SpikeOncePerNeuron : public SpikeGenerator {
+public:
+	SpikeOncePerNeuron(const std::vector<int>& spkTimes) : spkTimes_(spkTimes) {}
+
+	unsigned int nextSpikeTime(CARLsim* s, int grpId, int i, unsigned int currentTime,
+		unsigned int lastScheduledSpikeTime, unsigned int endOfTimeSlice) {
+		if (lastScheduledSpikeTime < (unsigned int)spkTimes_[i] && (unsigned int)spkTimes_[i] < endOfTimeSlice)
+			return spkTimes_[i];
+		return -1; // -1: large positive number
+	}
+
+private:
+	std::vector<int> spkTimes_;
+};
+
+/*!
+ * \brief testing the timing of spike delivery
+ * A spike must always arrive after the same number of ms (given by the synaptic delay), also when it is still on its
+ * way at the end of a second. This used to be wrong for spikes with a delay of 2+ ms, because the firing table got
+ * shifted by one ms every second.
+ */
+TEST(CORE, spikeDeliveryDelay) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	int delays[] = {1, 2, 7, 20};
+	int numDelays = 4;
+
+	// the largest delay is 20 ms: spikes emitted in [980,1000) are still on their way at the end of the first second
+	int spkTimesArr[] = {100, 979, 985, 989, 995, 998, 1005, 1500, 1979, 1990, 2500};
+	int numSpikes = 11;
+	std::vector<int> spkTimes(spkTimesArr, spkTimesArr+numSpikes);
+
+	CARLsim* sim = new CARLsim("CORE.spikeDeliveryDelay", CPU_MODE, SILENT, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", numSpikes, EXCITATORY_NEURON);
+	int gOut[4];
+	for (int d=0; d<numDelays; d++) {
+		gOut[d] = sim->createGroup("output", numSpikes, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gOut[d], 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->connect(gIn, gOut[d], "one-to-one", RangeWeight(100.0f), 1.0f, RangeDelay(delays[d]));
+	}
+	sim->setConductances(false);
+	SpikeOncePerNeuron spkGen(spkTimes);
+	sim->setSpikeGenerator(gIn, &spkGen);
+	sim->setupNetwork();
+
+	SpikeMonitor* spkMonIn = sim->setSpikeMonitor(gIn, "NULL");
+	SpikeMonitor* spkMonOut[4];
+	for (int d=0; d<numDelays; d++) {
+		spkMonOut[d] = sim->setSpikeMonitor(gOut[d], "NULL");
+		spkMonOut[d]->startRecording();
+	}
+	spkMonIn->startRecording();
+	sim->runNetwork(3, 0, false);
+	spkMonIn->stopRecording();
+
+	// every input spike makes its output neuron fire right after the spike arrived
+	std::vector<std::vector<int> > spkIn = spkMonIn->getSpikeVector2D();
+	int latency = -1;
+	for (int d=0; d<numDelays; d++) {
+		spkMonOut[d]->stopRecording();
+		std::vector<std::vector<int> > spkOut = spkMonOut[d]->getSpikeVector2D();
+		for (int i=0; i<numSpikes; i++) {
+			ASSERT_EQ(spkIn[i].size(), 1);
+			EXPECT_EQ(spkIn[i][0], spkTimes[i]);
+			ASSERT_EQ(spkOut[i].size(), 1);
+			if (latency < 0)
+				latency = spkOut[i][0] - spkIn[i][0] - delays[d];
+			EXPECT_EQ(spkOut[i][0] - spkIn[i][0] - delays[d], latency);
+		}
+	}
+	EXPECT_GE(latency, 0);
+
+	delete sim;
+}
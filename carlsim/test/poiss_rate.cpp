@@ -186,4 +186,57 @@ TEST(PoissRate, setRateNeurId) {
 TEST(PoissRate, runSim) {
 	// \TODO test CARLsim integration
 	// \TODO use cuRAND
+}
+
+// runs a Poisson group with half the neurons at 10Hz and half at 40Hz, and returns the spike times of every neuron
+static std::vector<std::vector<int> > runPoissonGroup(int nNeur, int refPeriod, bool perStep, int runMs) {
+	CARLsim* sim = new CARLsim("PoissRate.perStep",CPU_MODE,SILENT,0,42);
+	int g0 = sim->createSpikeGeneratorGroup("input", nNeur, EXCITATORY_NEURON);
+	int g1 = sim->createGroup("output", 1, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(g0, g1, "full", RangeWeight(0.0f), 1.0f);
+	sim->setConductances(false);
+	SpikeMonitor* spkMon = sim->setSpikeMonitor(g0, "NULL");
+	sim->setupNetwork();
+
+	PoissonRate rate(nNeur);
+	for (int i=0; i<nNeur; i++)
+		rate.setRate(i, (i < nNeur/2) ? 10.0f : 40.0f);
+	sim->setSpikeRate(g0, &rate, refPeriod, perStep);
+
+	spkMon->startRecording();
+	sim->runNetwork(runMs/1000, runMs%1000);
+	spkMon->stopRecording();
+
+	std::vector<std::vector<int> > spkTimes = spkMon->getSpikeVector2D();
+	delete sim;
+	return spkTimes;
+}
+
+//! per-step mode must produce the requested rates, honor the refractory period, and be reproducible
+TEST(PoissRate, perStep) {
+	int nNeur = 1000;
+	for (int perStep=0; perStep<=1; perStep++) {
+		// mean rates: with refPeriod 1 there is no dead time
+		std::vector<std::vector<int> > spkTimes = runPoissonGroup(nNeur, 1, perStep==1, 2000);
+		double meanLow = 0.0, meanHigh = 0.0;
+		for (int i=0; i<nNeur; i++)
+			((i < nNeur/2) ? meanLow : meanHigh) += spkTimes[i].size() / 2.0 / (nNeur/2);
+		EXPECT_NEAR(meanLow, 10.0, 1.0);
+		EXPECT_NEAR(meanHigh, 40.0, 2.0);
+
+		// no inter-spike interval may be shorter than the refractory period
+		int refPeriod = 10;
+		spkTimes = runPoissonGroup(nNeur, refPeriod, perStep==1, 1000);
+		for (int i=0; i<nNeur; i++) {
+			for (int s=1; s<spkTimes[i].size(); s++) {
+				EXPECT_GE(spkTimes[i][s]-spkTimes[i][s-1], refPeriod);
+			}
+		}
+	}
+
+	// same seed, same spikes
+	std::vector<std::vector<int> > spkTimes1 = runPoissonGroup(nNeur, 2, true, 500);
+	std::vector<std::vector<int> > spkTimes2 = runPoissonGroup(nNeur, 2, true, 500);
+	EXPECT_TRUE(spkTimes1 == spkTimes2);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <carlsim.h>
 #include <snn_definitions.h> // MAX_GRP_PER_SNN
+#include <algorithm> // std::binary_search
 
 #if defined(WIN32) || defined(WIN64)
 #include <periodic_spikegen.h>
@@ -693,3 +694,355 @@ TEST(SpikeMon, setLogFile) {
 		delete sim;
 	}
 }
+
+// spike files are written in the background: a file must hold the same spikes as the spike vector, even if it gets
+// more spikes than fit into one buffer of the writer and the simulation is deleted right after the last step
+TEST(SpikeMon, spikeFileWrittenInBackground) {
+	const int GRP_SIZE = 2000;
+	CARLsim* sim = new CARLsim("SpikeMon.spikeFileWrittenInBackground",CPU_MODE,SILENT,0,42);
+	int g0 = sim->createSpikeGeneratorGroup("Input",GRP_SIZE,EXCITATORY_NEURON);
+	int g1 = sim->createGroup("g1", 10, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(g0,g1,"random", RangeWeight(0.01f), 0.1f);
+	sim->setConductances(true);
+	sim->setupNetwork();
+
+	PoissonRate rate(GRP_SIZE);
+	rate.setRates(50.0f);
+	sim->setSpikeRate(g0, &rate);
+
+	SpikeMonitor* spkMon = sim->setSpikeMonitor(g0,"results/spkBackground.dat");
+	spkMon->startRecording();
+	sim->stepN(2500);
+	spkMon->stopRecording();
+	std::vector<std::vector<int> > spkVector = spkMon->getSpikeVector2D();
+	delete sim;
+
+	// some 250,000 spikes (2 MB) take several buffers of the writer
+	int* inputArray = NULL;
+	int64_t inputSize;
+	readAndReturnSpikeFile("results/spkBackground.dat",inputArray,inputSize);
+	EXPECT_GT(inputSize/2*sizeof(int)*2, MON_WRITER_CHUNK_SIZE);
+
+	std::vector<std::vector<int> > spkVectorFile(GRP_SIZE);
+	for (int i=0; i<inputSize; i+=2) {
+		ASSERT_TRUE(inputArray[i+1]>=0 && inputArray[i+1]<GRP_SIZE);
+		spkVectorFile[inputArray[i+1]].push_back(inputArray[i]);
+	}
+	EXPECT_TRUE(spkVectorFile == spkVector);
+
+	if (inputArray!=NULL) delete[] inputArray;
+}
+
+/*!
+ * \brief testing updateSpikeMonitor with many monitors that were last updated at different times
+ * All monitors are filled in a single pass over the spikes. Every monitor must still get exactly the spikes that
+ * happened while it was recording. The monitors of the second network start recording at staggered times, so their
+ * spikes must be the tail of the spikes seen by the first network (same seed, same spikes).
+ */
+TEST(SpikeMon, manyMonitorsStaggeredStart) {
+	const int NUM_GRP = 12;
+	const int GRP_SIZE = 50;
+	PoissonRate rate(GRP_SIZE);
+	rate.setRates(40.0f);
+
+	CARLsim* sim[2];
+	SpikeMonitor* spkMon[2][NUM_GRP];
+	for (int i=0; i<2; i++) {
+		sim[i] = new CARLsim("SpikeMon.manyMonitorsStaggeredStart",CPU_MODE,SILENT,0,42);
+		for (int g=0; g<NUM_GRP; g++)
+			sim[i]->createSpikeGeneratorGroup("Input",GRP_SIZE,EXCITATORY_NEURON);
+		int gOut = sim[i]->createGroup("output", 10, EXCITATORY_NEURON);
+		sim[i]->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+		for (int g=0; g<NUM_GRP; g++)
+			sim[i]->connect(g,gOut,"random", RangeWeight(0.01f), 0.1f);
+		sim[i]->setConductances(true);
+		sim[i]->setupNetwork();
+		for (int g=0; g<NUM_GRP; g++) {
+			sim[i]->setSpikeRate(g, &rate);
+			spkMon[i][g] = sim[i]->setSpikeMonitor(g,"NULL");
+		}
+	}
+
+	// first network records everything, second network starts group g at 150*g ms
+	for (int g=0; g<NUM_GRP; g++)
+		spkMon[0][g]->startRecording();
+	for (int t=0; t<2000; t+=50) {
+		for (int g=0; g<NUM_GRP; g++)
+			if (t==150*g)
+				spkMon[1][g]->startRecording();
+		for (int i=0; i<2; i++)
+			sim[i]->runNetwork(0,50,false);
+	}
+
+	for (int g=0; g<NUM_GRP; g++) {
+		spkMon[0][g]->stopRecording();
+		spkMon[1][g]->stopRecording();
+		std::vector<std::vector<int> > spkAll = spkMon[0][g]->getSpikeVector2D();
+		std::vector<std::vector<int> > spkLate = spkMon[1][g]->getSpikeVector2D();
+		ASSERT_EQ(spkLate.size(), GRP_SIZE);
+		for (int n=0; n<GRP_SIZE; n++) {
+			std::vector<int> expected;
+			for (unsigned int s=0; s<spkAll[n].size(); s++)
+				if (spkAll[n][s] >= 150*g)
+					expected.push_back(spkAll[n][s]);
+			EXPECT_TRUE(spkLate[n] == expected);
+		}
+		EXPECT_GT(spkMon[1][g]->getPopNumSpikes(), 0);
+	}
+
+	for (int i=0; i<2; i++)
+		delete sim[i];
+}
+
+/*!
+ * \brief testing the iterator and range queries of the spike store
+ * A dense group (mostly stored as bitmap blocks) and a sparse group (sparse AER blocks) are recorded over two recording
+ * periods, one of which ends in the middle of a second. Iterator and range queries must agree with the spike vector.
+ */
+TEST(SpikeMon, iteratorAndRangeQueries) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+	const int NUM_NEUR[2] = {64, 200};
+	const float RATE[2] = {300.0f, 5.0f};
+
+	CARLsim* sim = new CARLsim("SpikeMon.iteratorAndRangeQueries",CPU_MODE,SILENT,0,42);
+	int g0 = sim->createSpikeGeneratorGroup("dense",NUM_NEUR[0],EXCITATORY_NEURON);
+	int g1 = sim->createSpikeGeneratorGroup("sparse",NUM_NEUR[1],EXCITATORY_NEURON);
+	int g2 = sim->createGroup("output", 10, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g2, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(g0,g2,"random", RangeWeight(0.01f), 0.1f);
+	sim->connect(g1,g2,"random", RangeWeight(0.01f), 0.1f);
+	sim->setConductances(true);
+	sim->setupNetwork();
+
+	PoissonRate* rate[2];
+	SpikeMonitor* spkMon[2];
+	for (int i=0; i<2; i++) {
+		rate[i] = new PoissonRate(NUM_NEUR[i]);
+		rate[i]->setRates(RATE[i]);
+		sim->setSpikeRate(i==0?g0:g1, rate[i]);
+		spkMon[i] = sim->setSpikeMonitor(i==0?g0:g1,"NULL");
+		spkMon[i]->setPersistentData(true);
+	}
+
+	// record [0,1500) and [1800,3000)
+	for (int i=0; i<2; i++)
+		spkMon[i]->startRecording();
+	sim->runNetwork(1,500,false);
+	for (int i=0; i<2; i++)
+		spkMon[i]->stopRecording();
+	sim->runNetwork(0,300,false);
+	for (int i=0; i<2; i++)
+		spkMon[i]->startRecording();
+	sim->runNetwork(1,200,false);
+	for (int i=0; i<2; i++)
+		spkMon[i]->stopRecording();
+
+	for (int i=0; i<2; i++) {
+		std::vector<std::vector<int> > spkVector = spkMon[i]->getSpikeVector2D();
+		ASSERT_EQ(spkVector.size(), NUM_NEUR[i]);
+
+		// iterator visits all spikes in order of spike time and neuron ID, and agrees with the spike vector
+		std::vector<std::vector<int> > spkVectorIt(NUM_NEUR[i]);
+		int numSpk = 0, lastTime = -1, lastNeurId = -1;
+		for (SpikeIterator it=spkMon[i]->getSpikesBegin(); it!=spkMon[i]->getSpikesEnd(); ++it) {
+			EXPECT_TRUE(it.getTime()>lastTime || (it.getTime()==lastTime && it.getNeurId()>=lastNeurId));
+			EXPECT_FALSE(it.getTime()>=1500 && it.getTime()<1800);
+			lastTime = it.getTime();
+			lastNeurId = it.getNeurId();
+			spkVectorIt[it.getNeurId()].push_back(it.getTime());
+			numSpk++;
+		}
+		EXPECT_TRUE(spkVectorIt == spkVector);
+		EXPECT_EQ(numSpk, spkMon[i]->getPopNumSpikes());
+		EXPECT_GT(numSpk, 0);
+
+		// range queries, some of which start or end within a block
+		int range[5][2] = {{0,3000}, {0,1}, {250,1250}, {1499,1801}, {2999,5000}};
+		for (int r=0; r<5; r++) {
+			std::vector<int> spkTimes, neurIds;
+			spkMon[i]->getSpikesInRange(range[r][0], range[r][1], spkTimes, neurIds);
+			ASSERT_EQ(spkTimes.size(), neurIds.size());
+			EXPECT_EQ(spkMon[i]->getNumSpikesInRange(range[r][0], range[r][1]), spkTimes.size());
+
+			int numSpkRange = 0;
+			for (int n=0; n<NUM_NEUR[i]; n++) {
+				for (unsigned int s=0; s<spkVector[n].size(); s++) {
+					if (spkVector[n][s]>=range[r][0] && spkVector[n][s]<range[r][1])
+						numSpkRange++;
+				}
+			}
+			EXPECT_EQ(spkTimes.size(), numSpkRange);
+			for (unsigned int s=0; s<spkTimes.size(); s++) {
+				EXPECT_TRUE(spkTimes[s]>=range[r][0] && spkTimes[s]<range[r][1]);
+				EXPECT_TRUE(std::binary_search(spkVector[neurIds[s]].begin(), spkVector[neurIds[s]].end(),
+					spkTimes[s]));
+			}
+
+			// iterator can start anywhere
+			SpikeIterator it = spkMon[i]->getSpikesBegin(range[r][0]);
+			if (spkTimes.size())
+				EXPECT_EQ(it.getTime(), spkTimes[0]);
+		}
+	}
+
+	// cannot query while recording
+	spkMon[0]->startRecording();
+	EXPECT_DEATH({spkMon[0]->getSpikesBegin();},"");
+	EXPECT_DEATH({spkMon[0]->getNumSpikesInRange(0,1000);},"");
+	spkMon[0]->stopRecording();
+	EXPECT_DEATH({spkMon[0]->getNumSpikesInRange(1000,0);},"");
+
+	for (int i=0; i<2; i++)
+		delete rate[i];
+	delete sim;
+}
+
+/*!
+ * \brief testing STATS mode
+ * This test runs the same network twice, once with a SpikeMonitor in AER mode and once in STATS mode, and makes sure
+ * that the running statistics of STATS mode agree with the ones computed from the recorded spike times.
+ */
+TEST(SpikeMon, statsMode) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+	const int NUM_NEUR = 50;
+	const int BIN_SIZE = 100;
+	const int START[2] = {0, 2300};
+	const int STOP[2] = {2050, 3000};
+
+	SpikeMonitor* spkMon[2];
+	CARLsim* sim[2];
+	PoissonRate* rate[2];
+	for (int m=0; m<2; m++) {
+		sim[m] = new CARLsim("SpikeMon.statsMode",CPU_MODE,SILENT,0,42);
+		int g0 = sim[m]->createSpikeGeneratorGroup("input",NUM_NEUR,EXCITATORY_NEURON);
+		int g1 = sim[m]->createGroup("output", 1, EXCITATORY_NEURON);
+		sim[m]->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim[m]->connect(g0,g1,"full", RangeWeight(0.01f), 1.0f);
+		sim[m]->setConductances(true);
+		sim[m]->setupNetwork();
+
+		// some neurons are silent
+		rate[m] = new PoissonRate(NUM_NEUR);
+		for (int i=0; i<NUM_NEUR; i++)
+			rate[m]->setRate(i, (i%5)*15.0f);
+		sim[m]->setSpikeRate(g0, rate[m]);
+
+		spkMon[m] = sim[m]->setSpikeMonitor(g0,"NULL");
+		spkMon[m]->setPersistentData(true);
+		if (m==1) {
+			spkMon[m]->setMode(STATS);
+			spkMon[m]->setStatsBinSize(BIN_SIZE);
+			EXPECT_EQ(spkMon[m]->getMode(), STATS);
+			EXPECT_EQ(spkMon[m]->getStatsBinSize(), BIN_SIZE);
+		}
+
+		// record [0,2050) and [2300,3000), both of which end in the middle of a bin
+		spkMon[m]->startRecording();
+		sim[m]->runNetwork(2,50,false);
+		spkMon[m]->stopRecording();
+		sim[m]->runNetwork(0,250,false);
+		spkMon[m]->startRecording();
+		sim[m]->runNetwork(0,700,false);
+		spkMon[m]->stopRecording();
+	}
+
+	// same spikes, same counts and firing rates
+	EXPECT_GT(spkMon[0]->getPopNumSpikes(), 0);
+	EXPECT_EQ(spkMon[1]->getPopNumSpikes(), spkMon[0]->getPopNumSpikes());
+	EXPECT_FLOAT_EQ(spkMon[1]->getPopMeanFiringRate(), spkMon[0]->getPopMeanFiringRate());
+	EXPECT_FLOAT_EQ(spkMon[1]->getPopStdFiringRate(), spkMon[0]->getPopStdFiringRate());
+	EXPECT_FLOAT_EQ(spkMon[1]->getPercentSilentNeurons(), spkMon[0]->getPercentSilentNeurons());
+	for (int i=0; i<NUM_NEUR; i++)
+		EXPECT_EQ(spkMon[1]->getNeuronNumSpikes(i), spkMon[0]->getNeuronNumSpikes(i));
+
+	// compute the statistics from the spike times: only complete bins count, and ISIs stay within a recording period
+	std::vector<std::vector<int> > spkVector = spkMon[0]->getSpikeVector2D();
+	int numBins = 0;
+	for (int p=0; p<2; p++)
+		numBins += (STOP[p]-START[p])/BIN_SIZE;
+	EXPECT_EQ(spkMon[1]->getStatsNumBins(), numBins);
+
+	std::vector<double> popBinCnt(numBins, 0.0);
+	double sumCV = 0.0;
+	int numNeurCV = 0;
+	for (int i=0; i<NUM_NEUR; i++) {
+		std::vector<double> isi, binCnt(numBins, 0.0);
+		int binOffset = 0;
+		for (int p=0; p<2; p++) {
+			int lastSpkTime = -1;
+			for (unsigned int s=0; s<spkVector[i].size(); s++) {
+				int t = spkVector[i][s];
+				if (t<START[p] || t>=STOP[p])
+					continue;
+				if (lastSpkTime>=0 && t>lastSpkTime)
+					isi.push_back(t-lastSpkTime);
+				lastSpkTime = t;
+				int bin = (t-START[p])/BIN_SIZE;
+				if (bin < (STOP[p]-START[p])/BIN_SIZE) {
+					binCnt[binOffset+bin]++;
+					popBinCnt[binOffset+bin]++;
+				}
+			}
+			binOffset += (STOP[p]-START[p])/BIN_SIZE;
+		}
+
+		double isiMean = 0.0, isiVar = 0.0;
+		for (unsigned int k=0; k<isi.size(); k++)
+			isiMean += isi[k]/isi.size();
+		for (unsigned int k=0; k<isi.size(); k++)
+			isiVar += (isi[k]-isiMean)*(isi[k]-isiMean)/(isi.size()-1);
+		double cv = (isi.size()>=2) ? sqrt(isiVar)/isiMean : 0.0;
+		EXPECT_NEAR(spkMon[1]->getNeuronISICV(i), cv, 1e-4);
+		if (isi.size()>=2) {
+			sumCV += cv;
+			numNeurCV++;
+		}
+
+		double binMean = 0.0, binVar = 0.0;
+		for (int k=0; k<numBins; k++)
+			binMean += binCnt[k]/numBins;
+		for (int k=0; k<numBins; k++)
+			binVar += (binCnt[k]-binMean)*(binCnt[k]-binMean)/(numBins-1);
+		EXPECT_NEAR(spkMon[1]->getNeuronFanoFactor(i), (binMean>0) ? binVar/binMean : 0.0, 1e-4);
+		if (i%5==0) {
+			EXPECT_FLOAT_EQ(spkMon[1]->getNeuronISICV(i), 0.0f);
+			EXPECT_FLOAT_EQ(spkMon[1]->getNeuronFanoFactor(i), 0.0f);
+		}
+	}
+	EXPECT_NEAR(spkMon[1]->getPopMeanISICV(), sumCV/numNeurCV, 1e-4);
+	EXPECT_EQ(spkMon[1]->getAllISICV().size(), NUM_NEUR);
+	EXPECT_EQ(spkMon[1]->getAllFanoFactors().size(), NUM_NEUR);
+
+	double popMean = 0.0, popVar = 0.0, popMax = 0.0;
+	for (int k=0; k<numBins; k++) {
+		popMean += popBinCnt[k]/numBins;
+		popMax = std::max(popMax, popBinCnt[k]);
+	}
+	for (int k=0; k<numBins; k++)
+		popVar += (popBinCnt[k]-popMean)*(popBinCnt[k]-popMean)/(numBins-1);
+	EXPECT_NEAR(spkMon[1]->getPopFanoFactor(), popVar/popMean, 1e-4);
+	EXPECT_NEAR(spkMon[1]->getPopStdBinnedRate(), sqrt(popVar)*1000.0/(BIN_SIZE*NUM_NEUR), 1e-3);
+	EXPECT_NEAR(spkMon[1]->getPopMaxBinnedRate(), popMax*1000.0/(BIN_SIZE*NUM_NEUR), 1e-3);
+
+	// no spike times in STATS mode, no statistics in AER mode
+	EXPECT_DEATH({spkMon[1]->getSpikeVector2D();},"");
+	EXPECT_DEATH({spkMon[1]->getSpikesBegin();},"");
+	EXPECT_DEATH({spkMon[0]->getPopFanoFactor();},"");
+	EXPECT_DEATH({spkMon[0]->getNeuronISICV(0);},"");
+	EXPECT_DEATH({spkMon[1]->getNeuronISICV(NUM_NEUR);},"");
+	EXPECT_DEATH({spkMon[1]->setStatsBinSize(0);},"");
+
+	// cannot change mode while recording, changing mode deletes all data
+	spkMon[1]->startRecording();
+	EXPECT_DEATH({spkMon[1]->setMode(AER);},"");
+	EXPECT_DEATH({spkMon[1]->getPopFanoFactor();},"");
+	spkMon[1]->stopRecording();
+	spkMon[1]->setMode(AER);
+	EXPECT_EQ(spkMon[1]->getPopNumSpikes(), 0);
+
+	for (int m=0; m<2; m++) {
+		delete rate[m];
+		delete sim[m];
+	}
+}
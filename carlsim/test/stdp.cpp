@@ -620,4 +620,150 @@ TEST(STDP, setHomeoBaseFiringRate) {
 	sim.setHomeostasis(gExc, true, 1.0f, 10.0f);  // homeo scaling factor, avg time scale
 
 	EXPECT_DEATH({sim.setHomeoBaseFiringRate(ALL, 35.0f, 0.0f);},"");
-}
\ No newline at end of file
+}
+
+/*!
+ * \brief testing per-delay spike arrival times
+ * This function tests whether STDP with spike arrival times per neuron and delay (setPerDelayArrivalTimes) produces
+ * exactly the same weights as STDP with per-synapse spike times, for all E-STDP and I-STDP curves and a range of
+ * synaptic delays. The third E-STDP curve has time constants long enough for its lookup tables to be cut off.
+ */
+TEST(STDP, setPerDelayArrivalTimes) {
+	for (int eCurve = 0; eCurve < 3; eCurve++) {
+		for (int iCurve = 0; iCurve < 2; iCurve++) {
+			std::vector< std::vector<float> > wtExc[2], wtInh[2];
+
+			for (int perDelay = 0; perDelay < 2; perDelay++) {
+				CARLsim* sim = new CARLsim("STDP.setPerDelayArrivalTimes", CPU_MODE, SILENT, 0, 42);
+
+				int g1 = sim->createGroup("post", 20, EXCITATORY_NEURON);
+				sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+				int gex = sim->createSpikeGeneratorGroup("input-ex", 40, EXCITATORY_NEURON);
+				int gin = sim->createSpikeGeneratorGroup("input-in", 20, INHIBITORY_NEURON);
+
+				sim->connect(gex, g1, "random", RangeWeight(0.0f, 5.0f, 10.0f), 0.5f, RangeDelay(1,20), RadiusRF(-1),
+					SYN_PLASTIC);
+				sim->connect(gin, g1, "random", RangeWeight(0.0f, 2.0f, 5.0f), 0.5f, RangeDelay(1,5), RadiusRF(-1),
+					SYN_PLASTIC);
+				sim->setConductances(false);
+
+				if (eCurve == 0) {
+					sim->setESTDP(g1, true, STANDARD, ExpCurve(0.1f, 20.0f, -0.12f, 20.0f));
+				} else if (eCurve == 1) {
+					sim->setESTDP(g1, true, STANDARD, TimingBasedCurve(0.1f, 20.0f, -0.12f, 20.0f, 10.0f));
+				} else {
+					sim->setESTDP(g1, true, STANDARD, ExpCurve(0.1f, 100.0f, -0.12f, 200.0f));
+				}
+				if (iCurve == 0) {
+					sim->setISTDP(g1, true, STANDARD, ExpCurve(-0.1f, 10.0f, 0.12f, 10.0f));
+				} else {
+					sim->setISTDP(g1, true, STANDARD, PulseCurve(0.1f, -0.12f, 9.0f, 40.0f));
+				}
+
+				sim->setPerDelayArrivalTimes(perDelay==1);
+				sim->setupNetwork();
+
+				ConnectionMonitor* CMexc = sim->setConnectionMonitor(gex, g1, "NULL");
+				ConnectionMonitor* CMinh = sim->setConnectionMonitor(gin, g1, "NULL");
+				std::vector< std::vector<float> > wtExcInit = CMexc->takeSnapshot();
+				std::vector< std::vector<float> > wtInhInit = CMinh->takeSnapshot();
+
+				PoissonRate inEx(40);
+				inEx.setRates(20.0f);
+				sim->setSpikeRate(gex, &inEx);
+				PoissonRate inIn(20);
+				inIn.setRates(20.0f);
+				sim->setSpikeRate(gin, &inIn);
+
+				sim->runNetwork(2, 0, false);
+
+				wtExc[perDelay] = CMexc->takeSnapshot();
+				wtInh[perDelay] = CMinh->takeSnapshot();
+
+				// make sure STDP did change the weights
+				int numChanged = 0;
+				for (unsigned int i = 0; i < wtExc[perDelay].size(); i++) {
+					for (unsigned int j = 0; j < wtExc[perDelay][i].size(); j++) {
+						numChanged += (!isnan(wtExcInit[i][j]) && wtExc[perDelay][i][j] != wtExcInit[i][j]) ? 1 : 0;
+					}
+				}
+				for (unsigned int i = 0; i < wtInh[perDelay].size(); i++) {
+					for (unsigned int j = 0; j < wtInh[perDelay][i].size(); j++) {
+						numChanged += (!isnan(wtInhInit[i][j]) && wtInh[perDelay][i][j] != wtInhInit[i][j]) ? 1 : 0;
+					}
+				}
+				EXPECT_GT(numChanged, 0);
+
+				delete sim;
+			}
+
+			expectEqualWeights(wtExc[0], wtExc[1]);
+			expectEqualWeights(wtInh[0], wtInh[1]);
+		}
+	}
+}
+
+/*!
+ * \brief testing incremental weight update
+ * This function tests whether updating only the weights of synapses whose weight change got modified (with missed
+ * updates applied in closed form) produces the same weights as updating all plastic synapses, up to floating-point
+ * rounding. Weights must be up to date whenever they are read, also in between runs.
+ */
+TEST(STDP, incrementalWeightUpdate) {
+	for (int decay = 0; decay < 2; decay++) {
+		for (int interval = 0; interval < 2; interval++) {
+			std::vector< std::vector<float> > wtExc[2], wtInh[2], wtExcRun[2];
+
+			for (int incremental = 0; incremental < 2; incremental++) {
+				CARLsim* sim = new CARLsim("STDP.incrementalWeightUpdate", CPU_MODE, SILENT, 0, 42);
+
+				int g1 = sim->createGroup("post", 50, EXCITATORY_NEURON);
+				sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+				int gex = sim->createSpikeGeneratorGroup("input-ex", 100, EXCITATORY_NEURON);
+				int gin = sim->createSpikeGeneratorGroup("input-in", 20, INHIBITORY_NEURON);
+
+				sim->connect(gex, g1, "random", RangeWeight(0.0f, 8.0f, 16.0f), 0.2f, RangeDelay(1,10), RadiusRF(-1),
+					SYN_PLASTIC);
+				sim->connect(gin, g1, "random", RangeWeight(0.0f, 2.0f, 5.0f), 0.2f, RangeDelay(1), RadiusRF(-1),
+					SYN_PLASTIC);
+				sim->setConductances(false);
+				sim->setESTDP(g1, true, STANDARD, ExpCurve(0.5f, 20.0f, -0.6f, 20.0f));
+				sim->setISTDP(g1, true, STANDARD, ExpCurve(-0.1f, 10.0f, 0.12f, 10.0f));
+				sim->setWeightAndWeightChangeUpdate(interval ? INTERVAL_100MS : INTERVAL_10MS, decay==1, 0.9f);
+
+				sim->setIncrementalWeightUpdate(incremental==1);
+				sim->setupNetwork();
+
+				ConnectionMonitor* CMexc = sim->setConnectionMonitor(gex, g1, "NULL");
+				ConnectionMonitor* CMinh = sim->setConnectionMonitor(gin, g1, "NULL");
+
+				// sparse activity
+				PoissonRate inEx(100);
+				inEx.setRates(2.0f);
+				sim->setSpikeRate(gex, &inEx);
+				PoissonRate inIn(20);
+				inIn.setRates(2.0f);
+				sim->setSpikeRate(gin, &inIn);
+
+				// weights must be up to date in between runs, and also when switching to testing mode
+				for (int i = 0; i < 3; i++) {
+					sim->runNetwork(0, 777, false);
+				}
+				wtExcRun[incremental] = CMexc->takeSnapshot();
+				sim->startTesting();
+				sim->runNetwork(0, 500, false);
+				sim->stopTesting();
+				sim->runNetwork(1, 0, false);
+
+				wtExc[incremental] = CMexc->takeSnapshot();
+				wtInh[incremental] = CMinh->takeSnapshot();
+
+				delete sim;
+			}
+
+			expectEqualWeights(wtExcRun[0], wtExcRun[1], 1e-4f);
+			expectEqualWeights(wtExc[0], wtExc[1], 1e-4f);
+			expectEqualWeights(wtInh[0], wtInh[1], 1e-4f);
+		}
+	}
+}
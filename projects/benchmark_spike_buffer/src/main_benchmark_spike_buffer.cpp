@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <propagated_spike_buffer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+
+// Microbenchmark for PropagatedSpikeBuffer
+// The buffer is driven the same way CpuSNN drives it for Poisson groups: once every time slice, spikes for the next
+// timeSlice ms are scheduled for all neurons; then, every ms, the spikes of the current slot are read out and the
+// buffer advances by one step. Spike times are drawn up front, so only buffer operations are timed.
+// Every spike counts as one event when it is scheduled and one event when it is read out.
+// Usage: benchmark_spike_buffer [number of neurons (default: 10000)] [rate in Hz (default: 50)]
+//                               [simulation time in s (default: 100)]
+//
+// The benchmark only uses the part of the PropagatedSpikeBuffer interface that has not changed over time, so it can
+// be compared against any other version of CARLsim (e.g., the linked-list buffer of CARLsim 3.1.3): install that
+// version to a separate directory, then build and run this project once against each installation, for example:
+//   $ git worktree add ../carlsim-base <commit>
+//   $ cd ../carlsim-base && make && make install CARLSIM3_INSTALL_DIR=/tmp/carlsim-base
+//   $ cd - && make clean && make CARLSIM3_INSTALL_DIR=/tmp/carlsim-base && ./benchmark_spike_buffer
+// The checksum printed at the end must be the same for both versions. The buffer is timed with clock() rather than
+// Stopwatch, which is not usable in all older versions.
+
+// schedules the spikes of one time slice
+void schedule(PropagatedSpikeBuffer& buf, const std::vector<spikegroupid_t>& nid,
+	const std::vector<delaystep_t>& delay) {
+	for (size_t i=0; i<nid.size(); i++)
+		buf.scheduleSpikeTargetGroup(nid[i], delay[i]);
+}
+
+// reads out timeSlice steps, returns a checksum so that the compiler cannot drop the loop
+long long readOut(PropagatedSpikeBuffer& buf, int timeSlice) {
+	long long sum = 0;
+	for (int t=0; t<timeSlice; t++) {
+		PropagatedSpikeBuffer::const_iterator it_end = buf.endSpikeTargetGroups();
+		for (PropagatedSpikeBuffer::const_iterator it=buf.beginSpikeTargetGroups(); it!=it_end; ++it)
+			sum += *it;
+		buf.nextTimeStep();
+	}
+	return sum;
+}
+
+int main(int argc, const char* argv[]) {
+	int numNeur = (argc > 1) ? atoi(argv[1]) : 10000;
+	float rateHz = (argc > 2) ? atof(argv[2]) : 50.0f;
+	int runTimeSec = (argc > 3) ? atoi(argv[3]) : 100;
+
+	const int timeSlice = 1000;
+	const int bufferSize = 1023; // same as PROPAGATED_BUFFER_SIZE in CpuSNN
+	const int numSlices = runTimeSec;
+
+	// draw all spike times up front: one vector of (neuron, delay) pairs per time slice
+	srand(42);
+	std::vector< std::vector<spikegroupid_t> > nid(numSlices);
+	std::vector< std::vector<delaystep_t> > delay(numSlices);
+	long long numSpikes = 0;
+	for (int s=0; s<numSlices; s++) {
+		for (int n=0; n<numNeur && rateHz>0; n++) {
+			// Poisson process: exponentially distributed inter-spike intervals (in ms)
+			double t = 0.0;
+			while ((t += -log((rand()+1.0)/(RAND_MAX+2.0))*1000.0/rateHz) < timeSlice) {
+				nid[s].push_back(n);
+				delay[s].push_back((delaystep_t)t);
+			}
+		}
+		numSpikes += nid[s].size();
+	}
+
+	PropagatedSpikeBuffer buf(0, bufferSize);
+	long long checksum = 0;
+
+	clock_t start = clock();
+	for (int s=0; s<numSlices; s++) {
+		schedule(buf, nid[s], delay[s]);
+		checksum += readOut(buf, timeSlice);
+	}
+	unsigned long long runTimeMs = (unsigned long long)((clock() - start) * 1000.0 / CLOCKS_PER_SEC);
+
+	double eventsPerSec = 2.0*numSpikes / ((runTimeMs>0 ? runTimeMs : 1) / 1000.0);
+	printf("%d neurons at %.1f Hz, %d s simulation time: %lld spikes\n", numNeur, rateHz, runTimeSec, numSpikes);
+	printf("%6llu ms, %8.1f Mevents/s (checksum %lld)\n", runTimeMs, eventsPerSec/1e6, checksum);
+
+	return 0;
+}
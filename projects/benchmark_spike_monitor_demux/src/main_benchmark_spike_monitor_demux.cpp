@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// include CARLsim user interface
+#include <carlsim.h>
+
+#if defined(WIN32) || defined(WIN64)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// returns the time in ms from a monotonic clock
+static double getWallTimeMs() {
+#if defined(WIN32) || defined(WIN64)
+	LARGE_INTEGER cnt, freq;
+	QueryPerformanceCounter(&cnt);
+	QueryPerformanceFrequency(&freq);
+	return cnt.QuadPart*1e3/freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec*1e3 + ts.tv_nsec/1e6;
+#endif
+}
+
+//! builds a network of numGroups Poisson groups, which weakly project to a single output group
+static CARLsim* createNetwork(int numGroups, int numNeurPerGroup, PoissonRate* rate) {
+	// ---------------- CONFIG STATE -------------------
+	CARLsim* sim = new CARLsim("benchmark_spike_monitor_demux", CPU_MODE, SILENT, 0, 42);
+	for (int g = 0; g < numGroups; g++)
+		sim->createSpikeGeneratorGroup("input", numNeurPerGroup, EXCITATORY_NEURON);
+	int gOut = sim->createGroup("output", numNeurPerGroup, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	for (int g = 0; g < numGroups; g++)
+		sim->connect(g, gOut, "random", RangeWeight(0.5f), 0.01f, RangeDelay(1));
+	sim->setConductances(false);
+
+	// ---------------- SETUP STATE -------------------
+	sim->setupNetwork();
+	for (int g = 0; g < numGroups; g++)
+		sim->setSpikeRate(g, rate);
+	return sim;
+}
+
+// Benchmark for the spike monitors
+// Two copies of a network with many Poisson groups are simulated one second at a time: one with a recording spike
+// monitor on every group (numGroups inputs plus one output), the other without any monitors. Both networks simulate exactly the same spikes, so the
+// difference in run time is the time spent moving spikes into the monitors. The two networks take turns every
+// second, so that both see the same load on the machine.
+// Usage: benchmark_spike_monitor_demux [number of groups (default: 64)] [number of seconds (default: 20)]
+int main(int argc, const char* argv[]) {
+	int numGroups = (argc > 1) ? atoi(argv[1]) : 64;
+	int numSec = (argc > 2) ? atoi(argv[2]) : 20;
+	int numNeurPerGroup = 100;
+	PoissonRate rate(numNeurPerGroup);
+	rate.setRates(20.0f);
+
+	CARLsim* sim[2];
+	std::vector<SpikeMonitor*> spkMon;
+	double runTimeMs[2] = {0.0, 0.0};
+
+	for (int monitored = 0; monitored < 2; monitored++)
+		sim[monitored] = createNetwork(numGroups, numNeurPerGroup, &rate);
+	for (int g = 0; g < sim[1]->getNumGroups(); g++) {
+		spkMon.push_back(sim[1]->setSpikeMonitor(g, "NULL"));
+		spkMon[g]->startRecording();
+	}
+
+	// ---------------- RUN STATE -------------------
+	for (int s = 0; s < numSec; s++) {
+		for (int monitored = 0; monitored < 2; monitored++) {
+			double startMs = getWallTimeMs();
+			sim[monitored]->runNetwork(1, 0, false);
+			runTimeMs[monitored] += getWallTimeMs() - startMs;
+		}
+	}
+
+	int spikeCnt = 0;
+	for (unsigned int g = 0; g < spkMon.size(); g++) {
+		spkMon[g]->stopRecording();
+		spikeCnt += spkMon[g]->getPopNumSpikes();
+	}
+	for (int monitored = 0; monitored < 2; monitored++)
+		delete sim[monitored];
+
+	printf("%d groups of %d neurons, %d s, %d spikes recorded\n", numGroups, numNeurPerGroup, numSec, spikeCnt);
+	printf("without monitors  %8.1f ms per simulated second\n", runTimeMs[0]/numSec);
+	printf("with monitors     %8.1f ms per simulated second\n", runTimeMs[1]/numSec);
+	printf("monitor overhead  %8.1f ms per simulated second\n", (runTimeMs[1] - runTimeMs[0])/numSec);
+
+	return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// include CARLsim user interface
+#include <carlsim.h>
+
+#if defined(WIN32) || defined(WIN64)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+// returns the time in us from a monotonic clock
+static double getWallTimeUs() {
+#if defined(WIN32) || defined(WIN64)
+	LARGE_INTEGER cnt, freq;
+	QueryPerformanceCounter(&cnt);
+	QueryPerformanceFrequency(&freq);
+	return cnt.QuadPart*1e6/freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec*1e6 + ts.tv_nsec/1e3;
+#endif
+}
+
+// prints the median, 99th percentile, and maximum of the per-step times
+static void printLatency(const char* name, std::vector<double> stepTimeUs) {
+	std::sort(stepTimeUs.begin(), stepTimeUs.end());
+	size_t n = stepTimeUs.size();
+	printf("%-24s p50 %8.1f us   p99 %8.1f us   max %8.1f us\n", name, stepTimeUs[n/2],
+		stepTimeUs[std::min(n-1, n*99/100)], stepTimeUs[n-1]);
+}
+
+//! builds a small controller network: sensory input -> 100 excitatory / 25 inhibitory neurons -> motor output
+static CARLsim* createNetwork(int numSensory, int* gSensory, int* gMotor) {
+	// ---------------- CONFIG STATE -------------------
+	CARLsim* sim = new CARLsim("benchmark_step_latency", CPU_MODE, SILENT, 0, 42);
+
+	*gSensory = sim->createGroup("sensory", numSensory, EXCITATORY_NEURON);
+	int gExc = sim->createGroup("exc", 100, EXCITATORY_NEURON);
+	int gInh = sim->createGroup("inh", 25, INHIBITORY_NEURON);
+	*gMotor = sim->createGroup("motor", 10, EXCITATORY_NEURON);
+	sim->setNeuronParameters(*gSensory, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+	sim->setNeuronParameters(*gMotor, 0.02f, 0.2f, -65.0f, 8.0f);
+
+	sim->connect(*gSensory, gExc, "random", RangeWeight(0.1f), 0.2f, RangeDelay(1,5));
+	sim->connect(gExc, gExc, "random", RangeWeight(0.02f), 0.1f, RangeDelay(1,10));
+	sim->connect(gExc, gInh, "random", RangeWeight(0.05f), 0.2f, RangeDelay(1));
+	sim->connect(gInh, gExc, "random", RangeWeight(0.2f), 0.2f, RangeDelay(1));
+	sim->connect(gExc, *gMotor, "random", RangeWeight(0.05f), 0.2f, RangeDelay(1));
+	sim->setConductances(true);
+
+	// ---------------- SETUP STATE -------------------
+	sim->setupNetwork();
+	return sim;
+}
+
+// Benchmark for CARLsim::step
+// Two copies of a small controller network, with a spike monitor on every group, are advanced one ms at a time: one
+// with runNetwork(0,1), the other with step() followed by getLastStepSpikes on the motor group. The two networks take
+// turns every ms, so that both see the same load on the machine. Every ms a new sensory input is applied (not timed).
+// Both networks simulate exactly the same spikes.
+// Usage: benchmark_step_latency [number of steps (default: 10000)]
+int main(int argc, const char* argv[]) {
+	int numSteps = (argc > 1) ? atoi(argv[1]) : 10000;
+	int numSensory = 20;
+	CARLsim* sim[2];
+	int gSensory[2], gMotor[2];
+	std::vector<SpikeMonitor*> spkMon[2];
+	std::vector<double> stepTimeUs[2];
+
+	for (int stepping = 0; stepping < 2; stepping++) {
+		sim[stepping] = createNetwork(numSensory, &gSensory[stepping], &gMotor[stepping]);
+		for (int g = 0; g < sim[stepping]->getNumGroups(); g++) {
+			spkMon[stepping].push_back(sim[stepping]->setSpikeMonitor(g, "NULL"));
+			spkMon[stepping][g]->startRecording();
+		}
+	}
+
+	// ---------------- RUN STATE -------------------
+	std::vector<float> current(numSensory);
+	std::vector<int> motorSpikes;
+	for (int t = 0; t < numSteps; t++) {
+		// a slowly varying sensory input
+		for (int i = 0; i < numSensory; i++)
+			current[i] = 5.0f + ((i + t/50)%10);
+
+		for (int stepping = 0; stepping < 2; stepping++) {
+			sim[stepping]->setExternalCurrent(gSensory[stepping], current);
+
+			double startUs = getWallTimeUs();
+			if (stepping) {
+				sim[stepping]->step();
+				sim[stepping]->getLastStepSpikes(gMotor[stepping], motorSpikes);
+			} else {
+				sim[stepping]->runNetwork(0, 1, false);
+			}
+			stepTimeUs[stepping].push_back(getWallTimeUs() - startUs);
+		}
+	}
+
+	int spikeCnt[2] = {0, 0};
+	for (int stepping = 0; stepping < 2; stepping++) {
+		for (unsigned int g = 0; g < spkMon[stepping].size(); g++) {
+			spkMon[stepping][g]->stopRecording();
+			spikeCnt[stepping] += spkMon[stepping][g]->getPopNumSpikes();
+		}
+		delete sim[stepping];
+	}
+
+	printf("%d steps of 1 ms\n", numSteps);
+	printLatency("runNetwork(0,1)", stepTimeUs[0]);
+	printLatency("step()", stepTimeUs[1]);
+	printf("Spikes: %d (runNetwork), %d (step)\n", spikeCnt[0], spikeCnt[1]);
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// include CARLsim user interface
+#include <carlsim.h>
+
+#if defined(WIN32) || defined(WIN64)
+#include <stopwatch.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+// Benchmark for CARLsim::setIncrementalWeightUpdate
+// A large plastic network with sparse activity is run once with the default weight update (which visits every plastic
+// synapse every 10 ms) and once with the incremental weight update (which only visits neurons that were active).
+// Usage: benchmark_weight_update [input rate in Hz (default: 1)] [simulation time in s (default: 10)]
+int main(int argc, const char* argv[]) {
+	float inputRateHz = (argc > 1) ? atof(argv[1]) : 1.0f;
+	int runTimeSec = (argc > 2) ? atoi(argv[2]) : 10;
+
+	int numPre = 2000;
+	int numPost = 2000;
+	uint64_t runTimeMs[2];
+	int spikeCnt[2];
+
+	for (int incremental = 0; incremental < 2; incremental++) {
+		// ---------------- CONFIG STATE -------------------
+		CARLsim sim("benchmark_weight_update", CPU_MODE, SILENT, 0, 42);
+
+		int gin = sim.createSpikeGeneratorGroup("input", numPre, EXCITATORY_NEURON);
+		int gout = sim.createGroup("output", numPost, EXCITATORY_NEURON);
+		sim.setNeuronParameters(gout, 0.02f, 0.2f, -65.0f, 8.0f);
+
+		// 20% connectivity: 800k plastic synapses
+		sim.connect(gin, gout, "random", RangeWeight(0.0f, 2.0f, 4.0f), 0.2f, RangeDelay(1,20), RadiusRF(-1),
+			SYN_PLASTIC);
+		sim.setConductances(false);
+		sim.setESTDP(gout, true, STANDARD, ExpCurve(0.01f, 20.0f, -0.012f, 20.0f));
+		sim.setWeightAndWeightChangeUpdate(INTERVAL_10MS, false);
+		sim.setIncrementalWeightUpdate(incremental==1);
+
+		// ---------------- SETUP STATE -------------------
+		sim.setupNetwork();
+		SpikeMonitor* spkMon = sim.setSpikeMonitor(gout, "NULL");
+
+		PoissonRate in(numPre);
+		in.setRates(inputRateHz);
+		sim.setSpikeRate(gin, &in);
+
+		// ---------------- RUN STATE -------------------
+		Stopwatch watch(false);
+		watch.start(incremental ? "incremental" : "full sweep");
+		spkMon->startRecording();
+		sim.runNetwork(runTimeSec, 0, false);
+		spkMon->stopRecording();
+		runTimeMs[incremental] = watch.stop(false);
+		spikeCnt[incremental] = spkMon->getPopNumSpikes();
+	}
+
+	printf("Input rate: %.1f Hz, %d s simulation time\n", inputRateHz, runTimeSec);
+	printf("Full sweep:         %6llu ms (%d output spikes)\n", (unsigned long long)runTimeMs[0], spikeCnt[0]);
+	printf("Incremental update: %6llu ms (%d output spikes)\n", (unsigned long long)runTimeMs[1], spikeCnt[1]);
+	printf("Speedup:            %6.2fx\n", (double)runTimeMs[0]/(runTimeMs[1]>0 ? runTimeMs[1] : 1));
+
+	return 0;
+}
@@ -6,6 +6,8 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstdio>
+#include <cmath>
+#include <pthread.h>
 #include <vector>
 
 using namespace std;
@@ -15,92 +17,59 @@ namespace CARLsim_PTI {
     class TuneFiringRatesECJExperiment : public Experiment {
     public:
 
-			TuneFiringRatesECJExperiment() {}
-
-			void run(const ParameterInstances &parameters, std::ostream &outputStream) const {
-				// Decay constants
-				const float COND_tAMPA=5.0, COND_tNMDA=150.0, COND_tGABAa=6.0, COND_tGABAb=150.0;
-
-				// Neurons
-				const int NUM_NEURONS = 10;
+			TuneFiringRatesECJExperiment() {
+				pthread_mutex_init(&poolLock, NULL);
+			}
 
-				// Izhikevich parameters
-				const float REG_IZH[] = { 0.02f, 0.2f, -65.0f, 8.0f };
-				const float FAST_IZH[] = { 0.1f, 0.2f, -65.0f, 2.0f };
+			~TuneFiringRatesECJExperiment() {
+				for (unsigned int k = 0; k < pool.size(); k++) {
+					delete pool[k]->network;
+					delete pool[k]->in;
+					delete pool[k];
+				}
+				pthread_mutex_destroy(&poolLock);
+			}
 
+			void run(const ParameterInstances &parameters, std::ostream &outputStream) const {
 				// Simulation time (each must be at least 1s due to bug in SpikeMonitor)
 				const int runTime = 2;
 
 				// Target rates for the objective function
-				const float INPUT_TARGET_HZ = 30.0f;
 				const float EXC_TARGET_HZ   = 10.0f;
 				const float INH_TARGET_HZ   = 20.0f;
 
 				int indiNum = parameters.getNumInstances();
 
-				int poissonGroup[indiNum];
-				int excGroup[indiNum];
-				int inhGroup[indiNum];
-				SpikeMonitor* excMonitor[indiNum];
-				SpikeMonitor* inhMonitor[indiNum];
 				float excHz[indiNum];
 				float inhHz[indiNum];
 				float excError[indiNum];
 				float inhError[indiNum];
 				float fitness[indiNum];
-				/** construct a CARLsim network on the heap. */
-				CARLsim* const network = new CARLsim("tuneFiringRatesECJ", CPU_MODE, SILENT);
 
-				for(unsigned int i = 0; i < parameters.getNumInstances(); i++) {
-					/** Decode a genome*/
-					poissonGroup[i] = network->createSpikeGeneratorGroup("poisson", NUM_NEURONS, EXCITATORY_NEURON);
-					excGroup[i] = network->createGroup("exc", NUM_NEURONS, EXCITATORY_NEURON);
-					inhGroup[i] = network->createGroup("inh", NUM_NEURONS, INHIBITORY_NEURON);
-
-					network->setNeuronParameters(excGroup[i], REG_IZH[0], REG_IZH[1], REG_IZH[2], REG_IZH[3]);
-					network->setNeuronParameters(inhGroup[i], FAST_IZH[0], FAST_IZH[1], FAST_IZH[2], FAST_IZH[3]);
-					network->setConductances(true,COND_tAMPA,COND_tNMDA,COND_tGABAa,COND_tGABAb);
-
-					network->connect(poissonGroup[i], excGroup[i], "random", RangeWeight(parameters.getParameter(i,0)), 0.5f, RangeDelay(1));
-					network->connect(excGroup[i], excGroup[i], "random", RangeWeight(parameters.getParameter(i,1)), 0.5f, RangeDelay(1));
-					network->connect(excGroup[i], inhGroup[i], "random", RangeWeight(parameters.getParameter(i,2)), 0.5f, RangeDelay(1));
-					network->connect(inhGroup[i], excGroup[i], "random", RangeWeight(parameters.getParameter(i,3)), 0.5f, RangeDelay(1));
-
-				}
-
-				// can't call setupNetwork() multiple times in the loop
-				network->setupNetwork();
-
-				// it's unnecessary to do this in the loop
-				PoissonRate* const in = new PoissonRate(NUM_NEURONS);
-				/*for (int k=0;k<NUM_NEURONS;k++)*/
-					/*in->rates[k] = INPUT_TARGET_HZ;*/
-				in->setRates(INPUT_TARGET_HZ);
+				// building the network is the expensive part: reuse one from an earlier call if possible (see PTI
+				// option -persistent), after bringing it back to the state right after setupNetwork
+				Network* const net = acquireNetwork(indiNum);
 
 				for(unsigned int i = 0; i < parameters.getNumInstances(); i++) {
-					network->setSpikeRate(poissonGroup[i],in);
-
-					excMonitor[i] = network->setSpikeMonitor(excGroup[i], "/dev/null");
-					inhMonitor[i] = network->setSpikeMonitor(inhGroup[i], "/dev/null");
-
-					excMonitor[i]->startRecording();
-					inhMonitor[i]->startRecording();
+					/** Decode a genome: every individual is a replica of the same network */
+					for (int c = 0; c < NUM_CONNECTIONS; c++)
+						net->network->setReplicaWeight(net->connId[c], i, parameters.getParameter(i,c), true);
 
 					// initialize all the error and fitness variables
 					excHz[i]=0; inhHz[i]=0;
 					excError[i]=0; inhError[i]=0;
 					fitness[i]=0;
 				}
-				// again, we can't call this more than once.
-				network->runNetwork(runTime,0);
-
-				for(unsigned int i = 0; i < parameters.getNumInstances(); i++) {
 
-					excMonitor[i]->stopRecording();
-					inhMonitor[i]->stopRecording();
+				net->excMonitor->startRecording();
+				net->inhMonitor->startRecording();
+				net->network->runNetwork(runTime,0);
+				net->excMonitor->stopRecording();
+				net->inhMonitor->stopRecording();
 
-					excHz[i] = excMonitor[i]->getPopMeanFiringRate();
-					inhHz[i] = inhMonitor[i]->getPopMeanFiringRate();
+				for(unsigned int i = 0; i < parameters.getNumInstances(); i++) {
+					excHz[i] = net->excMonitor->getReplicaMeanFiringRate(i);
+					inhHz[i] = net->inhMonitor->getReplicaMeanFiringRate(i);
 
 					excError[i] = fabs(excHz[i] - EXC_TARGET_HZ);
 					inhError[i] = fabs(inhHz[i] - INH_TARGET_HZ);
@@ -108,8 +77,108 @@ namespace CARLsim_PTI {
 					fitness[i] = 1/(excError[i] + inhError[i]);
 					outputStream << fitness[i] << endl;
 				}
-				delete network;
-				delete in;
+				releaseNetwork(net);
+			}
+
+    private:
+			static const int NUM_CONNECTIONS = 4;
+
+			/** A network that evaluates a certain number of individuals, one replica (see
+			 * CARLsim::setNumReplicas) per individual. */
+			struct Network {
+				CARLsim* network;
+				PoissonRate* in;
+				int numIndividuals;
+				std::vector<short int> connId;
+				SpikeMonitor* excMonitor;
+				SpikeMonitor* inhMonitor;
+			};
+
+			/** Networks that are not in use right now. With -parallel, every thread ends up with a network of its
+			 * own. */
+			mutable std::vector<Network*> pool;
+			mutable pthread_mutex_t poolLock;
+
+			Network* acquireNetwork(int indiNum) const {
+				Network* net = NULL;
+				pthread_mutex_lock(&poolLock);
+				for (unsigned int k = 0; k < pool.size(); k++) {
+					if (pool[k]->numIndividuals == indiNum) {
+						net = pool[k];
+						pool.erase(pool.begin() + k);
+						break;
+					}
+				}
+				pthread_mutex_unlock(&poolLock);
+
+				if (net == NULL)
+					return buildNetwork(indiNum);
+				net->network->resetState();
+				return net;
+			}
+
+			void releaseNetwork(Network* net) const {
+				pthread_mutex_lock(&poolLock);
+				pool.push_back(net);
+				pthread_mutex_unlock(&poolLock);
+			}
+
+			Network* buildNetwork(int indiNum) const {
+				// Decay constants
+				const float COND_tAMPA=5.0, COND_tNMDA=150.0, COND_tGABAa=6.0, COND_tGABAb=150.0;
+
+				// Neurons
+				const int NUM_NEURONS = 10;
+
+				// Izhikevich parameters
+				const float REG_IZH[] = { 0.02f, 0.2f, -65.0f, 8.0f };
+				const float FAST_IZH[] = { 0.1f, 0.2f, -65.0f, 2.0f };
+
+				const float INPUT_TARGET_HZ = 30.0f;
+
+				Network* const net = new Network;
+				net->numIndividuals = indiNum;
+
+				/** construct a CARLsim network on the heap. The topology is built once and shared by all
+				 * individuals. */
+				net->network = new CARLsim("tuneFiringRatesECJ", CPU_MODE, SILENT);
+				net->network->setNumReplicas(indiNum);
+
+				int poissonGroup = net->network->createSpikeGeneratorGroup("poisson", NUM_NEURONS, EXCITATORY_NEURON);
+				int excGroup = net->network->createGroup("exc", NUM_NEURONS, EXCITATORY_NEURON);
+				int inhGroup = net->network->createGroup("inh", NUM_NEURONS, INHIBITORY_NEURON);
+
+				net->network->setNeuronParameters(excGroup, REG_IZH[0], REG_IZH[1], REG_IZH[2], REG_IZH[3]);
+				net->network->setNeuronParameters(inhGroup, FAST_IZH[0], FAST_IZH[1], FAST_IZH[2], FAST_IZH[3]);
+				net->network->setConductances(true,COND_tAMPA,COND_tNMDA,COND_tGABAa,COND_tGABAb);
+
+				// the weights are set by every call to run
+				for (int c = 0; c < NUM_CONNECTIONS; c++)
+					net->connId.push_back(net->network->connect(getPreGroup(c, poissonGroup, excGroup, inhGroup),
+						getPostGroup(c, excGroup, inhGroup), "random", RangeWeight(0.1f), 0.5f, RangeDelay(1)));
+
+				net->network->setupNetwork();
+
+				// every replica gets the same input rates
+				net->in = new PoissonRate(net->network->getGroupNumNeurons(poissonGroup));
+				net->in->setRates(INPUT_TARGET_HZ);
+				net->network->setSpikeRate(poissonGroup,net->in);
+
+				net->excMonitor = net->network->setSpikeMonitor(excGroup, "/dev/null");
+				net->inhMonitor = net->network->setSpikeMonitor(inhGroup, "/dev/null");
+				return net;
+			}
+
+			/** The connections of an individual are poisson-exc, exc-exc, exc-inh, and inh-exc, in the order of the
+			 * parameters. */
+			static int getPreGroup(int c, int poissonGroup, int excGroup, int inhGroup) {
+				const int pre[NUM_CONNECTIONS] = { poissonGroup, excGroup, excGroup, inhGroup };
+				return pre[c];
+			}
+
+			static int getPostGroup(int c, int excGroup, int inhGroup) {
+				const int post[NUM_CONNECTIONS] = { excGroup, excGroup, inhGroup, excGroup };
+				return post[c];
 			}
 		};
 }
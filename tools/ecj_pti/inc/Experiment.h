@@ -8,6 +8,13 @@
 namespace CARLsim_PTI {
     class Experiment {
     public:
+        /*! Evaluate the individuals in parameters and write one line of
+         * output per individual.
+         *
+         * In persistent mode (see PTI::usage), run is called once per batch on
+         * the same Experiment object, so an Experiment may build its CARLsim
+         * network on the first call and reuse it (see CARLsim::resetState)
+         * for all later batches. */
         virtual void run(const ParameterInstances &parameters, std::ostream &outputStream) const = 0;
     };
 }
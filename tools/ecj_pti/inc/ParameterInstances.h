@@ -20,6 +20,14 @@ namespace CARLsim_PTI {
          * than the second column (since we must have min <= max).
          */
         ParameterInstances(std::istream &inputStream, const bool firstColumnIsSubPopulation = false);
+
+        /*! Copy the individuals first..first+count-1 (and their
+         * subpopulations) of source, e.g. to evaluate them separately.
+         *
+         * Throws std::out_of_range if source has fewer than first+count
+         * individuals.
+         */
+        ParameterInstances(const ParameterInstances &source, const unsigned int first, const unsigned int count);
         
         ~ParameterInstances();
 
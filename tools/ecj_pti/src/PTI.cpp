@@ -4,25 +4,168 @@
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <pthread.h>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <typeinfo>
+#include <vector>
 
 using namespace CARLsim_PTI;
 
 namespace CARLsim_PTI {
     struct PTI::PTIImpl {
         std::ostream &outputStream;
+        const bool persistent;
+        const bool firstColumnIsSubPopulation;
+        const std::auto_ptr<std::ifstream> inputFile;
+        std::istream &inputStream;
         const std::auto_ptr<ParameterInstances> instances;
+        const int numWorkers;
+        const bool printTiming;
         
-        PTIImpl(const char* const fileName, const bool firstColumnIsSubPopulation, std::istream &defaultInputStream, std::ostream &outputStream):
+        PTIImpl(const char* const fileName, const bool firstColumnIsSubPopulation, std::istream &defaultInputStream, std::ostream &outputStream, const int numWorkers, const bool printTiming, const bool persistent):
                 outputStream(outputStream),
-                instances(loadParameterInstances(fileName, firstColumnIsSubPopulation, defaultInputStream)) {
+                persistent(persistent),
+                firstColumnIsSubPopulation(firstColumnIsSubPopulation),
+                inputFile(openInputFile(fileName)),
+                inputStream(fileName ? *inputFile : defaultInputStream),
+                instances(persistent ? NULL : new ParameterInstances(inputStream, firstColumnIsSubPopulation)),
+                numWorkers(numWorkers > 1 ? numWorkers : 1),
+                printTiming(printTiming) {
+        }
+
+        /*! The state shared by all worker threads of a parallel run. Workers
+         * take the next individual from a common counter, so that slow
+         * individuals do not hold up the rest of the population. */
+        struct ParallelRun {
+            const Experiment *experiment;
+            const ParameterInstances *instances;
+            unsigned int nextInstance;
+            pthread_mutex_t lock;
+            std::vector<std::string> outputs;
+            std::vector<std::string> errors;
+            std::vector<double> wallTimeMs;
+        };
+
+        static double getWallTimeMs() {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+        }
+
+        /*! Entry point of a worker thread: evaluates one individual at a
+         * time, each in a separate call to Experiment::run, and keeps its
+         * output until all individuals are done. */
+        static void* workerMain(void* arg) {
+            ParallelRun* const run = static_cast<ParallelRun*>(arg);
+            while (true) {
+                pthread_mutex_lock(&run->lock);
+                const unsigned int i = run->nextInstance++;
+                pthread_mutex_unlock(&run->lock);
+                if (i >= run->instances->getNumInstances())
+                    break;
+
+                const ParameterInstances individual(*run->instances, i, 1);
+                std::stringstream output;
+                const double startMs = getWallTimeMs();
+                try {
+                    run->experiment->run(individual, output);
+                } catch (const std::exception &e) {
+                    run->errors[i] = e.what();
+                }
+                run->wallTimeMs[i] = getWallTimeMs() - startMs;
+                run->outputs[i] = output.str();
+            }
+            return NULL;
+        }
+
+        /*! Evaluate the individuals on numWorkers threads and write their
+         * output in the order of the individuals. */
+        void runParallel(const Experiment &experiment, const ParameterInstances &batch) const {
+            const unsigned int numInstances = batch.getNumInstances();
+            ParallelRun run;
+            run.experiment = &experiment;
+            run.instances = &batch;
+            run.nextInstance = 0;
+            pthread_mutex_init(&run.lock, NULL);
+            run.outputs.resize(numInstances);
+            run.errors.resize(numInstances);
+            run.wallTimeMs.resize(numInstances);
+
+            const int numThreads = (numInstances < (unsigned int)numWorkers) ? numInstances : numWorkers;
+            std::vector<pthread_t> threads(numThreads);
+            for (int t = 0; t < numThreads; t++) {
+                if (pthread_create(&threads[t], NULL, &workerMain, &run) != 0)
+                    throw std::runtime_error(std::string("PTI::PTIImpl: Failed to create worker thread."));
+            }
+            for (int t = 0; t < numThreads; t++)
+                pthread_join(threads[t], NULL);
+            pthread_mutex_destroy(&run.lock);
+
+            for (unsigned int i = 0; i < numInstances; i++) {
+                if (!run.errors[i].empty())
+                    throw std::runtime_error(std::string("PTI::PTIImpl: Experiment failed: ") + run.errors[i]);
+            }
+            for (unsigned int i = 0; i < numInstances; i++) {
+                outputStream << run.outputs[i];
+                if (printTiming)
+                    std::cerr << "PTI: individual " << i << " took " << run.wallTimeMs[i] << " ms" << std::endl;
+            }
         }
         
+        /*! Evaluate one set of individuals, in parallel if requested. */
+        void evaluate(const Experiment &experiment, const ParameterInstances &batch) const {
+            if (numWorkers > 1) {
+                runParallel(experiment, batch);
+            } else {
+                const double startMs = getWallTimeMs();
+                experiment.run(batch, outputStream);
+                if (printTiming)
+                    std::cerr << "PTI: " << batch.getNumInstances() << " individuals took " << (getWallTimeMs() - startMs) << " ms" << std::endl;
+            }
+        }
+
+        /*! Read the rows of the next batch, which ends with an empty line or
+         * at the end of the input. Returns false if there is no batch left. */
+        bool readBatch(std::stringstream &batch) const {
+            std::string line;
+            bool foundRow = false;
+            while (std::getline(inputStream, line)) {
+                if (!line.empty() && line[line.size() - 1] == '\r')
+                    line.erase(line.size() - 1);
+                if (line.empty()) {
+                    if (foundRow)
+                        return true;
+                    continue; // ignore empty lines between batches
+                }
+                batch << line << '\n';
+                foundRow = true;
+            }
+            return foundRow;
+        }
+
+        /*! Evaluate batches until the input is closed. The output of every
+         * batch is followed by an empty line and flushed, so that the caller
+         * knows when the batch is done and can send the next one. The
+         * Experiment object lives on between batches, which lets it keep
+         * its network. */
+        void runPersistent(const Experiment &experiment) const {
+            while (true) {
+                std::stringstream rows;
+                if (!readBatch(rows))
+                    break;
+                const ParameterInstances batch(rows, firstColumnIsSubPopulation);
+                evaluate(experiment, batch);
+                outputStream << std::endl;
+                outputStream.flush();
+            }
+        }
+
         static const char* getStringArgument(const char* const option, const int argc, const char* const argv[]) {
             assert(option != NULL);
             for (int i = 0; i < argc - 1; i++) {
@@ -36,7 +179,7 @@ namespace CARLsim_PTI {
             assert(option != NULL);
             if (argc < 0)
                 throw std::invalid_argument(std::string("PTI::PTIImpl: argc is negative."));
-            if (argv == NULL)
+            if (argc > 0 && argv == NULL)
                 throw std::invalid_argument(std::string("PTI::PTIImpl: argv is NULL."));
             for (int i = 0; i < argc - 1; i++) {
                 if (0 == strcmp(option, argv[i]))
@@ -56,40 +199,36 @@ namespace CARLsim_PTI {
             return false;
         }
         
-        /*! Parse command line arguments and read in the parameter values to be
-         * used in an Experiment, allocating a ParameterInstances on the heap. */
-        static ParameterInstances* loadParameterInstances(const char* const fileName, const bool firstColumnIsSubPopulation, std::istream &defaultInputStream) {
-            // I asked the following SO question while deciding how to write this method: http://stackoverflow.com/questions/23049166/initialize-polymorphic-variable-on-stack
-            std::istream * const input(fileName ? new std::ifstream(fileName, std::ifstream::in) : &defaultInputStream); 
-            
-            if (fileName) {
-                if (!dynamic_cast<std::ifstream*>(input)->is_open())
-                    throw std::invalid_argument(std::string("PTI::PTIImpl: Failed to open file") + std::string(fileName) + std::string("."));
-            }
-            
-            ParameterInstances* const result = new ParameterInstances(*input, firstColumnIsSubPopulation);
-            
-            if (fileName) {
-                dynamic_cast<std::ifstream*>(input)->close();
-                delete(input);
+        /*! Open the csv file given on the command line, if any. */
+        static std::ifstream* openInputFile(const char* const fileName) {
+            if (!fileName)
+                return NULL;
+            std::ifstream* const input = new std::ifstream(fileName, std::ifstream::in);
+            if (!input->is_open()) {
+                delete input;
+                throw std::invalid_argument(std::string("PTI::PTIImpl: Failed to open file") + std::string(fileName) + std::string("."));
             }
-            return result;
+            return input;
         }
         
         bool repOK() const {
-            return instances.get() != NULL;
+            return persistent || instances.get() != NULL;
         }
     };
 }
 
 PTI::PTI(const int argc, const char* const argv[], std::ostream &outputStream):
-        impl(new PTIImpl(PTIImpl::getStringArgument("-f", argc, argv), PTIImpl::getFlagArgument("-subPops", argc, argv), std::cin, outputStream)) {
+        impl(new PTIImpl(PTIImpl::getStringArgument("-f", argc, argv), PTIImpl::getFlagArgument("-subPops", argc, argv), std::cin, outputStream,
+                PTIImpl::getIntegerArgument("-parallel", argc, argv), PTIImpl::getFlagArgument("-timing", argc, argv),
+                PTIImpl::getFlagArgument("-persistent", argc, argv))) {
     
     assert(repOK());
 }
 
 PTI::PTI(const int argc, const char* const argv[], std::ostream &outputStream, std::istream &defaultInputStream):
-        impl(new PTIImpl(PTIImpl::getStringArgument("-f", argc, argv), PTIImpl::getFlagArgument("-subPops", argc, argv), defaultInputStream, outputStream)) {
+        impl(new PTIImpl(PTIImpl::getStringArgument("-f", argc, argv), PTIImpl::getFlagArgument("-subPops", argc, argv), defaultInputStream, outputStream,
+                PTIImpl::getIntegerArgument("-parallel", argc, argv), PTIImpl::getFlagArgument("-timing", argc, argv),
+                PTIImpl::getFlagArgument("-persistent", argc, argv))) {
     
     assert(repOK());
 }
@@ -104,11 +243,26 @@ std::string PTI::usage() const {
     std::string("Format of csv file: Each row represents a single \nindividual, while \
   each csv represents a min or max value for a parameter. \nEach csv is a float.\
   If there are 4 individuals with 4 parameters, \nthen there will be four rows, \
-  each with 8 csv (2 for each parameter).\n\n");
+  each with 8 csv (2 for each parameter).\n\n") +
+    std::string("Options:\n\n") +
+    std::string("-parallel <n>  evaluate the individuals on n threads, one Experiment::run \n\
+  call per individual. The output is written in the order of the individuals. \n\
+  The Experiment must be safe to run from several threads at once (e.g., build \n\
+  its own CARLsim network with a distinct name).\n\n") +
+    std::string("-timing  print the wall time of every individual (or of the whole \n\
+  population if not run in parallel) to stderr.\n\n") +
+    std::string("-persistent  keep running and evaluate one batch of individuals after the \n\
+  other. Batches are separated by an empty line, and the output of every batch is \n\
+  followed by an empty line. The same Experiment object evaluates all batches, \n\
+  so it can keep its network alive between generations.\n\n");
 }
 
 void PTI::runExperiment(const Experiment& experiment) const {
-    experiment.run(*(impl.get()->instances.get()), impl.get()->outputStream);
+    PTIImpl* const p = impl.get();
+    if (p->persistent)
+        p->runPersistent(experiment);
+    else
+        p->evaluate(experiment, *(p->instances.get()));
     assert(repOK());
 }
 
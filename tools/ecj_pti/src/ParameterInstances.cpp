@@ -24,6 +24,14 @@ namespace CARLsim_PTI {
             assert(repOK());
         }
 
+        ParameterInstancesImpl(const ParameterInstancesImpl &source, const unsigned int first, const unsigned int count) {
+            if (first + count > source.getNumInstances())
+                throw out_of_range(string(typeid(*this).name()) + string(": requested individuals are out of range."));
+            instanceVectors.assign(source.instanceVectors.begin() + first, source.instanceVectors.begin() + first + count);
+            subPopulations.assign(source.subPopulations.begin() + first, source.subPopulations.begin() + first + count);
+            assert(repOK());
+        }
+
         void readCSV(istream &inputStream, vector< vector<double> > &instanceVectors, vector< unsigned int > &subPopulations, const bool firstColumnIsSubPopulation) {
             string strLine;
             // Iterate through each individual (row))
@@ -103,6 +111,11 @@ ParameterInstances::ParameterInstances(istream &inputStream, const bool firstCol
     assert(repOK());
 }
 
+ParameterInstances::ParameterInstances(const ParameterInstances &source, const unsigned int first, const unsigned int count):
+ impl(*new ParameterInstancesImpl(source.impl, first, count)) {
+    assert(repOK());
+}
+
 ParameterInstances::~ParameterInstances() {
     delete(&impl);
 }
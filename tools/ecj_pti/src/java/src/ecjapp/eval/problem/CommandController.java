@@ -23,12 +23,27 @@ public class CommandController {
     private final String commandPath;
     private final Option<String> arguments;
     private final Option<RemoteLoginInfo> remoteInfo;
+    private final boolean persistent;
+    
+    /** The running program in persistent mode (started by the first call to execute). */
+    private Process persistentProcess;
+    private Writer persistentInput;
+    private BufferedReader persistentOutput;
     
     public String getCommandPath() { return commandPath; }
     public Option<String> getArguments() { return arguments; }
     public Option<RemoteLoginInfo> getRemoteLoginInfo() { return remoteInfo; }
+    public boolean isPersistent() { return persistent; }
     
     public CommandController(final String commandPath, final Option<String> arguments, final Option<RemoteLoginInfo> remoteLoginInfo) throws IllegalArgumentException {
+        this(commandPath, arguments, remoteLoginInfo, false);
+    }
+    
+    /** @param persistent If true, the program is started only once and
+     * evaluates one batch of individuals after the other (it must have been
+     * started with the PTI's -persistent option, which is added to the
+     * arguments automatically). */
+    public CommandController(final String commandPath, final Option<String> arguments, final Option<RemoteLoginInfo> remoteLoginInfo, final boolean persistent) throws IllegalArgumentException {
         if (commandPath == null)
             throw new IllegalArgumentException(this.getClass().getSimpleName() + ": binaryPath is null.");
         if (commandPath.isEmpty())
@@ -40,6 +55,7 @@ public class CommandController {
         this.commandPath = commandPath;
         this.arguments = arguments;
         this.remoteInfo = remoteLoginInfo; // Immutable
+        this.persistent = persistent;
         assert(repOK());
     }
     
@@ -50,6 +66,8 @@ public class CommandController {
     public String execute(final List<DoubleVectorIndividual> individuals, final Option<List<Integer>> subPopulations, final String additionalArguments) throws IOException, InterruptedException {
         assert(individuals != null);
         assert(additionalArguments != null);
+        if (persistent)
+            return executePersistent(individuals, subPopulations);
         final String allArguments = (arguments.isDefined() ? arguments.get() : "") + (additionalArguments.isEmpty() ? "" : " " + additionalArguments);
         String carlsimShellCommand = String.format("%s %s", commandPath, allArguments);
         if (remoteInfo.isDefined())
@@ -65,6 +83,43 @@ public class CommandController {
         return streamToString(p.getInputStream());
     }
 
+    /** Send the individuals to the running program as one batch, followed
+     * by an empty line, and read its results up to the empty line that ends
+     * them.  The program is started on the first call. */
+    private synchronized String executePersistent(final List<DoubleVectorIndividual> individuals, final Option<List<Integer>> subPopulations) throws IOException {
+        if (persistentProcess == null) {
+            final String allArguments = (arguments.isDefined() ? arguments.get() + " " : "") + "-persistent";
+            String carlsimShellCommand = String.format("%s %s", commandPath, allArguments);
+            if (remoteInfo.isDefined())
+                carlsimShellCommand = remoteInfo.get().getSSHCommand(carlsimShellCommand);
+            persistentProcess = new ProcessBuilder(carlsimShellCommand.split(" ")).redirectError(ProcessBuilder.Redirect.INHERIT).start();
+            persistentInput = new BufferedWriter(new OutputStreamWriter(persistentProcess.getOutputStream()));
+            persistentOutput = new BufferedReader(new InputStreamReader(persistentProcess.getInputStream()));
+        }
+        
+        PopulationToFile.DoubleVectorIndividualsToFile(individuals, subPopulations, persistentInput);
+        persistentInput.write(String.format("%n"));
+        persistentInput.flush();
+        
+        final StringBuilder sb = new StringBuilder();
+        String line;
+        while ((line = persistentOutput.readLine()) != null && !line.isEmpty())
+            sb.append(line).append("\n");
+        if (line == null)
+            throw new IOException(String.format("%s: external command '%s' exited before finishing a batch.", this.getClass().getSimpleName(), commandPath));
+        return sb.toString();
+    }
+    
+    /** Close the input of the running program (in persistent mode), which
+     * makes it exit, and wait for it. */
+    public synchronized void close() throws InterruptedException, IOException {
+        if (persistentProcess == null)
+            return;
+        persistentInput.close(); // Sends EOF
+        persistentProcess.waitFor();
+        persistentProcess = null;
+    }
+
     private String streamToString(final InputStream s) throws IOException {
         final BufferedReader reader = new BufferedReader(new InputStreamReader(s));
         final StringBuilder sb = new StringBuilder();
@@ -88,6 +143,7 @@ public class CommandController {
         hash = 37 * hash + (this.commandPath != null ? this.commandPath.hashCode() : 0);
         hash = 37 * hash + (this.arguments != null ? this.arguments.hashCode() : 0);
         hash = 37 * hash + (this.remoteInfo != null ? this.remoteInfo.hashCode() : 0);
+        hash = 37 * hash + (this.persistent ? 1 : 0);
         return hash;
     }
     
@@ -98,12 +154,13 @@ public class CommandController {
         final CommandController ref = (CommandController) o;
         return commandPath.equals(ref.commandPath)
                 && arguments.equals(ref.arguments)
-                && remoteInfo.equals(ref.remoteInfo);
+                && remoteInfo.equals(ref.remoteInfo)
+                && persistent == ref.persistent;
     }
     
     @Override
     public String toString() {
-        return String.format("[%s: commandPath=\"%s\", arguments=\"%s\", remoteInfo=%s]", this.getClass().getSimpleName(), commandPath, arguments.toString(), remoteInfo.toString());
+        return String.format("[%s: commandPath=\"%s\", arguments=\"%s\", remoteInfo=%s, persistent=%b]", this.getClass().getSimpleName(), commandPath, arguments.toString(), remoteInfo.toString(), persistent);
     }
     
     // </editor-fold>
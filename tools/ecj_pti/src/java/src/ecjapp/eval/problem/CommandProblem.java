@@ -51,6 +51,7 @@ public class CommandProblem extends Problem implements SimpleGroupedProblemForm
     public final static String P_REEVALUATE = "reevaluate";
     public final static String P_ERROR_GENES_FILE = "errorGenesFile";
     public final static String P_ERROR_RESULTS_FILE = "errorResultsFile";
+    public final static String P_PERSISTENT = "persistent";
     
     private ObjectiveFunction objective;
     private Option<DynamicArguments> dynamicArguments;
@@ -85,7 +86,10 @@ public class CommandProblem extends Problem implements SimpleGroupedProblemForm
 	}
         else
             this.dynamicArguments = Option.NONE;
-        this.controller = new CommandController(commandPath, commandArguments, remoteInfo);
+        final boolean persistent = state.parameters.getBoolean(base.push(P_PERSISTENT), null, false);
+        if (persistent && dynamicArguments.isDefined())
+            state.output.fatal(String.format("%s: parameter %s cannot be used together with %s, because a persistent command is started only once.", this.getClass().getSimpleName(), base.push(P_PERSISTENT), base.push(P_DYNAMIC_ARGUMENTS)));
+        this.controller = new CommandController(commandPath, commandArguments, remoteInfo, persistent);
         this.reevaluate = state.parameters.getBoolean(base.push(P_REEVALUATE), null, false);
         
         final File genesErrorFile = state.parameters.getFile(base.push(P_ERROR_GENES_FILE),null);
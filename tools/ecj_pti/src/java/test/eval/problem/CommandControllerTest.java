@@ -103,6 +103,22 @@ public class CommandControllerTest {
         assertTrue(sut.repOK());
     }
     
+    /** Test of execute method in persistent mode, of class CARLsimController. */
+    @Test
+    public void testExecutePersistent() throws Exception {
+        System.out.println("execute (persistent)");
+        // cat echoes every batch, including the empty line that ends it (-persistent becomes $0 of the shell).
+        sut = new CommandController("/bin/sh", new Option<String>("-c cat"), Option.NONE, true);
+        
+        for (int i = 0; i < 3; i++) {
+            final String result = sut.execute(testPopulation, Option.NONE, "");
+            final String[] lines = result.split("\n");
+            testCSVEqualsPopulation(lines, testPopulation);
+        }
+        sut.close();
+        assertTrue(sut.repOK());
+    }
+    
     private static void testCSVEqualsPopulation(final String[] lines, List<DoubleVectorIndividual> population) {
         assertEquals(population.size(), lines.length);
         // For the ith line in the CSV
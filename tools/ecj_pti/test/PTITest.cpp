@@ -5,6 +5,7 @@
 
 #include <gtest/gtest.h>
 #include <ostream>
+#include <unistd.h>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -75,3 +76,97 @@ TEST_F(PTITest, RunWithFile) {
     }
     EXPECT_FALSE(getline(outputStream, strLine)) << "Test input had more lines than expected.";
 }
+
+/*! An Experiment that takes the longer the earlier the individual comes in
+ * the input, so that the individuals finish in reverse order when run in
+ * parallel. */
+class SlowFirstExperiment : public Experiment {
+public:
+    SlowFirstExperiment() {}
+
+    void run(const ParameterInstances &parameters, std::ostream &outputStream) const {
+        for(unsigned int i = 0; i < parameters.getNumInstances(); i++) {
+            usleep(50000.0 / parameters.getParameter(i, 0));
+            outputStream << parameters.getParameter(i, 0) << endl;
+        }
+    }
+};
+
+TEST_F(PTITest, RunParallel) {
+    const TestExperiment experiment;
+    std::stringstream inputStream(string("2.82, 6.51, 7.37, 7.67, 2.32, 3.95, 2.22, 5.21\n") +
+            string("2.81, 8.24, 5.11, 7.82, 3.62, 7.00, 1.98, 5.70\n") +
+            string("1.92, 9.74, 2.77, 5.04, 3.74, 6.72, 6.96, 9.26\n") +
+            string("2.95, 6.70, 7.12, 8.85, 4.15, 5.40, 3.19, 6.19"));
+    const char* const argv[2] = { "-parallel", "3" };
+    const PTI sut(2, argv, outputStream, inputStream);
+    sut.runExperiment(experiment);
+    const float expected[4] = { 38.07, 42.28, 46.15, 44.54999999999999 };
+    string strLine;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(getline(outputStream, strLine));
+        EXPECT_FLOAT_EQ(stringToFloat(strLine), expected[i]) << "Experiment returned incorrect sum of parameters.";
+    }
+    EXPECT_FALSE(getline(outputStream, strLine)) << "Test input had more lines than expected.";
+}
+
+TEST_F(PTITest, RunParallelPreservesOrder) {
+    const SlowFirstExperiment experiment;
+    std::stringstream inputStream("1, 1\n2, 2\n4, 4\n8, 8\n16, 16\n32, 32");
+    const char* const argv[2] = { "-parallel", "6" };
+    const PTI sut(2, argv, outputStream, inputStream);
+    sut.runExperiment(experiment);
+    const float expected[6] = { 1, 2, 4, 8, 16, 32 };
+    string strLine;
+    for (int i = 0; i < 6; i++) {
+        ASSERT_TRUE(getline(outputStream, strLine));
+        EXPECT_FLOAT_EQ(stringToFloat(strLine), expected[i]) << "Output is not in the order of the individuals.";
+    }
+    EXPECT_FALSE(getline(outputStream, strLine)) << "Test input had more lines than expected.";
+}
+
+/*! An Experiment that counts how often it has been run, like an Experiment
+ * that builds its network on the first call and reuses it afterwards. */
+class CountingExperiment : public Experiment {
+public:
+    CountingExperiment(): numRuns(0) {}
+
+    void run(const ParameterInstances &parameters, std::ostream &outputStream) const {
+        numRuns++;
+        for(unsigned int i = 0; i < parameters.getNumInstances(); i++)
+            outputStream << parameters.getParameter(i, 0) + parameters.getParameter(i, 1) << endl;
+    }
+
+    mutable int numRuns;
+};
+
+TEST_F(PTITest, RunPersistent) {
+    CountingExperiment experiment;
+    std::stringstream inputStream("1, 2\n3, 4\n\n5, 6\n\n\n7, 8\n9, 10\n");
+    const char* const argv[1] = { "-persistent" };
+    const PTI sut(1, argv, outputStream, inputStream);
+    sut.runExperiment(experiment);
+    EXPECT_EQ(3, experiment.numRuns) << "Every batch must be evaluated by a separate call to Experiment::run.";
+    const char* const expected[8] = { "3", "7", "", "11", "", "15", "19", "" };
+    string strLine;
+    for (int i = 0; i < 8; i++) {
+        ASSERT_TRUE(getline(outputStream, strLine));
+        EXPECT_EQ(string(expected[i]), strLine) << "Batches must be followed by an empty line.";
+    }
+    EXPECT_FALSE(getline(outputStream, strLine)) << "Test input had more lines than expected.";
+}
+
+TEST_F(PTITest, RunPersistentParallel) {
+    const TestExperiment experiment;
+    std::stringstream inputStream("1, 2\n3, 4\n\n5, 6\n");
+    const char* const argv[3] = { "-persistent", "-parallel", "2" };
+    const PTI sut(3, argv, outputStream, inputStream);
+    sut.runExperiment(experiment);
+    const char* const expected[5] = { "3", "7", "", "11", "" };
+    string strLine;
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(getline(outputStream, strLine));
+        EXPECT_EQ(string(expected[i]), strLine);
+    }
+    EXPECT_FALSE(getline(outputStream, strLine)) << "Test input had more lines than expected.";
+}
@@ -76,6 +76,17 @@ TEST_F(ParameterInstancesTest, GoodInput) {
     EXPECT_DEATH(sut.getParameter(0, 8), "");
 }
 
+TEST_F(ParameterInstancesTest, Subset) {
+    const ParameterInstances subset(sut, 1, 2);
+    EXPECT_EQ(subset.getNumInstances(), 2) << "Subset has incorrect number of rows.";
+    EXPECT_EQ(subset.getNumParameters(), 8) << "Subset has incorrect number of parameters.";
+    for (unsigned int i = 0; i < 2; i++)
+        for (unsigned int j = 0; j < 8; j++)
+            EXPECT_EQ(subset.getParameter(i, j), sut.getParameter(i + 1, j));
+    EXPECT_TRUE(subset.repOK());
+    EXPECT_THROW(const ParameterInstances tooMany(sut, 3, 2), std::out_of_range);
+}
+
 TEST_F(ParameterInstancesTest, OddColumnInput) {
     EXPECT_EQ(sut.getNumInstances(), 4) << "Constructor deduced incorrect number of rows.";
     EXPECT_EQ(sut.getNumParameters(), 8) << "Construct deduced incorrect number of parameters.";